@@ -659,6 +659,11 @@ extern DECLSPEC void SDLCALL SDL_MixAudioFormat(Uint8 * dst,
  *  same device from two threads at once does not promise which buffer will
  *  be queued first.
  *
+ *  If SDL_HINT_AUDIO_QUEUE_CAPACITY was set when the device was opened, the
+ *  queue is a fixed size ring that this function fills without locking the
+ *  device. Only one thread may queue audio to it then, and data that doesn't
+ *  fit in the free space is refused as a whole, returning -1.
+ *
  *  You may not queue audio on a device that is using an application-supplied
  *  callback; doing so returns an error. You have to use the audio callback
  *  or queue audio with this function, but not both.
@@ -705,6 +710,11 @@ extern DECLSPEC int SDLCALL SDL_QueueAudio(SDL_AudioDeviceID dev, const void *da
  *  two threads at once does not promise which thread will dequeued data
  *  first.
  *
+ *  If SDL_HINT_AUDIO_QUEUE_CAPACITY was set when the device was opened, the
+ *  queue is a fixed size ring that this function empties without locking the
+ *  device. Only one thread may dequeue audio from it then, and captured data
+ *  that doesn't fit in the ring is dropped.
+ *
  *  You may not dequeue audio from a device that is using an
  *  application-supplied callback; doing so returns an error. You have to use
  *  the audio callback, or dequeue audio with this function, but not both.
@@ -794,6 +804,52 @@ extern DECLSPEC Uint32 SDLCALL SDL_GetQueuedAudioSize(SDL_AudioDeviceID dev);
  */
 extern DECLSPEC void SDLCALL SDL_ClearQueuedAudio(SDL_AudioDeviceID dev);
 
+/**
+ *  \brief Fill levels of a device's audio queue.
+ *
+ *  The watermarks and counts cover the time since the device was opened or
+ *  SDL_ResetQueuedAudioStats() was last called. For playback devices the
+ *  audio thread reads from the queue every callback, so a low watermark near
+ *  zero means playback is about to skip, and an underrun means it did.
+ *
+ *  \sa SDL_GetQueuedAudioStats
+ *  \sa SDL_HINT_AUDIO_QUEUE_CAPACITY
+ */
+typedef struct SDL_AudioQueueStats
+{
+    Uint32 capacity;        /**< Size of the ring in bytes, 0 if the queue grows as needed */
+    Uint32 queued;          /**< Bytes in the queue right now */
+    Uint32 low_watermark;   /**< Least data a read found in the queue */
+    Uint32 high_watermark;  /**< Most data a write left in the queue */
+    Uint32 underruns;       /**< Reads that found less data than they asked for */
+    Uint32 overruns;        /**< Writes that were refused or dropped for lack of space */
+} SDL_AudioQueueStats;
+
+/**
+ *  Get the fill levels of the audio queue of a device opened without a
+ *  callback.
+ *
+ *  This can be called from any thread, and doesn't lock the device if the
+ *  queue is a ring.
+ *
+ *  \param dev The device ID of which to get the queue stats.
+ *  \param stats Filled in with the stats.
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_ResetQueuedAudioStats
+ */
+extern DECLSPEC int SDLCALL SDL_GetQueuedAudioStats(SDL_AudioDeviceID dev, SDL_AudioQueueStats *stats);
+
+/**
+ *  Start the watermarks over from the current fill level and zero the
+ *  underrun and overrun counts.
+ *
+ *  \param dev The device ID of which to reset the queue stats.
+ *
+ *  \sa SDL_GetQueuedAudioStats
+ */
+extern DECLSPEC void SDLCALL SDL_ResetQueuedAudioStats(SDL_AudioDeviceID dev);
+
 
 /**
  *  \name Audio lock functions
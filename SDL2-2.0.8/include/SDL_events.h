@@ -628,6 +628,23 @@ extern DECLSPEC void SDLCALL SDL_FlushEvents(Uint32 minType, Uint32 maxType);
  */
 extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event * event);
 
+/**
+ *  \brief Polls for all currently pending events, up to \c maxevents at a time.
+ *
+ *  The OS event loop is pumped once and then the queue is drained into
+ *  \c events with a single queue lock, which is much cheaper than calling
+ *  SDL_PollEvent() in a loop when many events arrive per frame.
+ *
+ *  Event filters and watchers have already run when the events were added,
+ *  exactly as for SDL_PollEvent().
+ *
+ *  \return The number of events stored in \c events, or -1 if there was an error.
+ *
+ *  \param events    An array of at least \c maxevents events to fill.
+ *  \param maxevents The maximum number of events to return.
+ */
+extern DECLSPEC int SDLCALL SDL_PollEvents(SDL_Event * events, int maxevents);
+
 /**
  *  \brief Waits indefinitely for the next available event.
  *
@@ -135,7 +135,8 @@ extern "C" {
  *
  *  This variable can be set to the following values:
  *    "0" or "nearest" - Nearest pixel sampling
- *    "1" or "linear"  - Linear filtering (supported by OpenGL and Direct3D)
+ *    "1" or "linear"  - Linear filtering (supported by OpenGL, Direct3D and the
+ *                       software renderer for 32-bit textures)
  *    "2" or "best"    - Currently this is the same as "linear"
  *
  *  By default nearest pixel sampling is used
@@ -917,6 +918,40 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_RESAMPLING_MODE   "SDL_AUDIO_RESAMPLING_MODE"
 
+/**
+ *  \brief  A variable controlling the filter used by SDL's internal resampler.
+ *
+ *  The internal resampler is used by SDL_AudioCVT, and by audio streams
+ *  when SDL_HINT_AUDIO_RESAMPLING_MODE doesn't pick libsamplerate.
+ *
+ *  This hint is checked whenever audio is resampled.
+ *
+ *  This variable can be set to the following values:
+ *
+ *    "0" or "default" - Use a 12 tap windowed sinc filter (Default when not set)
+ *    "1" or "fast"    - Use a 4 tap windowed sinc filter, lower quality but faster
+ */
+#define SDL_HINT_AUDIO_INTERNAL_RESAMPLER   "SDL_AUDIO_INTERNAL_RESAMPLER"
+
+/**
+ *  \brief  A variable setting the capacity of the audio queue of devices opened without a callback
+ *
+ *  When set to a number of bytes, SDL_QueueAudio() and SDL_DequeueAudio() use a
+ *  fixed size, lock-free ring shared by one application thread and the audio
+ *  thread, instead of a queue that grows as needed and is locked on every call.
+ *  The capacity is rounded up to a power of 2, and to at least twice the
+ *  device buffer size. Data that doesn't fit in the ring is refused by
+ *  SDL_QueueAudio(), or dropped when capturing. See SDL_GetQueuedAudioStats()
+ *  for the fill levels.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Use a queue that grows as needed (default)
+ *    "N"       - Use a ring of N bytes
+ *
+ *  This hint is checked when an audio device is opened.
+ */
+#define SDL_HINT_AUDIO_QUEUE_CAPACITY   "SDL_AUDIO_QUEUE_CAPACITY"
+
 /**
  *  \brief  A variable controlling the audio category on iOS and Mac OS X
  *
@@ -930,6 +965,83 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_CATEGORY   "SDL_AUDIO_CATEGORY"
 
+/**
+ *  \brief  A variable controlling whether SDL_PushEvent() and SDL_PollEvent() use a lock-free ring
+ *
+ *  When enabled, events pushed from any thread go into a fixed size lock-free
+ *  ring, and SDL_PollEvent() takes them from there without locking the event
+ *  queue. SDL_PeepEvents(), SDL_FlushEvents() and SDL_FilterEvents() move the
+ *  pending ring events into the locked queue first, so they see every event.
+ *  If the ring is full, the pushing thread moves its events into the locked
+ *  queue, so events from one thread always arrive in order. The ring and the
+ *  locked queue together hold at most as many events as the locked queue alone.
+ *
+ *  This helps when several threads push events on a multi-core system. When
+ *  the reader falls behind, as it tends to on a single core, events are copied
+ *  twice and the locked queue is slightly faster.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Events always go through the locked queue (default)
+ *    "1"       - Use the lock-free ring for SDL_PushEvent() and SDL_PollEvent()
+ *
+ *  This hint is checked when the event subsystem is initialized.
+ */
+#define SDL_HINT_EVENT_QUEUE_LOCKFREE   "SDL_EVENT_QUEUE_LOCKFREE"
+
+/**
+ *  \brief  A variable controlling whether surface pixels come from a buffer pool
+ *
+ *  When enabled, SDL_CreateRGBSurface() and friends take their pixel buffers
+ *  from a pool of size classed, 64 byte aligned buffers, and SDL_FreeSurface()
+ *  gives them back to it instead of the heap. This helps apps that create and
+ *  free many short lived surfaces. See SDL_GetSurfacePoolStats() and
+ *  SDL_TrimSurfacePool().
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Surface pixels are allocated with SDL_malloc() (default)
+ *    "1"       - Surface pixels come from the pool
+ *
+ *  This hint is checked each time a surface is created.
+ */
+#define SDL_HINT_SURFACE_POOL   "SDL_SURFACE_POOL"
+
+/**
+ *  \brief  A variable controlling how many threads large software blits may use
+ *
+ *  When set to a number greater than 1, SDL_BlitSurface() splits large
+ *  unscaled blits into bands of rows and runs them on up to that many threads,
+ *  including the calling thread. The result is identical to a single threaded
+ *  blit. Small blits, scaled blits and blits within one surface always run on
+ *  the calling thread. Large YUV to RGB conversions in SDL_ConvertPixels() are
+ *  split the same way.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Blits run on the calling thread (default)
+ *    "N"       - Large blits use up to N threads, e.g. SDL_GetCPUCount()
+ *
+ *  This hint is checked each time a large surface is blitted.
+ */
+#define SDL_HINT_BLIT_THREADS   "SDL_BLIT_THREADS"
+
+/**
+ *  \brief  A variable controlling whether the software renderer only redraws
+ *          and presents the parts of the window that changed
+ *
+ *  When enabled, the software renderer records the drawing commands of each
+ *  frame into the window. If a frame starts with SDL_RenderClear(), its
+ *  commands are compared with the previous frame's at SDL_RenderPresent(),
+ *  only the areas touched by commands that changed are drawn again, and only
+ *  those areas are pushed to the screen with SDL_UpdateWindowSurfaceRects().
+ *  This suits devices without a GPU where most frames change a few widgets.
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Commands are drawn immediately, and the whole window is presented (default)
+ *    "1"       - Commands are batched, and only changed areas are presented
+ *
+ *  This hint is checked when the software renderer is created for a window.
+ */
+#define SDL_HINT_RENDER_SW_DIRTY_RECTS  "SDL_RENDER_SW_DIRTY_RECTS"
+
 #define SDL_HINT_BACKGROUND_AUDIO "SDL_BACKGROUND_AUDIO"
 #define SDL_HINT_BLE "SDL_BLE"
 
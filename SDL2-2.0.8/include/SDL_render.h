@@ -411,6 +411,44 @@ extern DECLSPEC int SDLCALL SDL_UpdateYUVTexture(SDL_Texture * texture,
                                                  const Uint8 *Uplane, int Upitch,
                                                  const Uint8 *Vplane, int Vpitch);
 
+/**
+ *  \brief The function type called when a frame passed to
+ *         SDL_UpdateYUVTextureFrame() is no longer needed.
+ */
+typedef void (SDLCALL * SDL_YUVFrameReleaseCallback) (void *userdata);
+
+/**
+ *  \brief Update a whole YV12, IYUV, NV12 or NV21 texture from a decoded
+ *         frame, without copying the frame first.
+ *
+ *  \param texture   The texture to update
+ *  \param Yplane    The raw pixel data for the Y plane.
+ *  \param Ypitch    The number of bytes between rows of pixel data for the Y plane.
+ *  \param Uplane    The raw pixel data for the U plane, or the interleaved
+ *                   U/V plane for NV12 and NV21 textures.
+ *  \param Upitch    The number of bytes between rows of pixel data for the U plane.
+ *  \param Vplane    The raw pixel data for the V plane, or NULL for NV12 and
+ *                   NV21 textures.
+ *  \param Vpitch    The number of bytes between rows of pixel data for the V plane.
+ *  \param release   A function called once the planes are no longer needed,
+ *                   or NULL.
+ *  \param userdata  A pointer passed to \c release.
+ *
+ *  \return 0 on success, or -1 if the texture is not valid.
+ *
+ *  The planes are uploaded directly, or when the renderer doesn't support the
+ *  format, converted directly into the texture. In that case the frame is
+ *  kept until the texture is next updated, locked or destroyed, so the planes
+ *  must stay valid until \c release is called. \c release is called exactly
+ *  once, which may be before this function returns, even if it fails.
+ */
+extern DECLSPEC int SDLCALL SDL_UpdateYUVTextureFrame(SDL_Texture * texture,
+                                                      const Uint8 *Yplane, int Ypitch,
+                                                      const Uint8 *Uplane, int Upitch,
+                                                      const Uint8 *Vplane, int Vpitch,
+                                                      SDL_YUVFrameReleaseCallback release,
+                                                      void *userdata);
+
 /**
  *  \brief Lock a portion of the texture for write-only pixel access.
  *
@@ -45,6 +45,8 @@ extern "C" {
 #define SDL_RWOPS_JNIFILE   3U  /**< Android asset */
 #define SDL_RWOPS_MEMORY    4U  /**< Memory stream */
 #define SDL_RWOPS_MEMORY_RO 5U  /**< Read-Only memory stream */
+#define SDL_RWOPS_MAPPED    6U  /**< Read-Only memory mapped file */
+#define SDL_RWOPS_BUFFERED  7U  /**< Read-ahead buffer over another stream */
 
 /**
  * This is the read/write operation structure -- very basic.
@@ -165,6 +167,40 @@ extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromMem(void *mem, int size);
 extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromConstMem(const void *mem,
                                                       int size);
 
+/**
+ *  Open a file for reading by mapping it into memory.
+ *
+ *  The stream reads and seeks like one from SDL_RWFromConstMem(), without
+ *  a system call or stdio buffer per read, and SDL_RWGetMemoryView() gives
+ *  direct access to the file contents.  Where the file can't be mapped,
+ *  this returns a stream from SDL_RWFromFile() instead, which has no
+ *  memory view.
+ *
+ *  The file must not be truncated while the stream is open.
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromFileMapped(const char *file);
+
+/**
+ *  Read another stream through a read-ahead buffer.
+ *
+ *  Reads smaller than \c size are served from a buffer that is refilled
+ *  \c size bytes at a time, and seeks that land inside the buffer don't
+ *  touch \c src.  This is meant for decoders that read a few bytes at a
+ *  time; SDL_ReadU8() and the other endian-specific readers take the data
+ *  straight from the buffer.  Writes go through to \c src.
+ *
+ *  When \c src is a memory stream, the returned stream reads the memory
+ *  directly instead, and has the type of \c src.
+ *
+ *  Positions are those of \c src.  When the returned stream is closed, \c src
+ *  is closed too if \c autoclose is SDL_TRUE; otherwise it is left at the
+ *  position the buffered stream was read up to.  \c src must not be used
+ *  directly while the buffered stream is open.
+ */
+extern DECLSPEC SDL_RWops *SDLCALL SDL_RWFromBuffered(SDL_RWops * src,
+                                                      size_t size,
+                                                      SDL_bool autoclose);
+
 /* @} *//* RWFrom functions */
 
 
@@ -213,6 +249,20 @@ extern DECLSPEC void *SDLCALL SDL_LoadFile_RW(SDL_RWops * src, size_t *datasize,
  */
 #define SDL_LoadFile(file, datasize)   SDL_LoadFile_RW(SDL_RWFromFile(file, "rb"), datasize, 1)
 
+/**
+ *  Get direct access to the data of a memory stream.
+ *
+ *  For streams created with SDL_RWFromMem(), SDL_RWFromConstMem() or
+ *  SDL_RWFromFileMapped(), this returns the data at the current position,
+ *  and fills in \c size with the number of bytes left, if it's not NULL.
+ *  The position doesn't change.  The data stays valid until the stream
+ *  is closed, and must not be written to unless it came from SDL_RWFromMem().
+ *
+ *  \return the data, or NULL if the stream isn't backed by memory.
+ */
+extern DECLSPEC const void *SDLCALL SDL_RWGetMemoryView(SDL_RWops * context,
+                                                         size_t *size);
+
 /**
  *  \name Read endian functions
  *
@@ -53,6 +53,7 @@ extern "C" {
 #define SDL_PREALLOC        0x00000001  /**< Surface uses preallocated memory */
 #define SDL_RLEACCEL        0x00000002  /**< Surface is RLE encoded */
 #define SDL_DONTFREE        0x00000004  /**< Surface is referenced internally */
+#define SDL_POOLALLOC       0x00000008  /**< Surface pixels come from the surface pool */
 /* @} *//* Surface flags */
 
 /**
@@ -147,6 +148,35 @@ extern DECLSPEC SDL_Surface *SDLCALL SDL_CreateRGBSurfaceWithFormatFrom
     (void *pixels, int width, int height, int depth, int pitch, Uint32 format);
 extern DECLSPEC void SDLCALL SDL_FreeSurface(SDL_Surface * surface);
 
+/**
+ * \brief Statistics of the surface pixel buffer pool.
+ *
+ * \sa SDL_HINT_SURFACE_POOL
+ */
+typedef struct SDL_SurfacePoolStats
+{
+    Uint32 hits;                /**< Pixel buffers reused from the pool */
+    Uint32 misses;              /**< Pixel buffers that had to be allocated */
+    Uint32 buffers_retained;    /**< Free buffers currently held by the pool */
+    size_t bytes_retained;      /**< Memory held by those free buffers */
+} SDL_SurfacePoolStats;
+
+/**
+ *  Get the statistics of the surface pixel buffer pool.
+ *
+ *  \sa SDL_HINT_SURFACE_POOL
+ */
+extern DECLSPEC void SDLCALL SDL_GetSurfacePoolStats(SDL_SurfacePoolStats * stats);
+
+/**
+ *  Release free pixel buffers held by the surface pool until it holds no
+ *  more than \c max_bytes, for example when the app is low on memory.
+ *
+ *  Pass 0 to release everything. Buffers cached by other threads than the
+ *  calling one are kept until those threads exit.
+ */
+extern DECLSPEC void SDLCALL SDL_TrimSurfacePool(size_t max_bytes);
+
 /**
  *  \brief Set the palette used by a surface.
  *
@@ -495,13 +525,26 @@ extern DECLSPEC int SDLCALL SDL_LowerBlit
  *  \brief Perform a fast, low quality, stretch blit between two surfaces of the
  *         same pixel format.
  *
- *  \note This function uses a static buffer, and is not thread-safe.
+ *  Pixels are picked with nearest sampling.
  */
 extern DECLSPEC int SDLCALL SDL_SoftStretch(SDL_Surface * src,
                                             const SDL_Rect * srcrect,
                                             SDL_Surface * dst,
                                             const SDL_Rect * dstrect);
 
+/**
+ *  \brief Perform a bilinear filtered stretch blit between two surfaces of the
+ *         same 32-bit pixel format with 8 bits per channel.
+ *
+ *  \return 0 on success, or -1 if the surfaces can't be filtered.
+ *
+ *  \sa SDL_SoftStretch()
+ */
+extern DECLSPEC int SDLCALL SDL_SoftStretchLinear(SDL_Surface * src,
+                                                  const SDL_Rect * srcrect,
+                                                  SDL_Surface * dst,
+                                                  const SDL_Rect * dstrect);
+
 #define SDL_BlitScaled SDL_UpperBlitScaled
 
 /**
@@ -94,6 +94,20 @@ extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimer(Uint32 interval,
                                                  SDL_TimerCallback callback,
                                                  void *param);
 
+/**
+ * \brief Add a new timer with an interval in microseconds.
+ *
+ * This works like SDL_AddTimer(), except that the interval passed to and
+ * returned from the callback is in microseconds, and the timer thread
+ * yields instead of sleeping through the last millisecond before the
+ * deadline, so the callback fires with much less jitter.
+ *
+ * \return A timer ID, or 0 when an error occurs.
+ */
+extern DECLSPEC SDL_TimerID SDLCALL SDL_AddTimerUS(Uint32 interval,
+                                                   SDL_TimerCallback callback,
+                                                   void *param);
+
 /**
  * \brief Remove a timer knowing its ID.
  *
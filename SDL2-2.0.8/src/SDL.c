@@ -38,6 +38,8 @@
 #if !SDL_TIMERS_DISABLED
 # include "timer/SDL_timer_c.h"
 #endif
+extern void SDL_QuitBlitThreads(void);
+extern void SDL_QuitStretch(void);
 #if SDL_VIDEO_DRIVER_WINDOWS
 extern int SDL_HelperWindowCreate(void);
 extern int SDL_HelperWindowDestroy(void);
@@ -358,6 +360,8 @@ SDL_Quit(void)
     SDL_TicksQuit();
 #endif
 
+    SDL_QuitBlitThreads();
+    SDL_QuitStretch();
     SDL_ClearHints();
     SDL_AssertionsQuit();
     SDL_LogResetPriorities();
@@ -32,6 +32,27 @@ typedef struct SDL_DataQueuePacket
     Uint8 data[SDL_VARIABLE_LENGTH_ARRAY];  /* packet data */
 } SDL_DataQueuePacket;
 
+/* Fixed capacity ring for one producer and one consumer thread.
+   The producer only moves tail and the consumer only moves head, each kept
+   on its own cache line, so neither side has to lock. The positions are
+   free running 32-bit counters and the capacity is a power of 2. */
+typedef struct SDL_DataQueueRing
+{
+    SDL_atomic_t head;  /* read position, moved by the consumer. */
+
+    char cache_pad1[SDL_CACHELINE_SIZE-sizeof(SDL_atomic_t)];
+
+    SDL_atomic_t tail;  /* write position, moved by the producer. */
+
+    char cache_pad2[SDL_CACHELINE_SIZE-sizeof(SDL_atomic_t)];
+
+    Uint32 capacity;
+    Uint8 *buffer;
+} SDL_DataQueueRing;
+
+/* The largest ring, so the free running positions never look empty when full */
+#define SDL_DATAQUEUE_MAX_RING_CAPACITY (1u << 30)
+
 struct SDL_DataQueue
 {
     SDL_DataQueuePacket *head; /* device fed from here. */
@@ -39,6 +60,13 @@ struct SDL_DataQueue
     SDL_DataQueuePacket *pool; /* these are unused packets. */
     size_t packet_size;   /* size of new packets */
     size_t queued_bytes;  /* number of bytes of data in the queue. */
+    SDL_DataQueueRing *ring;  /* non-NULL if this is a ring, the list isn't used then. */
+
+    /* Watermarks, atomic so they can be read while the queue is in use. */
+    SDL_atomic_t low_watermark;
+    SDL_atomic_t high_watermark;
+    SDL_atomic_t underruns;
+    SDL_atomic_t overruns;
 };
 
 static void
@@ -69,6 +97,7 @@ SDL_NewDataQueue(const size_t _packetlen, const size_t initialslack)
 
         SDL_zerop(queue);
         queue->packet_size = packetlen;
+        SDL_ResetDataQueueStats(queue);
 
         for (i = 0; i < wantpackets; i++) {
             SDL_DataQueuePacket *packet = (SDL_DataQueuePacket *) SDL_malloc(sizeof (SDL_DataQueuePacket) + packetlen);
@@ -84,10 +113,56 @@ SDL_NewDataQueue(const size_t _packetlen, const size_t initialslack)
     return queue;
 }
 
+SDL_DataQueue *
+SDL_NewDataQueueRing(const size_t _capacity)
+{
+    SDL_DataQueue *queue;
+    SDL_DataQueueRing *ring;
+    Uint32 capacity = 1;
+
+    if (_capacity == 0) {
+        SDL_InvalidParamError("capacity");
+        return NULL;
+    } else if (_capacity > SDL_DATAQUEUE_MAX_RING_CAPACITY) {
+        SDL_SetError("Ring capacity is too large");
+        return NULL;
+    }
+
+    while (capacity < _capacity) {
+        capacity <<= 1;
+    }
+
+    queue = (SDL_DataQueue *) SDL_malloc(sizeof (SDL_DataQueue));
+    ring = (SDL_DataQueueRing *) SDL_malloc(sizeof (SDL_DataQueueRing) + capacity);
+    if (!queue || !ring) {
+        SDL_free(queue);
+        SDL_free(ring);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    SDL_zerop(queue);
+    SDL_zerop(ring);
+    ring->capacity = capacity;
+    ring->buffer = (Uint8 *) (ring + 1);
+    queue->packet_size = capacity;
+    queue->ring = ring;
+    SDL_ResetDataQueueStats(queue);
+
+    return queue;
+}
+
+SDL_bool
+SDL_IsDataQueueRing(SDL_DataQueue *queue)
+{
+    return (queue && queue->ring) ? SDL_TRUE : SDL_FALSE;
+}
+
 void
 SDL_FreeDataQueue(SDL_DataQueue *queue)
 {
     if (queue) {
+        SDL_free(queue->ring);
         SDL_FreeDataQueueList(queue->head);
         SDL_FreeDataQueueList(queue->pool);
         SDL_free(queue);
@@ -107,6 +182,12 @@ SDL_ClearDataQueue(SDL_DataQueue *queue, const size_t slack)
         return;
     }
 
+    if (queue->ring) {
+        /* Consumer side: drop everything the producer has written so far. */
+        SDL_AtomicSet(&queue->ring->head, SDL_AtomicGet(&queue->ring->tail));
+        return;
+    }
+
     packet = queue->head;
 
     /* merge the available pool and the current queue into one list. */
@@ -137,6 +218,86 @@ SDL_ClearDataQueue(SDL_DataQueue *queue, const size_t slack)
     SDL_FreeDataQueueList(packet);  /* free extra packets */
 }
 
+static void
+SDL_NoteDataQueueHigh(SDL_DataQueue *queue, const size_t queued)
+{
+    const int value = (int) SDL_min(queued, (size_t) SDL_MAX_SINT32);
+    int high;
+
+    do {
+        high = SDL_AtomicGet(&queue->high_watermark);
+    } while ((value > high) && !SDL_AtomicCAS(&queue->high_watermark, high, value));
+}
+
+static void
+SDL_NoteDataQueueRead(SDL_DataQueue *queue, const size_t queued, const size_t wanted)
+{
+    const int value = (int) SDL_min(queued, (size_t) SDL_MAX_SINT32);
+    int low;
+
+    do {
+        low = SDL_AtomicGet(&queue->low_watermark);
+    } while ((value < low) && !SDL_AtomicCAS(&queue->low_watermark, low, value));
+
+    if (queued < wanted) {
+        SDL_AtomicIncRef(&queue->underruns);
+    }
+}
+
+static int
+SDL_WriteToDataQueueRing(SDL_DataQueue *queue, const Uint8 *data, const size_t len)
+{
+    SDL_DataQueueRing *ring = queue->ring;
+    const Uint32 tail = (Uint32) SDL_AtomicGet(&ring->tail);
+    const Uint32 head = (Uint32) SDL_AtomicGet(&ring->head);
+    const Uint32 queued = tail - head;
+    const Uint32 pos = tail & (ring->capacity - 1);
+    size_t first;
+
+    SDL_MemoryBarrierAcquire();  /* pairs with the release in the reader. */
+
+    if (len > (size_t) (ring->capacity - queued)) {
+        /* all or nothing, so a partial write can't tear up the stream. */
+        SDL_AtomicIncRef(&queue->overruns);
+        return SDL_SetError("Data queue is full");
+    }
+
+    first = SDL_min(len, (size_t) (ring->capacity - pos));
+    SDL_memcpy(ring->buffer + pos, data, first);
+    SDL_memcpy(ring->buffer, data + first, len - first);
+
+    /* publish the data only after it's in place. */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&ring->tail, (int) (tail + (Uint32) len));
+
+    SDL_NoteDataQueueHigh(queue, queued + len);
+    return 0;
+}
+
+static size_t
+SDL_ReadFromDataQueueRing(SDL_DataQueue *queue, Uint8 *buf, const size_t len, const SDL_bool consume)
+{
+    SDL_DataQueueRing *ring = queue->ring;
+    const Uint32 head = (Uint32) SDL_AtomicGet(&ring->head);
+    const Uint32 tail = (Uint32) SDL_AtomicGet(&ring->tail);
+    const Uint32 queued = tail - head;
+    const Uint32 pos = head & (ring->capacity - 1);
+    const size_t cpy = SDL_min(len, (size_t) queued);
+    const size_t first = SDL_min(cpy, (size_t) (ring->capacity - pos));
+
+    SDL_MemoryBarrierAcquire();  /* pairs with the release in the writer. */
+    SDL_memcpy(buf, ring->buffer + pos, first);
+    SDL_memcpy(buf + first, ring->buffer, cpy - first);
+
+    if (consume) {
+        /* let the producer reuse the space only after we're done with it. */
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&ring->head, (int) (head + (Uint32) cpy));
+        SDL_NoteDataQueueRead(queue, queued, len);
+    }
+    return cpy;
+}
+
 static SDL_DataQueuePacket *
 AllocateDataQueuePacket(SDL_DataQueue *queue)
 {
@@ -186,6 +347,10 @@ SDL_WriteToDataQueue(SDL_DataQueue *queue, const void *_data, const size_t _len)
         return SDL_InvalidParamError("queue");
     }
 
+    if (queue->ring) {
+        return SDL_WriteToDataQueueRing(queue, data, len);
+    }
+
     orighead = queue->head;
     origtail = queue->tail;
     origlen = origtail ? origtail->datalen : 0;
@@ -210,6 +375,7 @@ SDL_WriteToDataQueue(SDL_DataQueue *queue, const void *_data, const size_t _len)
                 queue->pool = NULL;
 
                 SDL_FreeDataQueueList(packet);  /* give back what we can. */
+                SDL_AtomicIncRef(&queue->overruns);
                 return SDL_OutOfMemory();
             }
         }
@@ -222,6 +388,7 @@ SDL_WriteToDataQueue(SDL_DataQueue *queue, const void *_data, const size_t _len)
         queue->queued_bytes += datalen;
     }
 
+    SDL_NoteDataQueueHigh(queue, queue->queued_bytes);
     return 0;
 }
 
@@ -237,6 +404,10 @@ SDL_PeekIntoDataQueue(SDL_DataQueue *queue, void *_buf, const size_t _len)
         return 0;
     }
 
+    if (queue->ring) {
+        return SDL_ReadFromDataQueueRing(queue, buf, len, SDL_FALSE);
+    }
+
     for (packet = queue->head; len && packet; packet = packet->next) {
         const size_t avail = packet->datalen - packet->startpos;
         const size_t cpy = SDL_min(len, avail);
@@ -262,6 +433,12 @@ SDL_ReadFromDataQueue(SDL_DataQueue *queue, void *_buf, const size_t _len)
         return 0;
     }
 
+    if (queue->ring) {
+        return SDL_ReadFromDataQueueRing(queue, buf, len, SDL_TRUE);
+    }
+
+    SDL_NoteDataQueueRead(queue, queue->queued_bytes, len);
+
     while ((len > 0) && ((packet = queue->head) != NULL)) {
         const size_t avail = packet->datalen - packet->startpos;
         const size_t cpy = SDL_min(len, avail);
@@ -293,9 +470,42 @@ SDL_ReadFromDataQueue(SDL_DataQueue *queue, void *_buf, const size_t _len)
 size_t
 SDL_CountDataQueue(SDL_DataQueue *queue)
 {
+    if (queue && queue->ring) {
+        /* head first: tail only ever moves ahead of it, so a later tail
+           can't make this negative.  Other threads may still see both
+           move in between, so never report more than fits. */
+        const Uint32 head = (Uint32) SDL_AtomicGet(&queue->ring->head);
+        Uint32 queued;
+        SDL_MemoryBarrierAcquire();
+        queued = (Uint32) SDL_AtomicGet(&queue->ring->tail) - head;
+        return (size_t) SDL_min(queued, queue->ring->capacity);
+    }
     return queue ? queue->queued_bytes : 0;
 }
 
+void
+SDL_GetDataQueueStats(SDL_DataQueue *queue, SDL_DataQueueStats *stats)
+{
+    const int low = SDL_AtomicGet(&queue->low_watermark);
+
+    stats->capacity = queue->ring ? queue->ring->capacity : 0;
+    stats->queued = SDL_CountDataQueue(queue);
+    stats->high_watermark = (size_t) SDL_AtomicGet(&queue->high_watermark);
+    /* nothing read since the last reset, the queue never got any lower. */
+    stats->low_watermark = (low == SDL_MAX_SINT32) ? SDL_min(stats->queued, stats->high_watermark) : (size_t) low;
+    stats->underruns = (Uint32) SDL_AtomicGet(&queue->underruns);
+    stats->overruns = (Uint32) SDL_AtomicGet(&queue->overruns);
+}
+
+void
+SDL_ResetDataQueueStats(SDL_DataQueue *queue)
+{
+    SDL_AtomicSet(&queue->low_watermark, SDL_MAX_SINT32);
+    SDL_AtomicSet(&queue->high_watermark, (int) SDL_min(SDL_CountDataQueue(queue), (size_t) SDL_MAX_SINT32));
+    SDL_AtomicSet(&queue->underruns, 0);
+    SDL_AtomicSet(&queue->overruns, 0);
+}
+
 void *
 SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len)
 {
@@ -307,6 +517,9 @@ SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len)
     } else if (len == 0) {
         SDL_InvalidParamError("len");
         return NULL;
+    } else if (queue->ring) {
+        SDL_SetError("Can't reserve space in a ring data queue");
+        return NULL;
     } else if (len > queue->packet_size) {
         SDL_SetError("len is larger than packet size");
         return NULL;
@@ -34,6 +34,30 @@ size_t SDL_ReadFromDataQueue(SDL_DataQueue *queue, void *buf, const size_t len);
 size_t SDL_PeekIntoDataQueue(SDL_DataQueue *queue, void *buf, const size_t len);
 size_t SDL_CountDataQueue(SDL_DataQueue *queue);
 
+/* this makes a queue of fixed capacity (rounded up to a power of 2) for one
+   producer and one consumer thread. Writing and reading don't need any
+   locking as long as only one thread writes and only one thread reads or
+   peeks. SDL_ClearDataQueue() counts as a read. A write that doesn't fit in
+   the free space fails as a whole and counts as an overrun. Rings don't grow,
+   so SDL_ReserveSpaceInDataQueue() isn't supported. */
+SDL_DataQueue *SDL_NewDataQueueRing(const size_t capacity);
+SDL_bool SDL_IsDataQueueRing(SDL_DataQueue *queue);
+
+/* Fill levels of a queue since it was made or its stats were last reset.
+   These can be read from any thread while the queue is in use. */
+typedef struct SDL_DataQueueStats
+{
+    size_t capacity;        /* ring capacity, 0 if the queue grows as needed. */
+    size_t queued;          /* bytes in the queue right now. */
+    size_t low_watermark;   /* least data a read found in the queue. */
+    size_t high_watermark;  /* most data a write left in the queue. */
+    Uint32 underruns;       /* reads that found less data than they asked for. */
+    Uint32 overruns;        /* writes that failed for lack of space. */
+} SDL_DataQueueStats;
+
+void SDL_GetDataQueueStats(SDL_DataQueue *queue, SDL_DataQueueStats *stats);
+void SDL_ResetDataQueueStats(SDL_DataQueue *queue);
+
 /* this sets a section of the data queue aside (possibly allocating memory for it)
    as if it's been written to, but returns a pointer to that space. You may write
    to this space until a read would consume it. Writes (and other calls to this
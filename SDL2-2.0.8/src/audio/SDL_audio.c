@@ -553,8 +553,9 @@ SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
     SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
 
     /* note that if this needs to allocate more space and run out of memory,
-       we have no choice but to quietly drop the data and hope it works out
-       later, but you probably have bigger problems in this case anyhow. */
+       or the queue is a full ring, we have no choice but to quietly drop the
+       data and hope it works out later, but you probably have bigger problems
+       in this case anyhow. */
     SDL_WriteToDataQueue(device->buffer_queue, stream, len);
 }
 
@@ -573,9 +574,14 @@ SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
     }
 
     if (len > 0) {
-        current_audio.impl.LockDevice(device);
-        rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
-        current_audio.impl.UnlockDevice(device);
+        if (SDL_IsDataQueueRing(device->buffer_queue)) {
+            /* we're the only producer, the audio thread the only consumer. */
+            rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
+        } else {
+            current_audio.impl.LockDevice(device);
+            rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
+            current_audio.impl.UnlockDevice(device);
+        }
     }
 
     return rc;
@@ -594,6 +600,11 @@ SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
         return 0;  /* just report zero bytes dequeued. */
     }
 
+    if (SDL_IsDataQueueRing(device->buffer_queue)) {
+        /* we're the only consumer, the audio thread the only producer. */
+        return (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, data, len);
+    }
+
     current_audio.impl.LockDevice(device);
     rc = (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, data, len);
     current_audio.impl.UnlockDevice(device);
@@ -611,6 +622,15 @@ SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
     }
 
     /* Nothing to do unless we're set up for queueing. */
+    if ((device->callbackspec.callback == SDL_BufferQueueDrainCallback) ||
+        (device->callbackspec.callback == SDL_BufferQueueFillCallback)) {
+        if (SDL_IsDataQueueRing(device->buffer_queue) && (device->iscapture ||
+            (current_audio.impl.GetPendingBytes == SDL_AudioGetPendingBytes_Default))) {
+            /* a ring can be counted from any thread without locking. */
+            return (Uint32) SDL_CountDataQueue(device->buffer_queue);
+        }
+    }
+
     if (device->callbackspec.callback == SDL_BufferQueueDrainCallback) {
         current_audio.impl.LockDevice(device);
         retval = ((Uint32) SDL_CountDataQueue(device->buffer_queue)) + current_audio.impl.GetPendingBytes(device);
@@ -642,6 +662,47 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
     current_audio.impl.UnlockDevice(device);
 }
 
+int
+SDL_GetQueuedAudioStats(SDL_AudioDeviceID devid, SDL_AudioQueueStats *stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    SDL_DataQueueStats queuestats;
+
+    if (!device) {
+        return -1;  /* get_audio_device() will have set the error state */
+    } else if (!stats) {
+        return SDL_InvalidParamError("stats");
+    } else if (!device->buffer_queue) {
+        return SDL_SetError("Audio device has a callback, no queue to report on");
+    }
+
+    if (SDL_IsDataQueueRing(device->buffer_queue)) {
+        SDL_GetDataQueueStats(device->buffer_queue, &queuestats);
+    } else {
+        current_audio.impl.LockDevice(device);
+        SDL_GetDataQueueStats(device->buffer_queue, &queuestats);
+        current_audio.impl.UnlockDevice(device);
+    }
+
+    stats->capacity = (Uint32) queuestats.capacity;
+    stats->queued = (Uint32) queuestats.queued;
+    stats->low_watermark = (Uint32) queuestats.low_watermark;
+    stats->high_watermark = (Uint32) queuestats.high_watermark;
+    stats->underruns = queuestats.underruns;
+    stats->overruns = queuestats.overruns;
+    return 0;
+}
+
+void
+SDL_ResetQueuedAudioStats(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    if (device && device->buffer_queue) {
+        SDL_ResetDataQueueStats(device->buffer_queue);
+    }
+}
+
 
 /* The general mixing thread function */
 static int SDLCALL
@@ -1350,8 +1411,16 @@ open_audio_device(const char *devname, int iscapture,
     }
 
     if (device->spec.callback == NULL) {  /* use buffer queueing? */
-        /* pool a few packets to start. Enough for two callbacks. */
-        device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
+        const char *hint = SDL_GetHint(SDL_HINT_AUDIO_QUEUE_CAPACITY);
+        const size_t capacity = hint ? (size_t) SDL_strtoul(hint, NULL, 0) : 0;
+
+        if (capacity > 0) {
+            /* a fixed ring has to hold at least two callbacks worth. */
+            device->buffer_queue = SDL_NewDataQueueRing(SDL_max(capacity, (size_t) obtained->size * 2));
+        } else {
+            /* pool a few packets to start. Enough for two callbacks. */
+            device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
+        }
         if (!device->buffer_queue) {
             close_audio_device(device);
             SDL_SetError("Couldn't create audio buffer queue");
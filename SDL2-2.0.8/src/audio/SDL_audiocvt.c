@@ -33,6 +33,8 @@
 #include "SDL_assert.h"
 #include "../SDL_dataqueue.h"
 #include "SDL_cpuinfo.h"
+#include "SDL_hints.h"
+#include "../cpuinfo/SDL_simd.h"
 
 #define DEBUG_AUDIOSTREAM 0
 
@@ -460,9 +462,12 @@ SDL_PrepareResampleFilter(void)
     return 0;
 }
 
+static void SDL_FreeResampleTables(void);
+
 void
 SDL_FreeResampleFilter(void)
 {
+    SDL_FreeResampleTables();
     SDL_free(ResamplerFilter);
     SDL_free(ResamplerFilterDifference);
     ResamplerFilter = NULL;
@@ -480,6 +485,487 @@ ResamplerPadding(const int inrate, const int outrate)
     return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
 }
 
+/* Polyphase resampling.
+
+   With the rates reduced to outrate:inrate = L:M, output frame i lands on
+   input frame (i*M)/L, (i*M)%L Lths of the way to the next one.  So there
+   are only L different sets of filter taps, one per phase, which are worked
+   out once per ratio and channel count, with every tap repeated for each
+   channel.  The input position is tracked with integers, and each output
+   frame is then one dot product over the interleaved input frames around it.
+   Ratios with more than RESAMPLER_MAX_PHASES phases use the nearest phase
+   below.
+
+   The default taps are the windowed sinc SDL_ResampleAudio() always used.
+   SDL_HINT_AUDIO_INTERNAL_RESAMPLER can pick a shorter one instead.
+ */
+#define RESAMPLER_TAPS          (2 * (RESAMPLER_ZERO_CROSSINGS + 1))
+#define RESAMPLER_FAST_TAPS     4
+#define RESAMPLER_MAX_PHASES    1024
+#define RESAMPLER_MAX_CHANNELS  8
+#define RESAMPLER_MAX_TABLES    16
+
+typedef struct SDL_ResampleTable
+{
+    int inrate;         /* reduced by the greatest common divisor */
+    int outrate;
+    int chans;
+    int taps;
+    int phases;
+    int refcount;       /* resamples running with it */
+    float *coeffs;      /* phases * taps * chans, aligned to 32 bytes */
+    void *coeffs_base;
+    struct SDL_ResampleTable *next;
+} SDL_ResampleTable;
+
+typedef void (*SDL_ResampleFrameFunc)(const float *src, const float *coeffs, const int len, const int chans, float *dst);
+
+static SDL_ResampleTable *ResampleTables = NULL;
+static int NumResampleTables = 0;
+
+static int
+ResamplerGCD(int a, int b)
+{
+    while (b) {
+        const int r = a % b;
+        a = b;
+        b = r;
+    }
+    return a;
+}
+
+static int
+ResamplerTaps(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_AUDIO_INTERNAL_RESAMPLER);
+    if (hint && (*hint == '1' || SDL_strcasecmp(hint, "fast") == 0)) {
+        return RESAMPLER_FAST_TAPS;
+    }
+    return RESAMPLER_TAPS;
+}
+
+/* The taps of the windowed sinc table, interpolated between its entries:
+   the left wing over the input frame at or before the output time and the
+   ones before it, the right wing over the ones after it. */
+static void
+DefaultResampleTaps(float *taps, const double interpolation)
+{
+    int j;
+
+    for (j = 0; j <= RESAMPLER_ZERO_CROSSINGS; j++) {
+        const double position1 = (j + interpolation) * RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+        const double position2 = ((j + 1) - interpolation) * RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+        const int index1 = (int) position1;
+        const int index2 = (int) position2;
+
+        taps[RESAMPLER_ZERO_CROSSINGS - j] = (index1 < RESAMPLER_FILTER_SIZE) ?
+            (float) (ResamplerFilter[index1] + ((position1 - index1) * ResamplerFilterDifference[index1])) : 0.0f;
+        taps[RESAMPLER_ZERO_CROSSINGS + 1 + j] = (index2 < RESAMPLER_FILTER_SIZE) ?
+            (float) (ResamplerFilter[index2] + ((position2 - index2) * ResamplerFilterDifference[index2])) : 0.0f;
+    }
+}
+
+/* A kaiser windowed sinc over two zero crossings, scaled to keep the level */
+static void
+FastResampleTaps(float *taps, const double interpolation)
+{
+    const double beta = 0.1102 * (50.0 - 8.7);
+    const int half = RESAMPLER_FAST_TAPS / 2;
+    double values[RESAMPLER_FAST_TAPS];
+    double sum = 0.0;
+    int k;
+
+    for (k = 0; k < RESAMPLER_FAST_TAPS; k++) {
+        const double x = (double) (k - (half - 1)) - interpolation;
+        const double t = x / half;
+        double value = 0.0;
+
+        if (t > -1.0 && t < 1.0) {
+            const double sinc = (x == 0.0) ? 1.0 : SDL_sin(M_PI * x) / (M_PI * x);
+            value = sinc * bessel(beta * SDL_sqrt(1.0 - (t * t))) / bessel(beta);
+        }
+        values[k] = value;
+        sum += value;
+    }
+
+    for (k = 0; k < RESAMPLER_FAST_TAPS; k++) {
+        taps[k] = (float) (values[k] / sum);
+    }
+}
+
+static SDL_ResampleTable *
+SDL_CreateResampleTable(const int chans, const int inrate, const int outrate, const int numtaps)
+{
+    SDL_ResampleTable *table;
+    const int len = numtaps * chans;
+    float taps[RESAMPLER_TAPS];
+    float *coeffs;
+    int phase, k, chan;
+
+    table = (SDL_ResampleTable *) SDL_calloc(1, sizeof (*table));
+    if (!table) {
+        return NULL;
+    }
+    table->inrate = inrate;
+    table->outrate = outrate;
+    table->chans = chans;
+    table->taps = numtaps;
+    table->phases = SDL_min(outrate, RESAMPLER_MAX_PHASES);
+    table->coeffs_base = SDL_malloc((table->phases * len * sizeof (float)) + 31);
+    if (!table->coeffs_base) {
+        SDL_free(table);
+        return NULL;
+    }
+    table->coeffs = (float *) ((((size_t) table->coeffs_base) + 31) & ~((size_t) 31));
+
+    coeffs = table->coeffs;
+    for (phase = 0; phase < table->phases; phase++) {
+        const double interpolation = ((double) phase) / table->phases;
+
+        if (numtaps == RESAMPLER_FAST_TAPS) {
+            FastResampleTaps(taps, interpolation);
+        } else {
+            DefaultResampleTaps(taps, interpolation);
+        }
+        for (k = 0; k < numtaps; k++) {
+            for (chan = 0; chan < chans; chan++) {
+                *(coeffs++) = taps[k];
+            }
+        }
+    }
+    return table;
+}
+
+static void
+SDL_FreeResampleTables(void)
+{
+    while (ResampleTables) {
+        SDL_ResampleTable *next = ResampleTables->next;
+        SDL_free(ResampleTables->coeffs_base);
+        SDL_free(ResampleTables);
+        ResampleTables = next;
+    }
+    NumResampleTables = 0;
+}
+
+/* Tables are kept in most recently used order. Once there are
+   RESAMPLER_MAX_TABLES, the least recently used one that isn't being used
+   makes room for a new one. Returns NULL if the resampler has to do without
+   a table, otherwise the table has to be given back with
+   SDL_ReleaseResampleTable(). */
+static SDL_ResampleTable *
+SDL_GetResampleTable(const int chans, const int inrate, const int outrate)
+{
+    const int gcd = ResamplerGCD(inrate, outrate);
+    const int in = inrate / gcd;
+    const int out = outrate / gcd;
+    const int numtaps = ResamplerTaps();
+    SDL_ResampleTable *table, *prev, *created = NULL, *evicted = NULL;
+    int pass;
+
+    if (chans < 1 || chans > RESAMPLER_MAX_CHANNELS || !ResamplerFilter) {
+        return NULL;
+    }
+
+    for (pass = 0; pass < 2; pass++) {
+        SDL_AtomicLock(&ResampleFilterSpinlock);
+        for (prev = NULL, table = ResampleTables; table; prev = table, table = table->next) {
+            if (table->inrate == in && table->outrate == out &&
+                table->chans == chans && table->taps == numtaps) {
+                break;
+            }
+        }
+        if (table) {
+            if (prev) {
+                prev->next = table->next;
+                table->next = ResampleTables;
+                ResampleTables = table;
+            }
+            ++table->refcount;
+        } else if (created) {
+            if (NumResampleTables >= RESAMPLER_MAX_TABLES) {
+                SDL_ResampleTable *evicted_prev = NULL;
+                for (prev = NULL, table = ResampleTables; table; prev = table, table = table->next) {
+                    if (table->refcount == 0) {
+                        evicted = table;
+                        evicted_prev = prev;
+                    }
+                }
+                table = NULL;
+                if (evicted) {
+                    if (evicted_prev) {
+                        evicted_prev->next = evicted->next;
+                    } else {
+                        ResampleTables = evicted->next;
+                    }
+                    --NumResampleTables;
+                }
+            }
+            if (NumResampleTables < RESAMPLER_MAX_TABLES) {
+                table = created;
+                created = NULL;
+                table->next = ResampleTables;
+                table->refcount = 1;
+                ResampleTables = table;
+                ++NumResampleTables;
+            }
+        }
+        SDL_AtomicUnlock(&ResampleFilterSpinlock);
+
+        if (table || pass == 1) {
+            break;
+        }
+
+        /* Work out the taps without holding the lock, then look again */
+        created = SDL_CreateResampleTable(chans, in, out, numtaps);
+        if (!created) {
+            break;
+        }
+    }
+
+    /* Nothing can be resampling with an evicted table, and a new one isn't
+       needed if another thread made it first or if there was no room */
+    if (evicted) {
+        SDL_free(evicted->coeffs_base);
+        SDL_free(evicted);
+    }
+    if (created) {
+        SDL_free(created->coeffs_base);
+        SDL_free(created);
+    }
+    return table;
+}
+
+static void
+SDL_ReleaseResampleTable(SDL_ResampleTable *table)
+{
+    SDL_AtomicLock(&ResampleFilterSpinlock);
+    --table->refcount;
+    SDL_AtomicUnlock(&ResampleFilterSpinlock);
+}
+
+/* Builds the table ahead of the first resample, it stays cached */
+static void
+SDL_PrepareResampleTable(const int chans, const int inrate, const int outrate)
+{
+    SDL_ResampleTable *table = SDL_GetResampleTable(chans, inrate, outrate);
+    if (table) {
+        SDL_ReleaseResampleTable(table);
+    }
+}
+
+/* Every accumulator lane always adds up the same channel, so the lanes are
+   split across as many accumulators as it takes for the channels to line
+   up with them again. */
+static void
+SDL_ResampleFrame_Scalar(const float *src, const float *coeffs, const int len, const int chans, float *dst)
+{
+    float sums[RESAMPLER_MAX_CHANNELS];
+    int i, chan;
+
+    for (chan = 0; chan < chans; chan++) {
+        sums[chan] = 0.0f;
+    }
+    for (i = 0; i < len; i += chans) {
+        for (chan = 0; chan < chans; chan++) {
+            sums[chan] += src[i + chan] * coeffs[i + chan];
+        }
+    }
+    for (chan = 0; chan < chans; chan++) {
+        dst[chan] = sums[chan];
+    }
+}
+
+static void
+SDL_AddResampleLanes(const float *lanes, const int numlanes, const int chans, float *dst)
+{
+    int i, chan;
+
+    for (chan = 0; chan < chans; chan++) {
+        float sum = lanes[chan];
+        for (i = chan + chans; i < numlanes; i += chans) {
+            sum += lanes[i];
+        }
+        dst[chan] = sum;
+    }
+}
+
+#ifdef __SSE__
+static void
+SDL_ResampleFrame_SSE(const float *src, const float *coeffs, const int len, const int chans, float *dst)
+{
+    const int numacc = chans / ((chans % 4) == 0 ? 4 : (chans % 2) == 0 ? 2 : 1);
+    __m128 acc[RESAMPLER_MAX_CHANNELS];
+    float lanes[4 * RESAMPLER_MAX_CHANNELS];
+    int i, j;
+
+    if (numacc == 1) {
+        __m128 sum = _mm_setzero_ps();
+        for (i = 0; i < len; i += 4) {
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(src + i), _mm_load_ps(coeffs + i)));
+        }
+        acc[0] = sum;
+    } else {
+        for (j = 0; j < numacc; j++) {
+            acc[j] = _mm_setzero_ps();
+        }
+        for (i = 0; i < len; i += 4 * numacc) {
+            for (j = 0; j < numacc; j++) {
+                acc[j] = _mm_add_ps(acc[j], _mm_mul_ps(_mm_loadu_ps(src + i + 4 * j), _mm_load_ps(coeffs + i + 4 * j)));
+            }
+        }
+    }
+    j = 0;
+    do {
+        _mm_storeu_ps(lanes + 4 * j, acc[j]);
+    } while (++j < numacc);
+    SDL_AddResampleLanes(lanes, 4 * numacc, chans, dst);
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+/* Only used for an even number of channels, so the taps fill whole vectors */
+SDL_TARGETING_AVX2 static void
+SDL_ResampleFrame_AVX2(const float *src, const float *coeffs, const int len, const int chans, float *dst)
+{
+    const int numacc = chans / ((chans % 8) == 0 ? 8 : (chans % 4) == 0 ? 4 : 2);
+    __m256 acc[RESAMPLER_MAX_CHANNELS];
+    float lanes[8 * RESAMPLER_MAX_CHANNELS];
+    int i, j;
+
+    if (numacc == 1) {
+        __m256 sum = _mm256_setzero_ps();
+        for (i = 0; i < len; i += 8) {
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_loadu_ps(src + i), _mm256_load_ps(coeffs + i)));
+        }
+        acc[0] = sum;
+    } else {
+        for (j = 0; j < numacc; j++) {
+            acc[j] = _mm256_setzero_ps();
+        }
+        for (i = 0; i < len; i += 8 * numacc) {
+            for (j = 0; j < numacc; j++) {
+                acc[j] = _mm256_add_ps(acc[j], _mm256_mul_ps(_mm256_loadu_ps(src + i + 8 * j), _mm256_load_ps(coeffs + i + 8 * j)));
+            }
+        }
+    }
+    j = 0;
+    do {
+        _mm256_storeu_ps(lanes + 8 * j, acc[j]);
+    } while (++j < numacc);
+    SDL_AddResampleLanes(lanes, 8 * numacc, chans, dst);
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static void
+SDL_ResampleFrame_NEON(const float *src, const float *coeffs, const int len, const int chans, float *dst)
+{
+    const int numacc = chans / ((chans % 4) == 0 ? 4 : (chans % 2) == 0 ? 2 : 1);
+    float32x4_t acc[RESAMPLER_MAX_CHANNELS];
+    float lanes[4 * RESAMPLER_MAX_CHANNELS];
+    int i, j;
+
+    if (numacc == 1) {
+        float32x4_t sum = vdupq_n_f32(0.0f);
+        for (i = 0; i < len; i += 4) {
+            sum = vmlaq_f32(sum, vld1q_f32(src + i), vld1q_f32(coeffs + i));
+        }
+        acc[0] = sum;
+    } else {
+        for (j = 0; j < numacc; j++) {
+            acc[j] = vdupq_n_f32(0.0f);
+        }
+        for (i = 0; i < len; i += 4 * numacc) {
+            for (j = 0; j < numacc; j++) {
+                acc[j] = vmlaq_f32(acc[j], vld1q_f32(src + i + 4 * j), vld1q_f32(coeffs + i + 4 * j));
+            }
+        }
+    }
+    j = 0;
+    do {
+        vst1q_f32(lanes + 4 * j, acc[j]);
+    } while (++j < numacc);
+    SDL_AddResampleLanes(lanes, 4 * numacc, chans, dst);
+}
+#endif
+
+static SDL_ResampleFrameFunc
+ChooseResampleFrameFunc(const int chans)
+{
+#if HAVE_AVX2_INTRINSICS
+    if ((chans % 2) == 0 && SDL_HasAVX2()) {
+        return SDL_ResampleFrame_AVX2;
+    }
+#endif
+#ifdef __SSE__
+    if (SDL_HasSSE()) {
+        return SDL_ResampleFrame_SSE;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        return SDL_ResampleFrame_NEON;
+    }
+#endif
+    return SDL_ResampleFrame_Scalar;
+}
+
+/* The first output frame lands (frac / table->outrate) of the way past input frame srcindex. */
+static void
+SDL_ResampleAudioPolyphase(const SDL_ResampleTable *table, const int paddinglen,
+                           const float *lpadding, const float *rpadding,
+                           const float *inbuf, const int inframes,
+                           int srcindex, int frac,
+                           float *outbuf, const int outframes)
+{
+    const int chans = table->chans;
+    const int numtaps = table->taps;
+    const int len = numtaps * chans;
+    const int before = (numtaps / 2) - 1;  /* input frames before the one at or before the output time */
+    const int step = table->inrate / table->outrate;
+    const int stepfrac = table->inrate % table->outrate;
+    const SDL_ResampleFrameFunc resample = ChooseResampleFrameFunc(chans);
+    float window[RESAMPLER_TAPS * RESAMPLER_MAX_CHANNELS];
+    int i, k;
+
+    for (i = 0; i < outframes; i++) {
+        const int phase = (table->phases == table->outrate) ? frac :
+                          (int) (((Sint64) frac * table->phases) / table->outrate);
+        const int first = srcindex - before;
+        const float *src;
+
+        if (first >= 0 && (first + numtaps) <= inframes) {
+            src = inbuf + (first * chans);
+        } else {
+            /* Near the ends, gather the frames from the padding */
+            for (k = 0; k < numtaps; k++) {
+                const int srcframe = first + k;
+                const float *frame;
+                if (srcframe < 0) {
+                    frame = lpadding + ((paddinglen + srcframe) * chans);
+                } else if (srcframe >= inframes) {
+                    frame = rpadding + ((srcframe - inframes) * chans);
+                } else {
+                    frame = inbuf + (srcframe * chans);
+                }
+                SDL_memcpy(window + (k * chans), frame, chans * sizeof (float));
+            }
+            src = window;
+        }
+
+        resample(src, table->coeffs + (phase * len), len, chans, outbuf);
+        outbuf += chans;
+
+        srcindex += step;
+        frac += stepfrac;
+        if (frac >= table->outrate) {
+            frac -= table->outrate;
+            srcindex++;
+        }
+    }
+}
+
 /* lpadding and rpadding are expected to be buffers of (ResamplePadding(inrate, outrate) * chans * sizeof (float)) bytes. */
 static int
 SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
@@ -496,10 +982,17 @@ SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
     const int wantedoutframes = (int) ((inbuflen / framelen) * ratio);  /* outbuflen isn't total to write, it's total available. */
     const int maxoutframes = outbuflen / framelen;
     const int outframes = SDL_min(wantedoutframes, maxoutframes);
+    SDL_ResampleTable *table = SDL_GetResampleTable(chans, inrate, outrate);
     float *dst = outbuf;
     double outtime = 0.0;
     int i, j, chan;
 
+    if (table) {
+        SDL_ResampleAudioPolyphase(table, paddinglen, lpadding, rpadding, inbuf, inframes, 0, 0, outbuf, outframes);
+        SDL_ReleaseResampleTable(table);
+        return outframes * chans * sizeof (float);
+    }
+
     for (i = 0; i < outframes; i++) {
         const int srcindex = (int) (outtime * inrate);
         const double intime = ((double) srcindex) / finrate;
@@ -790,6 +1283,7 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, const int dst_channels,
     if (SDL_PrepareResampleFilter() < 0) {
         return -1;
     }
+    SDL_PrepareResampleTable(dst_channels, src_rate, dst_rate);
 
     /* Update (cvt) with filter details... */
     if (SDL_AddAudioCVTFilter(cvt, filter) < 0) {
@@ -863,56 +1357,12 @@ SDL_SupportedChannelCount(const int channels)
 }
 
 
-/* Creates a set of audio filters to convert from one format to another.
-   Returns 0 if no conversion is needed, 1 if the audio filter is set up,
-   or -1 if an error like invalid parameter, unsupported format, etc. occurred.
-*/
-
-int
-SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
-                  SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
-                  SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
+/* Adds a filter to (cvt) for every step of the conversion, or returns -1 */
+static int
+SDL_BuildAudioCVTFilters(SDL_AudioCVT * cvt,
+                         SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
+                         SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
 {
-    /* Sanity check target pointer */
-    if (cvt == NULL) {
-        return SDL_InvalidParamError("cvt");
-    }
-
-    /* Make sure we zero out the audio conversion before error checking */
-    SDL_zerop(cvt);
-
-    if (!SDL_SupportedAudioFormat(src_fmt)) {
-        return SDL_SetError("Invalid source format");
-    } else if (!SDL_SupportedAudioFormat(dst_fmt)) {
-        return SDL_SetError("Invalid destination format");
-    } else if (!SDL_SupportedChannelCount(src_channels)) {
-        return SDL_SetError("Invalid source channels");
-    } else if (!SDL_SupportedChannelCount(dst_channels)) {
-        return SDL_SetError("Invalid destination channels");
-    } else if (src_rate == 0) {
-        return SDL_SetError("Source rate is zero");
-    } else if (dst_rate == 0) {
-        return SDL_SetError("Destination rate is zero");
-    }
-
-#if DEBUG_CONVERT
-    printf("Build format %04x->%04x, channels %u->%u, rate %d->%d\n",
-           src_fmt, dst_fmt, src_channels, dst_channels, src_rate, dst_rate);
-#endif
-
-    /* Start off with no conversion necessary */
-    cvt->src_format = src_fmt;
-    cvt->dst_format = dst_fmt;
-    cvt->needed = 0;
-    cvt->filter_index = 0;
-    SDL_zero(cvt->filters);
-    cvt->len_mult = 1;
-    cvt->len_ratio = 1.0;
-    cvt->rate_incr = ((double) dst_rate) / ((double) src_rate);
-
-    /* Make sure we've chosen audio conversion functions (MMX, scalar, etc.) */
-    SDL_ChooseAudioConverters();
-
     /* Type conversion goes like this now:
         - byteswap to CPU native format first if necessary.
         - convert to native Float32 if necessary.
@@ -922,8 +1372,9 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
 
        The expectation is we can process data faster in float32
        (possibly with SIMD), and making several passes over the same
-       buffer is likely to be CPU cache-friendly, avoiding the
-       biggest performance hit in modern times. Previously we had
+       block of the buffer (see SDL_ConvertAudioBlocks) is CPU
+       cache-friendly, avoiding the biggest performance hit in
+       modern times. Previously we had
        (script-generated) custom converters for every data type and
        it was a bloat on SDL compile times and final library size. */
 
@@ -935,11 +1386,7 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
 
         /* just a byteswap needed? */
         if ((src_fmt & ~SDL_AUDIO_MASK_ENDIAN) == (dst_fmt & ~SDL_AUDIO_MASK_ENDIAN)) {
-            if (SDL_AddAudioCVTFilter(cvt, SDL_Convert_Byteswap) < 0) {
-                return -1;
-            }
-            cvt->needed = 1;
-            return 1;
+            return SDL_AddAudioCVTFilter(cvt, SDL_Convert_Byteswap);
         }
     }
 
@@ -1072,6 +1519,314 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
         return -1;              /* shouldn't happen, but just in case... */
     }
 
+    return 0;
+}
+
+/* Block conversion.
+
+   Each filter makes its own pass over the whole buffer, and the resampler
+   also needs a second buffer's worth of scratch space.  So when there is
+   more than one pass to make, SDL_BuildAudioCVT() puts SDL_ConvertAudioBlocks()
+   in the list instead, to run the same filters a block of frames at a time
+   in a small scratch buffer that stays in the cache.  The converted input
+   frames are queued up as floats for the resampler, and every block of
+   output goes straight to its final place in cvt->buf.
+
+   Output that takes more bytes than the input it came from is written from
+   the end of the buffer backwards, so input that is still needed is never
+   overwritten.  Output that takes fewer is written forwards, reading far
+   enough ahead of it.
+
+   The filters are worked out again from the channel counts and rates on
+   every conversion.  There is no other room for those in SDL_AudioCVT, so
+   like the resampler, this steals the last three slots of the filter list.
+ */
+#define SDL_AUDIOCVT_BLOCK_FRAMES 256
+
+typedef struct SDL_AudioBlockCVT
+{
+    SDL_AudioCVT *cvt;
+    SDL_AudioCVT incvt;     /* the filters before the resampler */
+    SDL_AudioCVT outcvt;    /* the ones after it */
+    int src_framelen;
+    int dst_framelen;
+    int inframes;
+    int chans;
+    Uint8 *scratch;         /* SDL_AUDIOCVT_BLOCK_FRAMES frames, as big as they get */
+    float *queue;           /* converted input frames for the resampler */
+    int queue_start;        /* first input frame in the queue, negative in the padding */
+    int queue_end;
+} SDL_AudioBlockCVT;
+
+static int
+SDL_RunAudioCVTFilters(SDL_AudioCVT *cvt, const SDL_AudioFormat format, Uint8 *buf, const int len)
+{
+    cvt->buf = buf;
+    cvt->len = cvt->len_cvt = len;
+    if (cvt->filters[0]) {
+        cvt->filter_index = 0;
+        cvt->filters[0] (cvt, format);
+    }
+    return cvt->len_cvt;
+}
+
+/* Converts input frames [first, last) into dst, with silence outside the buffer */
+static void
+SDL_ConvertAudioBlockInput(SDL_AudioBlockCVT *block, float *dst, int first, const int last)
+{
+    const int framelen = block->chans * (int) sizeof (float);
+
+    while (first < last) {
+        int frames;
+        if (first < 0 || first >= block->inframes) {
+            frames = ((first < 0) ? SDL_min(last, 0) : last) - first;
+            SDL_memset(dst, '\0', frames * framelen);
+        } else {
+            frames = SDL_min(SDL_min(last, block->inframes) - first, SDL_AUDIOCVT_BLOCK_FRAMES);
+            SDL_memcpy(block->scratch, block->cvt->buf + (first * block->src_framelen), frames * block->src_framelen);
+            SDL_RunAudioCVTFilters(&block->incvt, block->cvt->src_format, block->scratch, frames * block->src_framelen);
+            SDL_memcpy(dst, block->scratch, frames * framelen);
+        }
+        dst += frames * block->chans;
+        first += frames;
+    }
+}
+
+/* Makes the queue hold input frames [first, last), keeping the ones it already has */
+static void
+SDL_FillAudioBlockQueue(SDL_AudioBlockCVT *block, const int first, const int last)
+{
+    const int keepfirst = SDL_max(first, block->queue_start);
+    const int keeplast = SDL_min(last, block->queue_end);
+
+    if (keepfirst < keeplast) {
+        SDL_memmove(block->queue + ((keepfirst - first) * block->chans),
+                    block->queue + ((keepfirst - block->queue_start) * block->chans),
+                    (keeplast - keepfirst) * block->chans * sizeof (float));
+        SDL_ConvertAudioBlockInput(block, block->queue, first, keepfirst);
+        SDL_ConvertAudioBlockInput(block, block->queue + ((keeplast - first) * block->chans), keeplast, last);
+    } else {
+        SDL_ConvertAudioBlockInput(block, block->queue, first, last);
+    }
+    block->queue_start = first;
+    block->queue_end = last;
+}
+
+static void SDLCALL
+SDL_ConvertAudioBlocks(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    const int layout = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS-2];
+    const Uint8 src_channels = (Uint8) (layout >> 8);
+    const Uint8 dst_channels = (Uint8) (layout & 0xFF);
+    const int src_rate = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS-1];
+    const int dst_rate = (int) (size_t) cvt->filters[SDL_AUDIOCVT_MAX_FILTERS];
+    const int maxoutframes = (cvt->len * cvt->len_mult) / ((dst_channels * SDL_AUDIO_BITSIZE(cvt->dst_format)) / 8);
+    const SDL_AudioFilter resampler = (src_rate != dst_rate) ? ChooseCVTResampler(dst_channels) : NULL;
+    SDL_ResampleTable *table = NULL;
+    SDL_bool sharedtable = SDL_FALSE;
+    SDL_AudioBlockCVT block;
+    SDL_AudioCVT chain;
+    SDL_bool backwards;
+    Uint8 *work;
+    float *outblock;
+    int blockframes, outframes, queueframes, i, n;
+
+    SDL_assert(format == cvt->src_format);
+
+    SDL_zero(block);
+    block.cvt = cvt;
+    block.src_framelen = (src_channels * SDL_AUDIO_BITSIZE(cvt->src_format)) / 8;
+    block.dst_framelen = (dst_channels * SDL_AUDIO_BITSIZE(cvt->dst_format)) / 8;
+    block.inframes = cvt->len / block.src_framelen;
+    block.chans = dst_channels;
+
+    /* Split the filters at the resampler */
+    SDL_zero(chain);
+    if (SDL_BuildAudioCVTFilters(&chain, cvt->src_format, src_channels, src_rate, cvt->dst_format, dst_channels, dst_rate) < 0) {
+        return;
+    }
+    for (i = 0, n = 0; i < chain.filter_index; i++) {
+        if (chain.filters[i] == resampler) {
+            n = i + 1;
+        } else if (n == 0) {
+            block.incvt.filters[i] = chain.filters[i];
+        } else {
+            block.outcvt.filters[i - n] = chain.filters[i];
+        }
+    }
+
+    if (resampler) {
+        /* If the cached tables are all busy, use one of our own */
+        table = SDL_GetResampleTable(dst_channels, src_rate, dst_rate);
+        if (table) {
+            sharedtable = SDL_TRUE;
+        } else {
+            const int gcd = ResamplerGCD(src_rate, dst_rate);
+            table = SDL_CreateResampleTable(dst_channels, src_rate / gcd, dst_rate / gcd, ResamplerTaps());
+            if (!table) {
+                SDL_OutOfMemory();
+                return;
+            }
+        }
+        outframes = (int) (block.inframes * (((double) dst_rate) / ((double) src_rate)));
+        blockframes = (int) SDL_min(SDL_max(((Sint64) SDL_AUDIOCVT_BLOCK_FRAMES * table->outrate) / table->inrate, 1), SDL_AUDIOCVT_BLOCK_FRAMES);
+        queueframes = SDL_AUDIOCVT_BLOCK_FRAMES + table->taps + ((table->inrate + table->outrate - 1) / table->outrate) + 2;
+    } else {
+        outframes = block.inframes;
+        blockframes = SDL_AUDIOCVT_BLOCK_FRAMES;
+        queueframes = 0;
+    }
+    outframes = SDL_min(outframes, maxoutframes);
+    backwards = (((Sint64) block.dst_framelen * dst_rate) > ((Sint64) block.src_framelen * src_rate)) ? SDL_TRUE : SDL_FALSE;
+
+    /* Frames are at most 8 channels of 32 bits on the way through.  Keep
+       the blocks aligned, so the SIMD converters don't skip any of them. */
+    queueframes = (queueframes + 7) & ~7;
+    work = (Uint8 *) SDL_malloc((SDL_AUDIOCVT_BLOCK_FRAMES * 32) + (queueframes * block.chans * sizeof (float)) +
+                                (blockframes * block.chans * sizeof (float)) + 31);
+    if (!work) {
+        if (table && !sharedtable) {
+            SDL_free(table->coeffs_base);
+            SDL_free(table);
+        } else if (table) {
+            SDL_ReleaseResampleTable(table);
+        }
+        SDL_OutOfMemory();
+        return;
+    }
+    block.scratch = (Uint8 *) ((((size_t) work) + 31) & ~((size_t) 31));
+    block.queue = (float *) (block.scratch + (SDL_AUDIOCVT_BLOCK_FRAMES * 32));
+    outblock = block.queue + (queueframes * block.chans);
+
+    for (i = 0; i < outframes; i += blockframes) {
+        const int first = backwards ? SDL_max(outframes - i - blockframes, 0) : i;
+        const int last = backwards ? (outframes - i) : SDL_min(i + blockframes, outframes);
+        Uint8 *src;
+        int len;
+
+        if (table) {
+            const int before = (table->taps / 2) - 1;
+            const Sint64 firstpos = (Sint64) first * table->inrate;
+            const int srcindex = (int) (firstpos / table->outrate);
+            const int frac = (int) (firstpos % table->outrate);
+            const int lastindex = (int) ((((Sint64) last - 1) * table->inrate) / table->outrate);
+            int queuefirst = srcindex - before;
+            int queuelast = lastindex - before + table->taps;
+
+            if (!backwards) {
+                /* Read past every input byte this block's output will overwrite */
+                const int written = (int) ((((Sint64) last * block.dst_framelen) + block.src_framelen - 1) / block.src_framelen);
+                queuelast = SDL_max(queuelast, SDL_min(written, block.inframes));
+            }
+            SDL_assert((queuelast - queuefirst) <= queueframes);
+
+            SDL_FillAudioBlockQueue(&block, queuefirst, queuelast);
+            SDL_ResampleAudioPolyphase(table, 0, NULL, NULL, block.queue, queuelast - queuefirst,
+                                       srcindex - queuefirst, frac, outblock, last - first);
+            src = (Uint8 *) outblock;
+            len = SDL_RunAudioCVTFilters(&block.outcvt, AUDIO_F32SYS, src, (last - first) * block.chans * sizeof (float));
+        } else {
+            src = block.scratch;
+            SDL_memcpy(src, cvt->buf + (first * block.src_framelen), (last - first) * block.src_framelen);
+            len = SDL_RunAudioCVTFilters(&block.incvt, cvt->src_format, src, (last - first) * block.src_framelen);
+        }
+
+        SDL_assert(len == ((last - first) * block.dst_framelen));
+        SDL_memcpy(cvt->buf + (first * block.dst_framelen), src, len);
+    }
+
+    SDL_free(work);
+    if (table && !sharedtable) {
+        SDL_free(table->coeffs_base);
+        SDL_free(table);
+    } else if (table) {
+        SDL_ReleaseResampleTable(table);
+    }
+
+    cvt->len_cvt = outframes * block.dst_framelen;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, cvt->dst_format);
+    }
+}
+
+static void
+SDL_BuildAudioBlockCVT(SDL_AudioCVT *cvt, const Uint8 src_channels, const int src_rate,
+                       const Uint8 dst_channels, const int dst_rate)
+{
+    const int src_framelen = (src_channels * SDL_AUDIO_BITSIZE(cvt->src_format)) / 8;
+    const int dst_framelen = (dst_channels * SDL_AUDIO_BITSIZE(cvt->dst_format)) / 8;
+    const double mult = (((double) dst_rate) * dst_framelen) / (((double) src_rate) * src_framelen);
+
+    SDL_zero(cvt->filters);
+    cvt->filters[0] = SDL_ConvertAudioBlocks;
+    cvt->filter_index = 1;
+    cvt->filters[SDL_AUDIOCVT_MAX_FILTERS-2] = (SDL_AudioFilter) (size_t) ((src_channels << 8) | dst_channels);
+    cvt->filters[SDL_AUDIOCVT_MAX_FILTERS-1] = (SDL_AudioFilter) (size_t) src_rate;
+    cvt->filters[SDL_AUDIOCVT_MAX_FILTERS] = (SDL_AudioFilter) (size_t) dst_rate;
+
+    /* The output lands in place, no scratch space needed */
+    cvt->len_mult = SDL_max((int) SDL_ceil(mult), 1);
+}
+
+/* Creates a set of audio filters to convert from one format to another.
+   Returns 0 if no conversion is needed, 1 if the audio filter is set up,
+   or -1 if an error like invalid parameter, unsupported format, etc. occurred.
+*/
+
+int
+SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
+                  SDL_AudioFormat src_fmt, Uint8 src_channels, int src_rate,
+                  SDL_AudioFormat dst_fmt, Uint8 dst_channels, int dst_rate)
+{
+    /* Sanity check target pointer */
+    if (cvt == NULL) {
+        return SDL_InvalidParamError("cvt");
+    }
+
+    /* Make sure we zero out the audio conversion before error checking */
+    SDL_zerop(cvt);
+
+    if (!SDL_SupportedAudioFormat(src_fmt)) {
+        return SDL_SetError("Invalid source format");
+    } else if (!SDL_SupportedAudioFormat(dst_fmt)) {
+        return SDL_SetError("Invalid destination format");
+    } else if (!SDL_SupportedChannelCount(src_channels)) {
+        return SDL_SetError("Invalid source channels");
+    } else if (!SDL_SupportedChannelCount(dst_channels)) {
+        return SDL_SetError("Invalid destination channels");
+    } else if (src_rate == 0) {
+        return SDL_SetError("Source rate is zero");
+    } else if (dst_rate == 0) {
+        return SDL_SetError("Destination rate is zero");
+    }
+
+#if DEBUG_CONVERT
+    printf("Build format %04x->%04x, channels %u->%u, rate %d->%d\n",
+           src_fmt, dst_fmt, src_channels, dst_channels, src_rate, dst_rate);
+#endif
+
+    /* Start off with no conversion necessary */
+    cvt->src_format = src_fmt;
+    cvt->dst_format = dst_fmt;
+    cvt->needed = 0;
+    cvt->filter_index = 0;
+    SDL_zero(cvt->filters);
+    cvt->len_mult = 1;
+    cvt->len_ratio = 1.0;
+    cvt->rate_incr = ((double) dst_rate) / ((double) src_rate);
+
+    /* Make sure we've chosen audio conversion functions (MMX, scalar, etc.) */
+    SDL_ChooseAudioConverters();
+
+    if (SDL_BuildAudioCVTFilters(cvt, src_fmt, src_channels, src_rate, dst_fmt, dst_channels, dst_rate) < 0) {
+        return -1;
+    }
+
+    /* More than one pass over the buffer?  Do them all block by block. */
+    if (cvt->filter_index > 1 || src_rate != dst_rate) {
+        SDL_BuildAudioBlockCVT(cvt, src_channels, src_rate, dst_channels, dst_rate);
+    }
+
     cvt->needed = (cvt->filter_index != 0);
     return (cvt->needed);
 }
@@ -1342,6 +2097,7 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
                 SDL_FreeAudioStream(retval);
                 return NULL;
             }
+            SDL_PrepareResampleTable(pre_resample_channels, src_rate, dst_rate);
 
             retval->resampler_func = SDL_ResampleAudioStream;
             retval->reset_resampler_func = SDL_ResetAudioStreamResampler;
@@ -26,6 +26,7 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
+#include "../cpuinfo/SDL_simd.h"
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -125,6 +126,303 @@ static const Uint8 mix8[] = {
 	}	\
 }
 
+/* SIMD kernels for the native byte order S16, S32 and F32 formats.
+   They give the same results as the scalar code below: the source sample is
+   scaled with truncation toward zero, clamped to the symmetric range and then
+   added to the destination with saturation.  Each one mixes as many whole
+   vectors as fit and returns how many samples that was, the scalar code does
+   the rest.  Negative volumes (which amplify), and for S32 volumes above
+   SDL_MIX_MAXVOLUME, are always left to the scalar code. */
+typedef Uint32 (*SDL_MixAudioFunc) (void *dst, const void *src, Uint32 num, int volume);
+
+static SDL_MixAudioFunc SDL_MixAudio_S16 = NULL;
+static SDL_MixAudioFunc SDL_MixAudio_S32 = NULL;
+static SDL_MixAudioFunc SDL_MixAudio_F32 = NULL;
+
+#ifdef __SSE2__
+static Uint32
+SDL_MixAudio_S16_SSE2(void *dst, const void *src, Uint32 num, int volume)
+{
+    const __m128i vol = _mm_set1_epi16((Sint16) volume);
+    const __m128i bias = _mm_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    const __m128i minval = _mm_set1_epi16(-32767);
+    const __m128i *s = (const __m128i *) src;
+    __m128i *d = (__m128i *) dst;
+    const Uint32 count = num & ~7;
+    Uint32 i;
+
+    for (i = 0; i < count; i += 8, ++s, ++d) {
+        __m128i x = _mm_loadu_si128(s);
+        if (volume != SDL_MIX_MAXVOLUME) {
+            const __m128i lo = _mm_mullo_epi16(x, vol);
+            const __m128i hi = _mm_mulhi_epi16(x, vol);
+            __m128i p0 = _mm_unpacklo_epi16(lo, hi);
+            __m128i p1 = _mm_unpackhi_epi16(lo, hi);
+            p0 = _mm_srai_epi32(_mm_add_epi32(p0, _mm_and_si128(_mm_srai_epi32(p0, 31), bias)), 7);
+            p1 = _mm_srai_epi32(_mm_add_epi32(p1, _mm_and_si128(_mm_srai_epi32(p1, 31), bias)), 7);
+            x = _mm_packs_epi32(p0, p1);
+        }
+        x = _mm_max_epi16(x, minval);
+        _mm_storeu_si128(d, _mm_adds_epi16(_mm_loadu_si128(d), x));
+    }
+    return count;
+}
+
+static Uint32
+SDL_MixAudio_S32_SSE2(void *dst, const void *src, Uint32 num, int volume)
+{
+    const __m128d scale = _mm_set1_pd(((double) volume) / SDL_MIX_MAXVOLUME);
+    const __m128d minval = _mm_set1_pd(-2147483647.0);
+    const __m128d maxval = _mm_set1_pd(2147483647.0);
+    const __m128d summin = _mm_set1_pd(-2147483648.0);
+    const __m128i *s = (const __m128i *) src;
+    __m128i *d = (__m128i *) dst;
+    const Uint32 count = num & ~3;
+    Uint32 i;
+
+    /* Doubles hold the products exactly, and the clamped values are whole
+       numbers in range for the truncating conversions */
+    for (i = 0; i < count; i += 4, ++s, ++d) {
+        const __m128i x = _mm_loadu_si128(s);
+        const __m128i y = _mm_loadu_si128(d);
+        __m128d x0 = _mm_mul_pd(_mm_cvtepi32_pd(x), scale);
+        __m128d x1 = _mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(x, 8)), scale);
+        x0 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(x0, minval), maxval)));
+        x1 = _mm_cvtepi32_pd(_mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(x1, minval), maxval)));
+        x0 = _mm_add_pd(x0, _mm_cvtepi32_pd(y));
+        x1 = _mm_add_pd(x1, _mm_cvtepi32_pd(_mm_srli_si128(y, 8)));
+        x0 = _mm_min_pd(_mm_max_pd(x0, summin), maxval);
+        x1 = _mm_min_pd(_mm_max_pd(x1, summin), maxval);
+        _mm_storeu_si128(d, _mm_unpacklo_epi64(_mm_cvttpd_epi32(x0), _mm_cvttpd_epi32(x1)));
+    }
+    return count;
+}
+#endif
+
+#ifdef __SSE__
+static Uint32
+SDL_MixAudio_F32_SSE(void *dst, const void *src, Uint32 num, int volume)
+{
+    const __m128 fvolume = _mm_set1_ps((float) volume);
+    const __m128 fmaxvolume = _mm_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m128 minval = _mm_set1_ps(-3.402823466e+38F);
+    const __m128 maxval = _mm_set1_ps(3.402823466e+38F);
+    const float *s = (const float *) src;
+    float *d = (float *) dst;
+    const Uint32 count = num & ~3;
+    Uint32 i;
+
+    /* The clamp value comes first so that NaN is passed through */
+    for (i = 0; i < count; i += 4) {
+        __m128 x = _mm_mul_ps(_mm_mul_ps(_mm_loadu_ps(s + i), fvolume), fmaxvolume);
+        x = _mm_add_ps(x, _mm_loadu_ps(d + i));
+        x = _mm_max_ps(minval, _mm_min_ps(maxval, x));
+        _mm_storeu_ps(d + i, x);
+    }
+    return count;
+}
+#endif
+
+#if HAVE_AVX2_INTRINSICS
+SDL_TARGETING_AVX2 static Uint32
+SDL_MixAudio_S16_AVX2(void *dst, const void *src, Uint32 num, int volume)
+{
+    const __m256i vol = _mm256_set1_epi16((Sint16) volume);
+    const __m256i bias = _mm256_set1_epi32(SDL_MIX_MAXVOLUME - 1);
+    const __m256i minval = _mm256_set1_epi16(-32767);
+    const __m256i *s = (const __m256i *) src;
+    __m256i *d = (__m256i *) dst;
+    const Uint32 count = num & ~15;
+    Uint32 i;
+
+    /* The unpacks and the pack both work within 128-bit lanes, so the
+       samples end up back in order */
+    for (i = 0; i < count; i += 16, ++s, ++d) {
+        __m256i x = _mm256_loadu_si256(s);
+        if (volume != SDL_MIX_MAXVOLUME) {
+            const __m256i lo = _mm256_mullo_epi16(x, vol);
+            const __m256i hi = _mm256_mulhi_epi16(x, vol);
+            __m256i p0 = _mm256_unpacklo_epi16(lo, hi);
+            __m256i p1 = _mm256_unpackhi_epi16(lo, hi);
+            p0 = _mm256_srai_epi32(_mm256_add_epi32(p0, _mm256_and_si256(_mm256_srai_epi32(p0, 31), bias)), 7);
+            p1 = _mm256_srai_epi32(_mm256_add_epi32(p1, _mm256_and_si256(_mm256_srai_epi32(p1, 31), bias)), 7);
+            x = _mm256_packs_epi32(p0, p1);
+        }
+        x = _mm256_max_epi16(x, minval);
+        _mm256_storeu_si256(d, _mm256_adds_epi16(_mm256_loadu_si256(d), x));
+    }
+    return count;
+}
+
+/* At most full volume the scaled sample fits in 32 bits, apart from -2^31
+   at full volume, which the clamp takes care of */
+SDL_TARGETING_AVX2 static Uint32
+SDL_MixAudio_S32_AVX2(void *dst, const void *src, Uint32 num, int volume)
+{
+    const __m256i vol = _mm256_set1_epi32(volume);
+    const __m256i bias = _mm256_set1_epi64x(SDL_MIX_MAXVOLUME - 1);
+    const __m256i minval = _mm256_set1_epi32(-2147483647);
+    const __m256i maxval = _mm256_set1_epi32(2147483647);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i *s = (const __m256i *) src;
+    __m256i *d = (__m256i *) dst;
+    const Uint32 count = num & ~7;
+    Uint32 i;
+
+    for (i = 0; i < count; i += 8, ++s, ++d) {
+        __m256i x = _mm256_loadu_si256(s);
+        const __m256i y = _mm256_loadu_si256(d);
+        __m256i sum, overflow;
+        if (volume != SDL_MIX_MAXVOLUME) {
+            __m256i p0 = _mm256_mul_epi32(x, vol);
+            __m256i p1 = _mm256_mul_epi32(_mm256_srli_epi64(x, 32), vol);
+            p0 = _mm256_srli_epi64(_mm256_add_epi64(p0, _mm256_and_si256(_mm256_cmpgt_epi64(zero, p0), bias)), 7);
+            p1 = _mm256_srli_epi64(_mm256_add_epi64(p1, _mm256_and_si256(_mm256_cmpgt_epi64(zero, p1), bias)), 7);
+            x = _mm256_blend_epi32(p0, _mm256_slli_epi64(p1, 32), 0xAA);
+        }
+        x = _mm256_max_epi32(x, minval);
+
+        /* Saturating add: on overflow both inputs have the same sign */
+        sum = _mm256_add_epi32(x, y);
+        overflow = _mm256_andnot_si256(_mm256_xor_si256(x, y), _mm256_xor_si256(x, sum));
+        sum = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(sum),
+                                                   _mm256_castsi256_ps(_mm256_xor_si256(_mm256_srai_epi32(x, 31), maxval)),
+                                                   _mm256_castsi256_ps(overflow)));
+        _mm256_storeu_si256(d, sum);
+    }
+    return count;
+}
+
+SDL_TARGETING_AVX2 static Uint32
+SDL_MixAudio_F32_AVX2(void *dst, const void *src, Uint32 num, int volume)
+{
+    const __m256 fvolume = _mm256_set1_ps((float) volume);
+    const __m256 fmaxvolume = _mm256_set1_ps(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const __m256 minval = _mm256_set1_ps(-3.402823466e+38F);
+    const __m256 maxval = _mm256_set1_ps(3.402823466e+38F);
+    const float *s = (const float *) src;
+    float *d = (float *) dst;
+    const Uint32 count = num & ~7;
+    Uint32 i;
+
+    for (i = 0; i < count; i += 8) {
+        __m256 x = _mm256_mul_ps(_mm256_mul_ps(_mm256_loadu_ps(s + i), fvolume), fmaxvolume);
+        x = _mm256_add_ps(x, _mm256_loadu_ps(d + i));
+        x = _mm256_max_ps(minval, _mm256_min_ps(maxval, x));
+        _mm256_storeu_ps(d + i, x);
+    }
+    return count;
+}
+#endif
+
+#if HAVE_NEON_INTRINSICS
+static Uint32
+SDL_MixAudio_S16_NEON(void *dst, const void *src, Uint32 num, int volume)
+{
+    const int16x4_t vol = vdup_n_s16((Sint16) volume);
+    const int16x8_t minval = vdupq_n_s16(-32767);
+    const Sint16 *s = (const Sint16 *) src;
+    Sint16 *d = (Sint16 *) dst;
+    const Uint32 count = num & ~7;
+    Uint32 i;
+
+    for (i = 0; i < count; i += 8) {
+        int16x8_t x = vld1q_s16(s + i);
+        if (volume != SDL_MIX_MAXVOLUME) {
+            int32x4_t p0 = vmull_s16(vget_low_s16(x), vol);
+            int32x4_t p1 = vmull_s16(vget_high_s16(x), vol);
+            p0 = vshrq_n_s32(vaddq_s32(p0, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p0, 31)), 25))), 7);
+            p1 = vshrq_n_s32(vaddq_s32(p1, vreinterpretq_s32_u32(vshrq_n_u32(vreinterpretq_u32_s32(vshrq_n_s32(p1, 31)), 25))), 7);
+            x = vcombine_s16(vqmovn_s32(p0), vqmovn_s32(p1));
+        }
+        x = vmaxq_s16(x, minval);
+        vst1q_s16(d + i, vqaddq_s16(vld1q_s16(d + i), x));
+    }
+    return count;
+}
+
+static Uint32
+SDL_MixAudio_S32_NEON(void *dst, const void *src, Uint32 num, int volume)
+{
+    const int32x2_t vol = vdup_n_s32(volume);
+    const int32x4_t minval = vdupq_n_s32(-2147483647);
+    const Sint32 *s = (const Sint32 *) src;
+    Sint32 *d = (Sint32 *) dst;
+    const Uint32 count = num & ~3;
+    Uint32 i;
+
+    for (i = 0; i < count; i += 4) {
+        const int32x4_t x = vld1q_s32(s + i);
+        int64x2_t p0 = vmull_s32(vget_low_s32(x), vol);
+        int64x2_t p1 = vmull_s32(vget_high_s32(x), vol);
+        p0 = vshrq_n_s64(vaddq_s64(p0, vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_s64(vshrq_n_s64(p0, 63)), 57))), 7);
+        p1 = vshrq_n_s64(vaddq_s64(p1, vreinterpretq_s64_u64(vshrq_n_u64(vreinterpretq_u64_s64(vshrq_n_s64(p1, 63)), 57))), 7);
+        vst1q_s32(d + i, vqaddq_s32(vld1q_s32(d + i), vmaxq_s32(vcombine_s32(vqmovn_s64(p0), vqmovn_s64(p1)), minval)));
+    }
+    return count;
+}
+
+static Uint32
+SDL_MixAudio_F32_NEON(void *dst, const void *src, Uint32 num, int volume)
+{
+    const float32x4_t fvolume = vdupq_n_f32((float) volume);
+    const float32x4_t fmaxvolume = vdupq_n_f32(1.0f / ((float) SDL_MIX_MAXVOLUME));
+    const float32x4_t minval = vdupq_n_f32(-3.402823466e+38F);
+    const float32x4_t maxval = vdupq_n_f32(3.402823466e+38F);
+    const float *s = (const float *) src;
+    float *d = (float *) dst;
+    const Uint32 count = num & ~3;
+    Uint32 i;
+
+    /* vminq/vmaxq return NaN if either value is NaN, like the scalar code */
+    for (i = 0; i < count; i += 4) {
+        float32x4_t x = vmulq_f32(vmulq_f32(vld1q_f32(s + i), fvolume), fmaxvolume);
+        x = vaddq_f32(x, vld1q_f32(d + i));
+        vst1q_f32(d + i, vmaxq_f32(vminq_f32(x, maxval), minval));
+    }
+    return count;
+}
+#endif
+
+static void
+SDL_ChooseMixAudioFuncs(void)
+{
+    static SDL_bool funcs_chosen = SDL_FALSE;
+
+    if (funcs_chosen) {
+        return;
+    }
+
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        SDL_MixAudio_S16 = SDL_MixAudio_S16_AVX2;
+        SDL_MixAudio_S32 = SDL_MixAudio_S32_AVX2;
+        SDL_MixAudio_F32 = SDL_MixAudio_F32_AVX2;
+        funcs_chosen = SDL_TRUE;
+        return;
+    }
+#endif
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        SDL_MixAudio_S16 = SDL_MixAudio_S16_SSE2;
+        SDL_MixAudio_S32 = SDL_MixAudio_S32_SSE2;
+    }
+#endif
+#ifdef __SSE__
+    if (SDL_HasSSE()) {
+        SDL_MixAudio_F32 = SDL_MixAudio_F32_SSE;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        SDL_MixAudio_S16 = SDL_MixAudio_S16_NEON;
+        SDL_MixAudio_S32 = SDL_MixAudio_S32_NEON;
+        SDL_MixAudio_F32 = SDL_MixAudio_F32_NEON;
+    }
+#endif
+    funcs_chosen = SDL_TRUE;
+}
+
 void
 SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
                    Uint32 len, int volume)
@@ -133,6 +431,8 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
         return;
     }
 
+    SDL_ChooseMixAudioFuncs();
+
     switch (format) {
 
     case AUDIO_U8:
@@ -192,6 +492,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const int min_audioval = -(1 << (16 - 1));
 
             len /= 2;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            if (SDL_MixAudio_S16 && volume > 0 && volume <= 32767) {
+                const Uint32 mixed = SDL_MixAudio_S16(dst, src, len, volume);
+                src += mixed * 2;
+                dst += mixed * 2;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((src[1]) << 8 | src[0]);
                 // ADJUST_VOLUME(src1, volume);
@@ -224,6 +532,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const int min_audioval = -(1 << (16 - 1));
 
             len /= 2;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            if (SDL_MixAudio_S16 && volume > 0 && volume <= 32767) {
+                const Uint32 mixed = SDL_MixAudio_S16(dst, src, len, volume);
+                src += mixed * 2;
+                dst += mixed * 2;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((src[0]) << 8 | src[1]);
                 // ADJUST_VOLUME(src1, volume);
@@ -305,6 +621,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const Sint64 min_audioval = -(((Sint64) 1) << (32 - 1));
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            if (SDL_MixAudio_S32 && volume > 0 && volume <= SDL_MIX_MAXVOLUME) {
+                const Uint32 mixed = SDL_MixAudio_S32(dst32, src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = (Sint64) ((Sint32) SDL_SwapLE32(*src32));
                 src32++;
@@ -332,6 +656,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const Sint64 min_audioval = -(((Sint64) 1) << (32 - 1));
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            if (SDL_MixAudio_S32 && volume > 0 && volume <= SDL_MIX_MAXVOLUME) {
+                const Uint32 mixed = SDL_MixAudio_S32(dst32, src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = (Sint64) ((Sint32) SDL_SwapBE32(*src32));
                 src32++;
@@ -362,6 +694,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const double min_audioval = -3.402823466e+38F;
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            if (SDL_MixAudio_F32) {
+                const Uint32 mixed = SDL_MixAudio_F32(dst32, src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((SDL_SwapFloatLE(*src32) * fvolume) * fmaxvolume);
                 src2 = SDL_SwapFloatLE(*dst32);
@@ -391,6 +731,14 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
             const double min_audioval = -3.402823466e+38F;
 
             len /= 4;
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+            if (SDL_MixAudio_F32) {
+                const Uint32 mixed = SDL_MixAudio_F32(dst32, src32, len, volume);
+                src32 += mixed;
+                dst32 += mixed;
+                len -= mixed;
+            }
+#endif
             while (len--) {
                 src1 = ((SDL_SwapFloatBE(*src32) * fvolume) * fmaxvolume);
                 src2 = SDL_SwapFloatBE(*dst32);
@@ -0,0 +1,60 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+#ifndef SDL_simd_h_
+#define SDL_simd_h_
+
+#include "SDL_cpuinfo.h"
+
+/* Which SIMD kernels can be built into SDL.
+
+   SSE2 kernels are built when the compiler targets SSE2 (__SSE2__).
+
+   AVX2 kernels are built whenever the compiler can generate AVX2 code.  With
+   GCC and clang only the kernels themselves are compiled for AVX2, by putting
+   SDL_TARGETING_AVX2 in front of them, so they must only be called after
+   SDL_HasAVX2() says the CPU supports it.
+
+   NEON kernels are built when the compiler targets NEON and are still checked
+   at runtime with SDL_HasNEON().
+ */
+#if defined(_MSC_VER) && (_MSC_VER >= 1700) && (defined(_M_IX86) || defined(_M_X64)) && !defined(__clang__)
+#define HAVE_AVX2_INTRINSICS    1
+#define SDL_TARGETING_AVX2
+#elif HAVE_IMMINTRIN_H && !defined(SDL_DISABLE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__))
+#if defined(__AVX2__)
+#define HAVE_AVX2_INTRINSICS    1
+#define SDL_TARGETING_AVX2
+#elif defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define HAVE_AVX2_INTRINSICS    1
+#define SDL_TARGETING_AVX2      __attribute__((target("avx2")))
+#endif
+#endif
+
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(SDL_DISABLE_ARM_NEON_H)
+#include <arm_neon.h>
+#define HAVE_NEON_INTRINSICS    1
+#endif
+
+#endif /* SDL_simd_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
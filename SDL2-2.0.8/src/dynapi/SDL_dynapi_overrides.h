@@ -733,4 +733,15 @@
 #define SDL_BleNotifyCharacteristic SDL_BleNotifyCharacteristic_REAL
 #define SDL_BleDiscoverDescriptors SDL_BleDiscoverDescriptors_REAL
 #define SDL_BleAuthorizationStatus SDL_BleAuthorizationStatus_REAL
-#define SDL_BleUuidEqual SDL_BleUuidEqual_REAL
\ No newline at end of file
+#define SDL_BleUuidEqual SDL_BleUuidEqual_REAL
+#define SDL_PollEvents SDL_PollEvents_REAL
+#define SDL_AddTimerUS SDL_AddTimerUS_REAL
+#define SDL_GetSurfacePoolStats SDL_GetSurfacePoolStats_REAL
+#define SDL_TrimSurfacePool SDL_TrimSurfacePool_REAL
+#define SDL_SoftStretchLinear SDL_SoftStretchLinear_REAL
+#define SDL_UpdateYUVTextureFrame SDL_UpdateYUVTextureFrame_REAL
+#define SDL_GetQueuedAudioStats SDL_GetQueuedAudioStats_REAL
+#define SDL_ResetQueuedAudioStats SDL_ResetQueuedAudioStats_REAL
+#define SDL_RWFromFileMapped SDL_RWFromFileMapped_REAL
+#define SDL_RWGetMemoryView SDL_RWGetMemoryView_REAL
+#define SDL_RWFromBuffered SDL_RWFromBuffered_REAL
@@ -768,4 +768,15 @@ SDL_DYNAPI_PROC(void, SDL_BleWriteCharacteristic, (SDL_BlePeripheral* a, SDL_Ble
 SDL_DYNAPI_PROC(void, SDL_BleNotifyCharacteristic, (SDL_BlePeripheral* a, SDL_BleCharacteristic* b, SDL_bool c), (a, b, c), )
 SDL_DYNAPI_PROC(void, SDL_BleDiscoverDescriptors, (SDL_BlePeripheral* a, SDL_BleCharacteristic* b), (a, b), )
 SDL_DYNAPI_PROC(int, SDL_BleAuthorizationStatus, (void), (), return)
-SDL_DYNAPI_PROC(SDL_bool, SDL_BleUuidEqual, (const char* a, const char* b), (a, b), return)
\ No newline at end of file
+SDL_DYNAPI_PROC(SDL_bool, SDL_BleUuidEqual, (const char* a, const char* b), (a, b), return)
+SDL_DYNAPI_PROC(int,SDL_PollEvents,(SDL_Event *a, int b),(a,b),return)
+SDL_DYNAPI_PROC(SDL_TimerID,SDL_AddTimerUS,(Uint32 a, SDL_TimerCallback b, void *c),(a,b,c),return)
+SDL_DYNAPI_PROC(void,SDL_GetSurfacePoolStats,(SDL_SurfacePoolStats *a),(a),)
+SDL_DYNAPI_PROC(void,SDL_TrimSurfacePool,(size_t a),(a),)
+SDL_DYNAPI_PROC(int,SDL_SoftStretchLinear,(SDL_Surface *a, const SDL_Rect *b, SDL_Surface *c, const SDL_Rect *d),(a,b,c,d),return)
+SDL_DYNAPI_PROC(int,SDL_UpdateYUVTextureFrame,(SDL_Texture *a, const Uint8 *b, int c, const Uint8 *d, int e, const Uint8 *f, int g, SDL_YUVFrameReleaseCallback h, void *i),(a,b,c,d,e,f,g,h,i),return)
+SDL_DYNAPI_PROC(int,SDL_GetQueuedAudioStats,(SDL_AudioDeviceID a, SDL_AudioQueueStats *b),(a,b),return)
+SDL_DYNAPI_PROC(void,SDL_ResetQueuedAudioStats,(SDL_AudioDeviceID a),(a),)
+SDL_DYNAPI_PROC(SDL_RWops*,SDL_RWFromFileMapped,(const char *a),(a),return)
+SDL_DYNAPI_PROC(const void*,SDL_RWGetMemoryView,(SDL_RWops *a, size_t *b),(a,b),return)
+SDL_DYNAPI_PROC(SDL_RWops*,SDL_RWFromBuffered,(SDL_RWops *a, size_t b, SDL_bool c),(a,b,c),return)
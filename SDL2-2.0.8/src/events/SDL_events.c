@@ -74,6 +74,40 @@ typedef struct _SDL_SysWMEntry
     struct _SDL_SysWMEntry *next;
 } SDL_SysWMEntry;
 
+/* Lock-free event ring, used when SDL_HINT_EVENT_QUEUE_LOCKFREE is set.
+   Many threads can push without locking. The consumer side (SDL_PollEvent()
+   and draining into the locked queue) is serialized by a spinlock. Pushed
+   events always go through the ring, and events only move from the ring to
+   the end of the locked queue, so events from any one thread always come
+   out in the order they went in.
+   The number of entries must be a power of 2.
+ */
+#define SDL_EVENT_RING_ENTRIES  4096
+#define SDL_EVENT_RING_MASK     (SDL_EVENT_RING_ENTRIES-1)
+
+typedef struct
+{
+    SDL_atomic_t sequence;
+    SDL_Event event;
+} SDL_EventRingEntry;
+
+typedef struct
+{
+    SDL_EventRingEntry entries[SDL_EVENT_RING_ENTRIES];
+
+    char cache_pad1[SDL_CACHELINE_SIZE];
+
+    SDL_atomic_t enqueue_pos;
+
+    char cache_pad2[SDL_CACHELINE_SIZE-sizeof(SDL_atomic_t)];
+
+    SDL_atomic_t dequeue_pos;
+
+    char cache_pad3[SDL_CACHELINE_SIZE-sizeof(SDL_atomic_t)];
+
+    SDL_SpinLock consumer_lock;
+} SDL_EventRing;
+
 static struct
 {
     SDL_mutex *lock;
@@ -85,7 +119,8 @@ static struct
     SDL_EventEntry *free;
     SDL_SysWMEntry *wmmsg_used;
     SDL_SysWMEntry *wmmsg_free;
-} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
+    SDL_EventRing *ring;
+} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL, NULL };
 
 
 #ifdef SDL_DEBUG_EVENTS
@@ -354,6 +389,10 @@ SDL_StopEventLoop(void)
         SDL_free(wmmsg);
         wmmsg = next;
     }
+    if (SDL_EventQ.ring) {
+        SDL_free(SDL_EventQ.ring);
+        SDL_EventQ.ring = NULL;
+    }
 
     SDL_AtomicSet(&SDL_EventQ.count, 0);
     SDL_EventQ.max_events_seen = 0;
@@ -412,6 +451,21 @@ SDL_StartEventLoop(void)
             return -1;
         }
     }
+
+    if (!SDL_EventQ.ring && SDL_GetHintBoolean(SDL_HINT_EVENT_QUEUE_LOCKFREE, SDL_FALSE)) {
+        SDL_EventRing *ring = (SDL_EventRing *)SDL_malloc(sizeof(*ring));
+        if (ring) {
+            int i;
+            for (i = 0; i < SDL_EVENT_RING_ENTRIES; ++i) {
+                SDL_AtomicSet(&ring->entries[i].sequence, i);
+            }
+            SDL_AtomicSet(&ring->enqueue_pos, 0);
+            SDL_AtomicSet(&ring->dequeue_pos, 0);
+            ring->consumer_lock = 0;
+            SDL_EventQ.ring = ring;
+        }
+        /* Otherwise we just keep using the locked queue */
+    }
 #endif /* !SDL_THREADS_DISABLED */
 
     /* Process most event types */
@@ -425,6 +479,144 @@ SDL_StartEventLoop(void)
 }
 
 
+/* Add an event to the lock-free ring, returns 1 if it was added, 0 if the
+   ring is full, or -1 if the ring and the locked queue together are full */
+static int
+SDL_EnqueueRingEvent(SDL_EventRing *ring, const SDL_Event *event)
+{
+    SDL_EventRingEntry *entry;
+    unsigned queue_pos;
+    unsigned entry_seq;
+    int delta;
+
+    queue_pos = (unsigned)SDL_AtomicGet(&ring->enqueue_pos);
+    for ( ; ; ) {
+        entry = &ring->entries[queue_pos & SDL_EVENT_RING_MASK];
+        entry_seq = (unsigned)SDL_AtomicGet(&entry->sequence);
+
+        delta = (int)(entry_seq - queue_pos);
+        if (delta == 0) {
+            const int pending = (int)(queue_pos - (unsigned)SDL_AtomicGet(&ring->dequeue_pos));
+            if (SDL_AtomicGet(&SDL_EventQ.count) + pending >= SDL_MAX_QUEUED_EVENTS) {
+                return -1;
+            }
+
+            /* The entry and the queue position match, try to claim it */
+            if (SDL_AtomicCAS(&ring->enqueue_pos, (int)queue_pos, (int)(queue_pos+1))) {
+                #ifdef SDL_DEBUG_EVENTS
+                SDL_DebugPrintEvent(event);
+                #endif
+                entry->event = *event;
+                SDL_MemoryBarrierRelease();
+                SDL_AtomicSet(&entry->sequence, (int)(queue_pos+1));
+                return 1;
+            }
+        } else if (delta < 0) {
+            /* We ran into an entry that still needs to be dequeued */
+            return 0;
+        } else {
+            /* Another thread got here first, get the new queue position */
+            queue_pos = (unsigned)SDL_AtomicGet(&ring->enqueue_pos);
+        }
+    }
+}
+
+/* Take the oldest event out of the lock-free ring, returns SDL_FALSE if the ring is empty.
+   If 'wait' is set, wait for entries that have been claimed but not filled in yet,
+   otherwise treat them as the end of the ring.
+   -- called with the ring consumer lock held */
+static SDL_bool
+SDL_DequeueRingEvent(SDL_EventRing *ring, SDL_Event *event, SDL_bool wait)
+{
+    SDL_EventRingEntry *entry;
+    unsigned queue_pos;
+    unsigned entry_seq;
+    int delta;
+
+    queue_pos = (unsigned)SDL_AtomicGet(&ring->dequeue_pos);
+    for ( ; ; ) {
+        entry = &ring->entries[queue_pos & SDL_EVENT_RING_MASK];
+        entry_seq = (unsigned)SDL_AtomicGet(&entry->sequence);
+
+        delta = (int)(entry_seq - (queue_pos+1));
+        if (delta == 0) {
+            /* The entry and the queue position match, try to claim it */
+            if (SDL_AtomicCAS(&ring->dequeue_pos, (int)queue_pos, (int)(queue_pos+1))) {
+                SDL_MemoryBarrierAcquire();
+                *event = entry->event;
+                SDL_MemoryBarrierRelease();
+                SDL_AtomicSet(&entry->sequence, (int)(queue_pos+SDL_EVENT_RING_ENTRIES));
+                return SDL_TRUE;
+            }
+        } else if (delta < 0) {
+            if (!wait || (unsigned)SDL_AtomicGet(&ring->enqueue_pos) == queue_pos) {
+                /* We ran into an old entry, which means the ring is empty */
+                return SDL_FALSE;
+            }
+            /* A producer has claimed the entry and is still writing it */
+            SDL_Delay(0);
+        } else {
+            /* Another thread got here first, get the new queue position */
+            queue_pos = (unsigned)SDL_AtomicGet(&ring->dequeue_pos);
+        }
+    }
+}
+
+static int SDL_AddEvent(SDL_Event * event);
+
+/* Move everything in the lock-free ring to the end of the event queue, so
+   range queries see the events in order -- called with the queue locked */
+static void
+SDL_DrainEventRing(void)
+{
+    SDL_EventRing *ring = SDL_EventQ.ring;
+    SDL_Event event;
+
+    if (!ring) {
+        return;
+    }
+    SDL_AtomicLock(&ring->consumer_lock);
+    /* Leave the rest in the ring if the queue fills up, so nothing is dropped */
+    while (SDL_AtomicGet(&SDL_EventQ.count) < SDL_MAX_QUEUED_EVENTS &&
+           SDL_DequeueRingEvent(ring, &event, SDL_TRUE)) {
+        SDL_AddEvent(&event);
+    }
+    SDL_AtomicUnlock(&ring->consumer_lock);
+}
+
+/* Push an event through the lock-free ring. If the ring is full, move its
+   events to the locked queue and try again rather than putting this one in
+   the locked queue ahead of them. Returns 1, or -1 if the queue is full. */
+static int
+SDL_PushRingEvent(SDL_EventRing *ring, const SDL_Event *event)
+{
+    for ( ; ; ) {
+        int count;
+        const int status = SDL_EnqueueRingEvent(ring, event);
+        if (status > 0) {
+            return 1;
+        }
+        if (status < 0) {
+            return SDL_SetError("Event queue is full");
+        }
+
+        if (SDL_EventQ.lock && SDL_LockMutex(SDL_EventQ.lock) < 0) {
+            return SDL_SetError("Couldn't lock event queue");
+        }
+        count = SDL_AtomicGet(&SDL_EventQ.count);
+        SDL_DrainEventRing();
+        if (SDL_AtomicGet(&SDL_EventQ.count) == count) {
+            count = -1;  /* The locked queue is full too */
+        }
+        if (SDL_EventQ.lock) {
+            SDL_UnlockMutex(SDL_EventQ.lock);
+        }
+        if (count < 0) {
+            return SDL_SetError("Event queue is full");
+        }
+    }
+}
+
 /* Add an event to the event queue -- called with the queue locked */
 static int
 SDL_AddEvent(SDL_Event * event)
@@ -505,10 +697,12 @@ SDL_CutEvent(SDL_EventEntry *entry)
     SDL_AtomicAdd(&SDL_EventQ.count, -1);
 }
 
-/* Lock the event queue, take a peep at it, and unlock it */
-int
-SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
-               Uint32 minType, Uint32 maxType)
+/* Lock the event queue, take a peep at it, and unlock it.
+   'drain' can be cleared to leave the lock-free ring alone when only the
+   oldest event is wanted, everything in the locked queue is older. */
+static int
+SDL_PeepEventsInternal(SDL_Event * events, int numevents, SDL_eventaction action,
+                       Uint32 minType, Uint32 maxType, SDL_bool drain)
 {
     int i, used;
 
@@ -523,6 +717,11 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
     /* Lock the event queue */
     used = 0;
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
+        /* Older events may still be sitting in the lock-free ring */
+        if (drain || action == SDL_ADDEVENT) {
+            SDL_DrainEventRing();
+        }
+
         if (action == SDL_ADDEVENT) {
             for (i = 0; i < numevents; ++i) {
                 used += SDL_AddEvent(&events[i]);
@@ -584,6 +783,13 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
     return (used);
 }
 
+int
+SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
+               Uint32 minType, Uint32 maxType)
+{
+    return SDL_PeepEventsInternal(events, numevents, action, minType, maxType, SDL_TRUE);
+}
+
 SDL_bool
 SDL_HasEvent(Uint32 type)
 {
@@ -622,6 +828,8 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
         Uint32 type;
+
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             type = entry->event.type;
@@ -655,6 +863,36 @@ SDL_PumpEvents(void)
     SDL_SendPendingQuit();  /* in case we had a signal handler fire, etc. */
 }
 
+/* Get the oldest event, avoiding the queue lock when possible */
+static int
+SDL_GetNextEvent(SDL_Event * event)
+{
+    SDL_EventRing *ring = SDL_EventQ.ring;
+
+    if (event && ring && SDL_AtomicGet(&SDL_EventQ.active)) {
+        int status = -1;
+
+        if (SDL_AtomicGet(&SDL_EventQ.count) == 0) {
+            SDL_AtomicLock(&ring->consumer_lock);
+            if (SDL_AtomicGet(&SDL_EventQ.count) == 0) {
+                /* Nothing older is waiting in the locked queue */
+                status = SDL_DequeueRingEvent(ring, event, SDL_FALSE) ? 1 : 0;
+            }
+            SDL_AtomicUnlock(&ring->consumer_lock);
+            if (status >= 0) {
+                return status;
+            }
+        }
+
+        /* The head of the locked queue is older than anything in the ring */
+        status = SDL_PeepEventsInternal(event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT, SDL_FALSE);
+        if (status != 0) {
+            return status;
+        }
+    }
+    return SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
 /* Public functions */
 
 int
@@ -663,6 +901,19 @@ SDL_PollEvent(SDL_Event * event)
     return SDL_WaitEventTimeout(event, 0);
 }
 
+int
+SDL_PollEvents(SDL_Event * events, int maxevents)
+{
+    if (!events || maxevents <= 0) {
+        return SDL_InvalidParamError(!events ? "events" : "maxevents");
+    }
+
+    SDL_PumpEvents();
+
+    /* One lock for the whole batch, this also picks up the lock-free ring */
+    return SDL_PeepEvents(events, maxevents, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
 int
 SDL_WaitEvent(SDL_Event * event)
 {
@@ -679,7 +930,7 @@ SDL_WaitEventTimeout(SDL_Event * event, int timeout)
 
     for (;;) {
         SDL_PumpEvents();
-        switch (SDL_PeepEvents(event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT)) {
+        switch (SDL_GetNextEvent(event)) {
         case -1:
             return 0;
         case 0:
@@ -748,7 +999,12 @@ SDL_PushEvent(SDL_Event * event)
         }
     }
 
-    if (SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0, 0) <= 0) {
+    if (SDL_EventQ.ring && event->type != SDL_SYSWMEVENT &&
+        SDL_AtomicGet(&SDL_EventQ.active)) {
+        if (SDL_PushRingEvent(SDL_EventQ.ring, event) < 0) {
+            return -1;
+        }
+    } else if (SDL_PeepEvents(event, 1, SDL_ADDEVENT, 0, 0) <= 0) {
         return -1;
     }
 
@@ -852,6 +1108,8 @@ SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
         SDL_EventEntry *entry, *next;
+
+        SDL_DrainEventRing();
         for (entry = SDL_EventQ.head; entry; entry = next) {
             next = entry->next;
             if (!filter(userdata, &entry->event)) {
@@ -40,6 +40,17 @@
 #include <limits.h>
 #endif
 
+#if defined(__LINUX__) || defined(__FREEBSD__) || defined(__NETBSD__) || defined(__OPENBSD__)
+#define HAVE_MMAP_RWOPS 1
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(__WIN32__)
+#define HAVE_MMAP_RWOPS 1
+#endif
+
 /* This file provides a general interface for SDL to read and write
    data sources.  It can easily be extended to files, memory, etc.
 */
@@ -505,6 +516,307 @@ mem_close(SDL_RWops * context)
     return 0;
 }
 
+#ifdef HAVE_MMAP_RWOPS
+/* Functions for read-only files mapped into memory.  They read like
+   const memory. */
+
+static int SDLCALL
+mapped_close(SDL_RWops * context)
+{
+    if (context) {
+#ifdef __WIN32__
+        UnmapViewOfFile(context->hidden.mem.base);
+#else
+        munmap(context->hidden.mem.base, (size_t)(context->hidden.mem.stop - context->hidden.mem.base));
+#endif
+        SDL_FreeRW(context);
+    }
+    return 0;
+}
+
+/* Map a whole file for reading, returns -1 if it can't be mapped.
+   Empty files can't be, so they give a NULL *base and a *size of 0. */
+static int
+map_file(const char *file, void **base, size_t *size)
+{
+#ifdef __WIN32__
+    UINT old_error_mode;
+    LPTSTR tstr;
+    HANDLE h, mapping;
+    LARGE_INTEGER filesize;
+
+    /* Do not open a dialog box if failure */
+    old_error_mode =
+        SetErrorMode(SEM_NOOPENFILEERRORBOX | SEM_FAILCRITICALERRORS);
+    tstr = WIN_UTF8ToString(file);
+    h = CreateFile(tstr, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                   FILE_ATTRIBUTE_NORMAL, NULL);
+    SDL_free(tstr);
+    SetErrorMode(old_error_mode);
+
+    if (h == INVALID_HANDLE_VALUE) {
+        return SDL_SetError("Couldn't open %s", file);
+    }
+    if (GetFileType(h) != FILE_TYPE_DISK || !GetFileSizeEx(h, &filesize)) {
+        CloseHandle(h);
+        return SDL_SetError("%s can't be mapped", file);
+    }
+    if ((Uint64)filesize.QuadPart > (Uint64)((size_t)-1 / 2)) {
+        CloseHandle(h);
+        return SDL_SetError("%s is too large to map", file);
+    }
+    *base = NULL;
+    *size = (size_t)filesize.QuadPart;
+    if (*size == 0) {
+        CloseHandle(h);
+        return 0;
+    }
+    /* The view keeps the file open until it's unmapped */
+    mapping = CreateFileMapping(h, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping) {
+        *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(h);
+    if (!*base) {
+        return WIN_SetError("MapViewOfFile()");
+    }
+#else
+    struct stat st;
+    int fd;
+
+    fd = open(file, O_RDONLY);
+    if (fd < 0) {
+        return SDL_SetError("Couldn't open %s", file);
+    }
+    /* Pipes and devices have no size to map */
+    if (fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return SDL_SetError("%s can't be mapped", file);
+    }
+    if ((Uint64)st.st_size > (Uint64)((size_t)-1 / 2)) {
+        close(fd);
+        return SDL_SetError("%s is too large to map", file);
+    }
+    *base = NULL;
+    *size = (size_t)st.st_size;
+    if (*size == 0) {
+        close(fd);
+        return 0;
+    }
+    *base = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (*base == MAP_FAILED) {
+        *base = NULL;
+        return SDL_SetError("Couldn't map %s", file);
+    }
+#endif
+    return 0;
+}
+#endif /* HAVE_MMAP_RWOPS */
+
+
+/* Functions to read another stream through a read-ahead buffer */
+
+typedef struct SDL_RWBuffer
+{
+    SDL_RWops *src;
+    SDL_bool autoclose;
+    Sint64 offset;              /* position in src of data[0] */
+    size_t here;                /* read position in data */
+    size_t stop;                /* amount of data read ahead */
+    size_t size;
+    Uint8 *data;
+} SDL_RWBuffer;
+
+#define RWBUFFER(context) ((SDL_RWBuffer *)(context)->hidden.unknown.data1)
+
+/* Drop the data read ahead, moving src back to the read position */
+static Sint64
+buffered_sync(SDL_RWBuffer * buffer)
+{
+    Sint64 pos = buffer->offset + (Sint64)buffer->here;
+
+    if (buffer->here != buffer->stop) {
+        if (SDL_RWseek(buffer->src, pos, RW_SEEK_SET) < 0) {
+            return -1;
+        }
+    }
+    buffer->offset = pos;
+    buffer->here = buffer->stop = 0;
+    return pos;
+}
+
+static Sint64 SDLCALL
+buffered_size(SDL_RWops * context)
+{
+    return SDL_RWsize(RWBUFFER(context)->src);
+}
+
+static Sint64 SDLCALL
+buffered_seek(SDL_RWops * context, Sint64 offset, int whence)
+{
+    SDL_RWBuffer *buffer = RWBUFFER(context);
+    Sint64 pos;
+
+    switch (whence) {
+    case RW_SEEK_SET:
+        pos = offset;
+        break;
+    case RW_SEEK_CUR:
+        pos = buffer->offset + (Sint64)buffer->here + offset;
+        break;
+    case RW_SEEK_END:
+        pos = SDL_RWseek(buffer->src, offset, RW_SEEK_END);
+        if (pos >= 0) {
+            buffer->offset = pos;
+            buffer->here = buffer->stop = 0;
+        }
+        return pos;
+    default:
+        return SDL_SetError("Unknown value for 'whence'");
+    }
+
+    /* Seeking within the data read ahead doesn't need src */
+    if (pos >= buffer->offset && pos <= buffer->offset + (Sint64)buffer->stop) {
+        buffer->here = (size_t)(pos - buffer->offset);
+        return pos;
+    }
+    pos = SDL_RWseek(buffer->src, pos, RW_SEEK_SET);
+    if (pos >= 0) {
+        buffer->offset = pos;
+        buffer->here = buffer->stop = 0;
+    }
+    return pos;
+}
+
+static size_t SDLCALL
+buffered_read(SDL_RWops * context, void *ptr, size_t size, size_t maxnum)
+{
+    SDL_RWBuffer *buffer = RWBUFFER(context);
+    Uint8 *dst = (Uint8 *) ptr;
+    size_t total_bytes;
+    size_t left, amount;
+
+    total_bytes = (maxnum * size);
+    if ((maxnum <= 0) || (size <= 0)
+        || ((total_bytes / maxnum) != (size_t) size)) {
+        return 0;
+    }
+
+    left = total_bytes;
+    while (left > 0) {
+        amount = buffer->stop - buffer->here;
+        if (amount == 0) {
+            buffer->offset += (Sint64)buffer->stop;
+            buffer->here = buffer->stop = 0;
+            if (left >= buffer->size) {
+                /* Large reads go straight to the caller */
+                amount = SDL_RWread(buffer->src, dst, 1, left);
+                buffer->offset += (Sint64)amount;
+            } else {
+                buffer->stop = SDL_RWread(buffer->src, buffer->data, 1, buffer->size);
+                amount = SDL_min(buffer->stop, left);
+                SDL_memcpy(dst, buffer->data, amount);
+                buffer->here = amount;
+            }
+            if (amount == 0) {
+                break;
+            }
+        } else {
+            if (amount > left) {
+                amount = left;
+            }
+            SDL_memcpy(dst, &buffer->data[buffer->here], amount);
+            buffer->here += amount;
+        }
+        dst += amount;
+        left -= amount;
+    }
+    return ((total_bytes - left) / size);
+}
+
+static size_t SDLCALL
+buffered_write(SDL_RWops * context, const void *ptr, size_t size, size_t num)
+{
+    SDL_RWBuffer *buffer = RWBUFFER(context);
+    Sint64 pos;
+
+    if (buffered_sync(buffer) < 0) {
+        return 0;
+    }
+    num = SDL_RWwrite(buffer->src, ptr, size, num);
+    pos = SDL_RWtell(buffer->src);
+    buffer->offset = (pos >= 0) ? pos : buffer->offset + (Sint64)(num * size);
+    return num;
+}
+
+static int SDLCALL
+buffered_close(SDL_RWops * context)
+{
+    int status = 0;
+
+    if (context) {
+        SDL_RWBuffer *buffer = RWBUFFER(context);
+        if (buffer->autoclose) {
+            status = SDL_RWclose(buffer->src);
+        } else {
+            /* Leave src where reading stopped, for whoever reads it next */
+            buffered_sync(buffer);
+        }
+        SDL_free(buffer);
+        SDL_FreeRW(context);
+    }
+    return status;
+}
+
+/* Memory streams don't need a buffer, they get a second view of the same
+   memory instead, which hands its position back to src when closed */
+typedef struct SDL_RWMemoryView
+{
+    SDL_RWops rwops;
+    SDL_RWops *src;
+    SDL_bool autoclose;
+} SDL_RWMemoryView;
+
+static int SDLCALL
+memview_close(SDL_RWops * context)
+{
+    int status = 0;
+
+    if (context) {
+        SDL_RWMemoryView *view = (SDL_RWMemoryView *) context;
+        if (view->autoclose) {
+            status = SDL_RWclose(view->src);
+        } else {
+            view->src->hidden.mem.here = context->hidden.mem.here;
+        }
+        SDL_FreeRW(context);
+    }
+    return status;
+}
+
+/* Reads a few bytes from memory or from the data read ahead without an
+   indirect call, for the endian-specific readers */
+static SDL_INLINE size_t
+read_small(SDL_RWops * src, void *ptr, size_t size)
+{
+    if (src->read == buffered_read) {
+        SDL_RWBuffer *buffer = RWBUFFER(src);
+        if (buffer->stop - buffer->here >= size) {
+            SDL_memcpy(ptr, &buffer->data[buffer->here], size);
+            buffer->here += size;
+            return 1;
+        }
+    } else if (src->read == mem_read) {
+        if ((size_t)(src->hidden.mem.stop - src->hidden.mem.here) >= size) {
+            SDL_memcpy(ptr, src->hidden.mem.here, size);
+            src->hidden.mem.here += size;
+            return 1;
+        }
+    }
+    return SDL_RWread(src, ptr, size, 1);
+}
 
 /* Functions to create SDL_RWops structures from various data sources */
 
@@ -681,6 +993,106 @@ SDL_RWFromConstMem(const void *mem, int size)
     return rwops;
 }
 
+SDL_RWops *
+SDL_RWFromFileMapped(const char *file)
+{
+#ifdef HAVE_MMAP_RWOPS
+    static Uint8 empty[1];
+    SDL_RWops *rwops;
+    void *data = NULL;
+    size_t size = 0;
+#endif
+
+    if (!file || !*file) {
+        SDL_SetError("SDL_RWFromFileMapped(): No file specified");
+        return NULL;
+    }
+
+#ifdef HAVE_MMAP_RWOPS
+    rwops = SDL_AllocRW();
+    if (!rwops) {
+        return NULL;
+    }
+    if (map_file(file, &data, &size) == 0) {
+        rwops->size = mem_size;
+        rwops->seek = mem_seek;
+        rwops->read = mem_read;
+        rwops->write = mem_writeconst;
+        rwops->close = data ? mapped_close : mem_close;
+        rwops->type = SDL_RWOPS_MAPPED;
+        rwops->hidden.mem.base = data ? (Uint8 *) data : empty;
+        rwops->hidden.mem.here = rwops->hidden.mem.base;
+        rwops->hidden.mem.stop = rwops->hidden.mem.base + size;
+        return rwops;
+    }
+    SDL_FreeRW(rwops);
+#endif
+
+    /* Not mappable here (e.g. Android assets or pipes), so stream it */
+    return SDL_RWFromFile(file, "rb");
+}
+
+SDL_RWops *
+SDL_RWFromBuffered(SDL_RWops * src, size_t size, SDL_bool autoclose)
+{
+    SDL_RWops *rwops;
+    SDL_RWBuffer *buffer;
+    Sint64 offset;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+    if (!size) {
+        SDL_InvalidParamError("size");
+        return NULL;
+    }
+
+    if (src->read == mem_read) {
+        SDL_RWMemoryView *view = (SDL_RWMemoryView *) SDL_malloc(sizeof (*view));
+        if (!view) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        view->rwops = *src;
+        view->rwops.close = memview_close;
+        view->src = src;
+        view->autoclose = autoclose;
+        return &view->rwops;
+    }
+
+    buffer = (SDL_RWBuffer *) SDL_malloc(sizeof (*buffer) + size);
+    if (!buffer) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    rwops = SDL_AllocRW();
+    if (!rwops) {
+        SDL_free(buffer);
+        return NULL;
+    }
+
+    /* Streams that can't tell their position can still be read */
+    offset = SDL_RWtell(src);
+    buffer->src = src;
+    buffer->autoclose = autoclose;
+    buffer->offset = (offset >= 0) ? offset : 0;
+    buffer->here = 0;
+    buffer->stop = 0;
+    buffer->size = size;
+    buffer->data = (Uint8 *) (buffer + 1);
+
+    rwops->size = buffered_size;
+    rwops->seek = buffered_seek;
+    rwops->read = buffered_read;
+    rwops->write = buffered_write;
+    rwops->close = buffered_close;
+    rwops->hidden.unknown.data1 = buffer;
+    rwops->hidden.unknown.data2 = NULL;
+    rwops->type = SDL_RWOPS_BUFFERED;
+    return rwops;
+}
+
 SDL_RWops *
 SDL_AllocRW(void)
 {
@@ -715,6 +1127,23 @@ SDL_LoadFile_RW(SDL_RWops * src, size_t *datasize, int freesrc)
         return NULL;
     }
 
+    /* Memory streams can be copied out in one go */
+    if (src->read == mem_read) {
+        size_total = (size_t)(src->hidden.mem.stop - src->hidden.mem.here);
+        data = SDL_malloc(size_total + 1);
+        if (!data) {
+            SDL_OutOfMemory();
+            goto done;
+        }
+        SDL_memcpy(data, src->hidden.mem.here, size_total);
+        src->hidden.mem.here += size_total;
+        if (datasize) {
+            *datasize = size_total;
+        }
+        ((char *)data)[size_total] = '\0';
+        goto done;
+    }
+
     size = SDL_RWsize(src);
     if (size < 0) {
         size = FILE_CHUNK_SIZE;
@@ -754,6 +1183,23 @@ done:
     return data;
 }
 
+const void *
+SDL_RWGetMemoryView(SDL_RWops * context, size_t *size)
+{
+    if (!context) {
+        SDL_InvalidParamError("context");
+        return NULL;
+    }
+    if (context->read != mem_read) {
+        SDL_SetError("Stream isn't backed by memory");
+        return NULL;
+    }
+    if (size) {
+        *size = (size_t)(context->hidden.mem.stop - context->hidden.mem.here);
+    }
+    return context->hidden.mem.here;
+}
+
 /* Functions for dynamically reading and writing endian-specific values */
 
 Uint8
@@ -761,7 +1207,7 @@ SDL_ReadU8(SDL_RWops * src)
 {
     Uint8 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return value;
 }
 
@@ -770,7 +1216,7 @@ SDL_ReadLE16(SDL_RWops * src)
 {
     Uint16 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return SDL_SwapLE16(value);
 }
 
@@ -779,7 +1225,7 @@ SDL_ReadBE16(SDL_RWops * src)
 {
     Uint16 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return SDL_SwapBE16(value);
 }
 
@@ -788,7 +1234,7 @@ SDL_ReadLE32(SDL_RWops * src)
 {
     Uint32 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return SDL_SwapLE32(value);
 }
 
@@ -797,7 +1243,7 @@ SDL_ReadBE32(SDL_RWops * src)
 {
     Uint32 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return SDL_SwapBE32(value);
 }
 
@@ -806,7 +1252,7 @@ SDL_ReadLE64(SDL_RWops * src)
 {
     Uint64 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return SDL_SwapLE64(value);
 }
 
@@ -815,7 +1261,7 @@ SDL_ReadBE64(SDL_RWops * src)
 {
     Uint64 value = 0;
 
-    SDL_RWread(src, &value, sizeof (value), 1);
+    read_small(src, &value, sizeof (value));
     return SDL_SwapBE64(value);
 }
 
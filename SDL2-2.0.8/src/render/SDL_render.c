@@ -28,6 +28,7 @@
 #include "SDL_render.h"
 #include "SDL_sysrender.h"
 #include "software/SDL_render_sw_c.h"
+#include "../video/SDL_yuv_c.h"
 
 
 #define SDL_WINDOWRENDERDATA    "_SDL_WindowRenderData"
@@ -805,6 +806,55 @@ SDL_GetTextureBlendMode(SDL_Texture * texture, SDL_BlendMode *blendMode)
     return 0;
 }
 
+static SDL_bool
+IsNVFormat(Uint32 format)
+{
+    return (format == SDL_PIXELFORMAT_NV12 || format == SDL_PIXELFORMAT_NV21);
+}
+
+static void
+SDL_ReleaseYUVFrame(SDL_YUVFrame * frame)
+{
+    SDL_YUVFrameReleaseCallback release = frame->release;
+    void *userdata = frame->userdata;
+
+    SDL_zerop(frame);
+    if (release) {
+        release(userdata);
+    }
+}
+
+/* Copies a frame held by the texture into the YUV staging buffer, so the
+   texture can be partially updated or locked again */
+static int
+SDL_FlushTextureFrame(SDL_Texture * texture)
+{
+    SDL_YUVFrame *frame = &texture->frame;
+    SDL_Rect rect;
+    int retval;
+
+    if (!frame->planes[0]) {
+        return 0;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = texture->w;
+    rect.h = texture->h;
+    if (IsNVFormat(texture->format)) {
+        retval = SDL_SW_UpdateNVTexturePlanar(texture->yuv, &rect,
+                                              frame->planes[0], frame->pitches[0],
+                                              frame->planes[1], frame->pitches[1]);
+    } else {
+        retval = SDL_SW_UpdateYUVTexturePlanar(texture->yuv, &rect,
+                                               frame->planes[0], frame->pitches[0],
+                                               frame->planes[1], frame->pitches[1],
+                                               frame->planes[2], frame->pitches[2]);
+    }
+    SDL_ReleaseYUVFrame(frame);
+    return retval;
+}
+
 static int
 SDL_UpdateTextureYUV(SDL_Texture * texture, const SDL_Rect * rect,
                      const void *pixels, int pitch)
@@ -812,6 +862,9 @@ SDL_UpdateTextureYUV(SDL_Texture * texture, const SDL_Rect * rect,
     SDL_Texture *native = texture->native;
     SDL_Rect full_rect;
 
+    if (SDL_FlushTextureFrame(texture) < 0) {
+        return -1;
+    }
     if (SDL_SW_UpdateYUVTexture(texture->yuv, rect, pixels, pitch) < 0) {
         return -1;
     }
@@ -937,6 +990,9 @@ SDL_UpdateTextureYUVPlanar(SDL_Texture * texture, const SDL_Rect * rect,
     SDL_Texture *native = texture->native;
     SDL_Rect full_rect;
 
+    if (SDL_FlushTextureFrame(texture) < 0) {
+        return -1;
+    }
     if (SDL_SW_UpdateYUVTexturePlanar(texture->yuv, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch) < 0) {
         return -1;
     }
@@ -1040,10 +1096,199 @@ int SDL_UpdateYUVTexture(SDL_Texture * texture, const SDL_Rect * rect,
     }
 }
 
+/* Converts a frame straight into the native texture */
+static int
+SDL_UpdateTextureYUVFrame(SDL_Texture * texture, const SDL_YUVFrame * frame)
+{
+    SDL_Texture *native = texture->native;
+    const Uint8 *u, *v;
+    SDL_Rect rect;
+    int retval;
+
+    switch (texture->format) {
+    case SDL_PIXELFORMAT_NV12:
+        u = frame->planes[1];
+        v = u + 1;
+        break;
+    case SDL_PIXELFORMAT_NV21:
+        v = frame->planes[1];
+        u = v + 1;
+        break;
+    default:
+        u = frame->planes[1];
+        v = frame->planes[2];
+        break;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = texture->w;
+    rect.h = texture->h;
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        /* We can lock the texture and convert into it */
+        void *native_pixels = NULL;
+        int native_pitch = 0;
+
+        if (SDL_LockTexture(native, &rect, &native_pixels, &native_pitch) < 0) {
+            return -1;
+        }
+        retval = SDL_ConvertPixels_YUVPlanes_to_RGB(rect.w, rect.h, texture->format,
+                                                    frame->planes[0], u, v,
+                                                    frame->pitches[0], frame->pitches[1],
+                                                    native->format, native_pixels, native_pitch);
+        SDL_UnlockTexture(native);
+    } else {
+        /* Use a temporary buffer for updating */
+        const int temp_pitch = (((rect.w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
+        void *temp_pixels = SDL_malloc(rect.h * temp_pitch);
+        if (!temp_pixels) {
+            return SDL_OutOfMemory();
+        }
+        retval = SDL_ConvertPixels_YUVPlanes_to_RGB(rect.w, rect.h, texture->format,
+                                                    frame->planes[0], u, v,
+                                                    frame->pitches[0], frame->pitches[1],
+                                                    native->format, temp_pixels, temp_pitch);
+        if (retval == 0) {
+            retval = SDL_UpdateTexture(native, &rect, temp_pixels, temp_pitch);
+        }
+        SDL_free(temp_pixels);
+    }
+    return retval;
+}
+
+/* For renderers that take NV12 and NV21 only as one block of memory */
+static int
+SDL_UpdateTextureNVPacked(SDL_Texture * texture, const SDL_Rect * rect,
+                          const Uint8 *Yplane, int Ypitch,
+                          const Uint8 *UVplane, int UVpitch)
+{
+    SDL_Renderer *renderer = texture->renderer;
+    const int pitch = rect->w;
+    const int uv_pitch = 2 * ((pitch + 1) / 2);
+    const int uv_rows = (rect->h + 1) / 2;
+    Uint8 *pixels, *dst;
+    int row, retval;
+
+    pixels = (Uint8 *) SDL_malloc(rect->h * pitch + uv_rows * uv_pitch);
+    if (!pixels) {
+        return SDL_OutOfMemory();
+    }
+    dst = pixels;
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, Yplane, pitch);
+        Yplane += Ypitch;
+        dst += pitch;
+    }
+    for (row = 0; row < uv_rows; ++row) {
+        SDL_memcpy(dst, UVplane, uv_pitch);
+        UVplane += UVpitch;
+        dst += uv_pitch;
+    }
+    retval = renderer->UpdateTexture(renderer, texture, rect, pixels, pitch);
+    SDL_free(pixels);
+    return retval;
+}
+
+int
+SDL_UpdateYUVTextureFrame(SDL_Texture * texture,
+                          const Uint8 *Yplane, int Ypitch,
+                          const Uint8 *Uplane, int Upitch,
+                          const Uint8 *Vplane, int Vpitch,
+                          SDL_YUVFrameReleaseCallback release, void *userdata)
+{
+    SDL_Renderer *renderer;
+    SDL_YUVFrame frame;
+    SDL_Rect rect;
+    SDL_bool nv;
+    int retval;
+
+    frame.planes[0] = Yplane;
+    frame.planes[1] = Uplane;
+    frame.planes[2] = Vplane;
+    frame.pitches[0] = Ypitch;
+    frame.pitches[1] = Upitch;
+    frame.pitches[2] = Vpitch;
+    frame.release = release;
+    frame.userdata = userdata;
+
+    SDL_assert(texture && texture->magic == &texture_magic);
+    if (!texture || texture->magic != &texture_magic) {
+        SDL_SetError("Invalid texture");
+        SDL_ReleaseYUVFrame(&frame);
+        return -1;
+    }
+
+    nv = IsNVFormat(texture->format);
+    if (!Yplane) {
+        retval = SDL_InvalidParamError("Yplane");
+    } else if (!Ypitch) {
+        retval = SDL_InvalidParamError("Ypitch");
+    } else if (!Uplane) {
+        retval = SDL_InvalidParamError("Uplane");
+    } else if (!Upitch) {
+        retval = SDL_InvalidParamError("Upitch");
+    } else if (!nv && !Vplane) {
+        retval = SDL_InvalidParamError("Vplane");
+    } else if (!nv && !Vpitch) {
+        retval = SDL_InvalidParamError("Vpitch");
+    } else if (!nv && texture->format != SDL_PIXELFORMAT_YV12 &&
+               texture->format != SDL_PIXELFORMAT_IYUV) {
+        retval = SDL_SetError("Texture format must be YV12, IYUV, NV12 or NV21");
+    } else {
+        retval = 0;
+    }
+    if (retval < 0) {
+        SDL_ReleaseYUVFrame(&frame);
+        return retval;
+    }
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = texture->w;
+    rect.h = texture->h;
+
+    if (texture->yuv) {
+        /* The whole texture is replaced, so the last frame isn't needed */
+        SDL_ReleaseYUVFrame(&texture->frame);
+
+        if (!nv && Upitch != Vpitch) {
+            /* The conversion steps through U and V together */
+            retval = SDL_UpdateTextureYUVPlanar(texture, &rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
+        } else {
+            retval = SDL_UpdateTextureYUVFrame(texture, &frame);
+            if (retval == 0) {
+                /* Keep the frame instead of the staging buffer up to date */
+                texture->frame = frame;
+                return 0;
+            }
+        }
+    } else {
+        renderer = texture->renderer;
+        if (!nv) {
+            SDL_assert(renderer->UpdateTextureYUV);
+            if (renderer->UpdateTextureYUV) {
+                retval = renderer->UpdateTextureYUV(renderer, texture, &rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
+            } else {
+                retval = SDL_Unsupported();
+            }
+        } else if (renderer->UpdateTextureNV) {
+            retval = renderer->UpdateTextureNV(renderer, texture, &rect, Yplane, Ypitch, Uplane, Upitch);
+        } else {
+            retval = SDL_UpdateTextureNVPacked(texture, &rect, Yplane, Ypitch, Uplane, Upitch);
+        }
+    }
+    SDL_ReleaseYUVFrame(&frame);
+    return retval;
+}
+
 static int
 SDL_LockTextureYUV(SDL_Texture * texture, const SDL_Rect * rect,
                    void **pixels, int *pitch)
 {
+    if (SDL_FlushTextureFrame(texture) < 0) {
+        return -1;
+    }
     return SDL_SW_LockYUVTexture(texture->yuv, rect, pixels, pitch);
 }
 
@@ -2063,6 +2308,7 @@ SDL_DestroyTexture(SDL_Texture * texture)
         SDL_DestroyTexture(texture->native);
     }
     if (texture->yuv) {
+        SDL_ReleaseYUVFrame(&texture->frame);
         SDL_SW_DestroyYUVTexture(texture->yuv);
     }
     SDL_free(texture->pixels);
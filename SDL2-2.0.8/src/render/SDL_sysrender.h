@@ -45,6 +45,15 @@ typedef struct
     float h;
 } SDL_FRect;
 
+/* Planes handed over by SDL_UpdateYUVTextureFrame() */
+typedef struct
+{
+    const Uint8 *planes[3];
+    int pitches[3];
+    SDL_YUVFrameReleaseCallback release;
+    void *userdata;
+} SDL_YUVFrame;
+
 /* Define the SDL texture structure */
 struct SDL_Texture
 {
@@ -66,6 +75,9 @@ struct SDL_Texture
     int pitch;
     SDL_Rect locked_rect;
 
+    /* A decoder frame shown through native, until the YUV data is needed */
+    SDL_YUVFrame frame;
+
     void *driverdata;           /**< Driver specific texture representation */
 
     SDL_Texture *prev;
@@ -95,6 +107,10 @@ struct SDL_Renderer
                             const Uint8 *Yplane, int Ypitch,
                             const Uint8 *Uplane, int Upitch,
                             const Uint8 *Vplane, int Vpitch);
+    int (*UpdateTextureNV) (SDL_Renderer * renderer, SDL_Texture * texture,
+                            const SDL_Rect * rect,
+                            const Uint8 *Yplane, int Ypitch,
+                            const Uint8 *UVplane, int UVpitch);
     int (*LockTexture) (SDL_Renderer * renderer, SDL_Texture * texture,
                         const SDL_Rect * rect, void **pixels, int *pitch);
     void (*UnlockTexture) (SDL_Renderer * renderer, SDL_Texture * texture);
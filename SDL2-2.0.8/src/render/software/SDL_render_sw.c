@@ -24,6 +24,7 @@
 
 #include "../SDL_sysrender.h"
 #include "SDL_render_sw_c.h"
+#include "SDL_atomic.h"
 #include "SDL_hints.h"
 
 #include "SDL_draw.h"
@@ -33,6 +34,7 @@
 #include "SDL_drawline.h"
 #include "SDL_drawpoint.h"
 #include "SDL_rotate.h"
+#include "../../video/SDL_blit.h"
 
 /* SDL surface based renderer implementation */
 
@@ -95,12 +97,69 @@ SDL_RenderDriver SW_RenderDriver = {
      0}
 };
 
+/* Drawing commands recorded for the window when dirty rectangles are on */
+typedef enum
+{
+    SW_CMD_CLEAR,
+    SW_CMD_DRAW_POINTS,
+    SW_CMD_DRAW_LINES,
+    SW_CMD_FILL_RECTS,
+    SW_CMD_COPY,
+    SW_CMD_COPY_EX
+} SW_CommandType;
+
+typedef struct
+{
+    SW_CommandType type;
+    Uint8 r, g, b, a;           /* the draw color, or the texture modulation */
+    SDL_BlendMode blendMode;    /* of the renderer, or of the texture */
+    SDL_Rect clip;              /* the surface clip rect for the command */
+    SDL_Rect bounds;            /* the pixels the command may touch */
+    SDL_bool exact;             /* draws the same pixels under any clip rect */
+    int first, count;           /* points or rects in the frame arrays */
+    SDL_Texture *texture;
+    Uint32 version;             /* of the texture contents */
+    SDL_Rect srcrect;
+    SDL_Rect dstrect;
+    double angle;
+    SDL_FPoint center;
+    SDL_RendererFlip flip;
+    int scale_quality;
+} SW_RenderCommand;
+
+typedef struct
+{
+    SW_RenderCommand *commands;
+    int num_commands;
+    int max_commands;
+    SDL_Point *points;
+    int num_points;
+    int max_points;
+    SDL_Rect *rects;
+    int num_rects;
+    int max_rects;
+    SDL_bool cleared;           /* the frame starts with SDL_RenderClear() */
+} SW_RenderFrame;
+
+/* More damaged areas than this get merged into their bounding box */
+#define SW_MAX_DIRTY_RECTS  16
+
 typedef struct
 {
     SDL_Surface *surface;
     SDL_Surface *window;
+    SDL_bool batching;          /* record the window's commands for dirty rects */
+    SDL_bool deferred;          /* the frame's commands haven't been drawn yet */
+    SDL_bool redraw;            /* the next frame has to be presented in full */
+    SW_RenderFrame frames[2];
+    SW_RenderFrame *frame;
+    SW_RenderFrame *last_frame;
 } SW_RenderData;
 
+static int SW_RunCommand(SDL_Surface * surface, const SW_RenderFrame * frame,
+                         const SW_RenderCommand * cmd, const SDL_Rect * damage);
+static void SW_FlushCommands(SDL_Renderer * renderer);
+
 
 static SDL_Surface *
 SW_ActivateRenderer(SDL_Renderer * renderer)
@@ -114,6 +173,7 @@ SW_ActivateRenderer(SDL_Renderer * renderer)
         SDL_Surface *surface = SDL_GetWindowSurface(renderer->window);
         if (surface) {
             data->surface = data->window = surface;
+            data->redraw = SDL_TRUE;
 
             SW_UpdateViewport(renderer);
             SW_UpdateClipRect(renderer);
@@ -122,6 +182,265 @@ SW_ActivateRenderer(SDL_Renderer * renderer)
     return data->surface;
 }
 
+static int
+GetScaleQuality(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+
+    if (!hint || *hint == '0' || SDL_strcasecmp(hint, "nearest") == 0) {
+        return 0;
+    } else {
+        return 1;
+    }
+}
+
+/* Recording the window's drawing commands.
+
+   With SDL_HINT_RENDER_SW_DIRTY_RECTS, every command drawn into the window
+   is recorded. When a frame starts by clearing the window and so did the
+   one before, the commands aren't drawn right away: at present time the two
+   frames are compared, and the commands are drawn again only inside the
+   areas touched by commands that differ. Anything that needs the window or
+   the textures the frame uses before then draws the held back commands as
+   they are. Frames that don't start with a clear are drawn immediately, and
+   the area touched by all their commands is presented.
+ */
+
+static SDL_atomic_t SW_texture_version;
+
+/* The texture surfaces are private to the renderer, so their userdata holds
+   a version that changes whenever the texture contents may have changed. */
+static void
+SW_TouchTexture(SDL_Texture * texture)
+{
+    SDL_Surface *surface = (SDL_Surface *) texture->driverdata;
+
+    surface->userdata = (void *)(uintptr_t)(Uint32)(SDL_AtomicAdd(&SW_texture_version, 1) + 1);
+}
+
+static SDL_bool
+SW_IsBatching(SDL_Renderer * renderer)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+
+    return (data->batching && data->surface && data->surface == data->window);
+}
+
+static void
+SW_ClipBounds(const SDL_Rect * rect, const SDL_Rect * clip, SDL_Rect * bounds)
+{
+    if (!SDL_IntersectRect(rect, clip, bounds)) {
+        SDL_zerop(bounds);
+    }
+}
+
+static SW_RenderCommand *
+SW_QueueCommand(SDL_Renderer * renderer, SW_CommandType type)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    SW_RenderFrame *frame = data->frame;
+    SW_RenderCommand *cmd;
+
+    if (frame->num_commands == frame->max_commands) {
+        int max_commands = frame->max_commands ? 2 * frame->max_commands : 64;
+        cmd = (SW_RenderCommand *) SDL_realloc(frame->commands, max_commands * sizeof(*cmd));
+        if (!cmd) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        frame->commands = cmd;
+        frame->max_commands = max_commands;
+    }
+
+    if (frame->num_commands == 0) {
+        /* Only frames that start from a cleared window can be compared */
+        frame->cleared = (type == SW_CMD_CLEAR);
+        data->deferred = (frame->cleared && !data->redraw && data->last_frame->cleared);
+    }
+
+    cmd = &frame->commands[frame->num_commands++];
+    SDL_zerop(cmd);
+    cmd->type = type;
+    cmd->r = renderer->r;
+    cmd->g = renderer->g;
+    cmd->b = renderer->b;
+    cmd->a = renderer->a;
+    cmd->blendMode = renderer->blendMode;
+    cmd->clip = data->surface->clip_rect;
+    return cmd;
+}
+
+static int
+SW_SubmitCommand(SDL_Renderer * renderer, const SW_RenderCommand * cmd)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+
+    if (data->deferred) {
+        return 0;
+    }
+    return SW_RunCommand(data->surface, data->frame, cmd, NULL);
+}
+
+static int
+SW_QueueClear(SDL_Renderer * renderer)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    SW_RenderCommand *cmd = SW_QueueCommand(renderer, SW_CMD_CLEAR);
+
+    if (!cmd) {
+        return -1;
+    }
+    cmd->bounds.w = data->surface->w;
+    cmd->bounds.h = data->surface->h;
+    cmd->exact = SDL_TRUE;
+    return SW_SubmitCommand(renderer, cmd);
+}
+
+static int
+SW_QueuePoints(SDL_Renderer * renderer, SW_CommandType type,
+               const SDL_Point * points, int count)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    SW_RenderFrame *frame = data->frame;
+    SW_RenderCommand *cmd;
+    SDL_Rect bounds;
+
+    if (frame->num_points + count > frame->max_points) {
+        int max_points = SDL_max(2 * frame->max_points, frame->num_points + count);
+        SDL_Point *new_points = (SDL_Point *) SDL_realloc(frame->points, max_points * sizeof(*new_points));
+        if (!new_points) {
+            return SDL_OutOfMemory();
+        }
+        frame->points = new_points;
+        frame->max_points = max_points;
+    }
+
+    cmd = SW_QueueCommand(renderer, type);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->first = frame->num_points;
+    cmd->count = count;
+    SDL_memcpy(&frame->points[cmd->first], points, count * sizeof(*points));
+    frame->num_points += count;
+
+    SDL_zero(bounds);
+    SDL_EnclosePoints(points, count, NULL, &bounds);
+    SW_ClipBounds(&bounds, &cmd->clip, &cmd->bounds);
+
+    /* Lines get clipped with rounding, so a different clip rect may move
+       their pixels */
+    cmd->exact = (type == SW_CMD_DRAW_POINTS);
+    return SW_SubmitCommand(renderer, cmd);
+}
+
+static int
+SW_QueueFillRects(SDL_Renderer * renderer, const SDL_Rect * rects, int count)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    SW_RenderFrame *frame = data->frame;
+    SW_RenderCommand *cmd;
+    SDL_Rect bounds;
+    int i;
+
+    if (frame->num_rects + count > frame->max_rects) {
+        int max_rects = SDL_max(2 * frame->max_rects, frame->num_rects + count);
+        SDL_Rect *new_rects = (SDL_Rect *) SDL_realloc(frame->rects, max_rects * sizeof(*new_rects));
+        if (!new_rects) {
+            return SDL_OutOfMemory();
+        }
+        frame->rects = new_rects;
+        frame->max_rects = max_rects;
+    }
+
+    cmd = SW_QueueCommand(renderer, SW_CMD_FILL_RECTS);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->first = frame->num_rects;
+    cmd->count = count;
+    SDL_memcpy(&frame->rects[cmd->first], rects, count * sizeof(*rects));
+    frame->num_rects += count;
+
+    SDL_zero(bounds);
+    for (i = 0; i < count; ++i) {
+        SDL_UnionRect(&bounds, &rects[i], &bounds);
+    }
+    SW_ClipBounds(&bounds, &cmd->clip, &cmd->bounds);
+    cmd->exact = SDL_TRUE;
+    return SW_SubmitCommand(renderer, cmd);
+}
+
+static int
+SW_QueueCopy(SDL_Renderer * renderer, SDL_Texture * texture,
+             const SDL_Rect * srcrect, const SDL_Rect * dstrect,
+             const double angle, const SDL_FPoint * center, const SDL_RendererFlip flip)
+{
+    SDL_Surface *src = (SDL_Surface *) texture->driverdata;
+    SW_RenderCommand *cmd;
+    SDL_Rect bounds;
+
+    cmd = SW_QueueCommand(renderer, center ? SW_CMD_COPY_EX : SW_CMD_COPY);
+    if (!cmd) {
+        return -1;
+    }
+    cmd->r = texture->r;
+    cmd->g = texture->g;
+    cmd->b = texture->b;
+    cmd->a = texture->a;
+    cmd->blendMode = texture->blendMode;
+    cmd->texture = texture;
+    cmd->version = (Uint32)(uintptr_t)src->userdata;
+    cmd->srcrect = *srcrect;
+    cmd->dstrect = *dstrect;
+    cmd->scale_quality = GetScaleQuality();
+
+    if (center) {
+        /* However it's rotated, the copy stays within a circle around the
+           center, give or take the rounding of the rotated surface */
+        const double dx = SDL_max(center->x, dstrect->w - center->x);
+        const double dy = SDL_max(center->y, dstrect->h - center->y);
+        const int radius = (int)SDL_ceil(SDL_sqrt(dx * dx + dy * dy)) + 2;
+
+        cmd->angle = angle;
+        cmd->center = *center;
+        cmd->flip = flip;
+        bounds.x = (int)SDL_floor(dstrect->x + center->x) - radius;
+        bounds.y = (int)SDL_floor(dstrect->y + center->y) - radius;
+        bounds.w = bounds.h = 2 * radius + 1;
+    } else {
+        /* Scaled copies work out the source pixels from the clipped area */
+        cmd->exact = (srcrect->w == dstrect->w && srcrect->h == dstrect->h);
+        bounds = *dstrect;
+    }
+    SW_ClipBounds(&bounds, &cmd->clip, &cmd->bounds);
+    return SW_SubmitCommand(renderer, cmd);
+}
+
+static SDL_bool
+SW_FrameUsesTexture(const SW_RenderFrame * frame, SDL_Texture * texture)
+{
+    int i;
+
+    for (i = 0; i < frame->num_commands; ++i) {
+        if (frame->commands[i].texture == texture) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+/* Held back commands have to be drawn before a texture they use changes */
+static void
+SW_FlushTexture(SDL_Renderer * renderer, SDL_Texture * texture)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+
+    if (data->deferred && SW_FrameUsesTexture(data->frame, texture)) {
+        SW_FlushCommands(renderer);
+    }
+}
+
 SDL_Renderer *
 SW_CreateRendererForSurface(SDL_Surface * surface)
 {
@@ -147,6 +466,9 @@ SW_CreateRendererForSurface(SDL_Surface * surface)
     }
     data->surface = surface;
     data->window = surface;
+    data->frame = &data->frames[0];
+    data->last_frame = &data->frames[1];
+    data->redraw = SDL_TRUE;
 
     renderer->WindowEvent = SW_WindowEvent;
     renderer->GetOutputSize = SW_GetOutputSize;
@@ -182,12 +504,18 @@ SDL_Renderer *
 SW_CreateRenderer(SDL_Window * window, Uint32 flags)
 {
     SDL_Surface *surface;
+    SDL_Renderer *renderer;
 
     surface = SDL_GetWindowSurface(window);
     if (!surface) {
         return NULL;
     }
-    return SW_CreateRendererForSurface(surface);
+    renderer = SW_CreateRendererForSurface(surface);
+    if (renderer) {
+        SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+        data->batching = SDL_GetHintBoolean(SDL_HINT_RENDER_SW_DIRTY_RECTS, SDL_FALSE);
+    }
+    return renderer;
 }
 
 static void
@@ -196,8 +524,15 @@ SW_WindowEvent(SDL_Renderer * renderer, const SDL_WindowEvent *event)
     SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
 
     if (event->event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        /* The old window surface is still there until it's asked for again */
+        SW_FlushCommands(renderer);
         data->surface = NULL;
         data->window = NULL;
+        data->redraw = SDL_TRUE;
+    } else if (event->event == SDL_WINDOWEVENT_EXPOSED ||
+               event->event == SDL_WINDOWEVENT_SHOWN ||
+               event->event == SDL_WINDOWEVENT_RESTORED) {
+        data->redraw = SDL_TRUE;
     }
 }
 
@@ -249,6 +584,7 @@ SW_CreateTexture(SDL_Renderer * renderer, SDL_Texture * texture)
     if (!texture->driverdata) {
         return -1;
     }
+    SW_TouchTexture(texture);
     return 0;
 }
 
@@ -301,6 +637,9 @@ SW_UpdateTexture(SDL_Renderer * renderer, SDL_Texture * texture,
     int row;
     size_t length;
 
+    SW_FlushTexture(renderer, texture);
+    SW_TouchTexture(texture);
+
     if(SDL_MUSTLOCK(surface))
         SDL_LockSurface(surface);
     src = (Uint8 *) pixels;
@@ -324,6 +663,9 @@ SW_LockTexture(SDL_Renderer * renderer, SDL_Texture * texture,
 {
     SDL_Surface *surface = (SDL_Surface *) texture->driverdata;
 
+    SW_FlushTexture(renderer, texture);
+    SW_TouchTexture(texture);
+
     *pixels =
         (void *) ((Uint8 *) surface->pixels + rect->y * surface->pitch +
                   rect->x * surface->format->BytesPerPixel);
@@ -342,6 +684,8 @@ SW_SetRenderTarget(SDL_Renderer * renderer, SDL_Texture * texture)
     SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
 
     if (texture ) {
+        SW_FlushTexture(renderer, texture);
+        SW_TouchTexture(texture);
         data->surface = (SDL_Surface *) texture->driverdata;
     } else {
         data->surface = data->window;
@@ -385,25 +729,51 @@ SW_UpdateClipRect(SDL_Renderer * renderer)
 }
 
 static int
-SW_RenderClear(SDL_Renderer * renderer)
+SW_Clear(SDL_Surface * surface, Uint8 r, Uint8 g, Uint8 b, Uint8 a,
+         const SDL_Rect * rect)
 {
-    SDL_Surface *surface = SW_ActivateRenderer(renderer);
     Uint32 color;
     SDL_Rect clip_rect;
+    int status;
 
-    if (!surface) {
-        return -1;
-    }
-
-    color = SDL_MapRGBA(surface->format,
-                        renderer->r, renderer->g, renderer->b, renderer->a);
+    color = SDL_MapRGBA(surface->format, r, g, b, a);
 
     /* By definition the clear ignores the clip rect */
     clip_rect = surface->clip_rect;
     SDL_SetClipRect(surface, NULL);
-    SDL_FillRect(surface, NULL, color);
+    status = SDL_FillRect(surface, rect, color);
     SDL_SetClipRect(surface, &clip_rect);
-    return 0;
+    return status;
+}
+
+static int
+SW_RenderClear(SDL_Renderer * renderer)
+{
+    SDL_Surface *surface = SW_ActivateRenderer(renderer);
+
+    if (!surface) {
+        return -1;
+    }
+
+    if (SW_IsBatching(renderer)) {
+        return SW_QueueClear(renderer);
+    }
+    return SW_Clear(surface, renderer->r, renderer->g, renderer->b,
+                    renderer->a, NULL);
+}
+
+static int
+SW_DrawPoints(SDL_Surface * surface, const SDL_Point * points, int count,
+              SDL_BlendMode blendMode, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    /* Draw the points! */
+    if (blendMode == SDL_BLENDMODE_NONE) {
+        Uint32 color = SDL_MapRGBA(surface->format, r, g, b, a);
+
+        return SDL_DrawPoints(surface, points, count, color);
+    } else {
+        return SDL_BlendPoints(surface, points, count, blendMode, r, g, b, a);
+    }
 }
 
 static int
@@ -437,24 +807,33 @@ SW_RenderDrawPoints(SDL_Renderer * renderer, const SDL_FPoint * points,
         }
     }
 
-    /* Draw the points! */
-    if (renderer->blendMode == SDL_BLENDMODE_NONE) {
-        Uint32 color = SDL_MapRGBA(surface->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
-
-        status = SDL_DrawPoints(surface, final_points, count, color);
+    if (SW_IsBatching(renderer)) {
+        status = SW_QueuePoints(renderer, SW_CMD_DRAW_POINTS, final_points, count);
     } else {
-        status = SDL_BlendPoints(surface, final_points, count,
-                                renderer->blendMode,
-                                renderer->r, renderer->g, renderer->b,
-                                renderer->a);
+        status = SW_DrawPoints(surface, final_points, count,
+                               renderer->blendMode,
+                               renderer->r, renderer->g, renderer->b,
+                               renderer->a);
     }
     SDL_stack_free(final_points);
 
     return status;
 }
 
+static int
+SW_DrawLines(SDL_Surface * surface, const SDL_Point * points, int count,
+             SDL_BlendMode blendMode, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    /* Draw the lines! */
+    if (blendMode == SDL_BLENDMODE_NONE) {
+        Uint32 color = SDL_MapRGBA(surface->format, r, g, b, a);
+
+        return SDL_DrawLines(surface, points, count, color);
+    } else {
+        return SDL_BlendLines(surface, points, count, blendMode, r, g, b, a);
+    }
+}
+
 static int
 SW_RenderDrawLines(SDL_Renderer * renderer, const SDL_FPoint * points,
                    int count)
@@ -486,24 +865,32 @@ SW_RenderDrawLines(SDL_Renderer * renderer, const SDL_FPoint * points,
         }
     }
 
-    /* Draw the lines! */
-    if (renderer->blendMode == SDL_BLENDMODE_NONE) {
-        Uint32 color = SDL_MapRGBA(surface->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
-
-        status = SDL_DrawLines(surface, final_points, count, color);
+    if (SW_IsBatching(renderer)) {
+        status = SW_QueuePoints(renderer, SW_CMD_DRAW_LINES, final_points, count);
     } else {
-        status = SDL_BlendLines(surface, final_points, count,
-                                renderer->blendMode,
-                                renderer->r, renderer->g, renderer->b,
-                                renderer->a);
+        status = SW_DrawLines(surface, final_points, count,
+                              renderer->blendMode,
+                              renderer->r, renderer->g, renderer->b,
+                              renderer->a);
     }
     SDL_stack_free(final_points);
 
     return status;
 }
 
+static int
+SW_FillRects(SDL_Surface * surface, const SDL_Rect * rects, int count,
+             SDL_BlendMode blendMode, Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    if (blendMode == SDL_BLENDMODE_NONE) {
+        Uint32 color = SDL_MapRGBA(surface->format, r, g, b, a);
+
+        return SDL_FillRects(surface, rects, count, color);
+    } else {
+        return SDL_BlendFillRects(surface, rects, count, blendMode, r, g, b, a);
+    }
+}
+
 static int
 SW_RenderFillRects(SDL_Renderer * renderer, const SDL_FRect * rects, int count)
 {
@@ -538,43 +925,63 @@ SW_RenderFillRects(SDL_Renderer * renderer, const SDL_FRect * rects, int count)
         }
     }
 
-    if (renderer->blendMode == SDL_BLENDMODE_NONE) {
-        Uint32 color = SDL_MapRGBA(surface->format,
-                                   renderer->r, renderer->g, renderer->b,
-                                   renderer->a);
-        status = SDL_FillRects(surface, final_rects, count, color);
+    if (SW_IsBatching(renderer)) {
+        status = SW_QueueFillRects(renderer, final_rects, count);
     } else {
-        status = SDL_BlendFillRects(surface, final_rects, count,
-                                    renderer->blendMode,
-                                    renderer->r, renderer->g, renderer->b,
-                                    renderer->a);
+        status = SW_FillRects(surface, final_rects, count,
+                              renderer->blendMode,
+                              renderer->r, renderer->g, renderer->b,
+                              renderer->a);
     }
     SDL_stack_free(final_rects);
 
     return status;
 }
 
+/* Stretch with linear filtering into a temporary surface and blit that with
+   the texture's blend mode and modulation. Only the part of the destination
+   inside the clip rectangle gets stretched. */
 static int
-SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
-              const SDL_Rect * srcrect, const SDL_FRect * dstrect)
+SW_BlitScaledLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                    SDL_Surface * dst, const SDL_Rect * dstrect)
 {
-    SDL_Surface *surface = SW_ActivateRenderer(renderer);
-    SDL_Surface *src = (SDL_Surface *) texture->driverdata;
-    SDL_Rect final_rect;
+    SDL_Surface *scaled;
+    SDL_Rect visible;
+    SDL_BlendMode blendmode;
+    Uint8 r, g, b, a;
+    int retval;
 
-    if (!surface) {
-        return -1;
+    if (!SDL_IntersectRect(dstrect, &dst->clip_rect, &visible)) {
+        return 0;
     }
 
-    if (renderer->viewport.x || renderer->viewport.y) {
-        final_rect.x = (int)(renderer->viewport.x + dstrect->x);
-        final_rect.y = (int)(renderer->viewport.y + dstrect->y);
-    } else {
-        final_rect.x = (int)dstrect->x;
-        final_rect.y = (int)dstrect->y;
+    scaled = SDL_CreateRGBSurfaceWithFormat(0, visible.w, visible.h, 32, src->format->format);
+    if (!scaled) {
+        return -1;
     }
-    final_rect.w = (int)dstrect->w;
-    final_rect.h = (int)dstrect->h;
+    SDL_GetSurfaceBlendMode(src, &blendmode);
+    SDL_GetSurfaceColorMod(src, &r, &g, &b);
+    SDL_GetSurfaceAlphaMod(src, &a);
+    SDL_SetSurfaceBlendMode(scaled, blendmode);
+    SDL_SetSurfaceColorMod(scaled, r, g, b);
+    SDL_SetSurfaceAlphaMod(scaled, a);
+
+    retval = SDL_PrivateSoftStretch(src, srcrect, scaled, &scaled->clip_rect,
+                                    dstrect->w, dstrect->h,
+                                    visible.x - dstrect->x, visible.y - dstrect->y,
+                                    SDL_TRUE);
+    if (retval == 0) {
+        retval = SDL_BlitSurface(scaled, NULL, dst, &visible);
+    }
+    SDL_FreeSurface(scaled);
+    return retval;
+}
+
+static int
+SW_Copy(SDL_Surface * surface, SDL_Surface * src, const SDL_Rect * srcrect,
+        const SDL_Rect * dstrect, int scale_quality)
+{
+    SDL_Rect final_rect = *dstrect;
 
     if ( srcrect->w == final_rect.w && srcrect->h == final_rect.h ) {
         return SDL_BlitSurface(src, srcrect, surface, &final_rect);
@@ -583,39 +990,20 @@ SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
          * to avoid potentially frequent RLE encoding/decoding.
          */
         SDL_SetSurfaceRLE(surface, 0);
+        if (scale_quality && src->format->BytesPerPixel == 4) {
+            return SW_BlitScaledLinear(src, srcrect, surface, &final_rect);
+        }
         return SDL_BlitScaled(src, srcrect, surface, &final_rect);
     }
 }
 
 static int
-GetScaleQuality(void)
-{
-    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
-
-    if (!hint || *hint == '0' || SDL_strcasecmp(hint, "nearest") == 0) {
-        return 0;
-    } else {
-        return 1;
-    }
-}
-
-static int
-SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
-                const SDL_Rect * srcrect, const SDL_FRect * dstrect,
-                const double angle, const SDL_FPoint * center, const SDL_RendererFlip flip)
+SW_RenderCopy(SDL_Renderer * renderer, SDL_Texture * texture,
+              const SDL_Rect * srcrect, const SDL_FRect * dstrect)
 {
     SDL_Surface *surface = SW_ActivateRenderer(renderer);
     SDL_Surface *src = (SDL_Surface *) texture->driverdata;
-    SDL_Rect final_rect, tmp_rect;
-    SDL_Surface *src_clone, *src_rotated, *src_scaled;
-    SDL_Surface *mask = NULL, *mask_rotated = NULL;
-    int retval = 0, dstwidth, dstheight, abscenterx, abscentery;
-    double cangle, sangle, px, py, p1x, p1y, p2x, p2y, p3x, p3y, p4x, p4y;
-    SDL_BlendMode blendmode;
-    Uint8 alphaMod, rMod, gMod, bMod;
-    int applyModulation = SDL_FALSE;
-    int blitRequired = SDL_FALSE;
-    int isOpaque = SDL_FALSE;
+    SDL_Rect final_rect;
 
     if (!surface) {
         return -1;
@@ -631,6 +1019,28 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
     final_rect.w = (int)dstrect->w;
     final_rect.h = (int)dstrect->h;
 
+    if (SW_IsBatching(renderer)) {
+        return SW_QueueCopy(renderer, texture, srcrect, &final_rect, 0.0, NULL, SDL_FLIP_NONE);
+    }
+    return SW_Copy(surface, src, srcrect, &final_rect, GetScaleQuality());
+}
+
+static int
+SW_CopyEx(SDL_Surface * surface, SDL_Surface * src, const SDL_Rect * srcrect,
+          const SDL_Rect * dstrect, const double angle, const SDL_FPoint * center,
+          const SDL_RendererFlip flip, int scale_quality)
+{
+    SDL_Rect final_rect = *dstrect, tmp_rect;
+    SDL_Surface *src_clone, *src_rotated, *src_scaled;
+    SDL_Surface *mask = NULL, *mask_rotated = NULL;
+    int retval = 0, dstwidth, dstheight, abscenterx, abscentery;
+    double cangle, sangle, px, py, p1x, p1y, p2x, p2y, p3x, p3y, p4x, p4y;
+    SDL_BlendMode blendmode;
+    Uint8 alphaMod, rMod, gMod, bMod;
+    int applyModulation = SDL_FALSE;
+    int blitRequired = SDL_FALSE;
+    int isOpaque = SDL_FALSE;
+
     tmp_rect = final_rect;
     tmp_rect.x = 0;
     tmp_rect.y = 0;
@@ -717,7 +1127,7 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
 
     if (!retval) {
         SDLgfx_rotozoomSurfaceSizeTrig(tmp_rect.w, tmp_rect.h, angle, &dstwidth, &dstheight, &cangle, &sangle);
-        src_rotated = SDLgfx_rotateSurface(src_clone, angle, dstwidth/2, dstheight/2, GetScaleQuality(), flip & SDL_FLIP_HORIZONTAL, flip & SDL_FLIP_VERTICAL, dstwidth, dstheight, cangle, sangle);
+        src_rotated = SDLgfx_rotateSurface(src_clone, angle, dstwidth/2, dstheight/2, scale_quality, flip & SDL_FLIP_HORIZONTAL, flip & SDL_FLIP_VERTICAL, dstwidth, dstheight, cangle, sangle);
         if (src_rotated == NULL) {
             retval = -1;
         }
@@ -831,10 +1241,319 @@ SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
     return retval;
 }
 
+static int
+SW_RenderCopyEx(SDL_Renderer * renderer, SDL_Texture * texture,
+                const SDL_Rect * srcrect, const SDL_FRect * dstrect,
+                const double angle, const SDL_FPoint * center, const SDL_RendererFlip flip)
+{
+    SDL_Surface *surface = SW_ActivateRenderer(renderer);
+    SDL_Surface *src = (SDL_Surface *) texture->driverdata;
+    SDL_Rect final_rect;
+
+    if (!surface) {
+        return -1;
+    }
+
+    if (renderer->viewport.x || renderer->viewport.y) {
+        final_rect.x = (int)(renderer->viewport.x + dstrect->x);
+        final_rect.y = (int)(renderer->viewport.y + dstrect->y);
+    } else {
+        final_rect.x = (int)dstrect->x;
+        final_rect.y = (int)dstrect->y;
+    }
+    final_rect.w = (int)dstrect->w;
+    final_rect.h = (int)dstrect->h;
+
+    if (SW_IsBatching(renderer)) {
+        return SW_QueueCopy(renderer, texture, srcrect, &final_rect, angle, center, flip);
+    }
+    return SW_CopyEx(surface, src, srcrect, &final_rect, angle, center, flip, GetScaleQuality());
+}
+
+static int
+SW_RunCommand(SDL_Surface * surface, const SW_RenderFrame * frame,
+              const SW_RenderCommand * cmd, const SDL_Rect * damage)
+{
+    SDL_Rect saved_clip = surface->clip_rect;
+    SDL_Rect clip = cmd->clip;
+    SDL_Texture *texture = cmd->texture;
+    SDL_Surface *src = NULL;
+    SDL_bool modulated = SDL_FALSE;
+    int status = 0;
+
+    /* Commands that don't draw exactly the same pixels under a smaller clip
+       rect are drawn whole, the damaged area has grown to cover them. */
+    if (damage && cmd->exact) {
+        SW_ClipBounds(&cmd->clip, damage, &clip);
+    }
+    SDL_SetClipRect(surface, &clip);
+
+    if (texture) {
+        /* The texture modulation may have changed since the command */
+        src = (SDL_Surface *) texture->driverdata;
+        if (cmd->r != texture->r || cmd->g != texture->g || cmd->b != texture->b ||
+            cmd->a != texture->a || cmd->blendMode != texture->blendMode) {
+            SDL_SetSurfaceColorMod(src, cmd->r, cmd->g, cmd->b);
+            SDL_SetSurfaceAlphaMod(src, cmd->a);
+            SDL_SetSurfaceBlendMode(src, cmd->blendMode);
+            modulated = SDL_TRUE;
+        }
+    }
+
+    switch (cmd->type) {
+    case SW_CMD_CLEAR:
+        status = SW_Clear(surface, cmd->r, cmd->g, cmd->b, cmd->a, damage);
+        break;
+    case SW_CMD_DRAW_POINTS:
+        status = SW_DrawPoints(surface, &frame->points[cmd->first], cmd->count,
+                               cmd->blendMode, cmd->r, cmd->g, cmd->b, cmd->a);
+        break;
+    case SW_CMD_DRAW_LINES:
+        status = SW_DrawLines(surface, &frame->points[cmd->first], cmd->count,
+                              cmd->blendMode, cmd->r, cmd->g, cmd->b, cmd->a);
+        break;
+    case SW_CMD_FILL_RECTS:
+        status = SW_FillRects(surface, &frame->rects[cmd->first], cmd->count,
+                              cmd->blendMode, cmd->r, cmd->g, cmd->b, cmd->a);
+        break;
+    case SW_CMD_COPY:
+        status = SW_Copy(surface, src, &cmd->srcrect, &cmd->dstrect,
+                         cmd->scale_quality);
+        break;
+    case SW_CMD_COPY_EX:
+        status = SW_CopyEx(surface, src, &cmd->srcrect, &cmd->dstrect,
+                           cmd->angle, &cmd->center, cmd->flip,
+                           cmd->scale_quality);
+        break;
+    }
+
+    if (modulated) {
+        SDL_SetSurfaceColorMod(src, texture->r, texture->g, texture->b);
+        SDL_SetSurfaceAlphaMod(src, texture->a);
+        SDL_SetSurfaceBlendMode(src, texture->blendMode);
+    }
+    SDL_SetClipRect(surface, &saved_clip);
+    return status;
+}
+
+static void
+SW_FlushCommands(SDL_Renderer * renderer)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    SW_RenderFrame *frame = data->frame;
+    int i;
+
+    if (!data->deferred) {
+        return;
+    }
+    data->deferred = SDL_FALSE;
+
+    /* The rest of the frame is drawn as it comes. The comparison with the
+       last frame still tells which areas need presenting. */
+    for (i = 0; i < frame->num_commands; ++i) {
+        SW_RunCommand(data->window, frame, &frame->commands[i], NULL);
+    }
+}
+
+static SDL_bool
+SW_SameCommand(const SW_RenderFrame * frame1, const SW_RenderCommand * cmd1,
+               const SW_RenderFrame * frame2, const SW_RenderCommand * cmd2)
+{
+    if (cmd1->type != cmd2->type ||
+        cmd1->r != cmd2->r || cmd1->g != cmd2->g ||
+        cmd1->b != cmd2->b || cmd1->a != cmd2->a ||
+        cmd1->blendMode != cmd2->blendMode ||
+        !SDL_RectEquals(&cmd1->clip, &cmd2->clip) ||
+        cmd1->count != cmd2->count ||
+        cmd1->texture != cmd2->texture ||
+        cmd1->version != cmd2->version ||
+        !SDL_RectEquals(&cmd1->srcrect, &cmd2->srcrect) ||
+        !SDL_RectEquals(&cmd1->dstrect, &cmd2->dstrect) ||
+        cmd1->angle != cmd2->angle ||
+        cmd1->center.x != cmd2->center.x ||
+        cmd1->center.y != cmd2->center.y ||
+        cmd1->flip != cmd2->flip ||
+        cmd1->scale_quality != cmd2->scale_quality) {
+        return SDL_FALSE;
+    }
+
+    switch (cmd1->type) {
+    case SW_CMD_DRAW_POINTS:
+    case SW_CMD_DRAW_LINES:
+        return (SDL_memcmp(&frame1->points[cmd1->first], &frame2->points[cmd2->first],
+                           cmd1->count * sizeof(SDL_Point)) == 0);
+    case SW_CMD_FILL_RECTS:
+        return (SDL_memcmp(&frame1->rects[cmd1->first], &frame2->rects[cmd2->first],
+                           cmd1->count * sizeof(SDL_Rect)) == 0);
+    default:
+        return SDL_TRUE;
+    }
+}
+
+/* Adds an area to a list of rects that don't overlap, merging it with the
+   ones it touches, and returns the new number of rects. */
+static int
+SW_AddDirtyRect(SDL_Rect * rects, int count, const SDL_Rect * rect)
+{
+    SDL_Rect merged = *rect;
+    int i;
+
+    if (SDL_RectEmpty(&merged)) {
+        return count;
+    }
+
+    i = 0;
+    while (i < count) {
+        if (SDL_HasIntersection(&rects[i], &merged)) {
+            SDL_UnionRect(&rects[i], &merged, &merged);
+            rects[i] = rects[--count];
+            i = 0;
+        } else {
+            ++i;
+        }
+    }
+
+    if (count == SW_MAX_DIRTY_RECTS) {
+        for (i = 0; i < count; ++i) {
+            SDL_UnionRect(&rects[i], &merged, &merged);
+        }
+        count = 0;
+    }
+    rects[count++] = merged;
+    return count;
+}
+
+static SDL_bool
+SW_RectContains(const SDL_Rect * outer, const SDL_Rect * inner)
+{
+    return (inner->x >= outer->x && inner->y >= outer->y &&
+            inner->x + inner->w <= outer->x + outer->w &&
+            inner->y + inner->h <= outer->y + outer->h);
+}
+
+/* Works out the areas of the window the frame changes, returns -1 if that's
+   all of it. */
+static int
+SW_GetDirtyRects(SW_RenderData * data, SDL_Rect * rects)
+{
+    const SW_RenderFrame *frame = data->frame;
+    const SW_RenderFrame *last = data->last_frame;
+    int count = 0;
+    int i, j;
+
+    if (data->redraw) {
+        return -1;
+    }
+
+    if (frame->cleared && last->cleared) {
+        int first = 0;
+        int end = frame->num_commands;
+        int last_end = last->num_commands;
+        SDL_bool grown;
+
+        /* The commands both frames start and end with draw in the same order,
+           so they can only make a difference where the others draw. */
+        while (first < end && first < last_end &&
+               SW_SameCommand(frame, &frame->commands[first], last, &last->commands[first])) {
+            ++first;
+        }
+        while (end > first && last_end > first &&
+               SW_SameCommand(frame, &frame->commands[end-1], last, &last->commands[last_end-1])) {
+            --end;
+            --last_end;
+        }
+        for (i = first; i < end; ++i) {
+            count = SW_AddDirtyRect(rects, count, &frame->commands[i].bounds);
+        }
+        for (i = first; i < last_end; ++i) {
+            count = SW_AddDirtyRect(rects, count, &last->commands[i].bounds);
+        }
+
+        /* Commands that are drawn whole have to fit in a single dirty rect */
+        do {
+            grown = SDL_FALSE;
+            for (i = 0; i < frame->num_commands; ++i) {
+                const SW_RenderCommand *cmd = &frame->commands[i];
+                if (cmd->exact) {
+                    continue;
+                }
+                for (j = 0; j < count; ++j) {
+                    if (SDL_HasIntersection(&cmd->bounds, &rects[j]) &&
+                        !SW_RectContains(&rects[j], &cmd->bounds)) {
+                        count = SW_AddDirtyRect(rects, count, &cmd->bounds);
+                        grown = SDL_TRUE;
+                        break;
+                    }
+                }
+            }
+        } while (grown);
+    } else {
+        for (i = 0; i < frame->num_commands; ++i) {
+            count = SW_AddDirtyRect(rects, count, &frame->commands[i].bounds);
+        }
+    }
+
+    if (count == 1 && rects[0].x == 0 && rects[0].y == 0 &&
+        rects[0].w == data->window->w && rects[0].h == data->window->h) {
+        return -1;
+    }
+    return count;
+}
+
+static void
+SW_PresentFrame(SDL_Renderer * renderer)
+{
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    SW_RenderFrame *frame = data->frame;
+    SDL_Rect rects[SW_MAX_DIRTY_RECTS];
+    int count = -1;
+    int i, j;
+
+    if (data->window) {
+        count = SW_GetDirtyRects(data, rects);
+    }
+
+    if (data->deferred) {
+        if (count < 0) {
+            for (i = 0; i < frame->num_commands; ++i) {
+                SW_RunCommand(data->window, frame, &frame->commands[i], NULL);
+            }
+        } else {
+            for (j = 0; j < count; ++j) {
+                for (i = 0; i < frame->num_commands; ++i) {
+                    const SW_RenderCommand *cmd = &frame->commands[i];
+                    if (SDL_HasIntersection(&cmd->bounds, &rects[j])) {
+                        SW_RunCommand(data->window, frame, cmd, &rects[j]);
+                    }
+                }
+            }
+        }
+        data->deferred = SDL_FALSE;
+    }
+
+    if (count < 0) {
+        SDL_UpdateWindowSurface(renderer->window);
+    } else if (count > 0) {
+        SDL_UpdateWindowSurfaceRects(renderer->window, rects, count);
+    }
+
+    /* An empty frame leaves the window as it was */
+    if (frame->num_commands > 0) {
+        data->frame = data->last_frame;
+        data->last_frame = frame;
+        data->frame->num_commands = 0;
+        data->frame->num_points = 0;
+        data->frame->num_rects = 0;
+        data->frame->cleared = SDL_FALSE;
+        data->redraw = SDL_FALSE;
+    }
+}
+
 static int
 SW_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
                     Uint32 format, void * pixels, int pitch)
 {
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
     SDL_Surface *surface = SW_ActivateRenderer(renderer);
     Uint32 src_format;
     void *src_pixels;
@@ -847,6 +1566,10 @@ SW_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
      * SDL_RenderReadPixels.
      */
 
+    if (surface == data->window) {
+        SW_FlushCommands(renderer);
+    }
+
     if (rect->x < 0 || rect->x+rect->w > surface->w ||
         rect->y < 0 || rect->y+rect->h > surface->h) {
         return SDL_SetError("Tried to read outside of surface bounds");
@@ -865,9 +1588,12 @@ SW_RenderReadPixels(SDL_Renderer * renderer, const SDL_Rect * rect,
 static void
 SW_RenderPresent(SDL_Renderer * renderer)
 {
+    SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
     SDL_Window *window = renderer->window;
 
-    if (window) {
+    if (data->batching) {
+        SW_PresentFrame(renderer);
+    } else if (window) {
         SDL_UpdateWindowSurface(window);
     }
 }
@@ -877,6 +1603,7 @@ SW_DestroyTexture(SDL_Renderer * renderer, SDL_Texture * texture)
 {
     SDL_Surface *surface = (SDL_Surface *) texture->driverdata;
 
+    SW_FlushTexture(renderer, texture);
     SDL_FreeSurface(surface);
 }
 
@@ -884,7 +1611,15 @@ static void
 SW_DestroyRenderer(SDL_Renderer * renderer)
 {
     SW_RenderData *data = (SW_RenderData *) renderer->driverdata;
+    int i;
 
+    if (data) {
+        for (i = 0; i < SDL_arraysize(data->frames); ++i) {
+            SDL_free(data->frames[i].commands);
+            SDL_free(data->frames[i].points);
+            SDL_free(data->frames[i].rects);
+        }
+    }
     SDL_free(data);
     SDL_free(renderer);
 }
@@ -34,7 +34,8 @@ typedef struct _SDL_Timer
     SDL_TimerCallback callback;
     void *param;
     Uint32 interval;
-    Uint32 scheduled;
+    SDL_bool precise;       /* interval is in microseconds instead of milliseconds */
+    Uint64 scheduled;       /* deadline in microseconds, see SDL_GetTimerMicroseconds() */
     SDL_atomic_t canceled;
     struct _SDL_Timer *next;
 } SDL_Timer;
@@ -46,13 +47,38 @@ typedef struct _SDL_TimerMap
     struct _SDL_TimerMap *next;
 } SDL_TimerMap;
 
-/* The timers are kept in a sorted list */
+/* The timer map is hashed by timer ID so SDL_RemoveTimer() stays cheap
+   with many live timers. The number of buckets must be a power of 2. */
+#define SDL_TIMERMAP_BUCKETS    1024
+#define SDL_TIMERMAP_MASK       (SDL_TIMERMAP_BUCKETS-1)
+
+/* Hierarchical timing wheel, one microsecond per slot at the lowest level.
+   A timer lives at the level of the highest bit where its deadline differs
+   from the current wheel time, and moves down a level each time the wheel
+   passes its slot, so inserting and expiring are both constant time.
+ */
+#define SDL_TIMER_WHEEL_BITS    6
+#define SDL_TIMER_WHEEL_SIZE    (1 << SDL_TIMER_WHEEL_BITS)
+#define SDL_TIMER_WHEEL_MASK    (SDL_TIMER_WHEEL_SIZE-1)
+#define SDL_TIMER_WHEEL_LEVELS  8
+
+typedef struct {
+    Uint64 now;
+    int count[SDL_TIMER_WHEEL_LEVELS];
+    SDL_Timer *slots[SDL_TIMER_WHEEL_LEVELS][SDL_TIMER_WHEEL_SIZE];
+    SDL_Timer *expired;
+    SDL_Timer *expired_tail;
+} SDL_TimerWheel;
+
+/* The timers are kept in a timing wheel */
 typedef struct {
     /* Data used by the main thread */
     SDL_Thread *thread;
     SDL_atomic_t nextID;
-    SDL_TimerMap *timermap;
+    SDL_TimerMap *timermap[SDL_TIMERMAP_BUCKETS];
     SDL_mutex *timermap_lock;
+    Uint64 counter_base;
+    Uint64 counter_freq;
 
     /* Padding to separate cache lines between threads */
     char cache_pad[SDL_CACHELINE_SIZE];
@@ -64,48 +90,157 @@ typedef struct {
     SDL_Timer *freelist;
     SDL_atomic_t active;
 
-    /* List of timers - this is only touched by the timer thread */
-    SDL_Timer *timers;
+    /* Wheel of timers - this is only touched by the timer thread */
+    SDL_TimerWheel wheel;
 } SDL_TimerData;
 
 static SDL_TimerData SDL_timer_data;
 
 /* The idea here is that any thread might add a timer, but a single
- * thread manages the active timer queue, sorted by scheduling time.
+ * thread manages the active timer wheel, ordered by scheduling time.
  *
  * Timers are removed by simply setting a canceled flag
  */
 
+static Uint64
+SDL_GetTimerMicroseconds(SDL_TimerData *data)
+{
+    const Uint64 ticks = SDL_GetPerformanceCounter() - data->counter_base;
+
+    /* Split the conversion so a nanosecond counter can't overflow */
+    return (ticks / data->counter_freq) * 1000000 +
+           ((ticks % data->counter_freq) * 1000000) / data->counter_freq;
+}
+
+static void
+SDL_AddExpiredTimer(SDL_TimerWheel *wheel, SDL_Timer *timer)
+{
+    timer->next = NULL;
+    if (wheel->expired_tail) {
+        wheel->expired_tail->next = timer;
+    } else {
+        wheel->expired = timer;
+    }
+    wheel->expired_tail = timer;
+}
+
 static void
-SDL_AddTimerInternal(SDL_TimerData *data, SDL_Timer *timer)
+SDL_AddTimerInternal(SDL_TimerWheel *wheel, SDL_Timer *timer)
 {
-    SDL_Timer *prev, *curr;
+    Uint64 diff;
+    int level, slot;
 
-    prev = NULL;
-    for (curr = data->timers; curr; prev = curr, curr = curr->next) {
-        if ((Sint32)(timer->scheduled-curr->scheduled) < 0) {
+    if (timer->scheduled <= wheel->now) {
+        SDL_AddExpiredTimer(wheel, timer);
+        return;
+    }
+
+    /* Find the highest level where the deadline and the wheel time differ */
+    diff = (timer->scheduled ^ wheel->now) >> SDL_TIMER_WHEEL_BITS;
+    for (level = 0; diff && level < SDL_TIMER_WHEEL_LEVELS-1; ++level) {
+        diff >>= SDL_TIMER_WHEEL_BITS;
+    }
+
+    slot = (int)(timer->scheduled >> (level * SDL_TIMER_WHEEL_BITS)) & SDL_TIMER_WHEEL_MASK;
+    timer->next = wheel->slots[level][slot];
+    wheel->slots[level][slot] = timer;
+    ++wheel->count[level];
+}
+
+/* Move the wheel to the current time, collecting every timer that is due */
+static void
+SDL_AdvanceTimerWheel(SDL_TimerWheel *wheel, Uint64 now)
+{
+    const Uint64 then = wheel->now;
+    int level;
+
+    if (now <= then) {
+        return;
+    }
+    wheel->now = now;
+
+    for (level = 0; level < SDL_TIMER_WHEEL_LEVELS; ++level) {
+        const int shift = level * SDL_TIMER_WHEEL_BITS;
+        const Uint64 first = (then >> shift) + 1;
+        const Uint64 last = (now >> shift);
+        Uint64 unit;
+
+        if (first > last) {
+            /* Higher levels can't have moved either */
             break;
         }
+        if (!wheel->count[level]) {
+            continue;
+        }
+
+        /* Visit each slot the wheel passed, at most once around */
+        for (unit = first; unit <= last && unit < first + SDL_TIMER_WHEEL_SIZE; ++unit) {
+            const int slot = (int)(unit & SDL_TIMER_WHEEL_MASK);
+            SDL_Timer *timer = wheel->slots[level][slot];
+
+            wheel->slots[level][slot] = NULL;
+            while (timer) {
+                SDL_Timer *next = timer->next;
+
+                --wheel->count[level];
+                /* Either due now, or moves down to a lower level */
+                SDL_AddTimerInternal(wheel, timer);
+                timer = next;
+            }
+        }
     }
+}
 
-    /* Insert the timer here! */
-    if (prev) {
-        prev->next = timer;
-    } else {
-        data->timers = timer;
+/* Get the earliest deadline in the wheel, or 0 if there are no timers */
+static Uint64
+SDL_GetNextTimerDeadline(SDL_TimerWheel *wheel, SDL_bool *precise)
+{
+    int level, i;
+
+    if (wheel->expired) {
+        *precise = wheel->expired->precise;
+        return wheel->now;
+    }
+
+    /* Timers on a lower level always expire before those on a higher one */
+    for (level = 0; level < SDL_TIMER_WHEEL_LEVELS; ++level) {
+        const int shift = level * SDL_TIMER_WHEEL_BITS;
+        const Uint64 base = (wheel->now >> shift);
+
+        if (!wheel->count[level]) {
+            continue;
+        }
+        for (i = 1; i <= SDL_TIMER_WHEEL_SIZE; ++i) {
+            const int slot = (int)((base + i) & SDL_TIMER_WHEEL_MASK);
+            SDL_Timer *timer = wheel->slots[level][slot];
+            Uint64 deadline = 0;
+
+            for ( ; timer; timer = timer->next) {
+                if (!deadline || timer->scheduled < deadline) {
+                    deadline = timer->scheduled;
+                    *precise = timer->precise;
+                }
+            }
+            if (deadline) {
+                return deadline;
+            }
+        }
     }
-    timer->next = curr;
+    return 0;
 }
 
 static int SDLCALL
 SDL_TimerThread(void *_data)
 {
     SDL_TimerData *data = (SDL_TimerData *)_data;
+    SDL_TimerWheel *wheel = &data->wheel;
     SDL_Timer *pending;
     SDL_Timer *current;
     SDL_Timer *freelist_head = NULL;
     SDL_Timer *freelist_tail = NULL;
-    Uint32 tick, now, interval, delay;
+    Uint64 tick, now, next;
+    Uint32 interval, delay;
+    SDL_bool precise;
 
     /* Threaded timer loop:
      *  1. Queue timers added by other threads
@@ -128,11 +263,11 @@ SDL_TimerThread(void *_data)
         }
         SDL_AtomicUnlock(&data->lock);
 
-        /* Sort the pending timers into our list */
+        /* Put the pending timers into the wheel */
         while (pending) {
             current = pending;
             pending = pending->next;
-            SDL_AddTimerInternal(data, current);
+            SDL_AddTimerInternal(wheel, current);
         }
         freelist_head = NULL;
         freelist_tail = NULL;
@@ -142,23 +277,18 @@ SDL_TimerThread(void *_data)
             break;
         }
 
-        /* Initial delay if there are no timers */
-        delay = SDL_MUTEX_MAXWAIT;
-
-        tick = SDL_GetTicks();
+        tick = SDL_GetTimerMicroseconds(data);
+        SDL_AdvanceTimerWheel(wheel, tick);
 
         /* Process all the pending timers for this tick */
-        while (data->timers) {
-            current = data->timers;
-
-            if ((Sint32)(tick-current->scheduled) < 0) {
-                /* Scheduled for the future, wait a bit */
-                delay = (current->scheduled - tick);
-                break;
-            }
+        while (wheel->expired) {
+            current = wheel->expired;
 
             /* We're going to do something with this timer */
-            data->timers = current->next;
+            wheel->expired = current->next;
+            if (!wheel->expired) {
+                wheel->expired_tail = NULL;
+            }
 
             if (SDL_AtomicGet(&current->canceled)) {
                 interval = 0;
@@ -169,8 +299,8 @@ SDL_TimerThread(void *_data)
             if (interval > 0) {
                 /* Reschedule this timer */
                 current->interval = interval;
-                current->scheduled = tick + interval;
-                SDL_AddTimerInternal(data, current);
+                current->scheduled = tick + (current->precise ? interval : (Uint64)interval * 1000);
+                SDL_AddTimerInternal(wheel, current);
             } else {
                 if (!freelist_head) {
                     freelist_head = current;
@@ -184,13 +314,22 @@ SDL_TimerThread(void *_data)
             }
         }
 
-        /* Adjust the delay based on processing time */
-        now = SDL_GetTicks();
-        interval = (now - tick);
-        if (interval > delay) {
-            delay = 0;
-        } else {
-            delay -= interval;
+        /* Work out the delay until the next timer, based on processing time */
+        delay = SDL_MUTEX_MAXWAIT;
+        precise = SDL_FALSE;
+        next = SDL_GetNextTimerDeadline(wheel, &precise);
+        if (next) {
+            now = SDL_GetTimerMicroseconds(data);
+            next = (next > now) ? (next - now) : 0;
+            if (precise) {
+                /* Wake up early and yield through the last millisecond */
+                delay = (Uint32)(next / 1000);
+                if (!delay && next) {
+                    SDL_Delay(0);
+                }
+            } else {
+                delay = (Uint32)((next + 999) / 1000);
+            }
         }
 
         /* Note that each time a timer is added, this will return
@@ -221,6 +360,10 @@ SDL_TimerInit(void)
             return -1;
         }
 
+        data->counter_base = SDL_GetPerformanceCounter();
+        data->counter_freq = SDL_GetPerformanceFrequency();
+        SDL_zero(data->wheel);
+
         SDL_AtomicSet(&data->active, 1);
 
         /* Timer threads use a callback into the app, so we can't set a limited stack size here. */
@@ -239,8 +382,10 @@ void
 SDL_TimerQuit(void)
 {
     SDL_TimerData *data = &SDL_timer_data;
+    SDL_TimerWheel *wheel = &data->wheel;
     SDL_Timer *timer;
     SDL_TimerMap *entry;
+    int i, j;
 
     if (SDL_AtomicCAS(&data->active, 1, 0)) {  /* active? Move to inactive. */
         /* Shutdown the timer thread */
@@ -254,20 +399,33 @@ SDL_TimerQuit(void)
         data->sem = NULL;
 
         /* Clean up the timer entries */
-        while (data->timers) {
-            timer = data->timers;
-            data->timers = timer->next;
+        for (i = 0; i < SDL_TIMER_WHEEL_LEVELS; ++i) {
+            for (j = 0; j < SDL_TIMER_WHEEL_SIZE; ++j) {
+                while (wheel->slots[i][j]) {
+                    timer = wheel->slots[i][j];
+                    wheel->slots[i][j] = timer->next;
+                    SDL_free(timer);
+                }
+            }
+            wheel->count[i] = 0;
+        }
+        while (wheel->expired) {
+            timer = wheel->expired;
+            wheel->expired = timer->next;
             SDL_free(timer);
         }
+        wheel->expired_tail = NULL;
         while (data->freelist) {
             timer = data->freelist;
             data->freelist = timer->next;
             SDL_free(timer);
         }
-        while (data->timermap) {
-            entry = data->timermap;
-            data->timermap = entry->next;
-            SDL_free(entry);
+        for (i = 0; i < SDL_TIMERMAP_BUCKETS; ++i) {
+            while (data->timermap[i]) {
+                entry = data->timermap[i];
+                data->timermap[i] = entry->next;
+                SDL_free(entry);
+            }
         }
 
         SDL_DestroyMutex(data->timermap_lock);
@@ -275,8 +433,8 @@ SDL_TimerQuit(void)
     }
 }
 
-SDL_TimerID
-SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+static SDL_TimerID
+SDL_CreateTimer(Uint32 interval, SDL_bool precise, SDL_TimerCallback callback, void *param)
 {
     SDL_TimerData *data = &SDL_timer_data;
     SDL_Timer *timer;
@@ -309,7 +467,8 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     timer->callback = callback;
     timer->param = param;
     timer->interval = interval;
-    timer->scheduled = SDL_GetTicks() + interval;
+    timer->precise = precise;
+    timer->scheduled = SDL_GetTimerMicroseconds(data) + (precise ? interval : (Uint64)interval * 1000);
     SDL_AtomicSet(&timer->canceled, 0);
 
     entry = (SDL_TimerMap *)SDL_malloc(sizeof(*entry));
@@ -322,8 +481,8 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     entry->timerID = timer->timerID;
 
     SDL_LockMutex(data->timermap_lock);
-    entry->next = data->timermap;
-    data->timermap = entry;
+    entry->next = data->timermap[entry->timerID & SDL_TIMERMAP_MASK];
+    data->timermap[entry->timerID & SDL_TIMERMAP_MASK] = entry;
     SDL_UnlockMutex(data->timermap_lock);
 
     /* Add the timer to the pending list for the timer thread */
@@ -338,6 +497,18 @@ SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
     return entry->timerID;
 }
 
+SDL_TimerID
+SDL_AddTimer(Uint32 interval, SDL_TimerCallback callback, void *param)
+{
+    return SDL_CreateTimer(interval, SDL_FALSE, callback, param);
+}
+
+SDL_TimerID
+SDL_AddTimerUS(Uint32 interval, SDL_TimerCallback callback, void *param)
+{
+    return SDL_CreateTimer(interval, SDL_TRUE, callback, param);
+}
+
 SDL_bool
 SDL_RemoveTimer(SDL_TimerID id)
 {
@@ -348,12 +519,12 @@ SDL_RemoveTimer(SDL_TimerID id)
     /* Find the timer */
     SDL_LockMutex(data->timermap_lock);
     prev = NULL;
-    for (entry = data->timermap; entry; prev = entry, entry = entry->next) {
+    for (entry = data->timermap[id & SDL_TIMERMAP_MASK]; entry; prev = entry, entry = entry->next) {
         if (entry->timerID == id) {
             if (prev) {
                 prev->next = entry->next;
             } else {
-                data->timermap = entry->next;
+                data->timermap[id & SDL_TIMERMAP_MASK] = entry->next;
             }
             break;
         }
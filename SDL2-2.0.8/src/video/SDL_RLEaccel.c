@@ -89,6 +89,7 @@
 #include "SDL_sysvideo.h"
 #include "SDL_blit.h"
 #include "SDL_RLEaccel_c.h"
+#include "SDL_surfacepool_c.h"
 
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -1220,8 +1221,7 @@ RLEAlphaSurface(SDL_Surface * surface)
 
     /* Now that we have it encoded, release the original pixels */
     if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
-        surface->pixels = NULL;
+        SDL_FreeSurfacePixels(surface);
     }
 
     /* realloc the buffer to release unused memory */
@@ -1383,8 +1383,7 @@ RLEColorkeySurface(SDL_Surface * surface)
 
     /* Now that we have it encoded, release the original pixels */
     if (!(surface->flags & SDL_PREALLOC)) {
-        SDL_free(surface->pixels);
-        surface->pixels = NULL;
+        SDL_FreeSurfacePixels(surface);
     }
 
     /* realloc the buffer to release unused memory */
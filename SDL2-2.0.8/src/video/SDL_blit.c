@@ -84,8 +84,10 @@ SDL_SoftBlit(SDL_Surface * src, SDL_Rect * srcrect,
             info->dst_pitch - info->dst_w * info->dst_fmt->BytesPerPixel;
         RunBlit = (SDL_BlitFunc) src->map->data;
 
-        /* Run the actual software blit */
-        RunBlit(info);
+        /* Run the actual software blit, on several threads if it's large */
+        if (!SDL_RunThreadedBlit(src, dst, RunBlit, info)) {
+            RunBlit(info);
+        }
     }
 
     /* We need to unlock the surfaces if they're locked */
@@ -106,6 +106,20 @@ extern SDL_BlitFunc SDL_CalculateBlit1(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlitN(SDL_Surface * surface);
 extern SDL_BlitFunc SDL_CalculateBlitA(SDL_Surface * surface);
 
+/* Functions found in SDL_blit_threads.c */
+typedef void (*SDL_BlitJob) (void *data, int job, int num_jobs);
+extern int SDL_GetBlitThreads(int pixels, int rows);
+extern SDL_bool SDL_RunBlitJobs(int num_jobs, SDL_BlitJob job, void *data);
+extern SDL_bool SDL_RunThreadedBlit(SDL_Surface * src, SDL_Surface * dst, SDL_BlitFunc blit, SDL_BlitInfo * info);
+extern void SDL_QuitBlitThreads(void);
+
+/* Functions found in SDL_stretch.c */
+extern int SDL_PrivateSoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
+                                  SDL_Surface * dst, const SDL_Rect * dstrect,
+                                  int scaled_w, int scaled_h, int x, int y,
+                                  SDL_bool linear);
+extern void SDL_QuitStretch(void);
+
 /*
  * Useful macros for blitting routines
  */
@@ -22,6 +22,7 @@
 
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "../cpuinfo/SDL_simd.h"
 
 /* Functions to perform alpha blended blitting */
 
@@ -509,6 +510,282 @@ BlitRGBtoRGBPixelAlpha(SDL_BlitInfo * info)
     }
 }
 
+/* AVX2 and NEON versions of the 32-bit RGB->RGB blenders above.
+   They do the same integer math as the C versions, so they produce exactly
+   the same pixels, and are picked at runtime with SDL_HasAVX2() and
+   SDL_HasNEON().
+ */
+#if HAVE_AVX2_INTRINSICS || HAVE_NEON_INTRINSICS
+
+/* One pixel of BlitRGBtoRGBPixelAlpha, for the ends of rows */
+static SDL_INLINE Uint32
+BlendRGBtoRGBPixelAlpha(Uint32 s, Uint32 d)
+{
+    Uint32 alpha = s >> 24;
+    Uint32 dalpha, s1, d1;
+
+    if (alpha == 0) {
+        return d;
+    } else if (alpha == SDL_ALPHA_OPAQUE) {
+        return s;
+    }
+    dalpha = d >> 24;
+    s1 = s & 0xff00ff;
+    d1 = d & 0xff00ff;
+    d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+    s &= 0xff00;
+    d &= 0xff00;
+    d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+    dalpha = alpha + (dalpha * (alpha ^ 0xFF) >> 8);
+    return d1 | d | (dalpha << 24);
+}
+
+/* One pixel of BlitRGBtoRGBSurfaceAlpha, for the ends of rows */
+static SDL_INLINE Uint32
+BlendRGBtoRGBSurfaceAlpha(Uint32 s, Uint32 d, Uint32 alpha)
+{
+    Uint32 s1, d1;
+
+    if (alpha == 128) {
+        return ((((s & 0x00fefefe) + (d & 0x00fefefe)) >> 1)
+                + (s & d & 0x00010101)) | 0xff000000;
+    }
+    s1 = s & 0xff00ff;
+    d1 = d & 0xff00ff;
+    d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+    s &= 0xff00;
+    d &= 0xff00;
+    d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+    return d1 | d | 0xff000000;
+}
+
+#endif /* HAVE_AVX2_INTRINSICS || HAVE_NEON_INTRINSICS */
+
+#if HAVE_AVX2_INTRINSICS
+
+/* ARGB8888/ABGR8888 blending with pixel alpha, 8 pixels at a time */
+SDL_TARGETING_AVX2 static void
+BlitRGBtoRGBPixelAlphaAVX2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const __m256i rbmask = _mm256_set1_epi32(0x00ff00ff);
+    const __m256i gmask = _mm256_set1_epi32(0x0000ff00);
+    const __m256i amask = _mm256_set1_epi32(0xff000000);
+    const __m256i opaque = _mm256_set1_epi32(0xff);
+    const __m256i zero = _mm256_setzero_si256();
+
+    while (height--) {
+        int n = width;
+
+        for ( ; n >= 8; n -= 8, srcp += 8, dstp += 8) {
+            __m256i s, d, alpha, rb, g, a;
+
+            s = _mm256_loadu_si256((const __m256i *) srcp);
+            if (_mm256_testz_si256(s, amask)) {
+                continue;   /* all transparent */
+            }
+            d = _mm256_loadu_si256((const __m256i *) dstp);
+            alpha = _mm256_srli_epi32(s, 24);
+
+            rb = _mm256_and_si256(d, rbmask);
+            rb = _mm256_add_epi32(rb, _mm256_srli_epi32(_mm256_mullo_epi32(
+                     _mm256_sub_epi32(_mm256_and_si256(s, rbmask), rb), alpha), 8));
+            rb = _mm256_and_si256(rb, rbmask);
+
+            g = _mm256_and_si256(d, gmask);
+            g = _mm256_add_epi32(g, _mm256_srli_epi32(_mm256_mullo_epi32(
+                    _mm256_sub_epi32(_mm256_and_si256(s, gmask), g), alpha), 8));
+            g = _mm256_and_si256(g, gmask);
+
+            a = _mm256_mullo_epi32(_mm256_srli_epi32(d, 24), _mm256_xor_si256(alpha, opaque));
+            a = _mm256_add_epi32(alpha, _mm256_srli_epi32(a, 8));
+
+            rb = _mm256_or_si256(_mm256_or_si256(rb, g), _mm256_slli_epi32(a, 24));
+            rb = _mm256_blendv_epi8(rb, d, _mm256_cmpeq_epi32(alpha, zero));
+            rb = _mm256_blendv_epi8(rb, s, _mm256_cmpeq_epi32(alpha, opaque));
+            _mm256_storeu_si256((__m256i *) dstp, rb);
+        }
+        while (n--) {
+            *dstp = BlendRGBtoRGBPixelAlpha(*srcp, *dstp);
+            ++srcp;
+            ++dstp;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+/* RGB888/BGR888 blending with surface alpha, 8 pixels at a time */
+SDL_TARGETING_AVX2 static void
+BlitRGBtoRGBSurfaceAlphaAVX2(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const Uint32 alpha = info->a;
+    const __m256i rbmask = _mm256_set1_epi32(0x00ff00ff);
+    const __m256i gmask = _mm256_set1_epi32(0x0000ff00);
+    const __m256i amask = _mm256_set1_epi32(0xff000000);
+    const __m256i halfmask = _mm256_set1_epi32(0x00fefefe);
+    const __m256i lowmask = _mm256_set1_epi32(0x00010101);
+    const __m256i mm_alpha = _mm256_set1_epi32(alpha);
+
+    while (height--) {
+        int n = width;
+
+        for ( ; n >= 8; n -= 8, srcp += 8, dstp += 8) {
+            const __m256i s = _mm256_loadu_si256((const __m256i *) srcp);
+            const __m256i d = _mm256_loadu_si256((const __m256i *) dstp);
+            __m256i rb, g;
+
+            if (alpha == 128) {
+                rb = _mm256_srli_epi32(_mm256_add_epi32(_mm256_and_si256(s, halfmask),
+                                                        _mm256_and_si256(d, halfmask)), 1);
+                rb = _mm256_add_epi32(rb, _mm256_and_si256(_mm256_and_si256(s, d), lowmask));
+            } else {
+                rb = _mm256_and_si256(d, rbmask);
+                rb = _mm256_add_epi32(rb, _mm256_srli_epi32(_mm256_mullo_epi32(
+                         _mm256_sub_epi32(_mm256_and_si256(s, rbmask), rb), mm_alpha), 8));
+                rb = _mm256_and_si256(rb, rbmask);
+
+                g = _mm256_and_si256(d, gmask);
+                g = _mm256_add_epi32(g, _mm256_srli_epi32(_mm256_mullo_epi32(
+                        _mm256_sub_epi32(_mm256_and_si256(s, gmask), g), mm_alpha), 8));
+                g = _mm256_and_si256(g, gmask);
+                rb = _mm256_or_si256(rb, g);
+            }
+            _mm256_storeu_si256((__m256i *) dstp, _mm256_or_si256(rb, amask));
+        }
+        while (n--) {
+            *dstp = BlendRGBtoRGBSurfaceAlpha(*srcp, *dstp, alpha);
+            ++srcp;
+            ++dstp;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+
+/* ARGB8888/ABGR8888 blending with pixel alpha, 4 pixels at a time */
+static void
+BlitRGBtoRGBPixelAlphaNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const uint32x4_t rbmask = vdupq_n_u32(0x00ff00ff);
+    const uint32x4_t gmask = vdupq_n_u32(0x0000ff00);
+    const uint32x4_t opaque = vdupq_n_u32(0xff);
+    const uint32x4_t zero = vdupq_n_u32(0);
+
+    while (height--) {
+        int n = width;
+
+        for ( ; n >= 4; n -= 4, srcp += 4, dstp += 4) {
+            uint32x4_t s, d, alpha, rb, g, a;
+
+            s = vld1q_u32(srcp);
+            alpha = vshrq_n_u32(s, 24);
+            if (vgetq_lane_u64(vreinterpretq_u64_u32(alpha), 0) == 0 &&
+                vgetq_lane_u64(vreinterpretq_u64_u32(alpha), 1) == 0) {
+                continue;   /* all transparent */
+            }
+            d = vld1q_u32(dstp);
+
+            rb = vandq_u32(d, rbmask);
+            rb = vaddq_u32(rb, vshrq_n_u32(vmulq_u32(vsubq_u32(vandq_u32(s, rbmask), rb), alpha), 8));
+            rb = vandq_u32(rb, rbmask);
+
+            g = vandq_u32(d, gmask);
+            g = vaddq_u32(g, vshrq_n_u32(vmulq_u32(vsubq_u32(vandq_u32(s, gmask), g), alpha), 8));
+            g = vandq_u32(g, gmask);
+
+            a = vmulq_u32(vshrq_n_u32(d, 24), veorq_u32(alpha, opaque));
+            a = vaddq_u32(alpha, vshrq_n_u32(a, 8));
+
+            rb = vorrq_u32(vorrq_u32(rb, g), vshlq_n_u32(a, 24));
+            rb = vbslq_u32(vceqq_u32(alpha, zero), d, rb);
+            rb = vbslq_u32(vceqq_u32(alpha, opaque), s, rb);
+            vst1q_u32(dstp, rb);
+        }
+        while (n--) {
+            *dstp = BlendRGBtoRGBPixelAlpha(*srcp, *dstp);
+            ++srcp;
+            ++dstp;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+/* RGB888/BGR888 blending with surface alpha, 4 pixels at a time */
+static void
+BlitRGBtoRGBSurfaceAlphaNEON(SDL_BlitInfo * info)
+{
+    int width = info->dst_w;
+    int height = info->dst_h;
+    Uint32 *srcp = (Uint32 *) info->src;
+    int srcskip = info->src_skip >> 2;
+    Uint32 *dstp = (Uint32 *) info->dst;
+    int dstskip = info->dst_skip >> 2;
+    const Uint32 alpha = info->a;
+    const uint32x4_t rbmask = vdupq_n_u32(0x00ff00ff);
+    const uint32x4_t gmask = vdupq_n_u32(0x0000ff00);
+    const uint32x4_t amask = vdupq_n_u32(0xff000000);
+    const uint32x4_t halfmask = vdupq_n_u32(0x00fefefe);
+    const uint32x4_t lowmask = vdupq_n_u32(0x00010101);
+    const uint32x4_t mm_alpha = vdupq_n_u32(alpha);
+
+    while (height--) {
+        int n = width;
+
+        for ( ; n >= 4; n -= 4, srcp += 4, dstp += 4) {
+            const uint32x4_t s = vld1q_u32(srcp);
+            const uint32x4_t d = vld1q_u32(dstp);
+            uint32x4_t rb, g;
+
+            if (alpha == 128) {
+                rb = vshrq_n_u32(vaddq_u32(vandq_u32(s, halfmask), vandq_u32(d, halfmask)), 1);
+                rb = vaddq_u32(rb, vandq_u32(vandq_u32(s, d), lowmask));
+            } else {
+                rb = vandq_u32(d, rbmask);
+                rb = vaddq_u32(rb, vshrq_n_u32(vmulq_u32(vsubq_u32(vandq_u32(s, rbmask), rb), mm_alpha), 8));
+                rb = vandq_u32(rb, rbmask);
+
+                g = vandq_u32(d, gmask);
+                g = vaddq_u32(g, vshrq_n_u32(vmulq_u32(vsubq_u32(vandq_u32(s, gmask), g), mm_alpha), 8));
+                g = vandq_u32(g, gmask);
+                rb = vorrq_u32(rb, g);
+            }
+            vst1q_u32(dstp, vorrq_u32(rb, amask));
+        }
+        while (n--) {
+            *dstp = BlendRGBtoRGBSurfaceAlpha(*srcp, *dstp, alpha);
+            ++srcp;
+            ++dstp;
+        }
+        srcp += srcskip;
+        dstp += dstskip;
+    }
+}
+
+#endif /* HAVE_NEON_INTRINSICS */
+
 #ifdef __3dNOW__
 /* fast (as in MMX with prefetch) ARGB888->(A)RGB888 blending with pixel alpha */
 static void
@@ -1294,6 +1571,16 @@ SDL_CalculateBlitA(SDL_Surface * surface)
             if (sf->Rmask == df->Rmask
                 && sf->Gmask == df->Gmask
                 && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
+#if HAVE_AVX2_INTRINSICS
+                if (sf->Amask == 0xff000000 && sf->Gmask == 0xff00
+                    && SDL_HasAVX2())
+                    return BlitRGBtoRGBPixelAlphaAVX2;
+#endif
+#if HAVE_NEON_INTRINSICS
+                if (sf->Amask == 0xff000000 && sf->Gmask == 0xff00
+                    && SDL_HasNEON())
+                    return BlitRGBtoRGBPixelAlphaNEON;
+#endif
 #if defined(__MMX__) || defined(__3dNOW__)
                 if (sf->Rshift % 8 == 0
                     && sf->Gshift % 8 == 0
@@ -1352,6 +1639,16 @@ SDL_CalculateBlitA(SDL_Surface * surface)
                 if (sf->Rmask == df->Rmask
                     && sf->Gmask == df->Gmask
                     && sf->Bmask == df->Bmask && sf->BytesPerPixel == 4) {
+#if HAVE_AVX2_INTRINSICS
+                    if ((sf->Rmask | sf->Gmask | sf->Bmask) == 0xffffff
+                        && SDL_HasAVX2())
+                        return BlitRGBtoRGBSurfaceAlphaAVX2;
+#endif
+#if HAVE_NEON_INTRINSICS
+                    if ((sf->Rmask | sf->Gmask | sf->Bmask) == 0xffffff
+                        && SDL_HasNEON())
+                        return BlitRGBtoRGBSurfaceAlphaNEON;
+#endif
 #ifdef __MMX__
                     if (sf->Rshift % 8 == 0
                         && sf->Gshift % 8 == 0
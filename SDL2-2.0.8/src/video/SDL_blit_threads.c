@@ -0,0 +1,285 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+#include "SDL_hints.h"
+#include "SDL_thread.h"
+#include "SDL_blit.h"
+
+/* Splitting large blits into bands of rows that run on a pool of threads.
+
+   Every band is an ordinary blit of a few rows, run by the same blit
+   function the whole blit would have used, so the result matches a single
+   threaded blit exactly.  This relies on the blit functions not carrying
+   state from one row to the next, which holds for unscaled blits between
+   formats of at least 8 bits per pixel.
+
+   Other row based conversions, like YUV to RGB, share the pool through
+   SDL_RunBlitJobs().
+ */
+
+/* Blits smaller than this aren't worth waking the threads for */
+#define SDL_BLIT_THREAD_MIN_PIXELS  (256*1024)
+
+/* Each band gets at least this many rows */
+#define SDL_BLIT_THREAD_MIN_ROWS    32
+
+#define SDL_BLIT_MAX_THREADS        16
+
+#if !SDL_THREADS_DISABLED
+
+typedef struct
+{
+    SDL_Thread *thread;
+    SDL_sem *start;
+    int index;
+} SDL_BlitWorker;
+
+static struct
+{
+    SDL_mutex *lock;        /* held for the whole of a threaded blit */
+    SDL_sem *done;
+    SDL_atomic_t quit;
+    SDL_BlitJob job;
+    void *data;
+    int num_jobs;
+    int num_workers;
+    SDL_BlitWorker workers[SDL_BLIT_MAX_THREADS-1];
+} SDL_blit_threads;
+
+static SDL_SpinLock SDL_blit_threads_spinlock;
+
+static int SDLCALL
+SDL_BlitThread(void *data)
+{
+    SDL_BlitWorker *worker = (SDL_BlitWorker *)data;
+
+    for ( ; ; ) {
+        SDL_SemWait(worker->start);
+        if (SDL_AtomicGet(&SDL_blit_threads.quit)) {
+            break;
+        }
+        SDL_blit_threads.job(SDL_blit_threads.data, worker->index, SDL_blit_threads.num_jobs);
+        SDL_SemPost(SDL_blit_threads.done);
+    }
+    return 0;
+}
+
+static SDL_bool
+SDL_CreateBlitThreads(void)
+{
+    SDL_AtomicLock(&SDL_blit_threads_spinlock);
+    if (!SDL_blit_threads.lock) {
+        SDL_blit_threads.done = SDL_CreateSemaphore(0);
+        if (SDL_blit_threads.done) {
+            SDL_mutex *lock = SDL_CreateMutex();
+            if (!lock) {
+                SDL_DestroySemaphore(SDL_blit_threads.done);
+                SDL_blit_threads.done = NULL;
+            }
+            SDL_MemoryBarrierRelease();
+            SDL_blit_threads.lock = lock;
+        }
+    }
+    SDL_AtomicUnlock(&SDL_blit_threads_spinlock);
+
+    return SDL_blit_threads.lock ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Called with the pool locked */
+static int
+SDL_AddBlitThreads(int num_workers)
+{
+    while (SDL_blit_threads.num_workers < num_workers) {
+        SDL_BlitWorker *worker = &SDL_blit_threads.workers[SDL_blit_threads.num_workers];
+
+        worker->start = SDL_CreateSemaphore(0);
+        if (!worker->start) {
+            break;
+        }
+        worker->index = SDL_blit_threads.num_workers;
+        worker->thread = SDL_CreateThread(SDL_BlitThread, "SDLBlit", worker);
+        if (!worker->thread) {
+            SDL_DestroySemaphore(worker->start);
+            worker->start = NULL;
+            break;
+        }
+        ++SDL_blit_threads.num_workers;
+    }
+    return SDL_blit_threads.num_workers;
+}
+
+int
+SDL_GetBlitThreads(int pixels, int rows)
+{
+    const char *hint;
+    int num_threads;
+
+    if (pixels < SDL_BLIT_THREAD_MIN_PIXELS) {
+        return 1;
+    }
+
+    hint = SDL_GetHint(SDL_HINT_BLIT_THREADS);
+    if (!hint) {
+        return 1;
+    }
+    num_threads = SDL_atoi(hint);
+    num_threads = SDL_min(num_threads, SDL_BLIT_MAX_THREADS);
+    num_threads = SDL_min(num_threads, rows / SDL_BLIT_THREAD_MIN_ROWS);
+    return SDL_max(num_threads, 1);
+}
+
+SDL_bool
+SDL_RunBlitJobs(int num_jobs, SDL_BlitJob job, void *data)
+{
+    int i;
+
+    if (num_jobs < 2) {
+        return SDL_FALSE;
+    }
+
+    if (!SDL_blit_threads.lock && !SDL_CreateBlitThreads()) {
+        return SDL_FALSE;
+    }
+
+    /* If another thread is using the pool, blit on this one instead */
+    if (SDL_TryLockMutex(SDL_blit_threads.lock) != 0) {
+        return SDL_FALSE;
+    }
+
+    num_jobs = SDL_min(num_jobs, SDL_AddBlitThreads(num_jobs - 1) + 1);
+    if (num_jobs < 2) {
+        SDL_UnlockMutex(SDL_blit_threads.lock);
+        return SDL_FALSE;
+    }
+
+    SDL_blit_threads.job = job;
+    SDL_blit_threads.data = data;
+    SDL_blit_threads.num_jobs = num_jobs;
+    for (i = 0; i < num_jobs - 1; ++i) {
+        SDL_SemPost(SDL_blit_threads.workers[i].start);
+    }
+
+    /* The last job runs on this thread */
+    job(data, num_jobs - 1, num_jobs);
+
+    for (i = 0; i < num_jobs - 1; ++i) {
+        SDL_SemWait(SDL_blit_threads.done);
+    }
+    SDL_UnlockMutex(SDL_blit_threads.lock);
+
+    return SDL_TRUE;
+}
+
+typedef struct
+{
+    SDL_BlitFunc blit;
+    SDL_BlitInfo *info;
+} SDL_ThreadedBlit;
+
+static void
+SDL_BlitBand(void *data, int band, int num_bands)
+{
+    const SDL_ThreadedBlit *blit = (const SDL_ThreadedBlit *)data;
+    SDL_BlitInfo info = *blit->info;
+    const int rows = info.dst_h / num_bands;
+    const int extra = info.dst_h % num_bands;
+    const int y = band * rows + SDL_min(band, extra);
+
+    info.src += y * info.src_pitch;
+    info.dst += y * info.dst_pitch;
+    info.src_h = info.dst_h = rows + (band < extra ? 1 : 0);
+    blit->blit(&info);
+}
+
+SDL_bool
+SDL_RunThreadedBlit(SDL_Surface * src, SDL_Surface * dst, SDL_BlitFunc blit, SDL_BlitInfo * info)
+{
+    SDL_ThreadedBlit data;
+
+    /* Scaled blits step through the source from row to row, and blits
+       within a surface may depend on the order rows are copied in. */
+    if (info->src_w != info->dst_w || info->src_h != info->dst_h ||
+        src->pixels == dst->pixels) {
+        return SDL_FALSE;
+    }
+
+    /* Bitmap blits keep bit offsets across rows */
+    if (info->src_fmt->BitsPerPixel < 8 || info->dst_fmt->BitsPerPixel < 8) {
+        return SDL_FALSE;
+    }
+
+    data.blit = blit;
+    data.info = info;
+    return SDL_RunBlitJobs(SDL_GetBlitThreads(info->dst_w * info->dst_h, info->dst_h),
+                           SDL_BlitBand, &data);
+}
+
+void
+SDL_QuitBlitThreads(void)
+{
+    int i;
+
+    if (!SDL_blit_threads.lock) {
+        return;
+    }
+
+    SDL_AtomicSet(&SDL_blit_threads.quit, 1);
+    for (i = 0; i < SDL_blit_threads.num_workers; ++i) {
+        SDL_SemPost(SDL_blit_threads.workers[i].start);
+    }
+    for (i = 0; i < SDL_blit_threads.num_workers; ++i) {
+        SDL_WaitThread(SDL_blit_threads.workers[i].thread, NULL);
+        SDL_DestroySemaphore(SDL_blit_threads.workers[i].start);
+    }
+    SDL_DestroySemaphore(SDL_blit_threads.done);
+    SDL_DestroyMutex(SDL_blit_threads.lock);
+    SDL_zero(SDL_blit_threads);
+}
+
+#else
+
+int
+SDL_GetBlitThreads(int pixels, int rows)
+{
+    return 1;
+}
+
+SDL_bool
+SDL_RunBlitJobs(int num_jobs, SDL_BlitJob job, void *data)
+{
+    return SDL_FALSE;
+}
+
+SDL_bool
+SDL_RunThreadedBlit(SDL_Surface * src, SDL_Surface * dst, SDL_BlitFunc blit, SDL_BlitInfo * info)
+{
+    return SDL_FALSE;
+}
+
+void
+SDL_QuitBlitThreads(void)
+{
+}
+
+#endif /* !SDL_THREADS_DISABLED */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -26,145 +26,204 @@
    April 27, 2000 - Sam Lantinga
 */
 
+#include "SDL_atomic.h"
 #include "SDL_video.h"
 #include "SDL_blit.h"
+#include "../cpuinfo/SDL_simd.h"
 
-/* This isn't ready for general consumption yet - it should be folded
-   into the general blitting mechanism.
-*/
+/* Stretching is done a row at a time, using tables that map each destination
+   column and row to the source pixels it comes from.
 
-#if ((defined(_MSC_VER) && defined(_M_IX86))    || \
-     (defined(__WATCOMC__) && defined(__386__)) || \
-     (defined(__GNUC__) && defined(__i386__))) && SDL_ASSEMBLY_ROUTINES
-/* There's a bug with gcc 4.4.1 and -O2 where srcp doesn't get the correct
- * value after the first scanline.  FIXME? */
-/* #define USE_ASM_STRETCH */
-#endif
+   For nearest sampling a table holds the one source pixel for each
+   destination pixel, stepping through the source the way SDL always has.
 
-#ifdef USE_ASM_STRETCH
+   For linear filtering a table holds the two source pixels on either side of
+   the destination pixel's center, and the weight of the second one in 1/256
+   units.  Each source row is first filtered horizontally into a row of the
+   destination width, and pairs of those rows are then blended vertically.
+   Every channel is computed as (a * (256 - w) + b * w + 128) >> 8, in C and
+   in each SIMD kernel, so the result doesn't depend on the CPU.
 
-#ifdef HAVE_MPROTECT
-#include <sys/types.h>
-#include <sys/mman.h>
-#endif
-#ifdef __GNUC__
-#define PAGE_ALIGNED __attribute__((__aligned__(4096)))
-#else
-#define PAGE_ALIGNED
-#endif
+   The tables for the last few sizes are kept, since the same sizes tend to be
+   stretched over and over.
+ */
 
-#if defined(_M_IX86) || defined(__i386__) || defined(__386__)
-#define PREFIX16    0x66
-#define STORE_BYTE  0xAA
-#define STORE_WORD  0xAB
-#define LOAD_BYTE   0xAC
-#define LOAD_WORD   0xAD
-#define RETURN      0xC3
-#else
-#error Need assembly opcodes for this architecture
-#endif
+#define SDL_STRETCH_CACHE_SIZE  8
 
-static unsigned char copy_row[4096] PAGE_ALIGNED;
-
-static int
-generate_rowbytes(int src_w, int dst_w, int bpp)
+typedef struct SDL_StretchTable
 {
-    static struct
-    {
-        int bpp;
-        int src_w;
-        int dst_w;
-        int status;
-    } last;
+    int src_len;
+    int dst_len;
+    SDL_bool linear;
+    int *offsets;           /* first source pixel */
+    int *offsets1;          /* second source pixel, linear only */
+    Uint16 *weights;        /* weight of the second pixel, linear only */
+    struct SDL_StretchTable *next;
+} SDL_StretchTable;
 
-    int i;
-    int pos, inc;
-    unsigned char *eip, *fence;
-    unsigned char load, store;
+static SDL_StretchTable *SDL_stretch_cache;
+static SDL_SpinLock SDL_stretch_cache_lock;
 
-    /* See if we need to regenerate the copy buffer */
-    if ((src_w == last.src_w) && (dst_w == last.dst_w) && (bpp == last.bpp)) {
-        return (last.status);
-    }
-    last.bpp = bpp;
-    last.src_w = src_w;
-    last.dst_w = dst_w;
-    last.status = -1;
+static SDL_StretchTable *
+SDL_CreateStretchTable(int src_len, int dst_len, SDL_bool linear)
+{
+    SDL_StretchTable *table;
+    size_t size;
+    int i;
 
-    switch (bpp) {
-    case 1:
-        load = LOAD_BYTE;
-        store = STORE_BYTE;
-        break;
-    case 2:
-    case 4:
-        load = LOAD_WORD;
-        store = STORE_WORD;
-        break;
-    default:
-        return SDL_SetError("ASM stretch of %d bytes isn't supported", bpp);
+    size = sizeof(*table) + dst_len * sizeof(int);
+    if (linear) {
+        size += dst_len * (sizeof(int) + sizeof(Uint16));
     }
-#ifdef HAVE_MPROTECT
-    /* Make the code writeable */
-    if (mprotect(copy_row, sizeof(copy_row), PROT_READ | PROT_WRITE) < 0) {
-        return SDL_SetError("Couldn't make copy buffer writeable");
+    table = (SDL_StretchTable *) SDL_malloc(size);
+    if (!table) {
+        SDL_OutOfMemory();
+        return NULL;
     }
-#endif
-    pos = 0x10000;
-    inc = (src_w << 16) / dst_w;
-    eip = copy_row;
-    fence = copy_row + sizeof(copy_row)-2;
-    for (i = 0; i < dst_w; ++i) {
-        while (pos >= 0x10000L) {
-            if (eip == fence) {
-                return -1;
+    table->src_len = src_len;
+    table->dst_len = dst_len;
+    table->linear = linear;
+    table->offsets = (int *) (table + 1);
+    table->next = NULL;
+
+    if (linear) {
+        table->offsets1 = table->offsets + dst_len;
+        table->weights = (Uint16 *) (table->offsets1 + dst_len);
+
+        for (i = 0; i < dst_len; ++i) {
+            /* Source position of the destination pixel center, in 1/256 pixels */
+            Sint64 pos = (((Sint64) (2 * i + 1) * src_len - dst_len) * 256) / (2 * (Sint64) dst_len);
+            int x;
+
+            if (pos < 0) {
+                pos = 0;
             }
-            if (bpp == 2) {
-                *eip++ = PREFIX16;
+            x = (int) (pos >> 8);
+            if (x >= src_len - 1) {
+                table->offsets[i] = src_len - 1;
+                table->offsets1[i] = src_len - 1;
+                table->weights[i] = 0;
+            } else {
+                table->offsets[i] = x;
+                table->offsets1[i] = x + 1;
+                table->weights[i] = (Uint16) (pos & 0xFF);
             }
-            *eip++ = load;
-            pos -= 0x10000L;
         }
-        if (eip == fence) {
-            return -1;
+    } else {
+        int pos = 0x10000;
+        int inc = (src_len << 16) / dst_len;
+        int x = -1;
+
+        table->offsets1 = NULL;
+        table->weights = NULL;
+
+        for (i = 0; i < dst_len; ++i) {
+            while (pos >= 0x10000L) {
+                ++x;
+                pos -= 0x10000L;
+            }
+            table->offsets[i] = x;
+            pos += inc;
         }
-        if (bpp == 2) {
-            *eip++ = PREFIX16;
+    }
+    return table;
+}
+
+static SDL_StretchTable *
+SDL_GetStretchTable(int src_len, int dst_len, SDL_bool linear)
+{
+    SDL_StretchTable *table, *prev = NULL;
+
+    /* Take the table out of the cache while we use it */
+    SDL_AtomicLock(&SDL_stretch_cache_lock);
+    for (table = SDL_stretch_cache; table; prev = table, table = table->next) {
+        if (table->src_len == src_len && table->dst_len == dst_len &&
+            table->linear == linear) {
+            if (prev) {
+                prev->next = table->next;
+            } else {
+                SDL_stretch_cache = table->next;
+            }
+            table->next = NULL;
+            break;
         }
-        *eip++ = store;
-        pos += inc;
     }
-    *eip++ = RETURN;
+    SDL_AtomicUnlock(&SDL_stretch_cache_lock);
 
-#ifdef HAVE_MPROTECT
-    /* Make the code executable but not writeable */
-    if (mprotect(copy_row, sizeof(copy_row), PROT_READ | PROT_EXEC) < 0) {
-        return SDL_SetError("Couldn't make copy buffer executable");
+    if (!table) {
+        table = SDL_CreateStretchTable(src_len, dst_len, linear);
     }
-#endif
-    last.status = 0;
-    return (0);
+    return table;
 }
 
-#endif /* USE_ASM_STRETCH */
-
-#define DEFINE_COPY_ROW(name, type)         \
-static void name(type *src, int src_w, type *dst, int dst_w)    \
-{                                           \
-    int i;                                  \
-    int pos, inc;                           \
-    type pixel = 0;                         \
-                                            \
-    pos = 0x10000;                          \
-    inc = (src_w << 16) / dst_w;            \
-    for ( i=dst_w; i>0; --i ) {             \
-        while ( pos >= 0x10000L ) {         \
-            pixel = *src++;                 \
-            pos -= 0x10000L;                \
-        }                                   \
-        *dst++ = pixel;                     \
-        pos += inc;                         \
-    }                                       \
+static void
+SDL_ReleaseStretchTable(SDL_StretchTable * table)
+{
+    SDL_StretchTable *last = NULL;
+    int count = 0;
+
+    if (!table) {
+        return;
+    }
+
+    /* Put the table back at the front and drop the oldest one if full */
+    SDL_AtomicLock(&SDL_stretch_cache_lock);
+    table->next = SDL_stretch_cache;
+    SDL_stretch_cache = table;
+    for (table = SDL_stretch_cache; table; table = table->next) {
+        if (++count == SDL_STRETCH_CACHE_SIZE) {
+            last = table;
+            break;
+        }
+    }
+    if (last) {
+        table = last->next;
+        last->next = NULL;
+    } else {
+        table = NULL;
+    }
+    SDL_AtomicUnlock(&SDL_stretch_cache_lock);
+
+    while (table) {
+        SDL_StretchTable *next = table->next;
+        SDL_free(table);
+        table = next;
+    }
+}
+
+void
+SDL_QuitStretch(void)
+{
+    SDL_StretchTable *table;
+
+    SDL_AtomicLock(&SDL_stretch_cache_lock);
+    table = SDL_stretch_cache;
+    SDL_stretch_cache = NULL;
+    SDL_AtomicUnlock(&SDL_stretch_cache_lock);
+
+    while (table) {
+        SDL_StretchTable *next = table->next;
+        SDL_free(table);
+        table = next;
+    }
+}
+
+
+/* Nearest sampling */
+
+typedef void (*SDL_StretchRowFunc) (const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w);
+
+#define DEFINE_COPY_ROW(name, type)                                         \
+static void name(const Uint8 *src, Uint8 *dst, const SDL_StretchTable *table, int x, int w) \
+{                                                                           \
+    const type *srcp = (const type *) src;                                  \
+    type *dstp = (type *) dst;                                              \
+    const int *offsets = table->offsets + x;                                \
+    int i;                                                                  \
+                                                                            \
+    for (i = 0; i < w; ++i) {                                               \
+        dstp[i] = srcp[offsets[i]];                                         \
+    }                                                                       \
 }
 /* *INDENT-OFF* */
 DEFINE_COPY_ROW(copy_row1, Uint8)
@@ -172,84 +231,402 @@ DEFINE_COPY_ROW(copy_row2, Uint16)
 DEFINE_COPY_ROW(copy_row4, Uint32)
 /* *INDENT-ON* */
 
-/* The ASM code doesn't handle 24-bpp stretch blits */
 static void
-copy_row3(Uint8 * src, int src_w, Uint8 * dst, int dst_w)
+copy_row3(const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w)
 {
+    const int *offsets = table->offsets + x;
     int i;
-    int pos, inc;
-    Uint8 pixel[3] = { 0, 0, 0 };
-
-    pos = 0x10000;
-    inc = (src_w << 16) / dst_w;
-    for (i = dst_w; i > 0; --i) {
-        while (pos >= 0x10000L) {
-            pixel[0] = *src++;
-            pixel[1] = *src++;
-            pixel[2] = *src++;
-            pos -= 0x10000L;
-        }
+
+    for (i = 0; i < w; ++i) {
+        const Uint8 *pixel = src + offsets[i] * 3;
         *dst++ = pixel[0];
         *dst++ = pixel[1];
         *dst++ = pixel[2];
-        pos += inc;
     }
 }
 
-/* Perform a stretch blit between two surfaces of the same format.
-   NOTE:  This function is not safe to call from multiple threads!
-*/
+#if HAVE_AVX2_INTRINSICS
+SDL_TARGETING_AVX2 static void
+copy_row4_AVX2(const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w)
+{
+    const int *offsets = table->offsets + x;
+    Uint32 *dstp = (Uint32 *) dst;
+    int i = 0;
+
+    for ( ; i + 8 <= w; i += 8) {
+        const __m256i index = _mm256_loadu_si256((const __m256i *) (offsets + i));
+        _mm256_storeu_si256((__m256i *) (dstp + i), _mm256_i32gather_epi32((const int *) src, index, 4));
+    }
+    for ( ; i < w; ++i) {
+        dstp[i] = ((const Uint32 *) src)[offsets[i]];
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+
+/* Linear filtering, on 32-bit pixels with 8-bit channels */
+
+typedef void (*SDL_BlendRowsFunc) (const Uint32 * row0, const Uint32 * row1, Uint32 * dst, int w, int weight);
+
+static SDL_INLINE Uint32
+SDL_LerpPixel(Uint32 a, Uint32 b, Uint32 weight)
+{
+    /* Two channels at a time, each fits in 16 bits */
+    const Uint32 inv = 256 - weight;
+    const Uint32 rb = (((a & 0x00FF00FF) * inv + (b & 0x00FF00FF) * weight + 0x00800080) >> 8) & 0x00FF00FF;
+    const Uint32 ag = (((a >> 8) & 0x00FF00FF) * inv + ((b >> 8) & 0x00FF00FF) * weight + 0x00800080) & 0xFF00FF00;
+    return rb | ag;
+}
+
+static void
+SDL_StretchRowLinear(const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w)
+{
+    const Uint32 *srcp = (const Uint32 *) src;
+    Uint32 *dstp = (Uint32 *) dst;
+    const int *offsets = table->offsets + x;
+    const int *offsets1 = table->offsets1 + x;
+    const Uint16 *weights = table->weights + x;
+    int i;
+
+    for (i = 0; i < w; ++i) {
+        dstp[i] = SDL_LerpPixel(srcp[offsets[i]], srcp[offsets1[i]], weights[i]);
+    }
+}
+
+static void
+SDL_BlendRows(const Uint32 * row0, const Uint32 * row1, Uint32 * dst, int w, int weight)
+{
+    int i;
+
+    for (i = 0; i < w; ++i) {
+        dst[i] = SDL_LerpPixel(row0[i], row1[i], weight);
+    }
+}
+
+#ifdef __SSE2__
+static void
+SDL_StretchRowLinear_SSE2(const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w)
+{
+    const Uint32 *srcp = (const Uint32 *) src;
+    Uint32 *dstp = (Uint32 *) dst;
+    const int *offsets = table->offsets + x;
+    const int *offsets1 = table->offsets1 + x;
+    const Uint16 *weights = table->weights + x;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i full = _mm_set1_epi16(256);
+    const __m128i half = _mm_set1_epi16(128);
+    int i = 0;
+
+    for ( ; i + 4 <= w; i += 4) {
+        const __m128i p0 = _mm_setr_epi32(srcp[offsets[i]], srcp[offsets[i+1]], srcp[offsets[i+2]], srcp[offsets[i+3]]);
+        const __m128i p1 = _mm_setr_epi32(srcp[offsets1[i]], srcp[offsets1[i+1]], srcp[offsets1[i+2]], srcp[offsets1[i+3]]);
+        __m128i wt, w1lo, w1hi, lo, hi;
+
+        /* Each pixel's weight in its four channels */
+        wt = _mm_loadl_epi64((const __m128i *) (weights + i));
+        wt = _mm_unpacklo_epi16(wt, wt);
+        w1lo = _mm_unpacklo_epi32(wt, wt);
+        w1hi = _mm_unpackhi_epi32(wt, wt);
+
+        lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p0, zero), _mm_sub_epi16(full, w1lo)),
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(p1, zero), w1lo));
+        hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p0, zero), _mm_sub_epi16(full, w1hi)),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(p1, zero), w1hi));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, half), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, half), 8);
+        _mm_storeu_si128((__m128i *) (dstp + i), _mm_packus_epi16(lo, hi));
+    }
+    for ( ; i < w; ++i) {
+        dstp[i] = SDL_LerpPixel(srcp[offsets[i]], srcp[offsets1[i]], weights[i]);
+    }
+}
+
+static void
+SDL_BlendRows_SSE2(const Uint32 * row0, const Uint32 * row1, Uint32 * dst, int w, int weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w0 = _mm_set1_epi16(256 - weight);
+    const __m128i w1 = _mm_set1_epi16(weight);
+    const __m128i half = _mm_set1_epi16(128);
+    int i = 0;
+
+    for ( ; i + 4 <= w; i += 4) {
+        const __m128i p0 = _mm_loadu_si128((const __m128i *) (row0 + i));
+        const __m128i p1 = _mm_loadu_si128((const __m128i *) (row1 + i));
+        __m128i lo, hi;
+
+        lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(p0, zero), w0),
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(p1, zero), w1));
+        hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(p0, zero), w0),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(p1, zero), w1));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, half), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, half), 8);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+    for ( ; i < w; ++i) {
+        dst[i] = SDL_LerpPixel(row0[i], row1[i], weight);
+    }
+}
+#endif /* __SSE2__ */
+
+#if HAVE_AVX2_INTRINSICS
+SDL_TARGETING_AVX2 static void
+SDL_StretchRowLinear_AVX2(const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w)
+{
+    const Uint32 *srcp = (const Uint32 *) src;
+    Uint32 *dstp = (Uint32 *) dst;
+    const int *offsets = table->offsets + x;
+    const int *offsets1 = table->offsets1 + x;
+    const Uint16 *weights = table->weights + x;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i full = _mm256_set1_epi16(256);
+    const __m256i half = _mm256_set1_epi16(128);
+    int i = 0;
+
+    for ( ; i + 8 <= w; i += 8) {
+        const __m256i p0 = _mm256_i32gather_epi32((const int *) srcp, _mm256_loadu_si256((const __m256i *) (offsets + i)), 4);
+        const __m256i p1 = _mm256_i32gather_epi32((const int *) srcp, _mm256_loadu_si256((const __m256i *) (offsets1 + i)), 4);
+        __m256i wt, w1lo, w1hi, lo, hi;
+
+        /* Each pixel's weight in its four channels, matching the in-lane unpacks */
+        wt = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *) (weights + i)));
+        wt = _mm256_or_si256(wt, _mm256_slli_epi32(wt, 16));
+        w1lo = _mm256_unpacklo_epi32(wt, wt);
+        w1hi = _mm256_unpackhi_epi32(wt, wt);
+
+        lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(p0, zero), _mm256_sub_epi16(full, w1lo)),
+                              _mm256_mullo_epi16(_mm256_unpacklo_epi8(p1, zero), w1lo));
+        hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(p0, zero), _mm256_sub_epi16(full, w1hi)),
+                              _mm256_mullo_epi16(_mm256_unpackhi_epi8(p1, zero), w1hi));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, half), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, half), 8);
+        _mm256_storeu_si256((__m256i *) (dstp + i), _mm256_packus_epi16(lo, hi));
+    }
+    for ( ; i < w; ++i) {
+        dstp[i] = SDL_LerpPixel(srcp[offsets[i]], srcp[offsets1[i]], weights[i]);
+    }
+}
+
+SDL_TARGETING_AVX2 static void
+SDL_BlendRows_AVX2(const Uint32 * row0, const Uint32 * row1, Uint32 * dst, int w, int weight)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i w0 = _mm256_set1_epi16(256 - weight);
+    const __m256i w1 = _mm256_set1_epi16(weight);
+    const __m256i half = _mm256_set1_epi16(128);
+    int i = 0;
+
+    for ( ; i + 8 <= w; i += 8) {
+        const __m256i p0 = _mm256_loadu_si256((const __m256i *) (row0 + i));
+        const __m256i p1 = _mm256_loadu_si256((const __m256i *) (row1 + i));
+        __m256i lo, hi;
+
+        lo = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(p0, zero), w0),
+                              _mm256_mullo_epi16(_mm256_unpacklo_epi8(p1, zero), w1));
+        hi = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(p0, zero), w0),
+                              _mm256_mullo_epi16(_mm256_unpackhi_epi8(p1, zero), w1));
+        lo = _mm256_srli_epi16(_mm256_add_epi16(lo, half), 8);
+        hi = _mm256_srli_epi16(_mm256_add_epi16(hi, half), 8);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_packus_epi16(lo, hi));
+    }
+    for ( ; i < w; ++i) {
+        dst[i] = SDL_LerpPixel(row0[i], row1[i], weight);
+    }
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
+#if HAVE_NEON_INTRINSICS
+static void
+SDL_StretchRowLinear_NEON(const Uint8 * src, Uint8 * dst, const SDL_StretchTable * table, int x, int w)
+{
+    const Uint32 *srcp = (const Uint32 *) src;
+    Uint32 *dstp = (Uint32 *) dst;
+    const int *offsets = table->offsets + x;
+    const int *offsets1 = table->offsets1 + x;
+    const Uint16 *weights = table->weights + x;
+    int i = 0;
+
+    for ( ; i + 2 <= w; i += 2) {
+        uint32x2_t p0 = vdup_n_u32(0), p1 = vdup_n_u32(0);
+        uint16x8_t w1, sum;
+
+        p0 = vset_lane_u32(srcp[offsets[i]], p0, 0);
+        p0 = vset_lane_u32(srcp[offsets[i+1]], p0, 1);
+        p1 = vset_lane_u32(srcp[offsets1[i]], p1, 0);
+        p1 = vset_lane_u32(srcp[offsets1[i+1]], p1, 1);
+        w1 = vcombine_u16(vdup_n_u16(weights[i]), vdup_n_u16(weights[i+1]));
+
+        sum = vmulq_u16(vmovl_u8(vreinterpret_u8_u32(p0)), vsubq_u16(vdupq_n_u16(256), w1));
+        sum = vmlaq_u16(sum, vmovl_u8(vreinterpret_u8_u32(p1)), w1);
+        vst1_u32(dstp + i, vreinterpret_u32_u8(vrshrn_n_u16(sum, 8)));
+    }
+    for ( ; i < w; ++i) {
+        dstp[i] = SDL_LerpPixel(srcp[offsets[i]], srcp[offsets1[i]], weights[i]);
+    }
+}
+
+static void
+SDL_BlendRows_NEON(const Uint32 * row0, const Uint32 * row1, Uint32 * dst, int w, int weight)
+{
+    const uint16x8_t w0 = vdupq_n_u16(256 - weight);
+    const uint16x8_t w1 = vdupq_n_u16(weight);
+    int i = 0;
+
+    for ( ; i + 4 <= w; i += 4) {
+        const uint8x16_t p0 = vreinterpretq_u8_u32(vld1q_u32(row0 + i));
+        const uint8x16_t p1 = vreinterpretq_u8_u32(vld1q_u32(row1 + i));
+        uint16x8_t lo, hi;
+
+        lo = vmlaq_u16(vmulq_u16(vmovl_u8(vget_low_u8(p0)), w0), vmovl_u8(vget_low_u8(p1)), w1);
+        hi = vmlaq_u16(vmulq_u16(vmovl_u8(vget_high_u8(p0)), w0), vmovl_u8(vget_high_u8(p1)), w1);
+        vst1q_u32(dst + i, vreinterpretq_u32_u8(vcombine_u8(vrshrn_n_u16(lo, 8), vrshrn_n_u16(hi, 8))));
+    }
+    for ( ; i < w; ++i) {
+        dst[i] = SDL_LerpPixel(row0[i], row1[i], weight);
+    }
+}
+#endif /* HAVE_NEON_INTRINSICS */
+
+
+static void
+SDL_StretchNearest(const Uint8 * src, int src_pitch, Uint8 * dst, int dst_pitch, int bpp,
+                   const SDL_StretchTable * xtable, const SDL_StretchTable * ytable,
+                   int x, int y, int w, int h)
+{
+    SDL_StretchRowFunc copy_row = NULL;
+    const Uint8 *prev = NULL;
+    int prev_row = -1;
+    int j;
+
+    switch (bpp) {
+    case 1:
+        copy_row = copy_row1;
+        break;
+    case 2:
+        copy_row = copy_row2;
+        break;
+    case 3:
+        copy_row = copy_row3;
+        break;
+    case 4:
+        copy_row = copy_row4;
+#if HAVE_AVX2_INTRINSICS
+        if (SDL_HasAVX2()) {
+            copy_row = copy_row4_AVX2;
+        }
+#endif
+        break;
+    }
+
+    for (j = 0; j < h; ++j, dst += dst_pitch) {
+        const int src_row = ytable->offsets[y + j];
+
+        if (src_row == prev_row) {
+            /* Same source row as the last one, just copy that */
+            SDL_memcpy(dst, prev, w * bpp);
+        } else {
+            copy_row(src + src_row * src_pitch, dst, xtable, x, w);
+            prev = dst;
+            prev_row = src_row;
+        }
+    }
+}
+
+static int
+SDL_StretchLinear(const Uint8 * src, int src_pitch, Uint8 * dst, int dst_pitch,
+                  const SDL_StretchTable * xtable, const SDL_StretchTable * ytable,
+                  int x, int y, int w, int h)
+{
+    SDL_StretchRowFunc stretch_row = SDL_StretchRowLinear;
+    SDL_BlendRowsFunc blend_rows = SDL_BlendRows;
+    Uint32 *buffer, *rows[2], *swap;
+    int row_index[2] = { -1, -1 };
+    int j;
+
+#ifdef __SSE2__
+    if (SDL_HasSSE2()) {
+        stretch_row = SDL_StretchRowLinear_SSE2;
+        blend_rows = SDL_BlendRows_SSE2;
+    }
+#endif
+#if HAVE_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        stretch_row = SDL_StretchRowLinear_AVX2;
+        blend_rows = SDL_BlendRows_AVX2;
+    }
+#endif
+#if HAVE_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        stretch_row = SDL_StretchRowLinear_NEON;
+        blend_rows = SDL_BlendRows_NEON;
+    }
+#endif
+
+    buffer = (Uint32 *) SDL_malloc(2 * w * sizeof(Uint32));
+    if (!buffer) {
+        return SDL_OutOfMemory();
+    }
+    rows[0] = buffer;
+    rows[1] = buffer + w;
+
+    for (j = 0; j < h; ++j, dst += dst_pitch) {
+        const int y0 = ytable->offsets[y + j];
+        const int y1 = ytable->offsets1[y + j];
+        const int weight = ytable->weights[y + j];
+
+        /* Filter the two source rows horizontally, reusing what we can */
+        if (row_index[0] != y0) {
+            if (row_index[1] == y0) {
+                swap = rows[0];
+                rows[0] = rows[1];
+                rows[1] = swap;
+                row_index[1] = row_index[0];
+                row_index[0] = y0;
+            } else {
+                stretch_row(src + y0 * src_pitch, (Uint8 *) rows[0], xtable, x, w);
+                row_index[0] = y0;
+            }
+        }
+        if (weight == 0) {
+            SDL_memcpy(dst, rows[0], w * sizeof(Uint32));
+            continue;
+        }
+        if (row_index[1] != y1) {
+            stretch_row(src + y1 * src_pitch, (Uint8 *) rows[1], xtable, x, w);
+            row_index[1] = y1;
+        }
+        blend_rows(rows[0], rows[1], (Uint32 *) dst, w, weight);
+    }
+
+    SDL_free(buffer);
+    return 0;
+}
+
+/* Stretch srcrect to a scaled_w x scaled_h image, and write the part of it
+   starting at (x, y) into dstrect, which has to fit in that image. */
 int
-SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
-                SDL_Surface * dst, const SDL_Rect * dstrect)
+SDL_PrivateSoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
+                       SDL_Surface * dst, const SDL_Rect * dstrect,
+                       int scaled_w, int scaled_h, int x, int y,
+                       SDL_bool linear)
 {
+    SDL_StretchTable *xtable = NULL, *ytable = NULL;
     int src_locked;
     int dst_locked;
-    int pos, inc;
-    int dst_maxrow;
-    int src_row, dst_row;
-    Uint8 *srcp = NULL;
+    int retval = 0;
+    const Uint8 *srcp;
     Uint8 *dstp;
-    SDL_Rect full_src;
-    SDL_Rect full_dst;
-#ifdef USE_ASM_STRETCH
-    SDL_bool use_asm = SDL_TRUE;
-#ifdef __GNUC__
-    int u1, u2;
-#endif
-#endif /* USE_ASM_STRETCH */
     const int bpp = dst->format->BytesPerPixel;
 
     if (src->format->format != dst->format->format) {
         return SDL_SetError("Only works with same format surfaces");
     }
-
-    /* Verify the blit rectangles */
-    if (srcrect) {
-        if ((srcrect->x < 0) || (srcrect->y < 0) ||
-            ((srcrect->x + srcrect->w) > src->w) ||
-            ((srcrect->y + srcrect->h) > src->h)) {
-            return SDL_SetError("Invalid source blit rectangle");
-        }
-    } else {
-        full_src.x = 0;
-        full_src.y = 0;
-        full_src.w = src->w;
-        full_src.h = src->h;
-        srcrect = &full_src;
+    if (linear && (bpp != 4 || SDL_ISPIXELFORMAT_INDEXED(src->format->format) ||
+                   src->format->Rloss || src->format->Gloss || src->format->Bloss)) {
+        return SDL_SetError("Linear stretching only works with 32-bit surfaces");
     }
-    if (dstrect) {
-        if ((dstrect->x < 0) || (dstrect->y < 0) ||
-            ((dstrect->x + dstrect->w) > dst->w) ||
-            ((dstrect->y + dstrect->h) > dst->h)) {
-            return SDL_SetError("Invalid destination blit rectangle");
-        }
-    } else {
-        full_dst.x = 0;
-        full_dst.y = 0;
-        full_dst.w = dst->w;
-        full_dst.h = dst->h;
-        dstrect = &full_dst;
+    if (dstrect->w <= 0 || dstrect->h <= 0 || srcrect->w <= 0 || srcrect->h <= 0) {
+        return 0;
     }
 
     /* Lock the destination if it's in hardware */
@@ -272,73 +649,23 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
         src_locked = 1;
     }
 
-    /* Set up the data... */
-    pos = 0x10000;
-    inc = (srcrect->h << 16) / dstrect->h;
-    src_row = srcrect->y;
-    dst_row = dstrect->y;
-
-#ifdef USE_ASM_STRETCH
-    /* Write the opcodes for this stretch */
-    if ((bpp == 3) || (generate_rowbytes(srcrect->w, dstrect->w, bpp) < 0)) {
-        use_asm = SDL_FALSE;
-    }
-#endif
-
-    /* Perform the stretch blit */
-    for (dst_maxrow = dst_row + dstrect->h; dst_row < dst_maxrow; ++dst_row) {
-        dstp = (Uint8 *) dst->pixels + (dst_row * dst->pitch)
-            + (dstrect->x * bpp);
-        while (pos >= 0x10000L) {
-            srcp = (Uint8 *) src->pixels + (src_row * src->pitch)
-                + (srcrect->x * bpp);
-            ++src_row;
-            pos -= 0x10000L;
+    xtable = SDL_GetStretchTable(srcrect->w, scaled_w, linear);
+    ytable = SDL_GetStretchTable(srcrect->h, scaled_h, linear);
+    if (!xtable || !ytable) {
+        retval = -1;
+    } else {
+        srcp = (const Uint8 *) src->pixels + srcrect->y * src->pitch + srcrect->x * bpp;
+        dstp = (Uint8 *) dst->pixels + dstrect->y * dst->pitch + dstrect->x * bpp;
+        if (linear) {
+            retval = SDL_StretchLinear(srcp, src->pitch, dstp, dst->pitch,
+                                       xtable, ytable, x, y, dstrect->w, dstrect->h);
+        } else {
+            SDL_StretchNearest(srcp, src->pitch, dstp, dst->pitch, bpp,
+                               xtable, ytable, x, y, dstrect->w, dstrect->h);
         }
-#ifdef USE_ASM_STRETCH
-        if (use_asm) {
-#ifdef __GNUC__
-            __asm__ __volatile__("call *%4":"=&D"(u1), "=&S"(u2)
-                                 :"0"(dstp), "1"(srcp), "r"(copy_row)
-                                 :"memory");
-#elif defined(_MSC_VER) || defined(__WATCOMC__)
-            /* *INDENT-OFF* */
-            {
-                void *code = copy_row;
-                __asm {
-                    push edi
-                    push esi
-                    mov edi, dstp
-                    mov esi, srcp
-                    call dword ptr code
-                    pop esi
-                    pop edi
-                }
-            }
-            /* *INDENT-ON* */
-#else
-#error Need inline assembly for this compiler
-#endif
-        } else
-#endif
-            switch (bpp) {
-            case 1:
-                copy_row1(srcp, srcrect->w, dstp, dstrect->w);
-                break;
-            case 2:
-                copy_row2((Uint16 *) srcp, srcrect->w,
-                          (Uint16 *) dstp, dstrect->w);
-                break;
-            case 3:
-                copy_row3(srcp, srcrect->w, dstp, dstrect->w);
-                break;
-            case 4:
-                copy_row4((Uint32 *) srcp, srcrect->w,
-                          (Uint32 *) dstp, dstrect->w);
-                break;
-            }
-        pos += inc;
     }
+    SDL_ReleaseStretchTable(xtable);
+    SDL_ReleaseStretchTable(ytable);
 
     /* We need to unlock the surfaces if they're locked */
     if (dst_locked) {
@@ -347,7 +674,63 @@ SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
     if (src_locked) {
         SDL_UnlockSurface(src);
     }
-    return (0);
+    return retval;
+}
+
+static int
+SDL_StretchSurface(SDL_Surface * src, const SDL_Rect * srcrect,
+                   SDL_Surface * dst, const SDL_Rect * dstrect,
+                   SDL_bool linear)
+{
+    SDL_Rect full_src;
+    SDL_Rect full_dst;
+
+    /* Verify the blit rectangles */
+    if (srcrect) {
+        if ((srcrect->x < 0) || (srcrect->y < 0) ||
+            ((srcrect->x + srcrect->w) > src->w) ||
+            ((srcrect->y + srcrect->h) > src->h)) {
+            return SDL_SetError("Invalid source blit rectangle");
+        }
+    } else {
+        full_src.x = 0;
+        full_src.y = 0;
+        full_src.w = src->w;
+        full_src.h = src->h;
+        srcrect = &full_src;
+    }
+    if (dstrect) {
+        if ((dstrect->x < 0) || (dstrect->y < 0) ||
+            ((dstrect->x + dstrect->w) > dst->w) ||
+            ((dstrect->y + dstrect->h) > dst->h)) {
+            return SDL_SetError("Invalid destination blit rectangle");
+        }
+    } else {
+        full_dst.x = 0;
+        full_dst.y = 0;
+        full_dst.w = dst->w;
+        full_dst.h = dst->h;
+        dstrect = &full_dst;
+    }
+
+    return SDL_PrivateSoftStretch(src, srcrect, dst, dstrect,
+                                  dstrect->w, dstrect->h, 0, 0, linear);
+}
+
+/* Perform a stretch blit between two surfaces of the same format. */
+int
+SDL_SoftStretch(SDL_Surface * src, const SDL_Rect * srcrect,
+                SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    return SDL_StretchSurface(src, srcrect, dst, dstrect, SDL_FALSE);
+}
+
+/* Perform a bilinear stretch blit between two 32-bit surfaces of the same format. */
+int
+SDL_SoftStretchLinear(SDL_Surface * src, const SDL_Rect * srcrect,
+                      SDL_Surface * dst, const SDL_Rect * dstrect)
+{
+    return SDL_StretchSurface(src, srcrect, dst, dstrect, SDL_TRUE);
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
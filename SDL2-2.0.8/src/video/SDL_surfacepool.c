@@ -0,0 +1,331 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../SDL_internal.h"
+
+/* Pool of surface pixel buffers, so short lived surfaces don't go back
+   to the heap every time.
+
+   Buffers are rounded up to size classes, four per power of two from 256
+   bytes to 32 MB, and aligned for SIMD. Small classes are cached per
+   thread without any locking, everything else goes to a global free list.
+ */
+
+#include "SDL_hints.h"
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "SDL_surfacepool_c.h"
+
+#define SDL_POOL_ALIGNMENT      64
+
+#define SDL_POOL_MIN_SHIFT      8
+#define SDL_POOL_MAX_SHIFT      25
+#define SDL_POOL_STEPS          4
+#define SDL_POOL_NUM_CLASSES    ((SDL_POOL_MAX_SHIFT-SDL_POOL_MIN_SHIFT)*SDL_POOL_STEPS+1)
+
+/* Classes up to 256 KB are cached per thread */
+#define SDL_POOL_THREAD_SHIFT   18
+#define SDL_POOL_THREAD_CLASSES ((SDL_POOL_THREAD_SHIFT-SDL_POOL_MIN_SHIFT)*SDL_POOL_STEPS+1)
+#define SDL_POOL_THREAD_SLOTS   4
+
+/* Stop keeping free buffers once the pool holds this many bytes */
+#define SDL_POOL_MAX_RETAINED   (64*1024*1024)
+
+/* This sits right before the pixels handed out */
+typedef struct SDL_PoolBuffer
+{
+    void *raw;
+    struct SDL_PoolBuffer *next;
+    int size_class;
+} SDL_PoolBuffer;
+
+typedef struct
+{
+    SDL_PoolBuffer *buffers[SDL_POOL_THREAD_CLASSES][SDL_POOL_THREAD_SLOTS];
+    int count[SDL_POOL_THREAD_CLASSES];
+} SDL_PoolThreadCache;
+
+static struct
+{
+    SDL_SpinLock lock;
+    SDL_TLSID tls;
+    SDL_PoolBuffer *free[SDL_POOL_NUM_CLASSES];
+    SDL_atomic_t hits;
+    SDL_atomic_t misses;
+    SDL_atomic_t buffers_retained;
+    SDL_atomic_t bytes_retained;
+} SDL_surface_pool;
+
+
+static int
+SDL_GetPoolClass(size_t size)
+{
+    int shift, step;
+
+    if (size <= ((size_t)1 << SDL_POOL_MIN_SHIFT)) {
+        return 0;
+    }
+    if (size > ((size_t)1 << SDL_POOL_MAX_SHIFT)) {
+        return -1;
+    }
+
+    /* Find the power of two range, then the step within it */
+    shift = SDL_POOL_MIN_SHIFT;
+    while (((size_t)2 << shift) < size) {
+        ++shift;
+    }
+    step = (int)((size - 1 - ((size_t)1 << shift)) >> (shift - 2)) + 1;
+    return (shift - SDL_POOL_MIN_SHIFT) * SDL_POOL_STEPS + step;
+}
+
+static size_t
+SDL_GetPoolClassSize(int size_class)
+{
+    int shift, step;
+
+    if (size_class == 0) {
+        return ((size_t)1 << SDL_POOL_MIN_SHIFT);
+    }
+    shift = SDL_POOL_MIN_SHIFT + (size_class - 1) / SDL_POOL_STEPS;
+    step = (size_class - 1) % SDL_POOL_STEPS + 1;
+    return ((size_t)1 << shift) + step * ((size_t)1 << (shift - 2));
+}
+
+static SDL_PoolBuffer *
+SDL_CreatePoolBuffer(int size_class)
+{
+    const size_t size = SDL_GetPoolClassSize(size_class);
+    SDL_PoolBuffer *buffer;
+    Uint8 *raw, *pixels;
+
+    raw = (Uint8 *)SDL_malloc(size + sizeof(SDL_PoolBuffer) + SDL_POOL_ALIGNMENT - 1);
+    if (!raw) {
+        return NULL;
+    }
+    pixels = (Uint8 *)(((uintptr_t)raw + sizeof(SDL_PoolBuffer) + SDL_POOL_ALIGNMENT - 1) & ~(uintptr_t)(SDL_POOL_ALIGNMENT - 1));
+    buffer = (SDL_PoolBuffer *)pixels - 1;
+    buffer->raw = raw;
+    buffer->next = NULL;
+    buffer->size_class = size_class;
+    return buffer;
+}
+
+static void
+SDL_DestroyPoolBuffer(SDL_PoolBuffer *buffer)
+{
+    SDL_free(buffer->raw);
+}
+
+/* Put a buffer on the global free list, or free it if the pool is full */
+static void
+SDL_ReleasePoolBufferGlobal(SDL_PoolBuffer *buffer)
+{
+    const int size = (int)SDL_GetPoolClassSize(buffer->size_class);
+
+    if (SDL_AtomicGet(&SDL_surface_pool.bytes_retained) + size > SDL_POOL_MAX_RETAINED) {
+        SDL_DestroyPoolBuffer(buffer);
+        return;
+    }
+
+    SDL_AtomicLock(&SDL_surface_pool.lock);
+    buffer->next = SDL_surface_pool.free[buffer->size_class];
+    SDL_surface_pool.free[buffer->size_class] = buffer;
+    SDL_AtomicUnlock(&SDL_surface_pool.lock);
+
+    SDL_AtomicAdd(&SDL_surface_pool.buffers_retained, 1);
+    SDL_AtomicAdd(&SDL_surface_pool.bytes_retained, size);
+}
+
+static void SDLCALL
+SDL_FreePoolThreadCache(void *data)
+{
+    SDL_PoolThreadCache *cache = (SDL_PoolThreadCache *)data;
+    int i;
+
+    /* Hand the buffers of an exiting thread over to everybody else */
+    for (i = 0; i < SDL_POOL_THREAD_CLASSES; ++i) {
+        while (cache->count[i] > 0) {
+            SDL_PoolBuffer *buffer = cache->buffers[i][--cache->count[i]];
+
+            SDL_AtomicAdd(&SDL_surface_pool.buffers_retained, -1);
+            SDL_AtomicAdd(&SDL_surface_pool.bytes_retained, -(int)SDL_GetPoolClassSize(i));
+            SDL_ReleasePoolBufferGlobal(buffer);
+        }
+    }
+    SDL_free(cache);
+}
+
+static SDL_PoolThreadCache *
+SDL_GetPoolThreadCache(SDL_bool create)
+{
+    SDL_PoolThreadCache *cache;
+
+    if (!SDL_surface_pool.tls) {
+        if (!create) {
+            return NULL;
+        }
+        SDL_AtomicLock(&SDL_surface_pool.lock);
+        if (!SDL_surface_pool.tls) {
+            SDL_surface_pool.tls = SDL_TLSCreate();
+        }
+        SDL_AtomicUnlock(&SDL_surface_pool.lock);
+    }
+
+    cache = (SDL_PoolThreadCache *)SDL_TLSGet(SDL_surface_pool.tls);
+    if (!cache && create) {
+        cache = (SDL_PoolThreadCache *)SDL_calloc(1, sizeof(*cache));
+        if (cache && SDL_TLSSet(SDL_surface_pool.tls, cache, SDL_FreePoolThreadCache) < 0) {
+            SDL_free(cache);
+            cache = NULL;
+        }
+    }
+    return cache;
+}
+
+void *
+SDL_AllocSurfacePixels(SDL_Surface * surface, size_t size)
+{
+    SDL_PoolThreadCache *cache;
+    SDL_PoolBuffer *buffer = NULL;
+    int size_class;
+
+    if (!SDL_GetHintBoolean(SDL_HINT_SURFACE_POOL, SDL_FALSE)) {
+        return SDL_malloc(size);
+    }
+    size_class = SDL_GetPoolClass(size);
+    if (size_class < 0) {
+        return SDL_malloc(size);
+    }
+
+    if (size_class < SDL_POOL_THREAD_CLASSES) {
+        cache = SDL_GetPoolThreadCache(SDL_TRUE);
+        if (cache && cache->count[size_class] > 0) {
+            buffer = cache->buffers[size_class][--cache->count[size_class]];
+        }
+    }
+    if (!buffer && SDL_surface_pool.free[size_class]) {
+        SDL_AtomicLock(&SDL_surface_pool.lock);
+        buffer = SDL_surface_pool.free[size_class];
+        if (buffer) {
+            SDL_surface_pool.free[size_class] = buffer->next;
+        }
+        SDL_AtomicUnlock(&SDL_surface_pool.lock);
+    }
+
+    if (buffer) {
+        SDL_AtomicAdd(&SDL_surface_pool.hits, 1);
+        SDL_AtomicAdd(&SDL_surface_pool.buffers_retained, -1);
+        SDL_AtomicAdd(&SDL_surface_pool.bytes_retained, -(int)SDL_GetPoolClassSize(size_class));
+    } else {
+        SDL_AtomicAdd(&SDL_surface_pool.misses, 1);
+        buffer = SDL_CreatePoolBuffer(size_class);
+        if (!buffer) {
+            return NULL;
+        }
+    }
+
+    surface->flags |= SDL_POOLALLOC;
+    return (buffer + 1);
+}
+
+void
+SDL_FreeSurfacePixels(SDL_Surface * surface)
+{
+    SDL_PoolThreadCache *cache;
+    SDL_PoolBuffer *buffer;
+
+    if (!(surface->flags & SDL_POOLALLOC)) {
+        SDL_free(surface->pixels);
+        surface->pixels = NULL;
+        return;
+    }
+
+    buffer = (SDL_PoolBuffer *)surface->pixels - 1;
+    surface->flags &= ~SDL_POOLALLOC;
+    surface->pixels = NULL;
+
+    if (buffer->size_class < SDL_POOL_THREAD_CLASSES) {
+        cache = SDL_GetPoolThreadCache(SDL_TRUE);
+        if (cache && cache->count[buffer->size_class] < SDL_POOL_THREAD_SLOTS) {
+            cache->buffers[buffer->size_class][cache->count[buffer->size_class]++] = buffer;
+            SDL_AtomicAdd(&SDL_surface_pool.buffers_retained, 1);
+            SDL_AtomicAdd(&SDL_surface_pool.bytes_retained, (int)SDL_GetPoolClassSize(buffer->size_class));
+            return;
+        }
+    }
+    SDL_ReleasePoolBufferGlobal(buffer);
+}
+
+void
+SDL_GetSurfacePoolStats(SDL_SurfacePoolStats * stats)
+{
+    if (!stats) {
+        SDL_InvalidParamError("stats");
+        return;
+    }
+    stats->hits = (Uint32)SDL_AtomicGet(&SDL_surface_pool.hits);
+    stats->misses = (Uint32)SDL_AtomicGet(&SDL_surface_pool.misses);
+    stats->buffers_retained = (Uint32)SDL_AtomicGet(&SDL_surface_pool.buffers_retained);
+    stats->bytes_retained = (size_t)SDL_AtomicGet(&SDL_surface_pool.bytes_retained);
+}
+
+void
+SDL_TrimSurfacePool(size_t max_bytes)
+{
+    SDL_PoolThreadCache *cache;
+    SDL_PoolBuffer *trimmed = NULL;
+    int i;
+
+    SDL_AtomicLock(&SDL_surface_pool.lock);
+
+    /* Move the calling thread's cache to the global lists, other threads keep theirs */
+    cache = SDL_GetPoolThreadCache(SDL_FALSE);
+    if (cache) {
+        for (i = 0; i < SDL_POOL_THREAD_CLASSES; ++i) {
+            while (cache->count[i] > 0) {
+                SDL_PoolBuffer *buffer = cache->buffers[i][--cache->count[i]];
+                buffer->next = SDL_surface_pool.free[i];
+                SDL_surface_pool.free[i] = buffer;
+            }
+        }
+    }
+
+    /* Then let go of the biggest buffers until we're within budget */
+    for (i = SDL_POOL_NUM_CLASSES; i--; ) {
+        while (SDL_surface_pool.free[i] &&
+               (size_t)SDL_AtomicGet(&SDL_surface_pool.bytes_retained) > max_bytes) {
+            SDL_PoolBuffer *buffer = SDL_surface_pool.free[i];
+            SDL_surface_pool.free[i] = buffer->next;
+            buffer->next = trimmed;
+            trimmed = buffer;
+            SDL_AtomicAdd(&SDL_surface_pool.buffers_retained, -1);
+            SDL_AtomicAdd(&SDL_surface_pool.bytes_retained, -(int)SDL_GetPoolClassSize(i));
+        }
+    }
+    SDL_AtomicUnlock(&SDL_surface_pool.lock);
+
+    while (trimmed) {
+        SDL_PoolBuffer *next = trimmed->next;
+        SDL_DestroyPoolBuffer(trimmed);
+        trimmed = next;
+    }
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
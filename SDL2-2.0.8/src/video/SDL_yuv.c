@@ -24,7 +24,9 @@
 #include "SDL_video.h"
 #include "SDL_pixels_c.h"
 
+#include "SDL_blit.h"
 #include "yuv2rgb/yuv_rgb.h"
+#include "../cpuinfo/SDL_simd.h"
 
 #define SDL_YUV_SD_THRESHOLD    576
 
@@ -178,6 +180,224 @@ static int GetYUVPlanes(int width, int height, Uint32 format, const void *yuv, i
     return 0;
 }
 
+static SDL_bool yuv_rgb_avx2(
+    Uint32 src_format, Uint32 dst_format,
+	Uint32 width, Uint32 height, 
+	const Uint8 *y, const Uint8 *u, const Uint8 *v, Uint32 y_stride, Uint32 uv_stride, 
+	Uint8 *rgb, Uint32 rgb_stride, 
+	YCbCrType yuv_type)
+{
+#ifdef HAVE_AVX2_INTRINSICS
+    if (!SDL_HasAVX2()) {
+        return SDL_FALSE;
+    }
+
+    if (src_format == SDL_PIXELFORMAT_YV12 ||
+        src_format == SDL_PIXELFORMAT_IYUV) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuv420_rgb565_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuv420_rgb24_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuv420_rgba_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuv420_bgra_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuv420_argb_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuv420_abgr_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+
+    if (src_format == SDL_PIXELFORMAT_YUY2 ||
+        src_format == SDL_PIXELFORMAT_UYVY ||
+        src_format == SDL_PIXELFORMAT_YVYU) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuv422_rgb565_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuv422_rgb24_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuv422_rgba_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuv422_bgra_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuv422_argb_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuv422_abgr_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+
+    if (src_format == SDL_PIXELFORMAT_NV12 ||
+        src_format == SDL_PIXELFORMAT_NV21) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuvnv12_rgb565_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuvnv12_rgb24_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuvnv12_rgba_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuvnv12_bgra_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuvnv12_argb_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuvnv12_abgr_avx2(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+#endif
+    return SDL_FALSE;
+}
+
+static SDL_bool yuv_rgb_neon(
+    Uint32 src_format, Uint32 dst_format,
+	Uint32 width, Uint32 height, 
+	const Uint8 *y, const Uint8 *u, const Uint8 *v, Uint32 y_stride, Uint32 uv_stride, 
+	Uint8 *rgb, Uint32 rgb_stride, 
+	YCbCrType yuv_type)
+{
+#if defined(HAVE_NEON_INTRINSICS) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+    if (!SDL_HasNEON()) {
+        return SDL_FALSE;
+    }
+
+    if (src_format == SDL_PIXELFORMAT_YV12 ||
+        src_format == SDL_PIXELFORMAT_IYUV) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuv420_rgb565_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuv420_rgb24_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuv420_rgba_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuv420_bgra_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuv420_argb_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuv420_abgr_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+
+    if (src_format == SDL_PIXELFORMAT_YUY2 ||
+        src_format == SDL_PIXELFORMAT_UYVY ||
+        src_format == SDL_PIXELFORMAT_YVYU) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuv422_rgb565_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuv422_rgb24_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuv422_rgba_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuv422_bgra_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuv422_argb_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuv422_abgr_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+
+    if (src_format == SDL_PIXELFORMAT_NV12 ||
+        src_format == SDL_PIXELFORMAT_NV21) {
+
+        switch (dst_format) {
+        case SDL_PIXELFORMAT_RGB565:
+            yuvnv12_rgb565_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB24:
+            yuvnv12_rgb24_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGBX8888:
+        case SDL_PIXELFORMAT_RGBA8888:
+            yuvnv12_rgba_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGRX8888:
+        case SDL_PIXELFORMAT_BGRA8888:
+            yuvnv12_bgra_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_RGB888:
+        case SDL_PIXELFORMAT_ARGB8888:
+            yuvnv12_argb_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        case SDL_PIXELFORMAT_BGR888:
+        case SDL_PIXELFORMAT_ABGR8888:
+            yuvnv12_abgr_neon(width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+            return SDL_TRUE;
+        default:
+            break;
+        }
+    }
+#endif
+    return SDL_FALSE;
+}
+
 static SDL_bool yuv_rgb_sse(
     Uint32 src_format, Uint32 dst_format,
 	Uint32 width, Uint32 height, 
@@ -390,31 +610,120 @@ static SDL_bool yuv_rgb_std(
     return SDL_FALSE;
 }
 
+static SDL_bool yuv_rgb(
+    Uint32 src_format, Uint32 dst_format,
+    Uint32 width, Uint32 height,
+    const Uint8 *y, const Uint8 *u, const Uint8 *v, Uint32 y_stride, Uint32 uv_stride,
+    Uint8 *rgb, Uint32 rgb_stride,
+    YCbCrType yuv_type)
+{
+    if (yuv_rgb_avx2(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type)) {
+        return SDL_TRUE;
+    }
+
+    if (yuv_rgb_neon(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type)) {
+        return SDL_TRUE;
+    }
+
+    if (yuv_rgb_sse(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type)) {
+        return SDL_TRUE;
+    }
+
+    if (yuv_rgb_std(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type)) {
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+typedef struct
+{
+    Uint32 src_format;
+    Uint32 dst_format;
+    Uint32 width;
+    Uint32 height;
+    const Uint8 *y;
+    const Uint8 *u;
+    const Uint8 *v;
+    Uint32 y_stride;
+    Uint32 uv_stride;
+    Uint8 *rgb;
+    Uint32 rgb_stride;
+    YCbCrType yuv_type;
+    SDL_bool converted;
+} YUVToRGBBands;
+
+/* Converts one band of rows, keeping the chroma rows of 4:2:0 formats whole */
+static void
+yuv_rgb_band(void *data, int band, int num_bands)
+{
+    YUVToRGBBands *bands = (YUVToRGBBands *)data;
+    const int uv_rows = IsPacked4Format(bands->src_format) ? 1 : 2;
+    const int rows = (bands->height / uv_rows) / num_bands;
+    const int extra = (bands->height / uv_rows) % num_bands;
+    const int first = (band * rows + SDL_min(band, extra)) * uv_rows;
+    int height = (rows + (band < extra ? 1 : 0)) * uv_rows;
+    SDL_bool converted;
+
+    if (band == num_bands - 1) {
+        height = bands->height - first;
+    }
+
+    converted = yuv_rgb(bands->src_format, bands->dst_format, bands->width, height,
+                        bands->y + first * bands->y_stride,
+                        bands->u + (first / uv_rows) * bands->uv_stride,
+                        bands->v + (first / uv_rows) * bands->uv_stride,
+                        bands->y_stride, bands->uv_stride,
+                        bands->rgb + first * bands->rgb_stride, bands->rgb_stride,
+                        bands->yuv_type);
+
+    /* Every band converts the same formats, so they all agree */
+    if (band == 0) {
+        bands->converted = converted;
+    }
+}
+
+/* Large conversions are split into bands of rows on the blit threads */
+static SDL_bool yuv_rgb_threaded(
+    Uint32 src_format, Uint32 dst_format,
+    Uint32 width, Uint32 height,
+    const Uint8 *y, const Uint8 *u, const Uint8 *v, Uint32 y_stride, Uint32 uv_stride,
+    Uint8 *rgb, Uint32 rgb_stride,
+    YCbCrType yuv_type)
+{
+    YUVToRGBBands bands;
+
+    bands.src_format = src_format;
+    bands.dst_format = dst_format;
+    bands.width = width;
+    bands.height = height;
+    bands.y = y;
+    bands.u = u;
+    bands.v = v;
+    bands.y_stride = y_stride;
+    bands.uv_stride = uv_stride;
+    bands.rgb = rgb;
+    bands.rgb_stride = rgb_stride;
+    bands.yuv_type = yuv_type;
+    bands.converted = SDL_FALSE;
+    if (SDL_RunBlitJobs(SDL_GetBlitThreads(width * height, height), yuv_rgb_band, &bands)) {
+        return bands.converted;
+    }
+
+    return yuv_rgb(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, rgb, rgb_stride, yuv_type);
+}
+
 int
-SDL_ConvertPixels_YUV_to_RGB(int width, int height,
-         Uint32 src_format, const void *src, int src_pitch,
+SDL_ConvertPixels_YUVPlanes_to_RGB(int width, int height, Uint32 src_format,
+         const Uint8 *y, const Uint8 *u, const Uint8 *v, int y_pitch, int uv_pitch,
          Uint32 dst_format, void *dst, int dst_pitch)
 {
-	const Uint8 *y = NULL;
-    const Uint8 *u = NULL;
-    const Uint8 *v = NULL;
-    Uint32 y_stride = 0;
-    Uint32 uv_stride = 0;
     YCbCrType yuv_type = YCBCR_601;
 
-    if (GetYUVPlanes(width, height, src_format, src, src_pitch, &y, &u, &v, &y_stride, &uv_stride) < 0) {
-        return -1;
-    }
-
     if (GetYUVConversionType(width, height, &yuv_type) < 0) {
         return -1;
     }
 
-    if (yuv_rgb_sse(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, (Uint8*)dst, dst_pitch, yuv_type)) {
-        return 0;
-    }
-
-    if (yuv_rgb_std(src_format, dst_format, width, height, y, u, v, y_stride, uv_stride, (Uint8*)dst, dst_pitch, yuv_type)) {
+    if (yuv_rgb_threaded(src_format, dst_format, width, height, y, u, v, y_pitch, uv_pitch, (Uint8*)dst, dst_pitch, yuv_type)) {
         return 0;
     }
 
@@ -430,7 +739,7 @@ SDL_ConvertPixels_YUV_to_RGB(int width, int height,
         }
 
         /* convert src/src_format to tmp/ARGB8888 */
-        ret = SDL_ConvertPixels_YUV_to_RGB(width, height, src_format, src, src_pitch, SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch);
+        ret = SDL_ConvertPixels_YUVPlanes_to_RGB(width, height, src_format, y, u, v, y_pitch, uv_pitch, SDL_PIXELFORMAT_ARGB8888, tmp, tmp_pitch);
         if (ret < 0) {
             SDL_free(tmp);
             return ret;
@@ -445,6 +754,24 @@ SDL_ConvertPixels_YUV_to_RGB(int width, int height,
     return SDL_SetError("Unsupported YUV conversion");
 }
 
+int
+SDL_ConvertPixels_YUV_to_RGB(int width, int height,
+         Uint32 src_format, const void *src, int src_pitch,
+         Uint32 dst_format, void *dst, int dst_pitch)
+{
+	const Uint8 *y = NULL;
+    const Uint8 *u = NULL;
+    const Uint8 *v = NULL;
+    Uint32 y_stride = 0;
+    Uint32 uv_stride = 0;
+
+    if (GetYUVPlanes(width, height, src_format, src, src_pitch, &y, &u, &v, &y_stride, &uv_stride) < 0) {
+        return -1;
+    }
+
+    return SDL_ConvertPixels_YUVPlanes_to_RGB(width, height, src_format, y, u, v, y_stride, uv_stride, dst_format, dst, dst_pitch);
+}
+
 struct RGB2YUVFactors
 {
     int y_offset;
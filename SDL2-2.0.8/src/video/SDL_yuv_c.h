@@ -23,6 +23,9 @@
 
 /* YUV conversion functions */
 
+/* Converts from separate planes, u and v point at the first U and V sample,
+   which for NV12 and NV21 are next to each other in the same plane */
+extern int SDL_ConvertPixels_YUVPlanes_to_RGB(int width, int height, Uint32 src_format, const Uint8 *y, const Uint8 *u, const Uint8 *v, int y_pitch, int uv_pitch, Uint32 dst_format, void *dst, int dst_pitch);
 extern int SDL_ConvertPixels_YUV_to_RGB(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch);
 extern int SDL_ConvertPixels_RGB_to_YUV(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch);
 extern int SDL_ConvertPixels_YUV_to_YUV(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch);
@@ -5,6 +5,8 @@
 #include "yuv_rgb.h"
 
 #include "SDL_cpuinfo.h"
+#include "SDL_endian.h"
+#include "../../cpuinfo/SDL_simd.h"
 /*#include <x86intrin.h>*/
 
 #define PRECISION 6
@@ -685,3 +687,280 @@ void rgb24_yuv420_sseu(uint32_t width, uint32_t height,
 
 #endif //__SSE2__
 
+#ifdef HAVE_AVX2_INTRINSICS
+
+#define AVX2_FUNCTION_NAME	yuv420_rgb565_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv420_rgb565_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv420_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv420_rgb24_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv420_rgb24_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv420_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv420_rgba_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv420_rgba_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv420_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv420_bgra_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv420_bgra_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv420_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv420_argb_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv420_argb_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv420_argb_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv420_abgr_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv420_abgr_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv420_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv422_rgb565_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv422_rgb565_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv422_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv422_rgb24_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv422_rgb24_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv422_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv422_rgba_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv422_rgba_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv422_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv422_bgra_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv422_bgra_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv422_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv422_argb_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv422_argb_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv422_argb_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuv422_abgr_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuv422_abgr_sseu
+#endif
+#define STD_FUNCTION_NAME	yuv422_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuvnv12_rgb565_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuvnv12_rgb565_sseu
+#endif
+#define STD_FUNCTION_NAME	yuvnv12_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuvnv12_rgb24_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuvnv12_rgb24_sseu
+#endif
+#define STD_FUNCTION_NAME	yuvnv12_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuvnv12_rgba_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuvnv12_rgba_sseu
+#endif
+#define STD_FUNCTION_NAME	yuvnv12_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuvnv12_bgra_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuvnv12_bgra_sseu
+#endif
+#define STD_FUNCTION_NAME	yuvnv12_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuvnv12_argb_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuvnv12_argb_sseu
+#endif
+#define STD_FUNCTION_NAME	yuvnv12_argb_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_avx2_func.h"
+
+#define AVX2_FUNCTION_NAME	yuvnv12_abgr_avx2
+#ifdef __SSE2__
+#define SSE_FUNCTION_NAME	yuvnv12_abgr_sseu
+#endif
+#define STD_FUNCTION_NAME	yuvnv12_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_avx2_func.h"
+
+#endif //HAVE_AVX2_INTRINSICS
+
+#if defined(HAVE_NEON_INTRINSICS) && SDL_BYTEORDER == SDL_LIL_ENDIAN
+
+#define NEON_FUNCTION_NAME	yuv420_rgb565_neon
+#define STD_FUNCTION_NAME	yuv420_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_rgb24_neon
+#define STD_FUNCTION_NAME	yuv420_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_rgba_neon
+#define STD_FUNCTION_NAME	yuv420_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_bgra_neon
+#define STD_FUNCTION_NAME	yuv420_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_argb_neon
+#define STD_FUNCTION_NAME	yuv420_argb_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv420_abgr_neon
+#define STD_FUNCTION_NAME	yuv420_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_420
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgb565_neon
+#define STD_FUNCTION_NAME	yuv422_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgb24_neon
+#define STD_FUNCTION_NAME	yuv422_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_rgba_neon
+#define STD_FUNCTION_NAME	yuv422_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_bgra_neon
+#define STD_FUNCTION_NAME	yuv422_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_argb_neon
+#define STD_FUNCTION_NAME	yuv422_argb_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuv422_abgr_neon
+#define STD_FUNCTION_NAME	yuv422_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_422
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgb565_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgb565_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB565
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgb24_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgb24_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGB24
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_rgba_neon
+#define STD_FUNCTION_NAME	yuvnv12_rgba_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_RGBA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_bgra_neon
+#define STD_FUNCTION_NAME	yuvnv12_bgra_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_BGRA
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_argb_neon
+#define STD_FUNCTION_NAME	yuvnv12_argb_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ARGB
+#include "yuv_rgb_neon_func.h"
+
+#define NEON_FUNCTION_NAME	yuvnv12_abgr_neon
+#define STD_FUNCTION_NAME	yuvnv12_abgr_std
+#define YUV_FORMAT			YUV_FORMAT_NV12
+#define RGB_FORMAT			RGB_FORMAT_ABGR
+#include "yuv_rgb_neon_func.h"
+
+#endif //HAVE_NEON_INTRINSICS
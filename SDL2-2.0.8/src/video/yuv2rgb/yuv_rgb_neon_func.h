@@ -0,0 +1,254 @@
+// Copyright 2016 Adrien Descamps
+// Distributed under BSD 3-Clause License
+
+/* You need to define the following macros before including this file:
+	NEON_FUNCTION_NAME
+	STD_FUNCTION_NAME
+	YUV_FORMAT
+	RGB_FORMAT
+*/
+
+/* NEON version of the SSE2 code, converting 16 pixels of a line (or of two
+   lines, for 4:2:0 formats) at a time with the same 16 bit fixed point math.
+   The last addition saturates, so the result is the same as the standard C
+   code, which clamps, even for values the SSE2 code wraps around on.
+   The 32 bit formats are stored in little endian byte order. */
+
+#define UV2RGB_16 \
+	u_16 = vreinterpretq_s16_u16(vsubl_u8(u, vdup_n_u8(128))); \
+	v_16 = vreinterpretq_s16_u16(vsubl_u8(v, vdup_n_u8(128))); \
+	r_tmp = vmulq_n_s16(v_16, param->v_r_factor); \
+	g_tmp = vaddq_s16(vmulq_n_s16(u_16, param->u_g_factor), vmulq_n_s16(v_16, param->v_g_factor)); \
+	b_tmp = vmulq_n_s16(u_16, param->u_b_factor); \
+	r_uv = vzipq_s16(r_tmp, r_tmp); \
+	g_uv = vzipq_s16(g_tmp, g_tmp); \
+	b_uv = vzipq_s16(b_tmp, b_tmp); \
+
+#define ADD_Y2RGB_16(Y, R, G, B) \
+{ \
+	int16x8_t y_1, y_2; \
+	y_1 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(Y))), vdupq_n_s16(param->y_shift)); \
+	y_2 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_high_u8(Y))), vdupq_n_s16(param->y_shift)); \
+	y_1 = vmulq_n_s16(y_1, param->y_factor); \
+	y_2 = vmulq_n_s16(y_2, param->y_factor); \
+	\
+	R = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(r_uv.val[0], y_1), PRECISION)), \
+		vqmovun_s16(vshrq_n_s16(vqaddq_s16(r_uv.val[1], y_2), PRECISION))); \
+	G = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(g_uv.val[0], y_1), PRECISION)), \
+		vqmovun_s16(vshrq_n_s16(vqaddq_s16(g_uv.val[1], y_2), PRECISION))); \
+	B = vcombine_u8(vqmovun_s16(vshrq_n_s16(vqaddq_s16(b_uv.val[0], y_1), PRECISION)), \
+		vqmovun_s16(vshrq_n_s16(vqaddq_s16(b_uv.val[1], y_2), PRECISION))); \
+}
+
+#if RGB_FORMAT == RGB_FORMAT_RGB565
+
+#define PACK_RGB565_8(R, G, B) \
+	vorrq_u16(vorrq_u16( \
+		vandq_u16(vshll_n_u8(R, 8), vdupq_n_u16(0xF800)), \
+		vandq_u16(vshll_n_u8(G, 3), vdupq_n_u16(0x07E0))), \
+		vmovl_u8(vshr_n_u8(B, 3)))
+
+#define SAVE_LINE(rgb_ptr, R, G, B) \
+	vst1q_u16((uint16_t*)(rgb_ptr), PACK_RGB565_8(vget_low_u8(R), vget_low_u8(G), vget_low_u8(B))); \
+	vst1q_u16((uint16_t*)(rgb_ptr+16), PACK_RGB565_8(vget_high_u8(R), vget_high_u8(G), vget_high_u8(B))); \
+
+#elif RGB_FORMAT == RGB_FORMAT_RGB24
+
+#define SAVE_LINE(rgb_ptr, R, G, B) \
+{ \
+	uint8x16x3_t rgb; \
+	rgb.val[0] = R; rgb.val[1] = G; rgb.val[2] = B; \
+	vst3q_u8(rgb_ptr, rgb); \
+}
+
+#elif RGB_FORMAT == RGB_FORMAT_RGBA || RGB_FORMAT == RGB_FORMAT_BGRA || \
+      RGB_FORMAT == RGB_FORMAT_ARGB || RGB_FORMAT == RGB_FORMAT_ABGR
+
+#if RGB_FORMAT == RGB_FORMAT_RGBA
+#define PACK_PIXEL(R, G, B) rgb.val[0] = a; rgb.val[1] = B; rgb.val[2] = G; rgb.val[3] = R;
+#elif RGB_FORMAT == RGB_FORMAT_BGRA
+#define PACK_PIXEL(R, G, B) rgb.val[0] = a; rgb.val[1] = R; rgb.val[2] = G; rgb.val[3] = B;
+#elif RGB_FORMAT == RGB_FORMAT_ARGB
+#define PACK_PIXEL(R, G, B) rgb.val[0] = B; rgb.val[1] = G; rgb.val[2] = R; rgb.val[3] = a;
+#else
+#define PACK_PIXEL(R, G, B) rgb.val[0] = R; rgb.val[1] = G; rgb.val[2] = B; rgb.val[3] = a;
+#endif
+
+#define SAVE_LINE(rgb_ptr, R, G, B) \
+{ \
+	uint8x16x4_t rgb; \
+	const uint8x16_t a = vdupq_n_u8(0xFF); \
+	PACK_PIXEL(R, G, B) \
+	vst4q_u8(rgb_ptr, rgb); \
+}
+
+#else
+#error SAVE_LINE unimplemented
+#endif
+
+#if YUV_FORMAT == YUV_FORMAT_420
+
+#define READ_Y(y_ptr) \
+	y = vld1q_u8(y_ptr); \
+
+#define READ_UV \
+	u = vld1_u8(u_ptr); \
+	v = vld1_u8(v_ptr); \
+
+#elif YUV_FORMAT == YUV_FORMAT_422
+
+/* Y, U and V point into the same packed data, read all of it at once */
+#define READ_Y(y_ptr) \
+
+#define READ_UV \
+{ \
+	uint8x16x2_t yuv = vld2q_u8(y_ptr1-y_index); \
+	uint8x8x2_t uv = vuzp_u8(vget_low_u8(yuv.val[1-y_index]), vget_high_u8(yuv.val[1-y_index])); \
+	y = yuv.val[y_index]; \
+	u = uv.val[u_index]; \
+	v = uv.val[1-u_index]; \
+}
+
+#elif YUV_FORMAT == YUV_FORMAT_NV12
+
+#define READ_Y(y_ptr) \
+	y = vld1q_u8(y_ptr); \
+
+/* Loading from whichever of U and V comes first doesn't read past the row */
+#define READ_UV \
+{ \
+	uint8x8x2_t uv = vld2_u8(u_ptr-u_index); \
+	u = uv.val[u_index]; \
+	v = uv.val[1-u_index]; \
+}
+
+#else
+#error READ_UV unimplemented
+#endif
+
+#define YUV2RGB_16 \
+	int16x8_t r_tmp, g_tmp, b_tmp; \
+	int16x8x2_t r_uv, g_uv, b_uv; \
+	int16x8_t u_16, v_16; \
+	uint8x8_t u, v; \
+	uint8x16_t y, r, g, b; \
+	\
+	READ_UV \
+	UV2RGB_16 \
+	\
+	/* process the first line */\
+	READ_Y(y_ptr1) \
+	ADD_Y2RGB_16(y, r, g, b) \
+	SAVE_LINE(rgb_ptr1, r, g, b) \
+	\
+	/* process the second line */\
+	if (uv_y_sample_interval > 1) \
+	{ \
+		READ_Y(y_ptr2) \
+		ADD_Y2RGB_16(y, r, g, b) \
+		SAVE_LINE(rgb_ptr2, r, g, b) \
+	} \
+
+
+void NEON_FUNCTION_NAME(uint32_t width, uint32_t height,
+	const uint8_t *Y, const uint8_t *U, const uint8_t *V, uint32_t Y_stride, uint32_t UV_stride,
+	uint8_t *RGB, uint32_t RGB_stride,
+	YCbCrType yuv_type)
+{
+	const YUV2RGBParam *const param = &(YUV2RGB[yuv_type]);
+#if YUV_FORMAT == YUV_FORMAT_420
+	const int y_pixel_stride = 1;
+	const int uv_pixel_stride = 1;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 2;
+#elif YUV_FORMAT == YUV_FORMAT_422
+	const int y_pixel_stride = 2;
+	const int uv_pixel_stride = 4;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 1;
+	const int y_index = (Y > U) ? 1 : 0;
+	const int u_index = (U < V) ? 0 : 1;
+#elif YUV_FORMAT == YUV_FORMAT_NV12
+	const int y_pixel_stride = 1;
+	const int uv_pixel_stride = 2;
+	const int uv_x_sample_interval = 2;
+	const int uv_y_sample_interval = 2;
+	const int u_index = (U < V) ? 0 : 1;
+#endif
+#if RGB_FORMAT == RGB_FORMAT_RGB565
+	const int rgb_pixel_stride = 2;
+#elif RGB_FORMAT == RGB_FORMAT_RGB24
+	const int rgb_pixel_stride = 3;
+#elif RGB_FORMAT == RGB_FORMAT_RGBA || RGB_FORMAT == RGB_FORMAT_BGRA || \
+      RGB_FORMAT == RGB_FORMAT_ARGB || RGB_FORMAT == RGB_FORMAT_ABGR
+	const int rgb_pixel_stride = 4;
+#else
+#error Unknown RGB pixel size
+#endif
+
+	if (width >= 16) {
+		uint32_t xpos, ypos;
+		for(ypos=0; ypos<(height-(uv_y_sample_interval-1)); ypos+=uv_y_sample_interval)
+		{
+			const uint8_t *y_ptr1=Y+ypos*Y_stride,
+				*y_ptr2=Y+(ypos+1)*Y_stride,
+				*u_ptr=U+(ypos/uv_y_sample_interval)*UV_stride,
+				*v_ptr=V+(ypos/uv_y_sample_interval)*UV_stride;
+
+			uint8_t *rgb_ptr1=RGB+ypos*RGB_stride,
+				*rgb_ptr2=RGB+(ypos+1)*RGB_stride;
+
+			for(xpos=0; xpos<(width-15); xpos+=16)
+			{
+				YUV2RGB_16
+
+				y_ptr1+=16*y_pixel_stride;
+				y_ptr2+=16*y_pixel_stride;
+				u_ptr+=16*uv_pixel_stride/uv_x_sample_interval;
+				v_ptr+=16*uv_pixel_stride/uv_x_sample_interval;
+				rgb_ptr1+=16*rgb_pixel_stride;
+				rgb_ptr2+=16*rgb_pixel_stride;
+			}
+		}
+
+		/* Catch the last line, if needed */
+		if (uv_y_sample_interval == 2 && ypos == (height-1))
+		{
+			const uint8_t *y_ptr=Y+ypos*Y_stride,
+				*u_ptr=U+(ypos/uv_y_sample_interval)*UV_stride,
+				*v_ptr=V+(ypos/uv_y_sample_interval)*UV_stride;
+
+			uint8_t *rgb_ptr=RGB+ypos*RGB_stride;
+
+			STD_FUNCTION_NAME(width & ~15, 1, y_ptr, u_ptr, v_ptr, Y_stride, UV_stride, rgb_ptr, RGB_stride, yuv_type);
+		}
+	}
+
+	/* Catch the right column, if needed */
+	{
+		int converted = (width & ~15);
+		if (converted != width)
+		{
+			const uint8_t *y_ptr=Y+converted*y_pixel_stride,
+				*u_ptr=U+converted*uv_pixel_stride/uv_x_sample_interval,
+				*v_ptr=V+converted*uv_pixel_stride/uv_x_sample_interval;
+
+			uint8_t *rgb_ptr=RGB+converted*rgb_pixel_stride;
+
+			STD_FUNCTION_NAME(width-converted, height, y_ptr, u_ptr, v_ptr, Y_stride, UV_stride, rgb_ptr, RGB_stride, yuv_type);
+		}
+	}
+}
+
+#undef NEON_FUNCTION_NAME
+#undef STD_FUNCTION_NAME
+#undef YUV_FORMAT
+#undef RGB_FORMAT
+#undef UV2RGB_16
+#undef ADD_Y2RGB_16
+#undef PACK_RGB565_8
+#undef PACK_PIXEL
+#undef SAVE_LINE
+#undef READ_Y
+#undef READ_UV
+#undef YUV2RGB_16
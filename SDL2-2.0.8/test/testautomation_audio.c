@@ -969,6 +969,393 @@ int audio_openCloseAudioDeviceConnected()
 
 
 
+/**
+ * \brief Resamples a sine wave with both filters of the internal resampler and checks it against the ideal one.
+ *
+ * \sa https://wiki.libsdl.org/SDL_BuildAudioCVT
+ * \sa https://wiki.libsdl.org/SDL_ConvertAudio
+ */
+int audio_resampleQuality()
+{
+   const int rates[][2] = { { 44100, 48000 }, { 48000, 44100 }, { 48000, 16000 }, { 16000, 48000 }, { 44100, 48001 } };
+   const char *filters[] = { "default", "fast" };
+   const double minsnr[] = { 60.0, 40.0 };
+   const double tone = 1000.0;
+   SDL_AudioCVT cvt;
+   float *buf;
+   double noise, signal, snr;
+   int i, j, k, frames, outframes, result;
+
+   for (k = 0; k < SDL_arraysize(filters); k++) {
+     SDL_SetHint(SDL_HINT_AUDIO_INTERNAL_RESAMPLER, filters[k]);
+     for (i = 0; i < SDL_arraysize(rates); i++) {
+       result = SDL_BuildAudioCVT(&cvt, AUDIO_F32SYS, 1, rates[i][0], AUDIO_F32SYS, 1, rates[i][1]);
+       SDLTest_AssertPass("Call to SDL_BuildAudioCVT(F32, 1, %i, F32, 1, %i)", rates[i][0], rates[i][1]);
+       SDLTest_AssertCheck(result == 1, "Verify result value; expected: 1; got: %i", result);
+       if (result != 1) continue;
+
+       /* One second of a sine wave */
+       frames = rates[i][0];
+       cvt.len = frames * (int) sizeof (float);
+       buf = (float *) SDL_malloc(cvt.len * cvt.len_mult);
+       SDLTest_AssertCheck(buf != NULL, "Check data buffer to convert is not NULL");
+       if (buf == NULL) return TEST_ABORTED;
+       for (j = 0; j < frames; j++) {
+         buf[j] = (float) (0.5 * SDL_sin(2.0 * M_PI * tone * j / rates[i][0]));
+       }
+       cvt.buf = (Uint8 *) buf;
+
+       result = SDL_ConvertAudio(&cvt);
+       SDLTest_AssertPass("Call to SDL_ConvertAudio()");
+       SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+
+       /* Skip the start and end, where the filter runs into silence */
+       outframes = cvt.len_cvt / (int) sizeof (float);
+       noise = signal = 0.0;
+       for (j = 200; j < outframes - 200; j++) {
+         const double ideal = 0.5 * SDL_sin(2.0 * M_PI * tone * j / rates[i][1]);
+         noise += (buf[j] - ideal) * (buf[j] - ideal);
+         signal += ideal * ideal;
+       }
+       snr = (noise > 0.0) ? 10.0 * SDL_log(signal / noise) / SDL_log(10.0) : 1000.0;
+       SDLTest_AssertCheck(snr >= minsnr[k], "Verify %s resampler SNR from %i to %i Hz; expected: >=%.0f dB; got: %.1f dB",
+                           filters[k], rates[i][0], rates[i][1], minsnr[k], snr);
+
+       SDL_free(buf);
+     }
+   }
+   SDL_SetHint(SDL_HINT_AUDIO_INTERNAL_RESAMPLER, NULL);
+
+   return TEST_COMPLETED;
+}
+
+/* Converts len bytes of data with one SDL_AudioCVT, checking it stays within cvt.len * cvt.len_mult bytes */
+static Uint8 *
+_audio_convert(const Uint8 *data, int *len, SDL_AudioFormat src_format, Uint8 src_channels, int src_rate,
+               SDL_AudioFormat dst_format, Uint8 dst_channels, int dst_rate)
+{
+   const int guard = 64;
+   SDL_AudioCVT cvt;
+   int result, i, overrun = 0;
+
+   result = SDL_BuildAudioCVT(&cvt, src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate);
+   SDLTest_AssertCheck(result >= 0, "Verify SDL_BuildAudioCVT(0x%.4x, %i, %i, 0x%.4x, %i, %i) result; expected: >=0; got: %i",
+                       src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate, result);
+   if (result < 0) return NULL;
+
+   cvt.len = *len;
+   cvt.buf = (Uint8 *) SDL_malloc((cvt.len * cvt.len_mult) + guard);
+   if (cvt.buf == NULL) return NULL;
+   SDL_memcpy(cvt.buf, data, cvt.len);
+   SDL_memset(cvt.buf + (cvt.len * cvt.len_mult), 0xAA, guard);
+
+   result = SDL_ConvertAudio(&cvt);
+   SDLTest_AssertCheck(result == 0, "Verify SDL_ConvertAudio() result; expected: 0; got: %i", result);
+   for (i = 0; i < guard; i++) {
+     if (cvt.buf[(cvt.len * cvt.len_mult) + i] != 0xAA) {
+       overrun = 1;
+     }
+   }
+   SDLTest_AssertCheck(!overrun, "Verify conversion stays within len * len_mult (%i) bytes", cvt.len * cvt.len_mult);
+   SDLTest_AssertCheck(cvt.len_cvt <= cvt.len * cvt.len_mult, "Verify len_cvt; expected: <=%i; got: %i", cvt.len * cvt.len_mult, cvt.len_cvt);
+
+   *len = cvt.len_cvt;
+   return cvt.buf;
+}
+
+/**
+ * \brief Converts through chains of format, channel and rate changes at once and one step at a time, and compares them.
+ *
+ * \sa https://wiki.libsdl.org/SDL_BuildAudioCVT
+ * \sa https://wiki.libsdl.org/SDL_ConvertAudio
+ */
+int audio_convertAudioChains()
+{
+   const struct {
+     SDL_AudioFormat src_format;
+     Uint8 src_channels;
+     int src_rate;
+     SDL_AudioFormat dst_format;
+     Uint8 dst_channels;
+     int dst_rate;
+     Uint8 step_channels;   /* channels after the first step, before resampling */
+   } chains[] = {
+     { AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 48000, 2 },
+     { AUDIO_S16SYS, 1, 48000, AUDIO_F32SYS, 2, 44100, 2 },
+     { AUDIO_F32SYS, 6, 48000, AUDIO_S16SYS, 2, 44100, 2 },
+     { AUDIO_S16SYS, 6, 48000, AUDIO_F32SYS, 1, 48000, 2 }
+   };
+   const int frames = 4801;
+   Uint8 *data, *fused, *step1, *step2, *step3;
+   int i, j, len, fusedlen, steplen, maxdiff;
+
+   for (i = 0; i < SDL_arraysize(chains); i++) {
+     const int samples = frames * chains[i].src_channels;
+
+     /* A different tone in every channel */
+     len = samples * (SDL_AUDIO_BITSIZE(chains[i].src_format) / 8);
+     data = (Uint8 *) SDL_malloc(len);
+     SDLTest_AssertCheck(data != NULL, "Check data buffer to convert is not NULL");
+     if (data == NULL) return TEST_ABORTED;
+     for (j = 0; j < samples; j++) {
+       const double value = 0.8 * SDL_sin((j / chains[i].src_channels) * (0.01 + 0.02 * (j % chains[i].src_channels)));
+       if (chains[i].src_format == AUDIO_F32SYS) {
+         ((float *) data)[j] = (float) value;
+       } else {
+         ((Sint16 *) data)[j] = (Sint16) (value * 32767.0);
+       }
+     }
+
+     fusedlen = len;
+     fused = _audio_convert(data, &fusedlen, chains[i].src_format, chains[i].src_channels, chains[i].src_rate,
+                            chains[i].dst_format, chains[i].dst_channels, chains[i].dst_rate);
+     SDLTest_AssertPass("Call to SDL_ConvertAudio() from 0x%.4x %i ch %i Hz to 0x%.4x %i ch %i Hz",
+                        chains[i].src_format, chains[i].src_channels, chains[i].src_rate,
+                        chains[i].dst_format, chains[i].dst_channels, chains[i].dst_rate);
+
+     /* Float first, then the channels, then the rate, then the final format */
+     steplen = len;
+     step1 = _audio_convert(data, &steplen, chains[i].src_format, chains[i].src_channels, chains[i].src_rate,
+                            AUDIO_F32SYS, chains[i].step_channels, chains[i].src_rate);
+     step2 = step1 ? _audio_convert(step1, &steplen, AUDIO_F32SYS, chains[i].step_channels, chains[i].src_rate,
+                                    AUDIO_F32SYS, chains[i].dst_channels, chains[i].dst_rate) : NULL;
+     step3 = step2 ? _audio_convert(step2, &steplen, AUDIO_F32SYS, chains[i].dst_channels, chains[i].dst_rate,
+                                    chains[i].dst_format, chains[i].dst_channels, chains[i].dst_rate) : NULL;
+     SDLTest_AssertPass("Call to SDL_ConvertAudio() one step at a time");
+
+     if (fused && step3) {
+       SDLTest_AssertCheck(fusedlen == steplen, "Verify converted length; expected: %i; got: %i", steplen, fusedlen);
+       maxdiff = 0;
+       for (j = 0; j < SDL_min(fusedlen, steplen) / (SDL_AUDIO_BITSIZE(chains[i].dst_format) / 8); j++) {
+         if (chains[i].dst_format == AUDIO_F32SYS) {
+           maxdiff = SDL_max(maxdiff, (((float *) fused)[j] != ((float *) step3)[j]) ? 32768 : 0);
+         } else {
+           maxdiff = SDL_max(maxdiff, SDL_abs(((Sint16 *) fused)[j] - ((Sint16 *) step3)[j]));
+         }
+       }
+       /* Float to integer conversion rounds differently with and without SIMD */
+       SDLTest_AssertCheck(maxdiff <= 1, "Verify converted samples; expected: at most 1 apart; got: %i", maxdiff);
+     }
+
+     SDL_free(data);
+     SDL_free(fused);
+     SDL_free(step1);
+     SDL_free(step2);
+     SDL_free(step3);
+   }
+
+   return TEST_COMPLETED;
+}
+
+/* Reference mixing of one sample, the way SDL_MixAudioFormat() does it without SIMD */
+static Sint16
+_audio_mixS16(Sint16 dst, Sint16 src, int volume)
+{
+   int s = (src * volume) / SDL_MIX_MAXVOLUME;
+   s = SDL_max(SDL_min(s, 32767), -32767) + dst;
+   return (Sint16) SDL_max(SDL_min(s, 32767), -32768);
+}
+
+static Sint32
+_audio_mixS32(Sint32 dst, Sint32 src, int volume)
+{
+   Sint64 s = (((Sint64) src) * volume) / SDL_MIX_MAXVOLUME;
+   s = SDL_max(SDL_min(s, 2147483647), -2147483647) + dst;
+   return (Sint32) SDL_max(SDL_min(s, 2147483647), -((Sint64) 2147483647) - 1);
+}
+
+static float
+_audio_mixF32(float dst, float src, int volume)
+{
+   const double s = ((double) ((src * (float) volume) * (1.0f / ((float) SDL_MIX_MAXVOLUME)))) + ((double) dst);
+   return (float) SDL_max(SDL_min(s, 3.402823466e+38F), -3.402823466e+38F);
+}
+
+/**
+ * \brief Mixes buffers of various lengths with various volumes and checks every sample.
+ *
+ * \sa https://wiki.libsdl.org/SDL_MixAudioFormat
+ */
+int audio_mixAudioFormat()
+{
+   const Uint32 lengths[] = { 1, 7, 16, 37, 1037 };
+   const int volumes[] = { 1, 33, 64, 127, SDL_MIX_MAXVOLUME, 200 };
+   const SDL_AudioFormat formats[] = { AUDIO_S16SYS, AUDIO_S32SYS, AUDIO_F32SYS };
+   const char *formatNames[] = { "AUDIO_S16SYS", "AUDIO_S32SYS", "AUDIO_F32SYS" };
+   Sint32 src[1037], dst[1037], expected[1037];
+   int i, j, k, errors;
+   Uint32 n, len;
+
+   for (i = 0; i < SDL_arraysize(formats); i++) {
+     for (j = 0; j < SDL_arraysize(lengths); j++) {
+       for (k = 0; k < SDL_arraysize(volumes); k++) {
+         len = lengths[j];
+
+         /* Random samples, with some full scale ones to hit the clamping */
+         for (n = 0; n < len; n++) {
+           if (formats[i] == AUDIO_S16SYS) {
+             ((Sint16 *) src)[n] = (n % 5 == 0) ? -32768 : (Sint16) SDLTest_RandomSint16();
+             ((Sint16 *) dst)[n] = (n % 3 == 0) ? 32767 : (Sint16) SDLTest_RandomSint16();
+             ((Sint16 *) expected)[n] = _audio_mixS16(((Sint16 *) dst)[n], ((Sint16 *) src)[n], volumes[k]);
+           } else if (formats[i] == AUDIO_S32SYS) {
+             src[n] = (n % 5 == 0) ? (-2147483647 - 1) : SDLTest_RandomSint32();
+             dst[n] = (n % 3 == 0) ? 2147483647 : SDLTest_RandomSint32();
+             expected[n] = _audio_mixS32(dst[n], src[n], volumes[k]);
+           } else {
+             ((float *) src)[n] = (n % 5 == 0) ? -3.0e38f : SDLTest_RandomUnitFloat() * 2.0f - 1.0f;
+             ((float *) dst)[n] = (n % 3 == 0) ? 3.4e38f : SDLTest_RandomUnitFloat() * 2.0f - 1.0f;
+             ((float *) expected)[n] = _audio_mixF32(((float *) dst)[n], ((float *) src)[n], volumes[k]);
+           }
+         }
+
+         SDL_MixAudioFormat((Uint8 *) dst, (const Uint8 *) src, formats[i], len * SDL_AUDIO_BITSIZE(formats[i]) / 8, volumes[k]);
+
+         errors = 0;
+         for (n = 0; n < len; n++) {
+           if (formats[i] == AUDIO_S16SYS) {
+             errors += (((Sint16 *) dst)[n] != ((Sint16 *) expected)[n]);
+           } else if (formats[i] == AUDIO_S32SYS) {
+             errors += (dst[n] != expected[n]);
+           } else {
+             errors += (SDL_fabs(((float *) dst)[n] - ((float *) expected)[n]) > 1e-6 * SDL_fabs(((float *) expected)[n]));
+           }
+         }
+         SDLTest_AssertCheck(errors == 0, "Verify mixing %i samples of %s with volume %i; expected: 0 errors; got: %i",
+                             (int) len, formatNames[i], volumes[k], errors);
+       }
+     }
+   }
+
+   return TEST_COMPLETED;
+}
+
+/* Producer thread state for audio_queueAudioRing */
+typedef struct
+{
+   SDL_AudioDeviceID id;
+   Uint32 total;
+   Uint32 queued;
+   int refused;
+   SDL_atomic_t done;
+} _audio_ringProducer;
+
+static int SDLCALL
+_audio_ringProducerThread(void *arg)
+{
+   _audio_ringProducer *producer = (_audio_ringProducer *) arg;
+   Uint8 buffer[4096];
+   Uint32 seed = 1;
+   Uint32 len;
+
+   SDL_memset(buffer, 0, sizeof (buffer));
+   while (producer->queued < producer->total) {
+     /* Whole frames of random size, up to a full buffer */
+     seed = seed * 1103515245 + 12345;
+     len = (1 + ((seed >> 16) % (sizeof (buffer) / 4))) * 4;
+     len = SDL_min(len, producer->total - producer->queued);
+     if (SDL_QueueAudio(producer->id, buffer, len) == 0) {
+       producer->queued += len;
+     } else {
+       producer->refused++;
+       SDL_Delay(1);
+     }
+   }
+   SDL_AtomicSet(&producer->done, 1);
+   return 0;
+}
+
+/**
+ * \brief Queues audio from a producer thread into a lock-free ring while the audio thread drains it.
+ *
+ * \sa https://wiki.libsdl.org/SDL_QueueAudio
+ * \sa https://wiki.libsdl.org/SDL_GetQueuedAudioSize
+ */
+int audio_queueAudioRing()
+{
+   SDL_AudioSpec desired, obtained;
+   SDL_AudioQueueStats stats;
+   _audio_ringProducer producer;
+   SDL_Thread *thread;
+   Uint32 start;
+   int result, overfull = 0;
+
+   SDL_zero(producer);
+   desired.freq = 22050;
+   desired.format = AUDIO_S16SYS;
+   desired.channels = 2;
+   desired.samples = 512;
+   desired.callback = NULL;
+   desired.userdata = NULL;
+
+   /* Earlier tests call SDL_AudioQuit() behind the subsystem's back */
+   if (SDL_GetCurrentAudioDriver() == NULL) {
+     result = SDL_AudioInit(NULL);
+     SDLTest_AssertPass("Call to SDL_AudioInit(NULL)");
+     SDLTest_AssertCheck(result == 0, "Validate result value; expected: 0 got: %d", result);
+   }
+
+   SDL_SetHint(SDL_HINT_AUDIO_QUEUE_CAPACITY, "16384");
+   producer.id = SDL_OpenAudioDevice(NULL, 0, &desired, &obtained, 0);
+   SDL_SetHint(SDL_HINT_AUDIO_QUEUE_CAPACITY, NULL);
+   SDLTest_AssertPass("Call to SDL_OpenAudioDevice(NULL, 0, ...) with SDL_HINT_AUDIO_QUEUE_CAPACITY set");
+   if (producer.id == 0) {
+     SDLTest_Log("No device to test with: %s", SDL_GetError());
+     return TEST_SKIPPED;
+   }
+
+   result = SDL_GetQueuedAudioStats(producer.id, &stats);
+   SDLTest_AssertPass("Call to SDL_GetQueuedAudioStats()");
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+   SDLTest_AssertCheck(stats.capacity >= 16384 && (stats.capacity & (stats.capacity - 1)) == 0,
+                       "Verify ring capacity; expected: power of 2 >=16384; got: %u", stats.capacity);
+   SDLTest_AssertCheck(stats.queued == 0, "Verify queued bytes; expected: 0; got: %u", stats.queued);
+
+   /* Half a second of audio, much more than fits in the ring */
+   producer.total = (Uint32) obtained.freq * 4 / 2;
+   SDL_PauseAudioDevice(producer.id, 0);
+   thread = SDL_CreateThread(_audio_ringProducerThread, "AudioRingProducer", &producer);
+   SDLTest_AssertCheck(thread != NULL, "Verify producer thread was created");
+   if (thread == NULL) {
+     SDL_CloseAudioDevice(producer.id);
+     return TEST_ABORTED;
+   }
+
+   /* A third thread can watch the queue while it fills and drains */
+   start = SDL_GetTicks();
+   while (!SDL_AtomicGet(&producer.done) || SDL_GetQueuedAudioSize(producer.id) > 0) {
+     if (SDL_GetQueuedAudioSize(producer.id) > stats.capacity) {
+       overfull++;
+     }
+     if (SDL_TICKS_PASSED(SDL_GetTicks(), start + 10000)) {
+       break;
+     }
+     SDL_Delay(2);
+   }
+   SDL_WaitThread(thread, NULL);
+   SDLTest_AssertCheck(overfull == 0, "Verify the queue never held more than its capacity; got: %i times", overfull);
+   SDLTest_AssertCheck(producer.queued == producer.total, "Verify all audio was queued; expected: %u; got: %u", producer.total, producer.queued);
+   SDLTest_AssertCheck(SDL_GetQueuedAudioSize(producer.id) == 0, "Verify the audio thread drained the queue");
+
+   result = SDL_GetQueuedAudioStats(producer.id, &stats);
+   SDLTest_AssertCheck(result == 0, "Verify result value; expected: 0; got: %i", result);
+   SDLTest_AssertCheck(stats.high_watermark <= stats.capacity && stats.high_watermark > 0,
+                       "Verify high watermark; expected: 1..%u; got: %u", stats.capacity, stats.high_watermark);
+   SDLTest_AssertCheck(stats.low_watermark <= stats.high_watermark,
+                       "Verify low watermark; expected: <=%u; got: %u", stats.high_watermark, stats.low_watermark);
+   SDLTest_AssertCheck(stats.overruns == (Uint32) producer.refused,
+                       "Verify overruns match refused writes; expected: %i; got: %u", producer.refused, stats.overruns);
+
+   SDL_ResetQueuedAudioStats(producer.id);
+   result = SDL_GetQueuedAudioStats(producer.id, &stats);
+   SDLTest_AssertCheck(result == 0 && stats.overruns == 0 && stats.underruns == 0 && stats.high_watermark == 0,
+                       "Verify stats were reset; got: %u overruns, %u underruns, high watermark %u", stats.overruns, stats.underruns, stats.high_watermark);
+
+   SDL_CloseAudioDevice(producer.id);
+   SDLTest_AssertPass("Call to SDL_CloseAudioDevice()");
+
+   return TEST_COMPLETED;
+}
+
 /* ================= Test Case References ================== */
 
 /* Audio test cases */
@@ -1022,11 +1409,24 @@ static const SDLTest_TestCaseReference audioTest14 =
 static const SDLTest_TestCaseReference audioTest15 =
         { (SDLTest_TestCaseFp)audio_pauseUnpauseAudio, "audio_pauseUnpauseAudio", "Pause and Unpause audio for various audio specs while testing callback.", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference audioTest16 =
+        { (SDLTest_TestCaseFp)audio_resampleQuality, "audio_resampleQuality", "Checks the quality of the internal resampler on a sine wave.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest17 =
+        { (SDLTest_TestCaseFp)audio_mixAudioFormat, "audio_mixAudioFormat", "Mixes signed 16 bit, 32 bit and float audio and checks the result.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest18 =
+        { (SDLTest_TestCaseFp)audio_queueAudioRing, "audio_queueAudioRing", "Queues audio into a lock-free ring from a producer thread while the audio thread drains it.", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference audioTest19 =
+        { (SDLTest_TestCaseFp)audio_convertAudioChains, "audio_convertAudioChains", "Converts formats, channels and rates at once and one step at a time.", TEST_ENABLED };
+
 /* Sequence of Audio test cases */
 static const SDLTest_TestCaseReference *audioTests[] =  {
     &audioTest1, &audioTest2, &audioTest3, &audioTest4, &audioTest5, &audioTest6,
     &audioTest7, &audioTest8, &audioTest9, &audioTest10, &audioTest11,
-    &audioTest12, &audioTest13, &audioTest14, &audioTest15, NULL
+    &audioTest12, &audioTest13, &audioTest14, &audioTest15, &audioTest16,
+    &audioTest17, &audioTest18, &audioTest19, NULL
 };
 
 /* Audio test suite (global) */
@@ -72,6 +72,56 @@ events_pushPumpAndPollUserevent(void *arg)
    return TEST_COMPLETED;
 }
 
+/**
+ * @brief Test pushing several events and draining them in one batch.
+ *
+ * @sa http://wiki.libsdl.org/moin.cgi/SDL_PollEvents
+ */
+int
+events_pushAndPollUsereventBatch(void *arg)
+{
+   SDL_Event event;
+   SDL_Event events[8];
+   int i, result;
+
+   /* Make sure we start with an empty queue */
+   SDL_PumpEvents();
+   SDL_FlushEvents(SDL_FIRSTEVENT, SDL_LASTEVENT);
+
+   /* Push a few user events in order */
+   for (i = 0; i < 5; i++) {
+      SDL_zero(event);
+      event.type = SDL_USEREVENT;
+      event.user.code = i;
+      SDL_PushEvent(&event);
+   }
+   SDLTest_AssertPass("Call to SDL_PushEvent() x5");
+
+   /* A short batch gets the oldest events */
+   result = SDL_PollEvents(events, 3);
+   SDLTest_AssertPass("Call to SDL_PollEvents(events, 3)");
+   SDLTest_AssertCheck(result == 3, "Check result from SDL_PollEvents, expected: 3, got: %d", result);
+   for (i = 0; i < result; i++) {
+      SDLTest_AssertCheck(events[i].user.code == i, "Check event order, expected: %d, got: %d", i, events[i].user.code);
+   }
+
+   /* The rest come out with the next batch */
+   result = SDL_PollEvents(events, SDL_arraysize(events));
+   SDLTest_AssertPass("Call to SDL_PollEvents(events, 8)");
+   SDLTest_AssertCheck(result == 2, "Check result from SDL_PollEvents, expected: 2, got: %d", result);
+   if (result == 2) {
+      SDLTest_AssertCheck(events[0].user.code == 3 && events[1].user.code == 4, "Check event order of remaining events");
+   }
+
+   /* Invalid parameters */
+   result = SDL_PollEvents(NULL, 1);
+   SDLTest_AssertCheck(result == -1, "Check result from SDL_PollEvents(NULL, 1), expected: -1, got: %d", result);
+   result = SDL_PollEvents(events, 0);
+   SDLTest_AssertCheck(result == -1, "Check result from SDL_PollEvents(events, 0), expected: -1, got: %d", result);
+
+   return TEST_COMPLETED;
+}
+
 
 /**
  * @brief Adds and deletes an event watch function with NULL userdata
@@ -187,9 +237,12 @@ static const SDLTest_TestCaseReference eventsTest2 =
 static const SDLTest_TestCaseReference eventsTest3 =
         { (SDLTest_TestCaseFp)events_addDelEventWatchWithUserdata, "events_addDelEventWatchWithUserdata", "Adds and deletes an event watch function with userdata", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference eventsTest4 =
+        { (SDLTest_TestCaseFp)events_pushAndPollUsereventBatch, "events_pushAndPollUsereventBatch", "Pushes user events and polls them in batches", TEST_ENABLED };
+
 /* Sequence of Events test cases */
 static const SDLTest_TestCaseReference *eventsTests[] =  {
-    &eventsTest1, &eventsTest2, &eventsTest3, NULL
+    &eventsTest1, &eventsTest2, &eventsTest3, &eventsTest4, NULL
 };
 
 /* Events test suite (global) */
@@ -500,6 +500,78 @@ pixels_calcGammaRamp(void *arg)
   return TEST_COMPLETED;
 }
 
+/**
+ * @brief Check that large YUV to RGB conversions split across threads match single threaded ones
+ *
+ * @sa http://wiki.libsdl.org/moin.fcg/SDL_ConvertPixels
+ */
+int
+pixels_convertYUVThreaded(void *arg)
+{
+  const Uint32 yuvFormats[] = {
+    SDL_PIXELFORMAT_YV12, SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_NV21,
+    SDL_PIXELFORMAT_YUY2, SDL_PIXELFORMAT_UYVY, SDL_PIXELFORMAT_YVYU
+  };
+  const Uint32 rgbFormats[] = {
+    SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB555
+  };
+  const int w = 801, h = 601;
+  const int yuvPitch = 2 * (w + 1);
+  const int yuvSize = 2 * yuvPitch * h;   /* room for the planes of any format */
+  const int rgbPitch = 4 * w;
+  char *hint;
+  Uint8 *yuv, *expected, *actual;
+  int i, j, k, ret, differences;
+
+  yuv = (Uint8 *)SDL_malloc(yuvSize);
+  expected = (Uint8 *)SDL_malloc(rgbPitch * h);
+  actual = (Uint8 *)SDL_malloc(rgbPitch * h);
+  SDLTest_AssertCheck(yuv != NULL && expected != NULL && actual != NULL, "Validate buffers could be allocated");
+  if (yuv == NULL || expected == NULL || actual == NULL) {
+    SDL_free(yuv);
+    SDL_free(expected);
+    SDL_free(actual);
+    return TEST_ABORTED;
+  }
+
+  /* Stay well inside the range the conversions handle without clamping */
+  for (i = 0; i < yuvSize; i++) {
+    yuv[i] = (Uint8)SDLTest_RandomIntegerInRange(64, 192);
+  }
+
+  hint = SDL_strdup(SDL_GetHint(SDL_HINT_BLIT_THREADS) ? SDL_GetHint(SDL_HINT_BLIT_THREADS) : "0");
+  for (i = 0; i < SDL_arraysize(yuvFormats); i++) {
+    for (j = 0; j < SDL_arraysize(rgbFormats); j++) {
+      SDL_SetHint(SDL_HINT_BLIT_THREADS, "0");
+      SDL_memset(expected, 0, rgbPitch * h);
+      ret = SDL_ConvertPixels(w, h, yuvFormats[i], yuv, yuvPitch, rgbFormats[j], expected, rgbPitch);
+      SDLTest_AssertCheck(ret == 0, "Call to SDL_ConvertPixels(%s, %s) on one thread, expected: 0, got: %i",
+        SDL_GetPixelFormatName(yuvFormats[i]), SDL_GetPixelFormatName(rgbFormats[j]), ret);
+
+      SDL_SetHint(SDL_HINT_BLIT_THREADS, "4");
+      SDL_memset(actual, 0, rgbPitch * h);
+      ret = SDL_ConvertPixels(w, h, yuvFormats[i], yuv, yuvPitch, rgbFormats[j], actual, rgbPitch);
+      SDLTest_AssertCheck(ret == 0, "Call to SDL_ConvertPixels(%s, %s) on four threads, expected: 0, got: %i",
+        SDL_GetPixelFormatName(yuvFormats[i]), SDL_GetPixelFormatName(rgbFormats[j]), ret);
+
+      differences = 0;
+      for (k = 0; k < rgbPitch * h; k++) {
+        if (expected[k] != actual[k]) differences++;
+      }
+      SDLTest_AssertCheck(differences == 0, "Validate threaded %s to %s conversion matches, expected: 0 differences, got: %i",
+        SDL_GetPixelFormatName(yuvFormats[i]), SDL_GetPixelFormatName(rgbFormats[j]), differences);
+    }
+  }
+  SDL_SetHint(SDL_HINT_BLIT_THREADS, hint);
+
+  SDL_free(hint);
+  SDL_free(yuv);
+  SDL_free(expected);
+  SDL_free(actual);
+
+  return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Pixels test cases */
@@ -515,9 +587,12 @@ static const SDLTest_TestCaseReference pixelsTest3 =
 static const SDLTest_TestCaseReference pixelsTest4 =
         { (SDLTest_TestCaseFp)pixels_getPixelFormatName, "pixels_getPixelFormatName", "Call to SDL_GetPixelFormatName", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference pixelsTest5 =
+        { (SDLTest_TestCaseFp)pixels_convertYUVThreaded, "pixels_convertYUVThreaded", "Threaded YUV to RGB conversion with SDL_ConvertPixels", TEST_ENABLED };
+
 /* Sequence of Pixels test cases */
 static const SDLTest_TestCaseReference *pixelsTests[] =  {
-    &pixelsTest1, &pixelsTest2, &pixelsTest3, &pixelsTest4, NULL
+    &pixelsTest1, &pixelsTest2, &pixelsTest3, &pixelsTest4, &pixelsTest5, NULL
 };
 
 /* Pixels test suite (global) */
@@ -1058,6 +1058,290 @@ _clearScreen(void)
    return 0;
 }
 
+/* Draws a frame of a few widgets for render_testSoftwareDirtyRects */
+static void
+_drawWidgets(SDL_Renderer *target, SDL_Texture *texture, const SDL_Rect *widgets, int count, int frame)
+{
+   int i;
+   SDL_Rect clip;
+
+   SDL_SetRenderDrawColor(target, 16, 32, 48, SDL_ALPHA_OPAQUE);
+   SDL_RenderClear(target);
+   for (i = 0; i < count; ++i) {
+      switch (i % 5) {
+      case 0:
+         SDL_SetRenderDrawBlendMode(target, SDL_BLENDMODE_NONE);
+         SDL_SetRenderDrawColor(target, (Uint8)(i * 40), 200, 100, SDL_ALPHA_OPAQUE);
+         SDL_RenderFillRect(target, &widgets[i]);
+         break;
+      case 1:
+         SDL_SetRenderDrawBlendMode(target, SDL_BLENDMODE_BLEND);
+         SDL_SetRenderDrawColor(target, 250, (Uint8)(i * 40), 20, 128);
+         SDL_RenderFillRect(target, &widgets[i]);
+         break;
+      case 2:
+         SDL_RenderDrawLine(target, widgets[i].x, widgets[i].y, widgets[i].x + 40, widgets[i].y + 13);
+         break;
+      case 3:
+         SDL_RenderCopyEx(target, texture, NULL, &widgets[i], (double)(frame * 15), NULL, SDL_FLIP_NONE);
+         break;
+      case 4:
+         clip = widgets[i];
+         clip.w /= 2;
+         SDL_RenderSetClipRect(target, &clip);
+         SDL_RenderCopy(target, texture, NULL, &widgets[i]);
+         SDL_RenderSetClipRect(target, NULL);
+         break;
+      }
+   }
+}
+
+/**
+ * @brief Tests that the software renderer only presenting what changed gives
+ * the same pixels as drawing every frame in full.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RenderPresent
+ */
+int
+render_testSoftwareDirtyRects(void *arg)
+{
+   SDL_Window *dirtyWindow;
+   SDL_Renderer *dirtyRenderer, *referenceRenderer;
+   SDL_Surface *windowSurface, *reference;
+   SDL_Texture *dirtyTexture, *referenceTexture;
+   SDL_Surface *face;
+   SDL_Rect widgets[10];
+   int i, frame, y, mismatches = 0;
+
+   SDL_SetHint(SDL_HINT_RENDER_SW_DIRTY_RECTS, "1");
+   dirtyWindow = SDL_CreateWindow("render_testSoftwareDirtyRects", 100, 100,
+                                  TESTRENDER_SCREEN_W * 2, TESTRENDER_SCREEN_H * 2, 0);
+   SDLTest_AssertCheck(dirtyWindow != NULL, "Check SDL_CreateWindow result");
+   if (dirtyWindow == NULL) {
+      SDL_SetHint(SDL_HINT_RENDER_SW_DIRTY_RECTS, "0");
+      return TEST_ABORTED;
+   }
+   dirtyRenderer = SDL_CreateRenderer(dirtyWindow, -1, SDL_RENDERER_SOFTWARE);
+   SDL_SetHint(SDL_HINT_RENDER_SW_DIRTY_RECTS, "0");
+   SDLTest_AssertCheck(dirtyRenderer != NULL, "Check SDL_CreateRenderer result");
+   if (dirtyRenderer == NULL) {
+      SDL_DestroyWindow(dirtyWindow);
+      return TEST_ABORTED;
+   }
+
+   windowSurface = SDL_GetWindowSurface(dirtyWindow);
+   reference = SDL_CreateRGBSurfaceWithFormat(0, windowSurface->w, windowSurface->h,
+                                              32, windowSurface->format->format);
+   referenceRenderer = SDL_CreateSoftwareRenderer(reference);
+   SDLTest_AssertCheck(referenceRenderer != NULL, "Check SDL_CreateSoftwareRenderer result");
+
+   face = SDLTest_ImageFace();
+   dirtyTexture = SDL_CreateTextureFromSurface(dirtyRenderer, face);
+   referenceTexture = SDL_CreateTextureFromSurface(referenceRenderer, face);
+   SDL_FreeSurface(face);
+
+   for (i = 0; i < SDL_arraysize(widgets); ++i) {
+      widgets[i].x = (i * 37) % windowSurface->w - 10;
+      widgets[i].y = (i * 23) % windowSurface->h - 10;
+      widgets[i].w = 24 + i * 3;
+      widgets[i].h = 18 + i * 2;
+   }
+
+   for (frame = 0; frame < 20; ++frame) {
+      /* Move one widget a little each frame, and sometimes none */
+      if (frame % 4 != 3) {
+         widgets[frame % SDL_arraysize(widgets)].x += 3;
+      }
+      if (frame == 10) {
+         SDL_SetTextureAlphaMod(dirtyTexture, 100);
+         SDL_SetTextureAlphaMod(referenceTexture, 100);
+      }
+      _drawWidgets(dirtyRenderer, dirtyTexture, widgets, SDL_arraysize(widgets), frame);
+      SDL_RenderPresent(dirtyRenderer);
+      _drawWidgets(referenceRenderer, referenceTexture, widgets, SDL_arraysize(widgets), frame);
+
+      for (y = 0; y < reference->h; ++y) {
+         if (SDL_memcmp((Uint8 *)windowSurface->pixels + y * windowSurface->pitch,
+                        (Uint8 *)reference->pixels + y * reference->pitch,
+                        reference->w * 4) != 0) {
+            ++mismatches;
+            break;
+         }
+      }
+   }
+   SDLTest_AssertCheck(mismatches == 0, "Validate frames match full redraws, expected: 0 mismatched frames, got: %i", mismatches);
+
+   SDL_DestroyTexture(referenceTexture);
+   SDL_DestroyRenderer(referenceRenderer);
+   SDL_FreeSurface(reference);
+   SDL_DestroyTexture(dirtyTexture);
+   SDL_DestroyRenderer(dirtyRenderer);
+   SDL_DestroyWindow(dirtyWindow);
+
+   return TEST_COMPLETED;
+}
+
+static void SDLCALL
+_countFrameRelease(void *userdata)
+{
+   ++*(int *)userdata;
+}
+
+static int
+_compareRendered(SDL_Renderer *target_renderer, SDL_Texture *texture, SDL_Surface *target, const Uint32 *expected)
+{
+   int y;
+
+   SDL_RenderCopy(target_renderer, texture, NULL, NULL);
+   for (y = 0; y < target->h; ++y) {
+      if (SDL_memcmp((Uint8 *)target->pixels + y * target->pitch, expected + y * target->w, target->w * 4) != 0) {
+         return -1;
+      }
+   }
+   return 0;
+}
+
+/**
+ * @brief Tests that updating a texture from decoder planes gives the same
+ * pixels as converting the packed frame, and that the frame gets released.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_UpdateYUVTexture
+ */
+int
+render_testYUVTextureFrame(void *arg)
+{
+   const Uint32 formats[] = {
+      SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_YV12, SDL_PIXELFORMAT_NV12, SDL_PIXELFORMAT_NV21
+   };
+   const int w = 67, h = 45;
+   const int cw = (w + 1) / 2, ch = (h + 1) / 2;
+   const int Ypitch = w + 5;
+   SDL_Surface *target;
+   SDL_Renderer *swRenderer;
+   Uint8 *Yplane, *Uplane, *Vplane, *packed, *dst;
+   Uint32 *expected;
+   int i, access, y, ret, released, released2;
+
+   target = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+   SDLTest_AssertCheck(target != NULL, "Check SDL_CreateRGBSurfaceWithFormat result");
+   if (target == NULL) {
+      return TEST_ABORTED;
+   }
+   swRenderer = SDL_CreateSoftwareRenderer(target);
+   SDLTest_AssertCheck(swRenderer != NULL, "Check SDL_CreateSoftwareRenderer result");
+   if (swRenderer == NULL) {
+      SDL_FreeSurface(target);
+      return TEST_ABORTED;
+   }
+
+   /* The U and V pitches are also wide enough for interleaved planes */
+   Yplane = (Uint8 *)SDL_malloc(Ypitch * h);
+   Uplane = (Uint8 *)SDL_malloc((2 * cw + 4) * ch);
+   Vplane = (Uint8 *)SDL_malloc((2 * cw + 4) * ch);
+   packed = (Uint8 *)SDL_malloc(w * h + 2 * cw * ch);
+   expected = (Uint32 *)SDL_malloc(w * h * sizeof(Uint32));
+
+   /* Values within the range of video levels */
+   for (i = 0; i < Ypitch * h; ++i) {
+      Yplane[i] = (Uint8)SDLTest_RandomIntegerInRange(64, 192);
+   }
+   for (i = 0; i < (2 * cw + 4) * ch; ++i) {
+      Uplane[i] = (Uint8)SDLTest_RandomIntegerInRange(64, 192);
+      Vplane[i] = (Uint8)SDLTest_RandomIntegerInRange(64, 192);
+   }
+
+   for (i = 0; i < SDL_arraysize(formats); ++i) {
+      const Uint32 format = formats[i];
+      const SDL_bool nv = (format == SDL_PIXELFORMAT_NV12 || format == SDL_PIXELFORMAT_NV21);
+      const int Upitch = nv ? 2 * cw + 4 : cw + 3;
+
+      /* The frame packed the way SDL_UpdateTexture() takes it */
+      dst = packed;
+      for (y = 0; y < h; ++y, dst += w) {
+         SDL_memcpy(dst, Yplane + y * Ypitch, w);
+      }
+      if (nv) {
+         for (y = 0; y < ch; ++y, dst += 2 * cw) {
+            SDL_memcpy(dst, Uplane + y * Upitch, 2 * cw);
+         }
+      } else {
+         const Uint8 *first = (format == SDL_PIXELFORMAT_YV12) ? Vplane : Uplane;
+         const Uint8 *second = (format == SDL_PIXELFORMAT_YV12) ? Uplane : Vplane;
+         for (y = 0; y < ch; ++y, dst += cw) {
+            SDL_memcpy(dst, first + y * Upitch, cw);
+         }
+         for (y = 0; y < ch; ++y, dst += cw) {
+            SDL_memcpy(dst, second + y * Upitch, cw);
+         }
+      }
+      ret = SDL_ConvertPixels(w, h, format, packed, w, SDL_PIXELFORMAT_ARGB8888, expected, w * 4);
+      SDLTest_AssertCheck(ret == 0, "Check SDL_ConvertPixels result, expected: 0, got: %i", ret);
+
+      for (access = SDL_TEXTUREACCESS_STATIC; access <= SDL_TEXTUREACCESS_STREAMING; ++access) {
+         SDL_Texture *texture = SDL_CreateTexture(swRenderer, format, access, w, h);
+         SDLTest_AssertCheck(texture != NULL, "Check SDL_CreateTexture result for %s", SDL_GetPixelFormatName(format));
+         if (texture == NULL) {
+            continue;
+         }
+
+         released = 0;
+         ret = SDL_UpdateYUVTextureFrame(texture, Yplane, Ypitch, Uplane, Upitch,
+                                         nv ? NULL : Vplane, nv ? 0 : Upitch,
+                                         _countFrameRelease, &released);
+         SDLTest_AssertCheck(ret == 0, "Check SDL_UpdateYUVTextureFrame result, expected: 0, got: %i", ret);
+         SDLTest_AssertCheck(released <= 1, "Validate the frame is released at most once, got: %i", released);
+         ret = _compareRendered(swRenderer, texture, target, expected);
+         SDLTest_AssertCheck(ret == 0, "Validate %s frame matches the converted pixels", SDL_GetPixelFormatName(format));
+
+         /* Changing part of the texture has to start from the frame */
+         if (access == SDL_TEXTUREACCESS_STREAMING) {
+            void *pixels;
+            int pitch;
+            ret = SDL_LockTexture(texture, NULL, &pixels, &pitch);
+            SDLTest_AssertCheck(ret == 0, "Check SDL_LockTexture result, expected: 0, got: %i", ret);
+            SDL_UnlockTexture(texture);
+         } else if (!nv) {
+            SDL_Rect rect = { 0, 0, 2, 2 };
+            ret = SDL_UpdateYUVTexture(texture, &rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Upitch);
+            SDLTest_AssertCheck(ret == 0, "Check SDL_UpdateYUVTexture result, expected: 0, got: %i", ret);
+         }
+         if (access == SDL_TEXTUREACCESS_STREAMING || !nv) {
+            SDLTest_AssertCheck(released == 1, "Validate the frame is released once, got: %i", released);
+            ret = _compareRendered(swRenderer, texture, target, expected);
+            SDLTest_AssertCheck(ret == 0, "Validate %s texture still matches after a partial update", SDL_GetPixelFormatName(format));
+         }
+
+         /* A frame the texture still holds is released with it */
+         released2 = 0;
+         SDL_UpdateYUVTextureFrame(texture, Yplane, Ypitch, Uplane, Upitch,
+                                   nv ? NULL : Vplane, nv ? 0 : Upitch,
+                                   _countFrameRelease, &released2);
+         SDLTest_AssertCheck(released == 1, "Validate the first frame is released once, got: %i", released);
+         SDL_DestroyTexture(texture);
+         SDLTest_AssertCheck(released2 == 1, "Validate the second frame is released once, got: %i", released2);
+      }
+   }
+
+   /* Bad parameters still release the frame */
+   released = 0;
+   ret = SDL_UpdateYUVTextureFrame(NULL, Yplane, Ypitch, Uplane, cw, Vplane, cw,
+                                   _countFrameRelease, &released);
+   SDLTest_AssertCheck(ret == -1, "Check SDL_UpdateYUVTextureFrame result with NULL texture, expected: -1, got: %i", ret);
+   SDLTest_AssertCheck(released == 1, "Validate the frame is released once, got: %i", released);
+
+   SDL_free(expected);
+   SDL_free(packed);
+   SDL_free(Vplane);
+   SDL_free(Uplane);
+   SDL_free(Yplane);
+   SDL_DestroyRenderer(swRenderer);
+   SDL_FreeSurface(target);
+
+   return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Render test cases */
@@ -1085,9 +1369,15 @@ static const SDLTest_TestCaseReference renderTest6 =
 static const SDLTest_TestCaseReference renderTest7 =
         {  (SDLTest_TestCaseFp)render_testBlitBlend, "render_testBlitBlend", "Tests blitting with blending", TEST_DISABLED };
 
+static const SDLTest_TestCaseReference renderTest8 =
+        { (SDLTest_TestCaseFp)render_testSoftwareDirtyRects, "render_testSoftwareDirtyRects", "Tests presenting only what changed with the software renderer", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference renderTest9 =
+        { (SDLTest_TestCaseFp)render_testYUVTextureFrame, "render_testYUVTextureFrame", "Tests updating YUV textures from decoder planes", TEST_ENABLED };
+
 /* Sequence of Render test cases */
 static const SDLTest_TestCaseReference *renderTests[] =  {
-    &renderTest1, &renderTest2, &renderTest3, &renderTest4, &renderTest5, &renderTest6, &renderTest7, NULL
+    &renderTest1, &renderTest2, &renderTest3, &renderTest4, &renderTest5, &renderTest6, &renderTest7, &renderTest8, &renderTest9, NULL
 };
 
 /* Render test suite (global) */
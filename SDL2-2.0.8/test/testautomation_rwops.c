@@ -334,6 +334,219 @@ rwops_testFileRead(void)
    return TEST_COMPLETED;
 }
 
+/**
+ * @brief Tests reading from a memory mapped file.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromFileMapped
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWGetMemoryView
+ */
+int
+rwops_testFileMapped(void)
+{
+   SDL_RWops *rw;
+   const void *view;
+   size_t size;
+   Sint64 i;
+   int result;
+
+   /* Missing file */
+   rw = SDL_RWFromFileMapped("nonexistingfile.dat");
+   SDLTest_AssertPass("Call to SDL_RWFromFileMapped(\"nonexistingfile.dat\") succeeded");
+   SDLTest_AssertCheck(rw == NULL, "Verify SDL_RWFromFileMapped returns NULL for a missing file");
+
+   rw = SDL_RWFromFileMapped(RWopsReadTestFilename);
+   SDLTest_AssertPass("Call to SDL_RWFromFileMapped() succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening file with SDL_RWFromFileMapped does not return NULL");
+
+   /* Bail out if NULL */
+   if (rw == NULL) return TEST_ABORTED;
+
+   /* Check type */
+   SDLTest_AssertCheck(
+      rw->type == SDL_RWOPS_MAPPED,
+      "Verify RWops type is SDL_RWOPS_MAPPED; expected: %d, got: %d", SDL_RWOPS_MAPPED, rw->type);
+
+   /* Run generic tests */
+   _testGenericRWopsValidations( rw, 0 );
+
+   /* The view follows the position */
+   i = SDL_RWseek(rw, 6, RW_SEEK_SET);
+   SDLTest_AssertCheck(i == 6, "Verify seek to 6, got %"SDL_PRIs64, i);
+   size = 0;
+   view = SDL_RWGetMemoryView(rw, &size);
+   SDLTest_AssertPass("Call to SDL_RWGetMemoryView() succeeded");
+   SDLTest_AssertCheck(view != NULL, "Verify SDL_RWGetMemoryView does not return NULL");
+   SDLTest_AssertCheck(
+      size == sizeof(RWopsHelloWorldTestString)-7,
+      "Verify view size, expected %i, got %i", (int) (sizeof(RWopsHelloWorldTestString)-7), (int) size);
+   if (view != NULL) {
+      SDLTest_AssertCheck(
+         SDL_memcmp(view, RWopsHelloWorldTestString + 6, size) == 0,
+         "Verify view matches the file contents");
+   }
+   i = SDL_RWtell(rw);
+   SDLTest_AssertCheck(i == 6, "Verify SDL_RWGetMemoryView didn't move the position, got %"SDL_PRIs64, i);
+
+   /* Close handle */
+   result = SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+   /* Empty files can't be mapped, but still open */
+   rw = SDL_RWFromFile(RWopsWriteTestFilename, "w");
+   SDLTest_AssertCheck(rw != NULL, "Verify creating an empty file");
+   if (rw == NULL) return TEST_ABORTED;
+   SDL_RWclose(rw);
+   rw = SDL_RWFromFileMapped(RWopsWriteTestFilename);
+   SDLTest_AssertPass("Call to SDL_RWFromFileMapped() on an empty file succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening an empty file does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+   i = SDL_RWsize(rw);
+   SDLTest_AssertCheck(i == 0, "Verify size of empty file, expected 0, got %"SDL_PRIs64, i);
+   view = SDL_RWGetMemoryView(rw, &size);
+   SDLTest_AssertCheck(view != NULL && size == 0, "Verify view of empty file is empty, got %i bytes", (int) size);
+   result = SDL_RWclose(rw);
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+#ifdef __LINUX__
+   /* Files that can't be mapped are streamed instead */
+   rw = SDL_RWFromFileMapped("/dev/null");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening /dev/null with SDL_RWFromFileMapped does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+   SDLTest_AssertCheck(
+      rw->type != SDL_RWOPS_MAPPED,
+      "Verify RWops type is not SDL_RWOPS_MAPPED; got: %d", rw->type);
+   view = SDL_RWGetMemoryView(rw, &size);
+   SDLTest_AssertCheck(view == NULL, "Verify SDL_RWGetMemoryView returns NULL for /dev/null");
+   SDL_RWclose(rw);
+#endif
+
+   /* Streams that aren't in memory have no view */
+   rw = SDL_RWFromFile(RWopsReadTestFilename, "r");
+   SDLTest_AssertCheck(rw != NULL, "Verify opening file with SDL_RWFromFile does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+   view = SDL_RWGetMemoryView(rw, &size);
+   SDLTest_AssertCheck(view == NULL, "Verify SDL_RWGetMemoryView returns NULL for a file stream");
+   SDL_RWclose(rw);
+
+   return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests reading through a read-ahead buffer.
+ *
+ * \sa
+ * http://wiki.libsdl.org/moin.cgi/SDL_RWFromBuffered
+ */
+int
+rwops_testBuffered(void)
+{
+   char direct[sizeof(RWopsAlphabetString)];
+   char buffered[sizeof(RWopsAlphabetString)];
+   SDL_RWops *src, *rw, *mem;
+   Sint64 i, j;
+   size_t s1, s2;
+   int n, len, pos, whence, result;
+
+   src = SDL_RWFromFile(RWopsReadTestFilename, "r");
+   SDLTest_AssertCheck(src != NULL, "Verify opening file with SDL_RWFromFile does not return NULL");
+   if (src == NULL) return TEST_ABORTED;
+
+   /* Parameters */
+   rw = SDL_RWFromBuffered(NULL, 16, SDL_FALSE);
+   SDLTest_AssertCheck(rw == NULL, "Verify SDL_RWFromBuffered(NULL, ...) returns NULL");
+   rw = SDL_RWFromBuffered(src, 0, SDL_FALSE);
+   SDLTest_AssertCheck(rw == NULL, "Verify SDL_RWFromBuffered(..., 0, ...) returns NULL");
+
+   rw = SDL_RWFromBuffered(src, 5, SDL_TRUE);
+   SDLTest_AssertPass("Call to SDL_RWFromBuffered() succeeded");
+   SDLTest_AssertCheck(rw != NULL, "Verify SDL_RWFromBuffered does not return NULL");
+   if (rw == NULL) {
+      SDL_RWclose(src);
+      return TEST_ABORTED;
+   }
+   SDLTest_AssertCheck(
+      rw->type == SDL_RWOPS_BUFFERED,
+      "Verify RWops type is SDL_RWOPS_BUFFERED; expected: %d, got: %d", SDL_RWOPS_BUFFERED, rw->type);
+
+   /* Run generic tests */
+   _testGenericRWopsValidations( rw, 0 );
+
+   result = SDL_RWclose(rw);
+   SDLTest_AssertPass("Call to SDL_RWclose() succeeded");
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+
+   /* Random reads and seeks match the unbuffered stream */
+   mem = SDL_RWFromConstMem(RWopsAlphabetString, sizeof(RWopsAlphabetString)-1);
+   src = SDL_RWFromFile(RWopsAlphabetFilename, "r");
+   SDLTest_AssertCheck(mem != NULL && src != NULL, "Verify opening the alphabet as memory and as a file");
+   if (mem == NULL || src == NULL) return TEST_ABORTED;
+   rw = SDL_RWFromBuffered(src, 7, SDL_FALSE);
+   SDLTest_AssertCheck(rw != NULL, "Verify SDL_RWFromBuffered does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+   for (n = 0; n < 200; n++) {
+      if (SDLTest_RandomIntegerInRange(0, 2) == 0) {
+         whence = SDLTest_RandomIntegerInRange(RW_SEEK_SET, RW_SEEK_END);
+         pos = (whence == RW_SEEK_END) ? -SDLTest_RandomIntegerInRange(0, 26) :
+               (whence == RW_SEEK_CUR) ? SDLTest_RandomIntegerInRange(-(int)SDL_RWtell(mem), 26 - (int)SDL_RWtell(mem)) :
+                                         SDLTest_RandomIntegerInRange(0, 26);
+         i = SDL_RWseek(mem, pos, whence);
+         j = SDL_RWseek(rw, pos, whence);
+         if (i != j) {
+            SDLTest_AssertCheck(i == j, "Verify seek %d/%d result, expected %"SDL_PRIs64", got %"SDL_PRIs64, pos, whence, i, j);
+            break;
+         }
+      } else {
+         len = SDLTest_RandomIntegerInRange(1, 12);
+         SDL_zero(direct);
+         SDL_zero(buffered);
+         s1 = SDL_RWread(mem, direct, 1, len);
+         s2 = SDL_RWread(rw, buffered, 1, len);
+         if (s1 != s2 || SDL_memcmp(direct, buffered, s1) != 0) {
+            SDLTest_AssertCheck(SDL_FALSE, "Verify read of %d bytes, expected '%s', got '%s'", len, direct, buffered);
+            break;
+         }
+      }
+   }
+   SDLTest_AssertCheck(n == 200, "Verify 200 random reads and seeks matched");
+
+   /* Integer readers */
+   SDL_RWseek(rw, 0, RW_SEEK_SET);
+   s1 = SDL_ReadBE32(rw);
+   SDLTest_AssertCheck(s1 == 0x41424344, "Verify SDL_ReadBE32 through the buffer, expected 0x41424344, got 0x%x", (unsigned int) s1);
+   s1 = SDL_ReadU8(rw);
+   SDLTest_AssertCheck(s1 == 'E', "Verify SDL_ReadU8 through the buffer, expected 'E', got %d", (int) s1);
+
+   /* Closing leaves the file where reading stopped */
+   result = SDL_RWclose(rw);
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+   i = SDL_RWtell(src);
+   SDLTest_AssertCheck(i == 5, "Verify the file position after closing the buffer, expected 5, got %"SDL_PRIs64, i);
+   SDL_RWclose(src);
+   SDL_RWclose(mem);
+
+   /* Memory streams are read in place */
+   mem = SDL_RWFromConstMem(RWopsAlphabetString, sizeof(RWopsAlphabetString)-1);
+   SDLTest_AssertCheck(mem != NULL, "Verify opening the alphabet as memory");
+   if (mem == NULL) return TEST_ABORTED;
+   rw = SDL_RWFromBuffered(mem, 16, SDL_FALSE);
+   SDLTest_AssertCheck(rw != NULL, "Verify SDL_RWFromBuffered over memory does not return NULL");
+   if (rw == NULL) return TEST_ABORTED;
+   SDLTest_AssertCheck(
+      rw->type == SDL_RWOPS_MEMORY_RO,
+      "Verify RWops type is SDL_RWOPS_MEMORY_RO; expected: %d, got: %d", SDL_RWOPS_MEMORY_RO, rw->type);
+   s1 = SDL_ReadBE16(rw);
+   SDLTest_AssertCheck(s1 == 0x4142, "Verify SDL_ReadBE16 over memory, expected 0x4142, got 0x%x", (unsigned int) s1);
+   result = SDL_RWclose(rw);
+   SDLTest_AssertCheck(result == 0, "Verify result value is 0; got: %d", result);
+   i = SDL_RWtell(mem);
+   SDLTest_AssertCheck(i == 2, "Verify the memory position after closing the view, expected 2, got %"SDL_PRIs64, i);
+   SDL_RWclose(mem);
+
+   return TEST_COMPLETED;
+}
+
 /**
  * @brief Tests writing from file.
  *
@@ -733,10 +946,16 @@ static const SDLTest_TestCaseReference rwopsTest9 =
 static const SDLTest_TestCaseReference rwopsTest10 =
         { (SDLTest_TestCaseFp)rwops_testCompareRWFromMemWithRWFromFile, "rwops_testCompareRWFromMemWithRWFromFile", "Compare RWFromMem and RWFromFile RWops for read and seek", TEST_ENABLED };
 
+static const SDLTest_TestCaseReference rwopsTest11 =
+        { (SDLTest_TestCaseFp)rwops_testFileMapped, "rwops_testFileMapped", "Tests reading from a memory mapped file", TEST_ENABLED };
+
+static const SDLTest_TestCaseReference rwopsTest12 =
+        { (SDLTest_TestCaseFp)rwops_testBuffered, "rwops_testBuffered", "Tests reading through a read-ahead buffer", TEST_ENABLED };
+
 /* Sequence of RWops test cases */
 static const SDLTest_TestCaseReference *rwopsTests[] =  {
     &rwopsTest1, &rwopsTest2, &rwopsTest3, &rwopsTest4, &rwopsTest5, &rwopsTest6,
-    &rwopsTest7, &rwopsTest8, &rwopsTest9, &rwopsTest10, NULL
+    &rwopsTest7, &rwopsTest8, &rwopsTest9, &rwopsTest10, &rwopsTest11, &rwopsTest12, NULL
 };
 
 /* RWops test suite (global) */
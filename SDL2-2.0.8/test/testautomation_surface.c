@@ -588,6 +588,389 @@ surface_testBlitBlendLoop(void *arg) {
 
 }
 
+/**
+ * @brief Tests that surface pixels are recycled through the surface pool
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL_GetSurfacePoolStats
+ * http://wiki.libsdl.org/SDL_TrimSurfacePool
+ */
+int
+surface_testSurfacePool(void *arg)
+{
+    SDL_SurfacePoolStats before, after;
+    SDL_Surface *surface;
+    void *pixels;
+
+    SDL_SetHint(SDL_HINT_SURFACE_POOL, "1");
+    SDL_TrimSurfacePool(0);
+
+    /* The first allocation of a size can only miss */
+    SDL_GetSurfacePoolStats(&before);
+    surface = SDL_CreateRGBSurfaceWithFormat(0, 100, 100, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+    if (surface == NULL) {
+        SDL_SetHint(SDL_HINT_SURFACE_POOL, "0");
+        return TEST_ABORTED;
+    }
+    SDLTest_AssertCheck((surface->flags & SDL_POOLALLOC) != 0, "Verify surface has SDL_POOLALLOC set");
+    SDLTest_AssertCheck(((uintptr_t)surface->pixels & 63) == 0, "Verify pixels are 64-byte aligned");
+    pixels = surface->pixels;
+    SDL_FreeSurface(surface);
+    SDL_GetSurfacePoolStats(&after);
+    SDLTest_AssertCheck(after.misses == before.misses + 1, "Verify misses, expected: %u, got: %u", before.misses + 1, after.misses);
+    SDLTest_AssertCheck(after.bytes_retained > 0, "Verify freed pixels are retained");
+
+    /* A surface of the same size reuses the freed buffer */
+    before = after;
+    surface = SDL_CreateRGBSurfaceWithFormat(0, 100, 100, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+    if (surface != NULL) {
+        SDLTest_AssertCheck(surface->pixels == pixels, "Verify pixel buffer was reused");
+        SDL_FreeSurface(surface);
+    }
+    SDL_GetSurfacePoolStats(&after);
+    SDLTest_AssertCheck(after.hits == before.hits + 1, "Verify hits, expected: %u, got: %u", before.hits + 1, after.hits);
+
+    /* Trimming to nothing releases all buffers */
+    SDL_TrimSurfacePool(0);
+    SDL_GetSurfacePoolStats(&after);
+    SDLTest_AssertCheck(after.buffers_retained == 0, "Verify buffers_retained, expected: 0, got: %u", after.buffers_retained);
+    SDLTest_AssertCheck(after.bytes_retained == 0, "Verify bytes_retained, expected: 0, got: %u", (unsigned int)after.bytes_retained);
+
+    /* Without the hint pixels are not pooled */
+    SDL_SetHint(SDL_HINT_SURFACE_POOL, "0");
+    surface = SDL_CreateRGBSurfaceWithFormat(0, 100, 100, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(surface != NULL, "Verify surface is not NULL");
+    if (surface != NULL) {
+        SDLTest_AssertCheck((surface->flags & SDL_POOLALLOC) == 0, "Verify surface has SDL_POOLALLOC cleared");
+        SDL_FreeSurface(surface);
+    }
+
+    return TEST_COMPLETED;
+}
+
+/**
+ * @brief Tests that threaded blits match single threaded blits
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL_BlitSurface
+ */
+int
+surface_testThreadedBlit(void *arg)
+{
+    static const Uint32 formats[] = {
+        SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB888,
+        SDL_PIXELFORMAT_RGB565, SDL_PIXELFORMAT_RGB24
+    };
+    static const SDL_BlendMode modes[] = {
+        SDL_BLENDMODE_NONE, SDL_BLENDMODE_BLEND, SDL_BLENDMODE_ADD, SDL_BLENDMODE_MOD
+    };
+    const int w = 1023, h = 611;
+    SDL_Surface *source, *serial, *threaded;
+    Uint32 *pixels;
+    int i, j, x, y, ret;
+
+    /* A source with varied color and alpha */
+    source = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDLTest_AssertCheck(source != NULL, "Verify source surface is not NULL");
+    if (source == NULL) {
+        return TEST_ABORTED;
+    }
+    for (y = 0; y < h; ++y) {
+        pixels = (Uint32 *)((Uint8 *)source->pixels + y * source->pitch);
+        for (x = 0; x < w; ++x) {
+            pixels[x] = (Uint32)(x * 2654435761u) ^ (Uint32)(y * 40503u);
+        }
+    }
+
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        for (j = 0; j < SDL_arraysize(modes); ++j) {
+            serial = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, formats[i]);
+            threaded = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, formats[i]);
+            SDLTest_AssertCheck(serial != NULL && threaded != NULL, "Verify destination surfaces are not NULL");
+            if (serial == NULL || threaded == NULL) {
+                SDL_FreeSurface(serial);
+                SDL_FreeSurface(threaded);
+                continue;
+            }
+            SDL_FillRect(serial, NULL, SDL_MapRGB(serial->format, 40, 80, 120));
+            SDL_FillRect(threaded, NULL, SDL_MapRGB(threaded->format, 40, 80, 120));
+            SDL_SetSurfaceBlendMode(source, modes[j]);
+
+            SDL_SetHint(SDL_HINT_BLIT_THREADS, "0");
+            ret = SDL_BlitSurface(source, NULL, serial, NULL);
+            SDLTest_AssertCheck(ret == 0, "Verify serial blit, expected: 0, got: %i", ret);
+
+            SDL_SetHint(SDL_HINT_BLIT_THREADS, "4");
+            ret = SDL_BlitSurface(source, NULL, threaded, NULL);
+            SDLTest_AssertCheck(ret == 0, "Verify threaded blit, expected: 0, got: %i", ret);
+
+            ret = SDLTest_CompareSurfaces(threaded, serial, 0);
+            SDLTest_AssertCheck(ret == 0, "Validate %s blend mode %d, expected: 0, got: %i", SDL_GetPixelFormatName(formats[i]), modes[j], ret);
+
+            SDL_FreeSurface(serial);
+            SDL_FreeSurface(threaded);
+        }
+    }
+    SDL_SetHint(SDL_HINT_BLIT_THREADS, "0");
+    SDL_FreeSurface(source);
+
+    return TEST_COMPLETED;
+}
+
+/* Reference for 32-bit RGB to RGB blending, as done by SDL_blit_A.c */
+static Uint32
+_blendRGBtoRGB(Uint32 s, Uint32 d, Uint32 alpha, SDL_bool pixel_alpha)
+{
+    Uint32 s1, d1, dalpha;
+
+    if (pixel_alpha) {
+        if (alpha == 0) {
+            return d;
+        } else if (alpha == 255) {
+            return s;
+        }
+        dalpha = alpha + ((d >> 24) * (alpha ^ 0xFF) >> 8);
+    } else {
+        if (alpha == 128) {
+            return ((((s & 0x00fefefe) + (d & 0x00fefefe)) >> 1) + (s & d & 0x00010101)) | 0xff000000;
+        }
+        dalpha = 0xff;
+    }
+    s1 = s & 0xff00ff;
+    d1 = d & 0xff00ff;
+    d1 = (d1 + ((s1 - d1) * alpha >> 8)) & 0xff00ff;
+    s &= 0xff00;
+    d &= 0xff00;
+    d = (d + ((s - d) * alpha >> 8)) & 0xff00;
+    return d1 | d | (dalpha << 24);
+}
+
+/**
+ * @brief Tests the 32-bit RGB to RGB alpha blending blitters
+ *
+ * With AVX2 or NEON the blitters must match the C reference exactly,
+ * the MMX blitters may be off by one.
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL_BlitSurface
+ */
+int
+surface_testBlitRGBtoRGBAlpha(void *arg)
+{
+    static const struct {
+        Uint32 format;
+        Uint8 alphamod;
+    } cases[] = {
+        { SDL_PIXELFORMAT_ARGB8888, 255 },
+        { SDL_PIXELFORMAT_ABGR8888, 255 },
+        { SDL_PIXELFORMAT_RGB888, 100 },
+        { SDL_PIXELFORMAT_BGR888, 128 }
+    };
+    const int w = 333, h = 17;
+    const int tolerance = (SDL_HasAVX2() || SDL_HasNEON()) ? 0 : 1;
+    SDL_Surface *src, *dst;
+    Uint32 *srcp, *dstp;
+    int i, x, y, errors;
+
+    for (i = 0; i < SDL_arraysize(cases); ++i) {
+        const SDL_bool pixel_alpha = (cases[i].alphamod == 255);
+
+        src = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, cases[i].format);
+        dst = SDL_CreateRGBSurfaceWithFormat(0, w, h, 32, cases[i].format);
+        SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces are not NULL");
+        if (src == NULL || dst == NULL) {
+            SDL_FreeSurface(src);
+            SDL_FreeSurface(dst);
+            return TEST_ABORTED;
+        }
+        for (y = 0; y < h; ++y) {
+            srcp = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+            dstp = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+            for (x = 0; x < w; ++x) {
+                srcp[x] = (Uint32)((x * 2654435761u) ^ (y * 40503u));
+                /* Make sure transparent and opaque pixels show up */
+                if (x % 7 == 0) {
+                    srcp[x] &= 0x00ffffff;
+                } else if (x % 7 == 1) {
+                    srcp[x] |= 0xff000000;
+                }
+                dstp[x] = (Uint32)((x * 40503u) ^ (y * 2654435761u));
+            }
+        }
+        SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_BLEND);
+        SDL_SetSurfaceAlphaMod(src, cases[i].alphamod);
+        SDL_BlitSurface(src, NULL, dst, NULL);
+
+        /* Recreate the destination pattern and compare */
+        errors = 0;
+        for (y = 0; y < h; ++y) {
+            srcp = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+            dstp = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+            for (x = 0; x < w; ++x) {
+                const Uint32 d = (Uint32)((x * 40503u) ^ (y * 2654435761u));
+                const Uint32 alpha = pixel_alpha ? (srcp[x] >> 24) : cases[i].alphamod;
+                const Uint32 expected = _blendRGBtoRGB(srcp[x], pixel_alpha ? d : (d | 0xff000000), alpha, pixel_alpha);
+                int c;
+                for (c = 0; c < 32; c += 8) {
+                    if (SDL_abs((int)((dstp[x] >> c) & 0xff) - (int)((expected >> c) & 0xff)) > tolerance) {
+                        ++errors;
+                        break;
+                    }
+                }
+            }
+        }
+        SDLTest_AssertCheck(errors == 0, "Validate %s with alpha mod %d, expected: 0 errors, got: %d",
+                            SDL_GetPixelFormatName(cases[i].format), cases[i].alphamod, errors);
+
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+    }
+
+    return TEST_COMPLETED;
+}
+
+/* Reference for one channel of SDL_SoftStretchLinear() along one axis */
+static void
+_linearSample(int i, int src_len, int dst_len, int *p0, int *p1, int *weight)
+{
+    Sint64 pos = (((Sint64)(2 * i + 1) * src_len - dst_len) * 256) / (2 * (Sint64)dst_len);
+    if (pos < 0) {
+        pos = 0;
+    }
+    *p0 = (int)(pos >> 8);
+    if (*p0 >= src_len - 1) {
+        *p0 = *p1 = src_len - 1;
+        *weight = 0;
+    } else {
+        *p1 = *p0 + 1;
+        *weight = (int)(pos & 0xFF);
+    }
+}
+
+static Uint32
+_lerpPixel(Uint32 a, Uint32 b, int weight)
+{
+    Uint32 result = 0;
+    int c;
+    for (c = 0; c < 32; c += 8) {
+        const Uint32 value = (((a >> c) & 0xFF) * (256 - weight) + ((b >> c) & 0xFF) * weight + 128) >> 8;
+        result |= value << c;
+    }
+    return result;
+}
+
+/**
+ * @brief Tests nearest and linear stretching against reference implementations
+ *
+ * \sa
+ * http://wiki.libsdl.org/SDL_SoftStretch
+ * http://wiki.libsdl.org/SDL_SoftStretchLinear
+ */
+int
+surface_testSoftStretch(void *arg)
+{
+    static const struct {
+        int src_w, src_h, dst_w, dst_h;
+    } sizes[] = {
+        { 37, 23, 101, 59 },    /* up */
+        { 101, 59, 37, 23 },    /* down */
+        { 64, 1, 13, 7 },       /* mixed, single row */
+        { 5, 5, 5, 5 }          /* same size */
+    };
+    SDL_Surface *src, *dst, *dst16;
+    Uint32 *srcp, *dstp, *rowp;
+    int i, x, y, ret, errors;
+    int ypos, sy;
+
+    for (i = 0; i < SDL_arraysize(sizes); ++i) {
+        const int src_w = sizes[i].src_w, src_h = sizes[i].src_h;
+        const int dst_w = sizes[i].dst_w, dst_h = sizes[i].dst_h;
+
+        src = SDL_CreateRGBSurfaceWithFormat(0, src_w, src_h, 32, SDL_PIXELFORMAT_ARGB8888);
+        dst = SDL_CreateRGBSurfaceWithFormat(0, dst_w, dst_h, 32, SDL_PIXELFORMAT_ARGB8888);
+        SDLTest_AssertCheck(src != NULL && dst != NULL, "Verify surfaces are not NULL");
+        if (src == NULL || dst == NULL) {
+            SDL_FreeSurface(src);
+            SDL_FreeSurface(dst);
+            return TEST_ABORTED;
+        }
+        for (y = 0; y < src_h; ++y) {
+            srcp = (Uint32 *)((Uint8 *)src->pixels + y * src->pitch);
+            for (x = 0; x < src_w; ++x) {
+                srcp[x] = (Uint32)((x * 2654435761u) ^ (y * 40503u));
+            }
+        }
+
+        /* Nearest sampling steps through the source in 16.16 fixed point */
+        ret = SDL_SoftStretch(src, NULL, dst, NULL);
+        SDLTest_AssertCheck(ret == 0, "Verify SDL_SoftStretch() result, expected: 0, got: %i", ret);
+        errors = 0;
+        ypos = 0x10000;
+        sy = -1;
+        for (y = 0; y < dst_h; ++y) {
+            int pos = 0x10000, inc = (src_w << 16) / dst_w, sx = -1;
+            while (ypos >= 0x10000) {
+                ++sy;
+                ypos -= 0x10000;
+            }
+            ypos += (src_h << 16) / dst_h;
+            srcp = (Uint32 *)((Uint8 *)src->pixels + sy * src->pitch);
+            dstp = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+            for (x = 0; x < dst_w; ++x) {
+                while (pos >= 0x10000) {
+                    ++sx;
+                    pos -= 0x10000;
+                }
+                if (dstp[x] != srcp[sx]) {
+                    ++errors;
+                }
+                pos += inc;
+            }
+        }
+        SDLTest_AssertCheck(errors == 0, "Validate nearest %dx%d -> %dx%d, expected: 0 errors, got: %d", src_w, src_h, dst_w, dst_h, errors);
+
+        /* Linear filtering blends the four closest source pixels */
+        ret = SDL_SoftStretchLinear(src, NULL, dst, NULL);
+        SDLTest_AssertCheck(ret == 0, "Verify SDL_SoftStretchLinear() result, expected: 0, got: %i", ret);
+        errors = 0;
+        for (y = 0; y < dst_h; ++y) {
+            int y0, y1, wy;
+            _linearSample(y, src_h, dst_h, &y0, &y1, &wy);
+            srcp = (Uint32 *)((Uint8 *)src->pixels + y0 * src->pitch);
+            rowp = (Uint32 *)((Uint8 *)src->pixels + y1 * src->pitch);
+            dstp = (Uint32 *)((Uint8 *)dst->pixels + y * dst->pitch);
+            for (x = 0; x < dst_w; ++x) {
+                int x0, x1, wx;
+                _linearSample(x, src_w, dst_w, &x0, &x1, &wx);
+                if (dstp[x] != _lerpPixel(_lerpPixel(srcp[x0], srcp[x1], wx), _lerpPixel(rowp[x0], rowp[x1], wx), wy)) {
+                    ++errors;
+                }
+            }
+        }
+        SDLTest_AssertCheck(errors == 0, "Validate linear %dx%d -> %dx%d, expected: 0 errors, got: %d", src_w, src_h, dst_w, dst_h, errors);
+
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+    }
+
+    /* Linear filtering needs 32-bit pixels */
+    src = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 16, SDL_PIXELFORMAT_RGB565);
+    dst16 = SDL_CreateRGBSurfaceWithFormat(0, 16, 16, 16, SDL_PIXELFORMAT_RGB565);
+    SDLTest_AssertCheck(src != NULL && dst16 != NULL, "Verify surfaces are not NULL");
+    if (src != NULL && dst16 != NULL) {
+        ret = SDL_SoftStretchLinear(src, NULL, dst16, NULL);
+        SDLTest_AssertCheck(ret == -1, "Verify SDL_SoftStretchLinear() on RGB565, expected: -1, got: %i", ret);
+        ret = SDL_SoftStretch(src, NULL, dst16, NULL);
+        SDLTest_AssertCheck(ret == 0, "Verify SDL_SoftStretch() on RGB565, expected: 0, got: %i", ret);
+    }
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst16);
+
+    return TEST_COMPLETED;
+}
+
 /* ================= Test References ================== */
 
 /* Surface test cases */
@@ -630,11 +1013,24 @@ static const SDLTest_TestCaseReference surfaceTest11 =
 static const SDLTest_TestCaseReference surfaceTest12 =
         { (SDLTest_TestCaseFp)surface_testBlitBlendMod, "surface_testBlitBlendMod", "Tests blitting routines with mod blending mode.", TEST_ENABLED};
 
+static const SDLTest_TestCaseReference surfaceTest13 =
+        { (SDLTest_TestCaseFp)surface_testSurfacePool, "surface_testSurfacePool", "Tests recycling of surface pixels through the surface pool.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest14 =
+        { (SDLTest_TestCaseFp)surface_testThreadedBlit, "surface_testThreadedBlit", "Tests that threaded blits match single threaded blits.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest15 =
+        { (SDLTest_TestCaseFp)surface_testBlitRGBtoRGBAlpha, "surface_testBlitRGBtoRGBAlpha", "Tests the 32-bit RGB to RGB alpha blending blitters.", TEST_ENABLED};
+
+static const SDLTest_TestCaseReference surfaceTest16 =
+        { (SDLTest_TestCaseFp)surface_testSoftStretch, "surface_testSoftStretch", "Tests nearest and linear stretching.", TEST_ENABLED};
+
 /* Sequence of Surface test cases */
 static const SDLTest_TestCaseReference *surfaceTests[] =  {
     &surfaceTest1, &surfaceTest2, &surfaceTest3, &surfaceTest4, &surfaceTest5,
     &surfaceTest6, &surfaceTest7, &surfaceTest8, &surfaceTest9, &surfaceTest10,
-    &surfaceTest11, &surfaceTest12, NULL
+    &surfaceTest11, &surfaceTest12, &surfaceTest13, &surfaceTest14,
+    &surfaceTest15, &surfaceTest16, NULL
 };
 
 /* Surface test suite (global) */
@@ -0,0 +1,179 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Throughput benchmark for the software blitters.
+   Runs every format pair of the generated blit table (SDL_blit_auto.c),
+   plus the pairs with hand written kernels in SDL_blit_A.c, through each
+   blend mode, with and without scaling.
+
+   Usage: testblitbench [--width N] [--height N] [--frames N]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+static const Uint32 src_formats[] = {
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_BGR888,
+    SDL_PIXELFORMAT_ARGB8888,
+    SDL_PIXELFORMAT_RGBA8888,
+    SDL_PIXELFORMAT_ABGR8888,
+    SDL_PIXELFORMAT_BGRA8888
+};
+
+static const Uint32 dst_formats[] = {
+    SDL_PIXELFORMAT_RGB888,
+    SDL_PIXELFORMAT_BGR888,
+    SDL_PIXELFORMAT_ARGB8888
+};
+
+/* Pairs outside the generated table that have their own kernels */
+static const Uint32 extra_pairs[][2] = {
+    { SDL_PIXELFORMAT_ABGR8888, SDL_PIXELFORMAT_ABGR8888 },
+    { SDL_PIXELFORMAT_ARGB8888, SDL_PIXELFORMAT_RGB565 }
+};
+
+static const struct
+{
+    SDL_BlendMode mode;
+    Uint8 alpha;
+    const char *name;
+} modes[] = {
+    { SDL_BLENDMODE_NONE, 255, "none" },
+    { SDL_BLENDMODE_BLEND, 255, "blend" },
+    { SDL_BLENDMODE_BLEND, 160, "blend+alphamod" },
+    { SDL_BLENDMODE_ADD, 255, "add" },
+    { SDL_BLENDMODE_MOD, 255, "mod" }
+};
+
+static int width = 1920;
+static int height = 1080;
+static int frames = 20;
+
+static SDL_Surface *
+CreateSourceSurface(Uint32 format)
+{
+    SDL_Surface *surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, format);
+    int x, y;
+
+    if (!surface) {
+        return NULL;
+    }
+    /* Mix of transparent, opaque and translucent pixels */
+    for (y = 0; y < height; ++y) {
+        Uint32 *pixels = (Uint32 *)((Uint8 *)surface->pixels + y * surface->pitch);
+        for (x = 0; x < width; ++x) {
+            const Uint8 a = (x / 64) % 4 == 0 ? 0 : (x / 64) % 4 == 1 ? 255 : (Uint8)(x ^ y);
+            pixels[x] = SDL_MapRGBA(surface->format, (Uint8)x, (Uint8)y, (Uint8)(x + y), a);
+        }
+    }
+    return surface;
+}
+
+static void
+RunBlitBench(Uint32 src_format, Uint32 dst_format)
+{
+    SDL_Surface *src = CreateSourceSurface(src_format);
+    SDL_Surface *dst = SDL_CreateRGBSurfaceWithFormat(0, width, height, SDL_BITSPERPIXEL(dst_format), dst_format);
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    int i, j;
+
+    if (!src || !dst) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create surfaces: %s\n", SDL_GetError());
+        SDL_FreeSurface(src);
+        SDL_FreeSurface(dst);
+        return;
+    }
+
+    for (i = 0; i < SDL_arraysize(modes); ++i) {
+        SDL_Rect scaled;
+        Uint64 start, unscaled_ticks, scaled_ticks;
+
+        SDL_SetSurfaceBlendMode(src, modes[i].mode);
+        SDL_SetSurfaceAlphaMod(src, modes[i].alpha);
+
+        SDL_FillRect(dst, NULL, SDL_MapRGB(dst->format, 64, 128, 192));
+        SDL_BlitSurface(src, NULL, dst, NULL);  /* warm up */
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < frames; ++j) {
+            SDL_BlitSurface(src, NULL, dst, NULL);
+        }
+        unscaled_ticks = SDL_GetPerformanceCounter() - start;
+
+        scaled.x = scaled.y = 0;
+        scaled.w = width * 3 / 4;
+        scaled.h = height * 3 / 4;
+        start = SDL_GetPerformanceCounter();
+        for (j = 0; j < frames; ++j) {
+            SDL_BlitScaled(src, NULL, dst, &scaled);
+        }
+        scaled_ticks = SDL_GetPerformanceCounter() - start;
+
+        SDL_Log("%-24s -> %-24s %-15s %8.1f Mpix/s  scaled %8.1f Mpix/s\n",
+                SDL_GetPixelFormatName(src_format), SDL_GetPixelFormatName(dst_format), modes[i].name,
+                ((double)width * height * frames * freq) / ((double)SDL_max(unscaled_ticks, 1) * 1000000.0),
+                ((double)scaled.w * scaled.h * frames * freq) / ((double)SDL_max(scaled_ticks, 1) * 1000000.0));
+    }
+
+    SDL_FreeSurface(src);
+    SDL_FreeSurface(dst);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, j;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--width") == 0 && argv[i+1]) {
+            width = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--height") == 0 && argv[i+1]) {
+            height = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "--frames") == 0 && argv[i+1]) {
+            frames = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("Usage: %s [--width N] [--height N] [--frames N]\n", argv[0]);
+            return (1);
+        }
+    }
+    if (width <= 0 || height <= 0 || frames <= 0) {
+        SDL_Log("Width, height and frames must be positive\n");
+        return (1);
+    }
+
+    if (SDL_Init(0) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return (1);
+    }
+
+    SDL_Log("Blitting %dx%d, %d frames per test, AVX2: %s, NEON: %s\n", width, height, frames,
+            SDL_HasAVX2() ? "yes" : "no", SDL_HasNEON() ? "yes" : "no");
+
+    for (i = 0; i < SDL_arraysize(src_formats); ++i) {
+        for (j = 0; j < SDL_arraysize(dst_formats); ++j) {
+            RunBlitBench(src_formats[i], dst_formats[j]);
+        }
+    }
+    for (i = 0; i < SDL_arraysize(extra_pairs); ++i) {
+        RunBlitBench(extra_pairs[i][0], extra_pairs[i][1]);
+    }
+
+    SDL_Quit();
+    return (0);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
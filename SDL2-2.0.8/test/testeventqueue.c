@@ -0,0 +1,167 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Contention benchmark for the SDL event queue.
+   Several threads push user events while the main thread polls them,
+   once with the locked queue and once with SDL_HINT_EVENT_QUEUE_LOCKFREE.
+ */
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define NUM_WRITERS 4
+#define EVENTS_PER_WRITER   250000
+
+typedef struct
+{
+    int index;
+    int waits;
+} WriterData;
+
+static Uint32 benchEvent;
+static SDL_atomic_t writersRunning;
+
+static int SDLCALL
+EventWriter(void *_data)
+{
+    WriterData *data = (WriterData *)_data;
+    SDL_Event event;
+    int i;
+
+    SDL_zero(event);
+    event.type = benchEvent;
+    event.user.code = data->index;
+    for (i = 0; i < EVENTS_PER_WRITER; ++i) {
+        event.user.data1 = (void *)(uintptr_t)i;
+        while (SDL_PushEvent(&event) <= 0) {
+            /* The queue is full, let the reader catch up */
+            ++data->waits;
+            SDL_Delay(0);
+        }
+    }
+    SDL_AtomicAdd(&writersRunning, -1);
+    return 0;
+}
+
+static SDL_bool
+RunEventQueueTest(SDL_bool lock_free)
+{
+    WriterData writerData[NUM_WRITERS];
+    SDL_Thread *threads[NUM_WRITERS];
+    int expected[NUM_WRITERS];
+    Uint32 start, end;
+    int i, total = 0, polls = 0;
+    SDL_bool ordered = SDL_TRUE;
+    SDL_Event event;
+
+    SDL_Log("\nEvent queue test---------------------------------\n\n");
+    SDL_Log("Mode: %s\n", lock_free ? "LockFree" : "Mutex");
+
+    SDL_SetHint(SDL_HINT_EVENT_QUEUE_LOCKFREE, lock_free ? "1" : "0");
+    if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return SDL_FALSE;
+    }
+    benchEvent = SDL_RegisterEvents(1);
+
+    SDL_zero(writerData);
+    SDL_zero(expected);
+    SDL_AtomicSet(&writersRunning, NUM_WRITERS);
+
+    start = SDL_GetTicks();
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        char name[64];
+        SDL_snprintf(name, sizeof (name), "EventWriter%d", i);
+        writerData[i].index = i;
+        threads[i] = SDL_CreateThread(EventWriter, name, &writerData[i]);
+    }
+
+    while (total < NUM_WRITERS*EVENTS_PER_WRITER) {
+        ++polls;
+        while (SDL_PollEvent(&event)) {
+            if (event.type == benchEvent) {
+                const int writer = event.user.code;
+                if ((int)(uintptr_t)event.user.data1 != expected[writer]) {
+                    ordered = SDL_FALSE;
+                }
+                expected[writer] = (int)(uintptr_t)event.user.data1 + 1;
+                ++total;
+            }
+        }
+    }
+    end = SDL_GetTicks();
+
+    for (i = 0; i < NUM_WRITERS; ++i) {
+        SDL_WaitThread(threads[i], NULL);
+        SDL_Log("Writer %d wrote %d events, had %d waits\n", i, EVENTS_PER_WRITER, writerData[i].waits);
+    }
+    SDL_Log("Reader got %d events in %d polls\n", total, polls);
+    if (ordered) {
+        SDL_Log("Per-writer order: kept\n");
+    } else {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Per-writer order: BROKEN\n");
+    }
+    SDL_Log("Finished in %f sec, %f events/ms\n", (end - start) / 1000.f,
+            (float)total / (float)SDL_max(end - start, 1));
+
+    SDL_QuitSubSystem(SDL_INIT_EVENTS);
+    return ordered;
+}
+
+/* Push events with nobody reading them, returns how many fit */
+static int
+RunEventQueueCapacityTest(SDL_bool lock_free)
+{
+    SDL_Event event;
+    int count = 0;
+
+    SDL_SetHint(SDL_HINT_EVENT_QUEUE_LOCKFREE, lock_free ? "1" : "0");
+    if (SDL_Init(SDL_INIT_EVENTS) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return -1;
+    }
+    SDL_zero(event);
+    event.type = SDL_RegisterEvents(1);
+    while (SDL_PushEvent(&event) > 0) {
+        ++count;
+    }
+    SDL_Log("Mode: %s, the queue holds %d events\n", lock_free ? "LockFree" : "Mutex", count);
+    SDL_QuitSubSystem(SDL_INIT_EVENTS);
+    return count;
+}
+
+int
+main(int argc, char *argv[])
+{
+    SDL_bool ok = SDL_TRUE;
+    int capacity;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (!RunEventQueueTest(SDL_FALSE)) {
+        ok = SDL_FALSE;
+    }
+    if (!RunEventQueueTest(SDL_TRUE)) {
+        ok = SDL_FALSE;
+    }
+
+    SDL_Log("\nEvent queue capacity test------------------------\n\n");
+    capacity = RunEventQueueCapacityTest(SDL_FALSE);
+    if (capacity <= 0 || RunEventQueueCapacityTest(SDL_TRUE) != capacity) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "The lock-free ring changes the queue capacity\n");
+        ok = SDL_FALSE;
+    }
+
+    SDL_Quit();
+    return ok ? 0 : 1;
+}
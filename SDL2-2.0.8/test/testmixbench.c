@@ -0,0 +1,129 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Throughput benchmark for SDL_MixAudioFormat.
+   Mixes a number of stereo sources into one buffer, the way SDL_mixer's
+   mix_channels does in every audio callback, for a few buffer sizes and
+   source counts, in each of the formats that have SIMD kernels.
+
+   Usage: testmixbench [--callbacks N]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+static const int buffer_frames[] = { 256, 1024, 4096 };
+
+static const int source_counts[] = { 1, 8, 32, 64 };
+
+static const struct
+{
+    SDL_AudioFormat format;
+    const char *name;
+} formats[] = {
+    { AUDIO_S16SYS, "S16" },
+    { AUDIO_S32SYS, "S32" },
+    { AUDIO_F32SYS, "F32" }
+};
+
+static int callbacks = 2000;
+
+static void
+RunMixBench(SDL_AudioFormat format, const char *name, int frames, int sources, int volume)
+{
+    const int len = frames * 2 * SDL_AUDIO_BITSIZE(format) / 8;
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint8 *stream, *source;
+    Uint64 start, ticks;
+    double seconds;
+    int i, j;
+
+    stream = (Uint8 *) SDL_malloc(len);
+    source = (Uint8 *) SDL_malloc(len);
+    if (!stream || !source) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        SDL_free(stream);
+        SDL_free(source);
+        return;
+    }
+
+    /* Something other than silence, and quiet enough to rarely clip */
+    for (i = 0; i < frames * 2; ++i) {
+        const int value = (i * 7919) % 2001 - 1000;
+        if (format == AUDIO_S16SYS) {
+            ((Sint16 *) source)[i] = (Sint16) value;
+        } else if (format == AUDIO_S32SYS) {
+            ((Sint32 *) source)[i] = value * 65536;
+        } else {
+            ((float *) source)[i] = value / 32768.0f;
+        }
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < callbacks; ++i) {
+        SDL_memset(stream, 0, len);
+        for (j = 0; j < sources; ++j) {
+            SDL_MixAudioFormat(stream, source, format, len, volume);
+        }
+    }
+    ticks = SDL_GetPerformanceCounter() - start;
+
+    seconds = (double) ticks / (double) freq;
+    SDL_Log("%s  %5d frames  %3d sources  volume %3d  %8.2f ns/sample  %8.1f us/callback\n",
+            name, frames, sources, volume,
+            (seconds * 1e9) / ((double) callbacks * sources * frames * 2),
+            (seconds * 1e6) / callbacks);
+
+    SDL_free(stream);
+    SDL_free(source);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, j, k;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--callbacks") == 0 && argv[i+1]) {
+            callbacks = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("Usage: %s [--callbacks N]\n", argv[0]);
+            return (1);
+        }
+    }
+    if (callbacks <= 0) {
+        SDL_Log("Callbacks must be positive\n");
+        return (1);
+    }
+
+    SDL_Log("Mixing %d callbacks per test, SSE2: %s, AVX2: %s, NEON: %s\n", callbacks,
+            SDL_HasSSE2() ? "yes" : "no", SDL_HasAVX2() ? "yes" : "no", SDL_HasNEON() ? "yes" : "no");
+
+    for (k = 0; k < SDL_arraysize(formats); ++k) {
+        for (i = 0; i < SDL_arraysize(buffer_frames); ++i) {
+            for (j = 0; j < SDL_arraysize(source_counts); ++j) {
+                RunMixBench(formats[k].format, formats[k].name, buffer_frames[i], source_counts[j], SDL_MIX_MAXVOLUME / 2);
+            }
+        }
+        /* Full volume skips the scaling in some kernels */
+        RunMixBench(formats[k].format, formats[k].name, 1024, 32, SDL_MIX_MAXVOLUME);
+    }
+
+    return (0);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
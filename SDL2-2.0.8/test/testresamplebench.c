@@ -0,0 +1,225 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Throughput benchmark for audio resampling.
+   Pushes float audio through SDL_AudioStream in 10 ms packets, the way an
+   audio callback would, for a few common rate pairs and channel counts.
+   Each pair runs with both filters of the internal resampler, then with
+   every SDL_HINT_AUDIO_RESAMPLING_MODE setting.  Those use libsamplerate
+   when SDL was built with it, and the internal resampler otherwise.
+
+   Then it converts whole one second buffers with SDL_ConvertAudio() for a
+   few chains that change the format and channel count along the way.
+
+   Usage: testresamplebench [--seconds N]
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "SDL.h"
+
+static const int rate_pairs[][2] = {
+    { 48000, 44100 },
+    { 44100, 48000 },
+    { 44100, 16000 },
+    { 16000, 48000 }
+};
+
+static const int channel_counts[] = { 1, 2, 6 };
+
+static const struct
+{
+    const char *resampling_mode;
+    const char *internal_resampler;
+    const char *name;
+} modes[] = {
+    { "default", "default", "internal" },
+    { "default", "fast", "internal fast" },
+    { "fast", "default", "mode fast" },
+    { "medium", "default", "mode medium" },
+    { "best", "default", "mode best" }
+};
+
+static const struct
+{
+    SDL_AudioFormat src_format;
+    Uint8 src_channels;
+    int src_rate;
+    SDL_AudioFormat dst_format;
+    Uint8 dst_channels;
+    int dst_rate;
+    const char *name;
+} chains[] = {
+    { AUDIO_S16SYS, 2, 44100, AUDIO_F32SYS, 2, 48000, "S16 stereo 44100 -> F32 stereo 48000" },
+    { AUDIO_F32SYS, 6, 48000, AUDIO_S16SYS, 2, 44100, "F32 5.1 48000 -> S16 stereo 44100" },
+    { AUDIO_S16SYS, 6, 48000, AUDIO_F32SYS, 2, 48000, "S16 5.1 48000 -> F32 stereo 48000" },
+    { AUDIO_S16SYS, 1, 22050, AUDIO_S16SYS, 2, 44100, "S16 mono 22050 -> S16 stereo 44100" }
+};
+
+static int seconds = 10;
+
+static void
+RunResampleBench(int src_rate, int dst_rate, int channels, const char *name)
+{
+    const int packet_frames = src_rate / 100;
+    const int packet_len = packet_frames * channels * (int) sizeof (float);
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    SDL_AudioStream *stream;
+    float *packet, *output;
+    Uint64 start, ticks;
+    int i, j, output_len;
+
+    stream = SDL_NewAudioStream(AUDIO_F32SYS, channels, src_rate, AUDIO_F32SYS, channels, dst_rate);
+    if (!stream) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't create audio stream: %s\n", SDL_GetError());
+        return;
+    }
+
+    output_len = 4 * packet_len * dst_rate / src_rate;
+    packet = (float *) SDL_malloc(packet_len);
+    output = (float *) SDL_malloc(output_len);
+    if (!packet || !output) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        SDL_free(packet);
+        SDL_free(output);
+        SDL_FreeAudioStream(stream);
+        return;
+    }
+    for (i = 0; i < packet_frames; ++i) {
+        for (j = 0; j < channels; ++j) {
+            packet[i * channels + j] = (float) (0.5 * sin(i * (0.05 + 0.01 * j)));
+        }
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < seconds * 100; ++i) {
+        SDL_AudioStreamPut(stream, packet, packet_len);
+        while (SDL_AudioStreamGet(stream, output, output_len) > 0) {
+        }
+    }
+    ticks = SDL_GetPerformanceCounter() - start;
+
+    SDL_Log("%6d -> %-6d %d ch  %-14s %9.1f x realtime\n", src_rate, dst_rate, channels, name,
+            ((double) seconds * freq) / (double) SDL_max(ticks, 1));
+
+    SDL_free(packet);
+    SDL_free(output);
+    SDL_FreeAudioStream(stream);
+}
+
+static void
+RunConvertBench(SDL_AudioFormat src_format, Uint8 src_channels, int src_rate,
+                SDL_AudioFormat dst_format, Uint8 dst_channels, int dst_rate, const char *name)
+{
+    const int src_framelen = src_channels * SDL_AUDIO_BITSIZE(src_format) / 8;
+    const Uint64 freq = SDL_GetPerformanceFrequency();
+    SDL_AudioCVT cvt;
+    Uint8 *data;
+    Uint64 start, ticks;
+    int i;
+
+    if (SDL_BuildAudioCVT(&cvt, src_format, src_channels, src_rate, dst_format, dst_channels, dst_rate) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't build audio conversion: %s\n", SDL_GetError());
+        return;
+    }
+
+    /* Something other than silence, converted again every time */
+    cvt.len = src_rate * src_framelen;
+    data = (Uint8 *) SDL_malloc(cvt.len);
+    cvt.buf = (Uint8 *) SDL_malloc(cvt.len * cvt.len_mult);
+    if (!data || !cvt.buf) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Out of memory\n");
+        SDL_free(data);
+        SDL_free(cvt.buf);
+        return;
+    }
+    for (i = 0; i < cvt.len; ++i) {
+        data[i] = (Uint8) (i * 7919);
+    }
+    if (SDL_AUDIO_ISFLOAT(src_format)) {
+        for (i = 0; i < cvt.len / (int) sizeof (float); ++i) {
+            ((float *) data)[i] = (float) (0.5 * sin(i * 0.05));
+        }
+    }
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < seconds; ++i) {
+        SDL_memcpy(cvt.buf, data, cvt.len);
+        SDL_ConvertAudio(&cvt);
+    }
+    ticks = SDL_GetPerformanceCounter() - start;
+
+    SDL_Log("%-38s len_mult %2d %9.1f x realtime\n", name, cvt.len_mult,
+            ((double) seconds * freq) / (double) SDL_max(ticks, 1));
+
+    SDL_free(data);
+    SDL_free(cvt.buf);
+}
+
+int
+main(int argc, char *argv[])
+{
+    int i, j, k;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "--seconds") == 0 && argv[i+1]) {
+            seconds = SDL_atoi(argv[++i]);
+        } else {
+            SDL_Log("Usage: %s [--seconds N]\n", argv[0]);
+            return (1);
+        }
+    }
+    if (seconds <= 0) {
+        SDL_Log("Seconds must be positive\n");
+        return (1);
+    }
+
+    SDL_Log("Resampling %d seconds of audio per test, AVX2: %s, NEON: %s\n", seconds,
+            SDL_HasAVX2() ? "yes" : "no", SDL_HasNEON() ? "yes" : "no");
+
+    /* The resampling mode is only checked when the audio subsystem starts */
+    for (k = 0; k < SDL_arraysize(modes); ++k) {
+        SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, modes[k].resampling_mode);
+        SDL_SetHint(SDL_HINT_AUDIO_INTERNAL_RESAMPLER, modes[k].internal_resampler);
+        if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+            return (1);
+        }
+        for (i = 0; i < SDL_arraysize(rate_pairs); ++i) {
+            for (j = 0; j < SDL_arraysize(channel_counts); ++j) {
+                RunResampleBench(rate_pairs[i][0], rate_pairs[i][1], channel_counts[j], modes[k].name);
+            }
+        }
+        SDL_Quit();
+    }
+
+    SDL_SetHint(SDL_HINT_AUDIO_RESAMPLING_MODE, NULL);
+    SDL_SetHint(SDL_HINT_AUDIO_INTERNAL_RESAMPLER, NULL);
+    if (SDL_Init(SDL_INIT_AUDIO) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return (1);
+    }
+    for (k = 0; k < SDL_arraysize(chains); ++k) {
+        RunConvertBench(chains[k].src_format, chains[k].src_channels, chains[k].src_rate,
+                        chains[k].dst_format, chains[k].dst_channels, chains[k].dst_rate, chains[k].name);
+    }
+    SDL_Quit();
+
+    return (0);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,134 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Benchmark for the SDL timer thread: the cost of adding and removing
+   timers with many timers alive, and how late timers fire.
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "SDL.h"
+
+#define NUM_TIMERS      10000
+#define NUM_PROBES      200
+
+static SDL_TimerID ids[NUM_TIMERS];
+
+typedef struct
+{
+    Uint64 due;
+    Uint64 fired;
+} Probe;
+
+static Probe probes[NUM_PROBES];
+static SDL_atomic_t probes_fired;
+static Uint64 freq;
+
+static Uint32 SDLCALL
+idle(Uint32 interval, void *param)
+{
+    return interval;
+}
+
+static Uint32 SDLCALL
+probe(Uint32 interval, void *param)
+{
+    Probe *p = (Probe *)param;
+    p->fired = SDL_GetPerformanceCounter();
+    SDL_AtomicAdd(&probes_fired, 1);
+    return 0;
+}
+
+static double
+elapsed_us(Uint64 start, Uint64 end)
+{
+    return (double)(end - start) * 1000000.0 / (double)freq;
+}
+
+static void
+MeasureJitter(SDL_bool precise)
+{
+    double sum = 0.0, worst = 0.0;
+    int i;
+
+    SDL_AtomicSet(&probes_fired, 0);
+    for (i = 0; i < NUM_PROBES; ++i) {
+        /* Spread the probes out from 1 to ~50 ms */
+        const Uint32 ms = 1 + (i * 7) % 50;
+        probes[i].fired = 0;
+        probes[i].due = SDL_GetPerformanceCounter() + (freq * ms) / 1000;
+        if (precise) {
+            SDL_AddTimerUS(ms * 1000, probe, &probes[i]);
+        } else {
+            SDL_AddTimer(ms, probe, &probes[i]);
+        }
+    }
+    while (SDL_AtomicGet(&probes_fired) < NUM_PROBES) {
+        SDL_Delay(10);
+    }
+
+    for (i = 0; i < NUM_PROBES; ++i) {
+        double late = 0.0;
+        if (probes[i].fired > probes[i].due) {
+            late = elapsed_us(probes[i].due, probes[i].fired);
+        }
+        sum += late;
+        if (late > worst) {
+            worst = late;
+        }
+    }
+    SDL_Log("%s timers: average lateness %.1f us, worst %.1f us\n",
+            precise ? "SDL_AddTimerUS" : "SDL_AddTimer", sum / NUM_PROBES, worst);
+}
+
+int
+main(int argc, char *argv[])
+{
+    Uint64 start, now;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if (SDL_Init(SDL_INIT_TIMER) < 0) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s\n", SDL_GetError());
+        return (1);
+    }
+    freq = SDL_GetPerformanceFrequency();
+
+    /* Add a lot of long running timers with different intervals */
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        ids[i] = SDL_AddTimer(1000 + (i % 997) * 60, idle, NULL);
+    }
+    now = SDL_GetPerformanceCounter();
+    SDL_Log("Added %d timers: %.3f us per timer\n", NUM_TIMERS, elapsed_us(start, now) / NUM_TIMERS);
+
+    /* Give the timer thread a chance to take them all */
+    SDL_Delay(100);
+
+    MeasureJitter(SDL_FALSE);
+    MeasureJitter(SDL_TRUE);
+
+    start = SDL_GetPerformanceCounter();
+    for (i = 0; i < NUM_TIMERS; ++i) {
+        SDL_RemoveTimer(ids[i]);
+    }
+    now = SDL_GetPerformanceCounter();
+    SDL_Log("Removed %d timers: %.3f us per timer\n", NUM_TIMERS, elapsed_us(start, now) / NUM_TIMERS);
+
+    SDL_Quit();
+    return (0);
+}
+
+/* vi: set ts=4 sw=4 expandtab: */
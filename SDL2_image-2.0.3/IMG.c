@@ -69,6 +69,61 @@ extern void IMG_QuitWEBP(void);
 
 static int initialized = 0;
 
+/* Asynchronous loading.
+ * Loads wait in a queue sorted by priority, and are decoded by a pool of
+ * threads started on first use.  Loads with a callback are handed back
+ * by IMG_PumpAsyncLoads() on the caller's thread, the others by
+ * IMG_FinishAsyncLoad().  Decoded surfaces that haven't been handed back
+ * count against the memory limit, and workers don't start new loads
+ * while it is exceeded.
+ */
+enum {
+    IMG_ASYNC_QUEUED,
+    IMG_ASYNC_RUNNING,
+    IMG_ASYNC_DONE
+};
+
+struct IMG_AsyncLoad {
+    char *file;
+    SDL_RWops *src;
+    int freesrc;
+    char *type;
+    int priority;
+    IMG_AsyncLoadCallback callback;
+    void *userdata;
+
+    int state;
+    SDL_bool canceled;      /* running, free it when done */
+    SDL_Surface *surface;
+    size_t size;            /* of the surface pixels */
+    char *error;
+
+    IMG_AsyncLoad *next;    /* in the queue or the done list */
+    IMG_AsyncLoad *prev_load;
+    IMG_AsyncLoad *next_load;
+};
+
+static struct {
+    SDL_SpinLock init_lock;
+    SDL_mutex *lock;
+    SDL_cond *work;         /* a load was queued, memory freed, or quitting */
+    SDL_cond *finished;     /* a load was decoded */
+    SDL_Thread **threads;
+    int num_threads;
+    int max_threads;        /* 0 for one per CPU */
+    IMG_AsyncLoad *queue;
+    IMG_AsyncLoad *done;
+    IMG_AsyncLoad **done_tail;
+    IMG_AsyncLoad *loads;   /* all loads, for IMG_Quit() */
+    int pending;
+    size_t memory_limit;    /* 0 for no limit */
+    size_t memory_used;
+    SDL_bool quit;
+    SDL_mutex *serial_lock; /* held by loaders that aren't reentrant */
+} async;
+
+static void IMG_QuitAsyncLoads(void);
+
 int IMG_Init(int flags)
 {
     int result = 0;
@@ -105,6 +160,8 @@ int IMG_Init(int flags)
 
 void IMG_Quit()
 {
+    IMG_QuitAsyncLoads();
+
     if (initialized & IMG_INIT_JPG) {
         IMG_QuitJPG();
     }
@@ -124,7 +181,7 @@ void IMG_Quit()
 /* Load an image from a file */
 SDL_Surface *IMG_Load(const char *file)
 {
-    SDL_RWops *src = SDL_RWFromFile(file, "rb");
+    SDL_RWops *src = SDL_RWFromFileMapped(file);
     const char *ext = SDL_strrchr(file, '.');
     if(ext) {
         ext++;
@@ -192,7 +249,16 @@ SDL_Surface *IMG_LoadTyped_RW(SDL_RWops *src, int freesrc, const char *type)
         fprintf(stderr, "IMGLIB: Loading image as %s\n",
             supported[i].type);
 #endif
-        image = supported[i].load(src);
+        if (async.serial_lock &&
+            (supported[i].load == IMG_LoadGIF_RW ||
+             supported[i].load == IMG_LoadXPM_RW)) {
+            /* These keep their state in static variables */
+            SDL_LockMutex(async.serial_lock);
+            image = supported[i].load(src);
+            SDL_UnlockMutex(async.serial_lock);
+        } else {
+            image = supported[i].load(src);
+        }
         if(freesrc)
             SDL_RWclose(src);
         return image;
@@ -239,3 +305,448 @@ SDL_Texture *IMG_LoadTextureTyped_RW(SDL_Renderer *renderer, SDL_RWops *src, int
     return texture;
 }
 #endif /* SDL 2.0 */
+
+static void IMG_FreeAsyncLoad(IMG_AsyncLoad *load)
+{
+    if (load->src && load->freesrc) {
+        SDL_RWclose(load->src);
+    }
+    SDL_FreeSurface(load->surface);
+    SDL_free(load->file);
+    SDL_free(load->type);
+    SDL_free(load->error);
+    SDL_free(load);
+}
+
+/* These need the lock held */
+static void IMG_UnlinkAsyncLoad(IMG_AsyncLoad *load)
+{
+    if (load->prev_load) {
+        load->prev_load->next_load = load->next_load;
+    } else {
+        async.loads = load->next_load;
+    }
+    if (load->next_load) {
+        load->next_load->prev_load = load->prev_load;
+    }
+}
+
+static void IMG_RemoveFromList(IMG_AsyncLoad **list, IMG_AsyncLoad *load)
+{
+    IMG_AsyncLoad **prev;
+
+    for (prev = list; *prev; prev = &(*prev)->next) {
+        if (*prev == load) {
+            *prev = load->next;
+            if (list == &async.done && async.done_tail == &load->next) {
+                async.done_tail = prev;
+            }
+            break;
+        }
+    }
+    load->next = NULL;
+}
+
+static void IMG_QueueAsyncLoad(IMG_AsyncLoad *load)
+{
+    IMG_AsyncLoad **prev;
+
+    /* Higher priorities first, first come first served within one */
+    for (prev = &async.queue; *prev; prev = &(*prev)->next) {
+        if ((*prev)->priority < load->priority) {
+            break;
+        }
+    }
+    load->next = *prev;
+    *prev = load;
+}
+
+static void IMG_ReleaseAsyncMemory(IMG_AsyncLoad *load)
+{
+    async.memory_used -= load->size;
+    load->size = 0;
+    SDL_CondBroadcast(async.work);
+}
+
+static void IMG_DecodeAsyncLoad(IMG_AsyncLoad *load)
+{
+    if (load->file) {
+        load->surface = IMG_Load(load->file);
+    } else {
+        load->surface = IMG_LoadTyped_RW(load->src, load->freesrc, load->type);
+        load->src = NULL;
+    }
+    if (!load->surface) {
+        load->error = SDL_strdup(IMG_GetError());
+    }
+}
+
+static int SDLCALL IMG_AsyncThread(void *unused)
+{
+    IMG_AsyncLoad *load;
+
+    SDL_LockMutex(async.lock);
+    for ( ; ; ) {
+        while (!async.quit &&
+               (!async.queue ||
+                (async.memory_limit && async.memory_used >= async.memory_limit))) {
+            SDL_CondWait(async.work, async.lock);
+        }
+        if (async.quit) {
+            break;
+        }
+        load = async.queue;
+        async.queue = load->next;
+        load->next = NULL;
+        load->state = IMG_ASYNC_RUNNING;
+        SDL_UnlockMutex(async.lock);
+
+        IMG_DecodeAsyncLoad(load);
+
+        SDL_LockMutex(async.lock);
+        if (load->canceled) {
+            IMG_UnlinkAsyncLoad(load);
+            IMG_FreeAsyncLoad(load);
+            continue;
+        }
+        if (load->surface) {
+            load->size = (size_t)load->surface->h * load->surface->pitch;
+            async.memory_used += load->size;
+        }
+        load->state = IMG_ASYNC_DONE;
+        if (load->callback) {
+            *async.done_tail = load;
+            async.done_tail = &load->next;
+        }
+        SDL_CondBroadcast(async.finished);
+    }
+    SDL_UnlockMutex(async.lock);
+    return 0;
+}
+
+static int IMG_StartAsyncLoads(void)
+{
+    int i, num_threads;
+    int status = 0;
+
+    SDL_AtomicLock(&async.init_lock);
+    if (async.threads) {
+        SDL_AtomicUnlock(&async.init_lock);
+        return 0;
+    }
+
+    /* Load the image libraries now, so the loaders don't race to do it */
+    IMG_Init(IMG_INIT_JPG | IMG_INIT_PNG | IMG_INIT_TIF | IMG_INIT_WEBP);
+
+    async.lock = SDL_CreateMutex();
+    async.work = SDL_CreateCond();
+    async.finished = SDL_CreateCond();
+    async.serial_lock = SDL_CreateMutex();
+    num_threads = async.max_threads > 0 ? async.max_threads : SDL_GetCPUCount();
+    async.threads = (SDL_Thread **)SDL_calloc(num_threads, sizeof(*async.threads));
+    if (!async.lock || !async.work || !async.finished || !async.serial_lock || !async.threads) {
+        IMG_SetError("Out of memory");
+        status = -1;
+    } else {
+        async.done_tail = &async.done;
+        async.quit = SDL_FALSE;
+        for (i = 0; i < num_threads; ++i) {
+            async.threads[i] = SDL_CreateThread(IMG_AsyncThread, "SDL_image loader", NULL);
+            if (!async.threads[i]) {
+                break;
+            }
+        }
+        async.num_threads = i;
+        if (i == 0) {
+            /* SDL_CreateThread() set the error */
+            status = -1;
+        }
+    }
+    if (status < 0) {
+        /* Start from scratch the next time, rather than with no loaders */
+        SDL_DestroyMutex(async.lock);
+        SDL_DestroyCond(async.work);
+        SDL_DestroyCond(async.finished);
+        SDL_DestroyMutex(async.serial_lock);
+        SDL_free(async.threads);
+        async.lock = NULL;
+        async.work = NULL;
+        async.finished = NULL;
+        async.serial_lock = NULL;
+        async.threads = NULL;
+        async.num_threads = 0;
+    }
+    SDL_AtomicUnlock(&async.init_lock);
+    return status;
+}
+
+static void IMG_QuitAsyncLoads(void)
+{
+    int i;
+
+    if (!async.threads) {
+        return;
+    }
+
+    SDL_LockMutex(async.lock);
+    async.quit = SDL_TRUE;
+    SDL_CondBroadcast(async.work);
+    SDL_UnlockMutex(async.lock);
+    for (i = 0; i < async.num_threads; ++i) {
+        SDL_WaitThread(async.threads[i], NULL);
+    }
+
+    /* Nothing is running now, throw away what's left */
+    while (async.loads) {
+        IMG_AsyncLoad *load = async.loads;
+        async.loads = load->next_load;
+        IMG_FreeAsyncLoad(load);
+    }
+    SDL_DestroyMutex(async.lock);
+    SDL_DestroyCond(async.work);
+    SDL_DestroyCond(async.finished);
+    SDL_DestroyMutex(async.serial_lock);
+    SDL_free(async.threads);
+    async.lock = NULL;
+    async.work = NULL;
+    async.finished = NULL;
+    async.serial_lock = NULL;
+    async.threads = NULL;
+    async.num_threads = 0;
+    async.queue = NULL;
+    async.done = NULL;
+    async.pending = 0;
+    async.memory_used = 0;
+}
+
+static IMG_AsyncLoad *IMG_SubmitAsyncLoad(IMG_AsyncLoad *load)
+{
+    if (IMG_StartAsyncLoads() < 0) {
+        load->freesrc = 0;      /* the caller still has it */
+        IMG_FreeAsyncLoad(load);
+        return NULL;
+    }
+
+    SDL_LockMutex(async.lock);
+    load->state = IMG_ASYNC_QUEUED;
+    load->next_load = async.loads;
+    if (async.loads) {
+        async.loads->prev_load = load;
+    }
+    async.loads = load;
+    ++async.pending;
+    IMG_QueueAsyncLoad(load);
+    SDL_CondSignal(async.work);
+    SDL_UnlockMutex(async.lock);
+    return load;
+}
+
+void IMG_SetAsyncLoadLimits(int threads, size_t memory)
+{
+    SDL_AtomicLock(&async.init_lock);
+    async.max_threads = threads;
+    if (async.lock) {
+        SDL_LockMutex(async.lock);
+        async.memory_limit = memory;
+        SDL_CondBroadcast(async.work);
+        SDL_UnlockMutex(async.lock);
+    } else {
+        async.memory_limit = memory;
+    }
+    SDL_AtomicUnlock(&async.init_lock);
+}
+
+IMG_AsyncLoad *IMG_LoadAsync(const char *file, int priority, IMG_AsyncLoadCallback callback, void *userdata)
+{
+    IMG_AsyncLoad *load;
+
+    if (!file) {
+        IMG_SetError("Passed a NULL file name");
+        return NULL;
+    }
+    load = (IMG_AsyncLoad *)SDL_calloc(1, sizeof(*load));
+    if (!load) {
+        IMG_SetError("Out of memory");
+        return NULL;
+    }
+    load->file = SDL_strdup(file);
+    if (!load->file) {
+        SDL_free(load);
+        IMG_SetError("Out of memory");
+        return NULL;
+    }
+    load->priority = priority;
+    load->callback = callback;
+    load->userdata = userdata;
+    return IMG_SubmitAsyncLoad(load);
+}
+
+IMG_AsyncLoad *IMG_LoadTypedAsync_RW(SDL_RWops *src, int freesrc, const char *type, int priority, IMG_AsyncLoadCallback callback, void *userdata)
+{
+    IMG_AsyncLoad *load;
+
+    if (!src) {
+        IMG_SetError("Passed a NULL data source");
+        return NULL;
+    }
+    load = (IMG_AsyncLoad *)SDL_calloc(1, sizeof(*load));
+    if (!load) {
+        IMG_SetError("Out of memory");
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        return NULL;
+    }
+    if (type) {
+        load->type = SDL_strdup(type);
+        if (!load->type) {
+            SDL_free(load);
+            IMG_SetError("Out of memory");
+            if (freesrc) {
+                SDL_RWclose(src);
+            }
+            return NULL;
+        }
+    }
+    load->src = src;
+    load->freesrc = freesrc;
+    load->priority = priority;
+    load->callback = callback;
+    load->userdata = userdata;
+    load = IMG_SubmitAsyncLoad(load);
+    if (!load && freesrc) {
+        SDL_RWclose(src);
+    }
+    return load;
+}
+
+void IMG_SetAsyncLoadPriority(IMG_AsyncLoad *load, int priority)
+{
+    if (!load || !async.lock) {
+        return;
+    }
+    SDL_LockMutex(async.lock);
+    load->priority = priority;
+    if (load->state == IMG_ASYNC_QUEUED) {
+        IMG_RemoveFromList(&async.queue, load);
+        IMG_QueueAsyncLoad(load);
+    }
+    SDL_UnlockMutex(async.lock);
+}
+
+int IMG_AsyncLoadDone(IMG_AsyncLoad *load)
+{
+    int done;
+
+    if (!load || !async.lock) {
+        return 0;
+    }
+    SDL_LockMutex(async.lock);
+    done = (load->state == IMG_ASYNC_DONE);
+    SDL_UnlockMutex(async.lock);
+    return done;
+}
+
+SDL_Surface *IMG_FinishAsyncLoad(IMG_AsyncLoad *load)
+{
+    SDL_Surface *surface;
+
+    if (!load || !async.lock) {
+        IMG_SetError("Passed a NULL load");
+        return NULL;
+    }
+
+    SDL_LockMutex(async.lock);
+    if (load->state == IMG_ASYNC_QUEUED) {
+        /* Don't wait for a worker, decode it here */
+        IMG_RemoveFromList(&async.queue, load);
+        load->state = IMG_ASYNC_RUNNING;
+        SDL_UnlockMutex(async.lock);
+        IMG_DecodeAsyncLoad(load);
+        SDL_LockMutex(async.lock);
+    } else {
+        while (load->state != IMG_ASYNC_DONE) {
+            SDL_CondWait(async.finished, async.lock);
+        }
+        if (load->callback) {
+            IMG_RemoveFromList(&async.done, load);
+        }
+        IMG_ReleaseAsyncMemory(load);
+    }
+    IMG_UnlinkAsyncLoad(load);
+    --async.pending;
+    SDL_UnlockMutex(async.lock);
+
+    surface = load->surface;
+    load->surface = NULL;
+    if (!surface) {
+        IMG_SetError("%s", load->error ? load->error : "Couldn't load image");
+    }
+    IMG_FreeAsyncLoad(load);
+    return surface;
+}
+
+void IMG_CancelAsyncLoad(IMG_AsyncLoad *load)
+{
+    if (!load || !async.lock) {
+        return;
+    }
+
+    SDL_LockMutex(async.lock);
+    --async.pending;
+    if (load->state == IMG_ASYNC_RUNNING) {
+        /* The worker frees it when it's done */
+        load->canceled = SDL_TRUE;
+        SDL_UnlockMutex(async.lock);
+        return;
+    }
+    if (load->state == IMG_ASYNC_QUEUED) {
+        IMG_RemoveFromList(&async.queue, load);
+    } else {
+        if (load->callback) {
+            IMG_RemoveFromList(&async.done, load);
+        }
+        IMG_ReleaseAsyncMemory(load);
+    }
+    IMG_UnlinkAsyncLoad(load);
+    SDL_UnlockMutex(async.lock);
+
+    IMG_FreeAsyncLoad(load);
+}
+
+int IMG_PumpAsyncLoads(void)
+{
+    IMG_AsyncLoad *load;
+    int pending;
+
+    if (!async.lock) {
+        return 0;
+    }
+
+    SDL_LockMutex(async.lock);
+    while (async.done) {
+        load = async.done;
+        async.done = load->next;
+        if (!async.done) {
+            async.done_tail = &async.done;
+        }
+        load->next = NULL;
+        IMG_ReleaseAsyncMemory(load);
+        IMG_UnlinkAsyncLoad(load);
+        --async.pending;
+        SDL_UnlockMutex(async.lock);
+
+        /* The callback owns the surface */
+        if (!load->surface) {
+            IMG_SetError("%s", load->error ? load->error : "Couldn't load image");
+        }
+        load->callback(load->userdata, load->surface);
+        load->surface = NULL;
+        IMG_FreeAsyncLoad(load);
+
+        SDL_LockMutex(async.lock);
+    }
+    pending = async.pending;
+    SDL_UnlockMutex(async.lock);
+    return pending;
+}
@@ -875,21 +875,40 @@ LoadICOCUR_RW(SDL_RWops * src, int type, int freesrc)
     return (surface);
 }
 
+/* The loaders read headers, palettes and RLE data a few bytes at a time.
+   Closing the buffered stream leaves src after the image. */
+#define BMP_READ_AHEAD  65536
+
 /* Load a BMP type image from an SDL datasource */
 SDL_Surface *IMG_LoadBMP_RW(SDL_RWops *src)
 {
+    SDL_RWops *buffered = src ? SDL_RWFromBuffered(src, BMP_READ_AHEAD, SDL_FALSE) : NULL;
+
+    if ( buffered ) {
+        return(LoadBMP_RW(buffered, 1));
+    }
     return(LoadBMP_RW(src, 0));
 }
 
 /* Load a ICO type image from an SDL datasource */
 SDL_Surface *IMG_LoadICO_RW(SDL_RWops *src)
 {
+    SDL_RWops *buffered = src ? SDL_RWFromBuffered(src, BMP_READ_AHEAD, SDL_FALSE) : NULL;
+
+    if ( buffered ) {
+        return(LoadICOCUR_RW(buffered, 1, 1));
+    }
     return(LoadICOCUR_RW(src, 1, 0));
 }
 
 /* Load a CUR type image from an SDL datasource */
 SDL_Surface *IMG_LoadCUR_RW(SDL_RWops *src)
 {
+    SDL_RWops *buffered = src ? SDL_RWFromBuffered(src, BMP_READ_AHEAD, SDL_FALSE) : NULL;
+
+    if ( buffered ) {
+        return(LoadICOCUR_RW(buffered, 2, 1));
+    }
     return(LoadICOCUR_RW(src, 2, 0));
 }
 
@@ -146,8 +146,8 @@ static Image *ReadImage(SDL_RWops * src, int len, int height, int,
             unsigned char cmap[3][MAXCOLORMAPSIZE],
             int gray, int interlace, int ignore);
 
-Image *
-IMG_LoadGIF_RW(SDL_RWops *src)
+static Image *
+LoadGIF_RW(SDL_RWops *src)
 {
     Sint64 start;
     unsigned char buf[16];
@@ -269,6 +269,28 @@ done:
     return image;
 }
 
+/* The decoder reads a byte or a data block of at most 255 bytes at a time.
+   Closing the buffered stream leaves src after the image. */
+#define GIF_READ_AHEAD  65536
+
+Image *
+IMG_LoadGIF_RW(SDL_RWops *src)
+{
+    SDL_RWops *buffered;
+    Image *image;
+
+    if ( src == NULL ) {
+    return NULL;
+    }
+    buffered = SDL_RWFromBuffered(src, GIF_READ_AHEAD, SDL_FALSE);
+    if ( buffered == NULL ) {
+        return LoadGIF_RW(src);
+    }
+    image = LoadGIF_RW(buffered);
+    SDL_RWclose(buffered);
+    return image;
+}
+
 static int
 ReadColorMap(SDL_RWops *src, int number,
              unsigned char buffer[3][MAXCOLORMAPSIZE], int *gray)
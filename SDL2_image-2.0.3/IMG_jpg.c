@@ -316,12 +316,29 @@ static void output_no_message(j_common_ptr cinfo)
     /* do nothing */
 }
 
-/* Load a JPEG type image from an SDL datasource */
-SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
+/* Pick the largest DCT scaling that still leaves the image at least as big
+   as it would be when fit into max_w x max_h, so it only has to shrink. */
+static unsigned int JPG_ScaleDenom(j_decompress_ptr cinfo, int max_w, int max_h)
+{
+    unsigned int denom;
+
+    for ( denom = 8; denom > 1; denom /= 2 ) {
+        if ( (max_w > 0 && cinfo->image_width >= denom * max_w) ||
+             (max_h > 0 && cinfo->image_height >= denom * max_h) ) {
+            break;
+        }
+    }
+    return denom;
+}
+
+#define MAX_SCANLINES   16
+
+static SDL_Surface *LoadJPG_RW(SDL_RWops *src, int max_w, int max_h)
 {
     Sint64 start;
     struct jpeg_decompress_struct cinfo;
-    JSAMPROW rowptr[1];
+    JSAMPROW rowptr[MAX_SCANLINES];
+    JDIMENSION i, lines;
     SDL_Surface *volatile surface = NULL;
     struct my_error_mgr jerr;
 
@@ -354,6 +371,9 @@ SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
     jpeg_SDL_RW_src(&cinfo, src);
     lib.jpeg_read_header(&cinfo, TRUE);
 
+    cinfo.scale_num   = 1;
+    cinfo.scale_denom = JPG_ScaleDenom(&cinfo, max_w, max_h);
+
     if(cinfo.num_components == 4) {
         /* Set 32-bit Raw output */
         cinfo.out_color_space = JCS_CMYK;
@@ -373,8 +393,6 @@ SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
         cinfo.out_color_space = JCS_RGB;
         cinfo.quantize_colors = FALSE;
 #ifdef FAST_JPEG
-        cinfo.scale_num   = 1;
-        cinfo.scale_denom = 1;
         cinfo.dct_method = JDCT_FASTEST;
         cinfo.do_fancy_upsampling = FALSE;
 #endif
@@ -398,12 +416,15 @@ SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
         return NULL;
     }
 
-    /* Decompress the image */
+    /* Decompress the image, as many rows at a time as libjpeg will give */
     lib.jpeg_start_decompress(&cinfo);
     while ( cinfo.output_scanline < cinfo.output_height ) {
-        rowptr[0] = (JSAMPROW)(Uint8 *)surface->pixels +
-                            cinfo.output_scanline * surface->pitch;
-        lib.jpeg_read_scanlines(&cinfo, rowptr, (JDIMENSION) 1);
+        lines = SDL_min(cinfo.output_height - cinfo.output_scanline, MAX_SCANLINES);
+        for ( i = 0; i < lines; ++i ) {
+            rowptr[i] = (JSAMPROW)(Uint8 *)surface->pixels +
+                            (cinfo.output_scanline + i) * surface->pitch;
+        }
+        lib.jpeg_read_scanlines(&cinfo, rowptr, lines);
     }
     lib.jpeg_finish_decompress(&cinfo);
     lib.jpeg_destroy_decompress(&cinfo);
@@ -411,6 +432,18 @@ SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
     return(surface);
 }
 
+/* Load a JPEG type image from an SDL datasource */
+SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
+{
+    return LoadJPG_RW(src, 0, 0);
+}
+
+/* Load a JPEG type image, reduced by 1/2, 1/4 or 1/8 while decoding */
+SDL_Surface *IMG_LoadJPGScaled_RW(SDL_RWops *src, int max_w, int max_h)
+{
+    return LoadJPG_RW(src, max_w, max_h);
+}
+
 #define OUTPUT_BUFFER_SIZE   4096
 typedef struct {
     struct jpeg_destination_mgr pub;
@@ -558,8 +591,21 @@ SDL_Surface *IMG_LoadJPG_RW(SDL_RWops *src)
     return(NULL);
 }
 
+SDL_Surface *IMG_LoadJPGScaled_RW(SDL_RWops *src, int max_w, int max_h)
+{
+    return(NULL);
+}
+
 #endif /* LOAD_JPG */
 
+#else
+
+/* The platform decoders don't scale, load the full size image */
+SDL_Surface *IMG_LoadJPGScaled_RW(SDL_RWops *src, int max_w, int max_h)
+{
+    return IMG_LoadJPG_RW(src);
+}
+
 #endif /* !defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND) */
 
 /* We'll always have JPG save support */
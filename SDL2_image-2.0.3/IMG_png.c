@@ -23,6 +23,34 @@
 
 #include "SDL_image.h"
 
+#if defined(LOAD_PNG) || \
+    ((defined(__APPLE__) || defined(SDL_IMAGE_USE_WIC_BACKEND)) && !defined(SDL_IMAGE_USE_COMMON_BACKEND))
+/* Hand a whole decoded image to a rows callback, for when it can't be
+   streamed.  This takes ownership of the surface. */
+static int IMG_LoadRowsFromSurface(SDL_Surface *surface, Uint32 format, IMG_RowsCallback callback, void *userdata)
+{
+    SDL_Surface *converted;
+    SDL_Rect rect;
+    int status;
+
+    if ( !surface ) {
+        return -1;
+    }
+    converted = SDL_ConvertSurfaceFormat(surface, format, 0);
+    SDL_FreeSurface(surface);
+    if ( !converted ) {
+        return -1;
+    }
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = converted->w;
+    rect.h = converted->h;
+    status = callback(userdata, converted->w, converted->h, &rect, converted->pixels, converted->pitch);
+    SDL_FreeSurface(converted);
+    return (status < 0) ? -1 : 0;
+}
+#endif
+
 #if !(defined(__APPLE__) || defined(SDL_IMAGE_USE_WIC_BACKEND)) || defined(SDL_IMAGE_USE_COMMON_BACKEND)
 
 #ifdef LOAD_PNG
@@ -97,6 +125,7 @@ static struct {
     png_uint_32 (*png_get_tRNS) (png_const_structrp png_ptr, png_inforp info_ptr, png_bytep *trans, int *num_trans, png_color_16p *trans_values);
     png_uint_32 (*png_get_valid) (png_const_structrp png_ptr, png_const_inforp info_ptr, png_uint_32 flag);
     void (*png_read_image) (png_structrp png_ptr, png_bytepp image);
+    void (*png_read_rows) (png_structrp png_ptr, png_bytepp row, png_bytepp display_row, png_uint_32 num_rows);
     void (*png_read_info) (png_structrp png_ptr, png_inforp info_ptr);
     void (*png_read_update_info) (png_structrp png_ptr, png_inforp info_ptr);
     void (*png_set_expand) (png_structrp png_ptr);
@@ -148,6 +177,7 @@ int IMG_InitPNG()
         FUNCTION_LOADER(png_get_tRNS, png_uint_32 (*) (png_const_structrp png_ptr, png_inforp info_ptr, png_bytep *trans, int *num_trans, png_color_16p *trans_values))
         FUNCTION_LOADER(png_get_valid, png_uint_32 (*) (png_const_structrp png_ptr, png_const_inforp info_ptr, png_uint_32 flag))
         FUNCTION_LOADER(png_read_image, void (*) (png_structrp png_ptr, png_bytepp image))
+        FUNCTION_LOADER(png_read_rows, void (*) (png_structrp png_ptr, png_bytepp row, png_bytepp display_row, png_uint_32 num_rows))
         FUNCTION_LOADER(png_read_info, void (*) (png_structrp png_ptr, png_inforp info_ptr))
         FUNCTION_LOADER(png_read_update_info, void (*) (png_structrp png_ptr, png_inforp info_ptr))
         FUNCTION_LOADER(png_set_expand, void (*) (png_structrp png_ptr))
@@ -220,13 +250,12 @@ static void png_read_data(png_structp ctx, png_bytep area, png_size_t size)
     src = (SDL_RWops *)lib.png_get_io_ptr(ctx);
     SDL_RWread(src, area, size, 1);
 }
-SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
+
+/* Read the PNG header, set up the transforms and create a surface for
+   'rows' rows of the image, or all of it if 'rows' is 0. */
+static SDL_Surface *PNG_CreateSurface(png_structp png_ptr, png_infop info_ptr, int rows)
 {
-    Sint64 start;
-    const char *error;
-    SDL_Surface *volatile surface;
-    png_structp png_ptr;
-    png_infop info_ptr;
+    SDL_Surface *surface;
     png_uint_32 width, height;
     int bit_depth, color_type, interlace_type, num_channels;
     Uint32 Rmask;
@@ -234,57 +263,10 @@ SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
     Uint32 Bmask;
     Uint32 Amask;
     SDL_Palette *palette;
-    png_bytep *volatile row_pointers;
-    int row, i;
+    int i;
     int ckey = -1;
     png_color_16 *transv;
 
-    if ( !src ) {
-        /* The error message has been set in SDL_RWFromFile */
-        return NULL;
-    }
-    start = SDL_RWtell(src);
-
-    if ( (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0 ) {
-        return NULL;
-    }
-
-    /* Initialize the data we will clean up when we're done */
-    error = NULL;
-    png_ptr = NULL; info_ptr = NULL; row_pointers = NULL; surface = NULL;
-
-    /* Create the PNG loading context structure */
-    png_ptr = lib.png_create_read_struct(PNG_LIBPNG_VER_STRING,
-                      NULL,NULL,NULL);
-    if (png_ptr == NULL){
-        error = "Couldn't allocate memory for PNG file or incompatible PNG dll";
-        goto done;
-    }
-
-     /* Allocate/initialize the memory for image information.  REQUIRED. */
-    info_ptr = lib.png_create_info_struct(png_ptr);
-    if (info_ptr == NULL) {
-        error = "Couldn't create image information for PNG file";
-        goto done;
-    }
-
-    /* Set error handling if you are using setjmp/longjmp method (this is
-     * the normal method of doing things with libpng).  REQUIRED unless you
-     * set up your own error handlers in png_create_read_struct() earlier.
-     */
-#ifndef LIBPNG_VERSION_12
-    if ( setjmp(*lib.png_set_longjmp_fn(png_ptr, longjmp, sizeof (jmp_buf))) )
-#else
-    if ( setjmp(png_ptr->jmpbuf) )
-#endif
-    {
-        error = "Error reading the PNG file.";
-        goto done;
-    }
-
-    /* Set up the input control */
-    lib.png_set_read_fn(png_ptr, src, png_read_data);
-
     /* Read PNG header info */
     lib.png_read_info(png_ptr, info_ptr);
     lib.png_get_IHDR(png_ptr, info_ptr, &width, &height, &bit_depth,
@@ -366,11 +348,13 @@ SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
         Amask = 0x000000FF >> s;
 #endif
     }
-    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height,
+    if ( rows <= 0 || rows > (int)height ) {
+        rows = (int)height;
+    }
+    surface = SDL_CreateRGBSurface(SDL_SWSURFACE, width, rows,
             bit_depth*num_channels, Rmask,Gmask,Bmask,Amask);
     if ( surface == NULL ) {
-        error = SDL_GetError();
-        goto done;
+        return NULL;
     }
 
     if (ckey != -1) {
@@ -384,28 +368,6 @@ SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
         SDL_SetColorKey(surface, SDL_TRUE, ckey);
     }
 
-    /* Create the array of pointers to image data */
-    row_pointers = (png_bytep*) SDL_malloc(sizeof(png_bytep)*height);
-    if (!row_pointers) {
-        error = "Out of memory";
-        goto done;
-    }
-    for (row = 0; row < (int)height; row++) {
-        row_pointers[row] = (png_bytep)
-                (Uint8 *)surface->pixels + row*surface->pitch;
-    }
-
-    /* Read the entire image in one go */
-    lib.png_read_image(png_ptr, row_pointers);
-
-    /* and we're done!  (png_read_end() can be omitted if no processing of
-     * post-IDAT text/time/etc. is desired)
-     * In some cases it can't read PNG's created by some popular programs (ACDSEE),
-     * we do not want to process comments, so we omit png_read_end
-
-    lib.png_read_end(png_ptr, info_ptr);
-    */
-
     /* Load the palette, if any */
     palette = surface->format->palette;
     if ( palette ) {
@@ -428,6 +390,92 @@ SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
             }
         }
     }
+    return surface;
+}
+
+SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
+{
+    Sint64 start;
+    const char *error;
+    SDL_Surface *volatile surface;
+    png_structp png_ptr;
+    png_infop info_ptr;
+    png_bytep *volatile row_pointers;
+    int row;
+
+    if ( !src ) {
+        /* The error message has been set in SDL_RWFromFile */
+        return NULL;
+    }
+    start = SDL_RWtell(src);
+
+    if ( (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0 ) {
+        return NULL;
+    }
+
+    /* Initialize the data we will clean up when we're done */
+    error = NULL;
+    png_ptr = NULL; info_ptr = NULL; row_pointers = NULL; surface = NULL;
+
+    /* Create the PNG loading context structure */
+    png_ptr = lib.png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                      NULL,NULL,NULL);
+    if (png_ptr == NULL){
+        error = "Couldn't allocate memory for PNG file or incompatible PNG dll";
+        goto done;
+    }
+
+     /* Allocate/initialize the memory for image information.  REQUIRED. */
+    info_ptr = lib.png_create_info_struct(png_ptr);
+    if (info_ptr == NULL) {
+        error = "Couldn't create image information for PNG file";
+        goto done;
+    }
+
+    /* Set error handling if you are using setjmp/longjmp method (this is
+     * the normal method of doing things with libpng).  REQUIRED unless you
+     * set up your own error handlers in png_create_read_struct() earlier.
+     */
+#ifndef LIBPNG_VERSION_12
+    if ( setjmp(*lib.png_set_longjmp_fn(png_ptr, longjmp, sizeof (jmp_buf))) )
+#else
+    if ( setjmp(png_ptr->jmpbuf) )
+#endif
+    {
+        error = "Error reading the PNG file.";
+        goto done;
+    }
+
+    /* Set up the input control */
+    lib.png_set_read_fn(png_ptr, src, png_read_data);
+
+    surface = PNG_CreateSurface(png_ptr, info_ptr, 0);
+    if ( surface == NULL ) {
+        error = SDL_GetError();
+        goto done;
+    }
+
+    /* Create the array of pointers to image data */
+    row_pointers = (png_bytep*) SDL_malloc(sizeof(png_bytep)*surface->h);
+    if (!row_pointers) {
+        error = "Out of memory";
+        goto done;
+    }
+    for (row = 0; row < surface->h; row++) {
+        row_pointers[row] = (png_bytep)
+                (Uint8 *)surface->pixels + row*surface->pitch;
+    }
+
+    /* Read the entire image in one go */
+    lib.png_read_image(png_ptr, row_pointers);
+
+    /* and we're done!  (png_read_end() can be omitted if no processing of
+     * post-IDAT text/time/etc. is desired)
+     * In some cases it can't read PNG's created by some popular programs (ACDSEE),
+     * we do not want to process comments, so we omit png_read_end
+
+    lib.png_read_end(png_ptr, info_ptr);
+    */
 
 done:   /* Clean up and return */
     if ( png_ptr ) {
@@ -449,6 +497,196 @@ done:   /* Clean up and return */
     return(surface);
 }
 
+#define PNG_STREAM_ROWS 16
+
+/* Make the pixels in (rect) that match (key) transparent, keeping their
+   color, the way SDL_ConvertSurface() treats a colorkey */
+static void PNG_ColorkeyToAlpha(SDL_Surface *surface, const SDL_Rect *rect, Uint32 key)
+{
+    const Uint32 mask = ~surface->format->Amask;
+    Uint8 *row = (Uint8 *)surface->pixels + rect->y*surface->pitch;
+    int x, y;
+
+    key &= mask;
+    for ( y = 0; y < rect->h; ++y, row += surface->pitch ) {
+        if ( surface->format->BytesPerPixel == 4 ) {
+            Uint32 *spot = (Uint32 *)row + rect->x;
+            for ( x = 0; x < rect->w; ++x, ++spot ) {
+                if ( (*spot & mask) == key ) {
+                    *spot &= mask;
+                }
+            }
+        } else if ( surface->format->BytesPerPixel == 2 ) {
+            Uint16 *spot = (Uint16 *)row + rect->x;
+            for ( x = 0; x < rect->w; ++x, ++spot ) {
+                if ( (*spot & mask) == key ) {
+                    *spot &= (Uint16)mask;
+                }
+            }
+        }
+    }
+}
+
+/* Load a PNG type image a batch of rows at a time */
+int IMG_LoadPNGRows_RW(SDL_RWops *src, Uint32 format, IMG_RowsCallback callback, void *userdata)
+{
+    Sint64 start;
+    const char *error;
+    SDL_Surface *volatile batch;
+    SDL_Surface *volatile converted;
+    png_structp png_ptr;
+    png_infop info_ptr;
+    png_uint_32 width, height;
+    int interlace_type;
+    png_bytep row_pointers[PNG_STREAM_ROWS];
+    SDL_Surface *rows;
+    SDL_Rect rect;
+    Uint32 ckey;
+    SDL_bool has_ckey;
+    int i, y, status;
+
+    if ( !src ) {
+        /* The error message has been set in SDL_RWFromFile */
+        return -1;
+    }
+    if ( !callback ) {
+        return IMG_SetError("Passed a NULL callback");
+    }
+    if ( SDL_ISPIXELFORMAT_INDEXED(format) || SDL_ISPIXELFORMAT_FOURCC(format) ) {
+        return IMG_SetError("Unsupported pixel format");
+    }
+    start = SDL_RWtell(src);
+
+    if ( (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0 ) {
+        return -1;
+    }
+
+    /* Initialize the data we will clean up when we're done */
+    error = NULL;
+    status = 0;
+    png_ptr = NULL; info_ptr = NULL; batch = NULL; converted = NULL;
+
+    /* Create the PNG loading context structure */
+    png_ptr = lib.png_create_read_struct(PNG_LIBPNG_VER_STRING,
+                      NULL,NULL,NULL);
+    if (png_ptr == NULL){
+        error = "Couldn't allocate memory for PNG file or incompatible PNG dll";
+        goto done;
+    }
+
+    info_ptr = lib.png_create_info_struct(png_ptr);
+    if (info_ptr == NULL) {
+        error = "Couldn't create image information for PNG file";
+        goto done;
+    }
+
+#ifndef LIBPNG_VERSION_12
+    if ( setjmp(*lib.png_set_longjmp_fn(png_ptr, longjmp, sizeof (jmp_buf))) )
+#else
+    if ( setjmp(png_ptr->jmpbuf) )
+#endif
+    {
+        error = "Error reading the PNG file.";
+        goto done;
+    }
+
+    lib.png_set_read_fn(png_ptr, src, png_read_data);
+
+    batch = PNG_CreateSurface(png_ptr, info_ptr, PNG_STREAM_ROWS);
+    if ( batch == NULL ) {
+        error = SDL_GetError();
+        goto done;
+    }
+    lib.png_get_IHDR(png_ptr, info_ptr, &width, &height, NULL,
+            NULL, &interlace_type, NULL, NULL);
+
+    if ( interlace_type != PNG_INTERLACE_NONE ) {
+        /* Every pass touches every row, so the whole image is needed */
+        lib.png_destroy_read_struct(&png_ptr, &info_ptr, (png_infopp)0);
+        SDL_FreeSurface(batch);
+        SDL_RWseek(src, start, RW_SEEK_SET);
+        status = IMG_LoadRowsFromSurface(IMG_LoadPNG_RW(src), format, callback, userdata);
+        if ( status < 0 ) {
+            SDL_RWseek(src, start, RW_SEEK_SET);
+        }
+        return status;
+    }
+
+    /* Like SDL_ConvertSurface(), colorkeyed pixels keep their color, and
+       become transparent if the format has alpha.  Blits skip them, so
+       the key is taken off and the alpha set separately. */
+    has_ckey = (SDL_GetColorKey(batch, &ckey) == 0);
+    if ( has_ckey ) {
+        SDL_SetColorKey(batch, SDL_FALSE, 0);
+        if ( !SDL_ISPIXELFORMAT_ALPHA(format) ) {
+            has_ckey = SDL_FALSE;
+        } else if ( batch->format->palette ) {
+            /* The blit takes the alpha from the palette */
+            SDL_Color color = batch->format->palette->colors[ckey];
+            color.a = SDL_ALPHA_TRANSPARENT;
+            SDL_SetPaletteColors(batch->format->palette, &color, (int)ckey, 1);
+            has_ckey = SDL_FALSE;
+        }
+    }
+
+    /* Convert each batch unless libpng already gives the right format */
+    rows = batch;
+    if ( format != batch->format->format ) {
+        converted = SDL_CreateRGBSurfaceWithFormat(0, batch->w, batch->h,
+                SDL_BITSPERPIXEL(format), format);
+        if ( converted == NULL ) {
+            error = SDL_GetError();
+            goto done;
+        }
+        SDL_SetSurfaceBlendMode(batch, SDL_BLENDMODE_NONE);
+        rows = converted;
+        if ( has_ckey ) {
+            Uint8 r, g, b;
+            SDL_GetRGB(ckey, batch->format, &r, &g, &b);
+            ckey = SDL_MapRGB(converted->format, r, g, b);
+        }
+    }
+
+    for ( i = 0; i < batch->h; ++i ) {
+        row_pointers[i] = (png_bytep)(Uint8 *)batch->pixels + i*batch->pitch;
+    }
+    for ( y = 0; y < (int)height; y += rect.h ) {
+        rect.x = 0;
+        rect.y = 0;
+        rect.w = (int)width;
+        rect.h = SDL_min((int)height - y, batch->h);
+        lib.png_read_rows(png_ptr, row_pointers, NULL, rect.h);
+        if ( converted ) {
+            SDL_LowerBlit(batch, &rect, converted, &rect);
+            if ( has_ckey ) {
+                PNG_ColorkeyToAlpha(converted, &rect, ckey);
+            }
+        }
+        rect.y = y;
+        if ( callback(userdata, (int)width, (int)height, &rect, rows->pixels, rows->pitch) < 0 ) {
+            /* The callback has set the error */
+            SDL_RWseek(src, start, RW_SEEK_SET);
+            status = -1;
+            goto done;
+        }
+    }
+
+done:   /* Clean up and return */
+    if ( png_ptr ) {
+        lib.png_destroy_read_struct(&png_ptr,
+                                info_ptr ? &info_ptr : (png_infopp)0,
+                                (png_infopp)0);
+    }
+    SDL_FreeSurface(batch);
+    SDL_FreeSurface(converted);
+    if ( error ) {
+        SDL_RWseek(src, start, RW_SEEK_SET);
+        IMG_SetError("%s", error);
+        status = -1;
+    }
+    return status;
+}
+
 #else
 
 int IMG_InitPNG()
@@ -473,10 +711,67 @@ SDL_Surface *IMG_LoadPNG_RW(SDL_RWops *src)
     return(NULL);
 }
 
+int IMG_LoadPNGRows_RW(SDL_RWops *src, Uint32 format, IMG_RowsCallback callback, void *userdata)
+{
+    return IMG_SetError("PNG images are not supported");
+}
+
 #endif /* LOAD_PNG */
 
+#else
+
+/* The platform decoders only load whole images */
+int IMG_LoadPNGRows_RW(SDL_RWops *src, Uint32 format, IMG_RowsCallback callback, void *userdata)
+{
+    if ( !callback ) {
+        return IMG_SetError("Passed a NULL callback");
+    }
+    return IMG_LoadRowsFromSurface(IMG_LoadPNG_RW(src), format, callback, userdata);
+}
+
 #endif /* !defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND) */
 
+#if SDL_VERSION_ATLEAST(2,0,0)
+typedef struct {
+    SDL_Renderer *renderer;
+    SDL_Texture *texture;
+} PNG_TextureSink;
+
+static int SDLCALL PNG_UpdateTexture(void *userdata, int w, int h, const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    PNG_TextureSink *sink = (PNG_TextureSink *)userdata;
+
+    if ( !sink->texture ) {
+        sink->texture = SDL_CreateTexture(sink->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                          SDL_TEXTUREACCESS_STATIC, w, h);
+        if ( !sink->texture ) {
+            return -1;
+        }
+        SDL_SetTextureBlendMode(sink->texture, SDL_BLENDMODE_BLEND);
+    }
+    return SDL_UpdateTexture(sink->texture, rect, pixels, pitch);
+}
+
+/* Load a PNG type image straight into a texture */
+SDL_Texture *IMG_LoadPNGTexture_RW(SDL_Renderer *renderer, SDL_RWops *src, int freesrc)
+{
+    PNG_TextureSink sink;
+
+    sink.renderer = renderer;
+    sink.texture = NULL;
+    if ( IMG_LoadPNGRows_RW(src, SDL_PIXELFORMAT_ARGB8888, PNG_UpdateTexture, &sink) < 0 ) {
+        if ( sink.texture ) {
+            SDL_DestroyTexture(sink.texture);
+            sink.texture = NULL;
+        }
+    }
+    if ( src && freesrc ) {
+        SDL_RWclose(src);
+    }
+    return sink.texture;
+}
+#endif /* SDL 2.0 */
+
 /* We'll always have PNG save support */
 #define SAVE_PNG
 
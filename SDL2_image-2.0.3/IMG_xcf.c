@@ -737,7 +737,7 @@ do_layer_surface(SDL_Surface * surface, SDL_RWops * src, xcf_header * head, xcf_
     return 0;
 }
 
-SDL_Surface *IMG_LoadXCF_RW(SDL_RWops *src)
+static SDL_Surface *LoadXCF_RW(SDL_RWops *src)
 {
   Sint64 start;
   const char *error = NULL;
@@ -875,6 +875,29 @@ done:
   return(surface);
 }
 
+/* Properties, offsets and headers are read 32 bits at a time, and tiles
+   are read a few at a time between seeks.  Closing the buffered stream
+   leaves src after the image. */
+#define XCF_READ_AHEAD  65536
+
+SDL_Surface *IMG_LoadXCF_RW(SDL_RWops *src)
+{
+  SDL_RWops *buffered;
+  SDL_Surface *surface;
+
+  if (!src) {
+    /* The error message has been set in SDL_RWFromFile */
+    return NULL;
+  }
+  buffered = SDL_RWFromBuffered(src, XCF_READ_AHEAD, SDL_FALSE);
+  if (!buffered) {
+    return LoadXCF_RW(src);
+  }
+  surface = LoadXCF_RW(buffered);
+  SDL_RWclose(buffered);
+  return surface;
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -105,6 +105,36 @@ extern DECLSPEC SDL_Texture * SDLCALL IMG_LoadTexture_RW(SDL_Renderer *renderer,
 extern DECLSPEC SDL_Texture * SDLCALL IMG_LoadTextureTyped_RW(SDL_Renderer *renderer, SDL_RWops *src, int freesrc, const char *type);
 #endif /* SDL 2.0 */
 
+/* Load images on a pool of background threads.
+
+   Loads with a higher priority are decoded first.  When a callback is
+   given, it is called from IMG_PumpAsyncLoads() on the thread calling it,
+   so it may create textures, and it takes ownership of the surface.  If
+   the load failed the surface is NULL and IMG_GetError() has the reason.
+   Loads without a callback are claimed with IMG_FinishAsyncLoad(), which
+   waits for the load and returns the surface.
+
+   The returned handle is valid until the callback has been called, the
+   load is finished or canceled, or IMG_Quit() is called.
+ */
+typedef struct IMG_AsyncLoad IMG_AsyncLoad;
+typedef void (SDLCALL *IMG_AsyncLoadCallback)(void *userdata, SDL_Surface *surface);
+
+extern DECLSPEC IMG_AsyncLoad * SDLCALL IMG_LoadAsync(const char *file, int priority, IMG_AsyncLoadCallback callback, void *userdata);
+extern DECLSPEC IMG_AsyncLoad * SDLCALL IMG_LoadTypedAsync_RW(SDL_RWops *src, int freesrc, const char *type, int priority, IMG_AsyncLoadCallback callback, void *userdata);
+/* Run the callbacks of finished loads, returns the number of loads left */
+extern DECLSPEC int SDLCALL IMG_PumpAsyncLoads(void);
+extern DECLSPEC int SDLCALL IMG_AsyncLoadDone(IMG_AsyncLoad *load);
+extern DECLSPEC SDL_Surface * SDLCALL IMG_FinishAsyncLoad(IMG_AsyncLoad *load);
+/* Cancel a load, the callback won't be called */
+extern DECLSPEC void SDLCALL IMG_CancelAsyncLoad(IMG_AsyncLoad *load);
+extern DECLSPEC void SDLCALL IMG_SetAsyncLoadPriority(IMG_AsyncLoad *load, int priority);
+/* Set the number of threads used, 0 for one per CPU, before the first load.
+   Workers stop decoding while the surfaces not yet handed back use more than
+   'memory' bytes, 0 for no limit.
+ */
+extern DECLSPEC void SDLCALL IMG_SetAsyncLoadLimits(int threads, size_t memory);
+
 /* Functions to detect a file type, given a seekable source */
 extern DECLSPEC int SDLCALL IMG_isICO(SDL_RWops *src);
 extern DECLSPEC int SDLCALL IMG_isCUR(SDL_RWops *src);
@@ -128,9 +158,28 @@ extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadCUR_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadBMP_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadGIF_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadJPG_RW(SDL_RWops *src);
+/* Load a JPEG image using libjpeg's DCT scaling to shrink it by 1/2, 1/4 or
+   1/8 while decoding.  The largest reduction is used that keeps the image
+   at least as big as it would be when fit into max_w x max_h, so it can be
+   scaled down the rest of the way.  A size of 0 leaves that side unlimited.
+ */
+extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadJPGScaled_RW(SDL_RWops *src, int max_w, int max_h);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadLBM_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadPCX_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadPNG_RW(SDL_RWops *src);
+/* Load a PNG image a few rows at a time, without ever holding the whole
+   decoded image.  The callback gets each batch of rows, converted to
+   'format', with 'rect' giving where they go in the width x height image,
+   so it can be passed to SDL_UpdateTexture() or copied into a surface.
+   Returning a negative value from the callback stops the load.
+   Interlaced images are decoded in full and delivered in one batch.
+   This returns 0 on success, or -1 on error.
+ */
+typedef int (SDLCALL *IMG_RowsCallback)(void *userdata, int width, int height, const SDL_Rect *rect, const void *pixels, int pitch);
+extern DECLSPEC int SDLCALL IMG_LoadPNGRows_RW(SDL_RWops *src, Uint32 format, IMG_RowsCallback callback, void *userdata);
+#if SDL_VERSION_ATLEAST(2,0,0)
+extern DECLSPEC SDL_Texture * SDLCALL IMG_LoadPNGTexture_RW(SDL_Renderer *renderer, SDL_RWops *src, int freesrc);
+#endif
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadPNM_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadSVG_RW(SDL_RWops *src);
 extern DECLSPEC SDL_Surface * SDLCALL IMG_LoadTGA_RW(SDL_RWops *src);
@@ -89,6 +89,26 @@ extern DECLSPEC void SDLCALL Mix_Quit(void);
 #define MIX_CHANNELS    8
 #endif
 
+/* Set this hint (or environment variable) to a number of worker threads
+   before calling Mix_OpenAudio() to have them help the audio callback mix
+   the channels.  Each channel is always mixed by the same one of the
+   (threads + 1) partitions, so the output only depends on the number of
+   threads, not on how they were scheduled.  Effect callbacks of different
+   channels may then run at the same time on different threads.
+   The default is "0", which mixes every channel on the audio thread.
+ */
+#define MIX_HINT_MIX_THREADS    "SDL_MIXER_MIX_THREADS"
+
+/* Set this hint (or environment variable) to a number of milliseconds
+   before calling Mix_OpenAudio() to have OGG, FLAC and MP3 (libmad)
+   music decoded that far ahead on a background thread.  The audio
+   callback then only copies already decoded audio, so a slow disk or
+   decoder doesn't cause dropouts.  Seeking discards what was decoded
+   ahead.  Volume and fading still take effect immediately.
+   The default is "0", which decodes music in the audio callback.
+ */
+#define MIX_HINT_MUSIC_DECODE_AHEAD "SDL_MIXER_MUSIC_DECODE_AHEAD"
+
 /* Good default values for a PC soundcard */
 #define MIX_DEFAULT_FREQUENCY   22050
 #if SDL_BYTEORDER == SDL_LIL_ENDIAN
@@ -147,7 +167,7 @@ extern DECLSPEC int SDLCALL Mix_QuerySpec(int *frequency,Uint16 *format,int *cha
 
 /* Load a wave file or a music (.mod .s3m .it .xm) file */
 extern DECLSPEC Mix_Chunk * SDLCALL Mix_LoadWAV_RW(SDL_RWops *src, int freesrc);
-#define Mix_LoadWAV(file)   Mix_LoadWAV_RW(SDL_RWFromFile(file, "rb"), 1)
+#define Mix_LoadWAV(file)   Mix_LoadWAV_RW(SDL_RWFromFileMapped(file), 1)
 extern DECLSPEC Mix_Music * SDLCALL Mix_LoadMUS(const char *file);
 
 /* Load a music file from an SDL_RWop object (Ogg and MikMod specific currently)
@@ -167,6 +187,44 @@ extern DECLSPEC Mix_Chunk * SDLCALL Mix_QuickLoad_RAW(Uint8 *mem, Uint32 len);
 extern DECLSPEC void SDLCALL Mix_FreeChunk(Mix_Chunk *chunk);
 extern DECLSPEC void SDLCALL Mix_FreeMusic(Mix_Music *music);
 
+/* Cache the decoded and converted audio of chunks loaded with
+   Mix_LoadWAV_RW(), keyed by a hash of the file contents and the mixer
+   format.  Chunks loaded from the same data share one read-only buffer,
+   which stays cached after the last of them is freed, until the cache
+   needs the room for something else.
+   (max_bytes) is the budget for all the cached audio; buffers still in
+   use are never evicted, even if that puts the cache over budget.
+   The default is 0, which turns the cache off.
+   Mix_CloseAudio() drops the buffers no chunk is using, and Mix_Quit()
+   turns the cache off again; chunks still loaded keep their buffers
+   until they are freed.
+ */
+extern DECLSPEC void SDLCALL Mix_SetChunkCacheSize(Uint32 max_bytes);
+
+/* Also keep the converted audio in files in the directory (path), which
+   must exist.  When a file is loaded again, even by a later run of the
+   program, its audio is memory-mapped from there instead of decoded.
+   This works with a cache size of 0, in which case the files are only
+   mapped while chunks use them.
+   Files that can't be written or mapped are simply decoded every time.
+   Pass NULL to stop using the directory.
+   Returns 0 on success, or -1 on error.
+ */
+extern DECLSPEC int SDLCALL Mix_SetChunkCacheDir(const char *path);
+
+/* Counters for the chunk cache, since it was first turned on */
+typedef struct Mix_ChunkCacheStats
+{
+    Uint32 hits;        /* loads that shared an already cached buffer */
+    Uint32 misses;      /* loads that had to decode the file */
+    Uint32 disk_hits;   /* loads that mapped a file from the cache directory */
+    Uint32 evictions;   /* unused buffers dropped to stay in budget */
+    Uint32 entries;     /* buffers currently cached */
+    Uint32 bytes;       /* size of the audio currently cached */
+} Mix_ChunkCacheStats;
+
+extern DECLSPEC void SDLCALL Mix_GetChunkCacheStats(Mix_ChunkCacheStats *stats);
+
 /* Get a list of chunk/music decoders that this build of SDL_mixer provides.
    This list can change between builds AND runs of the program, if external
    libraries that add functionality become available.
@@ -338,15 +396,16 @@ extern DECLSPEC int SDLCALL Mix_UnregisterEffect(int channel, Mix_EffectFunc_t f
 extern DECLSPEC int SDLCALL Mix_UnregisterAllEffects(int channel);
 
 
+/* Deprecated: setting this environment variable used to make the internal
+ *  effects trade memory and quality for speed. They no longer have a slower
+ *  mode, so it doesn't change anything; it is only kept for compatibility.
+ */
 #define MIX_EFFECTSMAXSPEED  "MIX_EFFECTSMAXSPEED"
 
 /*
  * These are the internally-defined mixing effects. They use the same API that
  *  effects defined in the application use, but are provided here as a
- *  convenience. Some effects can reduce their quality or use more memory in
- *  the name of speed; to enable this, make sure the environment variable
- *  MIX_EFFECTSMAXSPEED (see above) is defined before you call
- *  Mix_OpenAudio().
+ *  convenience.
  */
 
 
@@ -595,6 +654,21 @@ extern DECLSPEC int SDLCALL Mix_PausedMusic(void);
 */
 extern DECLSPEC int SDLCALL Mix_SetMusicPosition(double position);
 
+/* Counters for music decoded ahead, see MIX_HINT_MUSIC_DECODE_AHEAD.
+   They are all zero if the music isn't decoded ahead.
+ */
+typedef struct Mix_MusicStreamStats
+{
+    Uint32 underruns;   /* callbacks that found too little decoded audio */
+    Uint32 decodes;     /* blocks decoded by the background thread */
+    Uint64 decode_us;   /* total time spent decoding them, in microseconds */
+    Uint32 max_decode_us; /* longest time spent decoding one of them */
+    Uint32 buffered;    /* bytes of audio currently decoded ahead */
+    Uint32 capacity;    /* size of the decode-ahead buffer, in bytes */
+} Mix_MusicStreamStats;
+
+extern DECLSPEC void SDLCALL Mix_GetMusicStreamStats(Mix_MusicStreamStats *stats);
+
 /* Check the status of a specific channel.
    If the specified channel is -1, check all channels.
 */
@@ -37,6 +37,27 @@
 #define __MIX_INTERNAL_EFFECT__
 #include "effects_internal.h"
 
+/* SIMD versions of the positional kernel, these mirror SDL's SDL_simd.h */
+#if defined(__SSE2__)
+#define POSITION_HAVE_SSE2  1
+#endif
+#if defined(_MSC_VER) && (_MSC_VER >= 1700) && (defined(_M_IX86) || defined(_M_X64)) && !defined(__clang__)
+#define POSITION_HAVE_AVX2  1
+#define POSITION_TARGETING_AVX2
+#elif HAVE_IMMINTRIN_H && !defined(SDL_DISABLE_IMMINTRIN_H) && (defined(__x86_64__) || defined(__i386__))
+#if defined(__AVX2__)
+#define POSITION_HAVE_AVX2  1
+#define POSITION_TARGETING_AVX2
+#elif defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+#define POSITION_HAVE_AVX2  1
+#define POSITION_TARGETING_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+#if (defined(__ARM_NEON) || defined(__ARM_NEON__)) && !defined(SDL_DISABLE_ARM_NEON_H)
+#include <arm_neon.h>
+#define POSITION_HAVE_NEON  1
+#endif
+
 /* profile code:
     #include <sys/time.h>
     #include <unistd.h>
@@ -75,6 +96,7 @@ typedef struct _Eff_positionargs
     volatile Sint16 room_angle;
     volatile int in_use;
     volatile int channels;
+    volatile Uint16 format;
 } position_args;
 
 static position_args **pos_args_array = NULL;
@@ -114,1021 +136,719 @@ static void _Eff_PositionDone(int channel, void *udata)
 }
 
 
-static void _Eff_position_u8(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Uint16) != 0) {
-        *ptr = (Uint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
+/*
+ * Every format and channel count goes through the same kernel: a block of
+ *  samples is converted to float (with the unsigned formats' bias taken
+ *  off), run through a gain matrix, and converted back.
+ *
+ * The matrix only ever routes one input channel to each output channel,
+ *  except for the center of a rotated 5.1 room, which blends two of them.
+ *  So it's kept as a source channel and gain per output channel, with an
+ *  optional second source and gain, and the gains are laid out as a
+ *  pattern that repeats with the interleaved samples, for the SIMD loops.
+ */
+#define POSITION_MAX_CHANNELS   8
+#define POSITION_PATTERN_LEN    56      /* lcm(channels, 8) for up to 8 */
+#define POSITION_BLOCK_LEN      1024    /* floats per block */
 
-    if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Uint8) * 2) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else for (i = 0; i < len; i += sizeof (Uint8) * 2) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-    }
-}
-static void _Eff_position_u8_c4(int chan, void *stream, int len, void *udata)
+typedef struct _Eff_positionmatrix
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
+    int channels;
+    int pattern_len;
+    int permuted;
+    int blended;
+    int src[POSITION_MAX_CHANNELS];
+    int src2[POSITION_MAX_CHANNELS];    /* -1 if there's no second source */
+    float gain2[POSITION_MAX_CHANNELS];
+    float pattern[POSITION_PATTERN_LEN];
+} position_matrix;
+
+/* Output speaker k plays input channel room_rotation[room_angle / 90][k] */
+static const int room_rotation[4][4] = {
+    { 0, 1, 2, 3 },
+    { 1, 3, 0, 2 },
+    { 3, 2, 1, 0 },
+    { 2, 0, 3, 1 }
+};
+
+static void build_position_matrix(volatile position_args *args, position_matrix *m)
+{
+    const int channels = SDL_min(SDL_max(args->channels, 1), POSITION_MAX_CHANNELS);
+    const float distance = args->distance_f;
+    float in_gain[POSITION_MAX_CHANNELS];
+    float gain[POSITION_MAX_CHANNELS];
+    int rotation = 0;
     int i;
 
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Uint16) != 0) {
-        *ptr = (Uint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
+    for (i = 0; i < channels; i++) {
+        in_gain[i] = distance;
+        m->src[i] = i;
+        m->src2[i] = -1;
+        m->gain2[i] = 0.0f;
+    }
+
+    /* Only the layouts set_amplitudes() knows about get panned */
+    if (channels == 2 || channels == 4 || channels == 6) {
+        in_gain[0] = args->left_f * distance;
+        in_gain[1] = args->right_f * distance;
+        if (channels == 2) {
+            if (args->room_angle == 180) {
+                m->src[0] = 1;
+                m->src[1] = 0;
+            }
+        } else {
+            in_gain[2] = args->left_rear_f * distance;
+            in_gain[3] = args->right_rear_f * distance;
+            rotation = (args->room_angle / 90) & 3;
+            for (i = 0; i < 4; i++) {
+                m->src[i] = room_rotation[rotation][i];
+            }
+        }
+        if (channels == 6) {
+            in_gain[4] = args->center_f * distance;
+            in_gain[5] = args->lfe_f * distance;
+            if (rotation != 0) {
+                /* The center is halfway between the two front speakers */
+                m->src[4] = m->src[0];
+                m->src2[4] = m->src[1];
+                m->gain2[4] = in_gain[m->src[1]] * 0.5f;
+            }
+        }
     }
 
-    if (args->room_angle == 0)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 90)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
+    m->channels = channels;
+    m->permuted = 0;
+    m->blended = 0;
+    for (i = 0; i < channels; i++) {
+        gain[i] = in_gain[m->src[i]];
+        if (m->src2[i] >= 0) {
+            gain[i] *= 0.5f;
+            m->blended = 1;
+        }
+        if (m->src[i] != i) {
+            m->permuted = 1;
+        }
     }
-    else if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
+
+    m->pattern_len = channels;
+    while (m->pattern_len % 8) {
+        m->pattern_len += channels;
     }
-    else if (args->room_angle == 270)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
+    for (i = 0; i < m->pattern_len; i++) {
+        m->pattern[i] = gain[i % channels];
     }
 }
 
 
-static void _Eff_position_u8_c6(int chan, void *stream, int len, void *udata)
+#ifdef POSITION_HAVE_SSE2
+static int position_gain_SSE2(float *buf, const float *pattern, int pattern_len, int count)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Uint16) != 0) {
-        *ptr = (Uint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    if (args->room_angle == 0)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->center_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 90)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f/2) + 128)
-            + (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f/2) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f/2) + 128)
-            + (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f/2) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 270)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f/2) + 128)
-            + (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f/2) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
+    int i, j = 0;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        _mm_storeu_ps(buf + i, _mm_mul_ps(_mm_loadu_ps(buf + i), _mm_loadu_ps(pattern + j)));
+        _mm_storeu_ps(buf + i + 4, _mm_mul_ps(_mm_loadu_ps(buf + i + 4), _mm_loadu_ps(pattern + j + 4)));
+        j += 8;
+        if (j == pattern_len) {
+            j = 0;
+        }
     }
+    return(i);
 }
 
-
-/*
- * This one runs about 10.1 times faster than the non-table version, with
- *  no loss in quality. It does, however, require 64k of memory for the
- *  lookup table. Also, this will only update position information once per
- *  call; the non-table version always checks the arguments for each sample,
- *  in case the user has called Mix_SetPanning() or whatnot again while this
- *  callback is running.
- */
-static void _Eff_position_table_u8(int chan, void *stream, int len, void *udata)
+static int position_s16_to_float_SSE2(const Sint16 *src, float *dst, int count)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    Uint32 *p;
     int i;
-    Uint8 *l = ((Uint8 *) _Eff_volume_table) + (256 * args->left_u8);
-    Uint8 *r = ((Uint8 *) _Eff_volume_table) + (256 * args->right_u8);
-    Uint8 *d = ((Uint8 *) _Eff_volume_table) + (256 * args->distance_u8);
-
-    if (args->room_angle == 180) {
-        Uint8 *temp = l;
-        l = r;
-        r = temp;
-    }
-        /*
-         * if there's only a mono channnel, then l[] and r[] are always
-         *  volume 255, and are therefore throwaways. Still, we have to
-         *  be sure not to overrun the audio buffer...
-         */
-    while (len % sizeof (Uint32) != 0) {
-        *ptr = d[l[*ptr]];
-        ptr++;
-        if (args->channels > 1) {
-            *ptr = d[r[*ptr]];
-            ptr++;
-        }
-        len -= args->channels;
-    }
-
-    p = (Uint32 *) ptr;
 
-    for (i = 0; i < len; i += sizeof (Uint32)) {
-#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-        *p = (d[l[(*p & 0xFF000000) >> 24]] << 24) |
-             (d[r[(*p & 0x00FF0000) >> 16]] << 16) |
-             (d[l[(*p & 0x0000FF00) >>  8]] <<  8) |
-             (d[r[(*p & 0x000000FF)      ]]      ) ;
-#else
-        *p = (d[r[(*p & 0xFF000000) >> 24]] << 24) |
-             (d[l[(*p & 0x00FF0000) >> 16]] << 16) |
-             (d[r[(*p & 0x0000FF00) >>  8]] <<  8) |
-             (d[l[(*p & 0x000000FF)      ]]      ) ;
-#endif
-        ++p;
+    for (i = 0; i + 8 <= count; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i *) (src + i));
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16)));
     }
+    return(i);
 }
 
-
-static void _Eff_position_s8(int chan, void *stream, int len, void *udata)
+static int position_float_to_s16_SSE2(const float *src, Sint16 *dst, int count)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
     int i;
 
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Sint16) != 0) {
-        *ptr = (Sint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Sint8) * 2) {
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f);
-        ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f);
-        ptr++;
-    }
-    else
-    for (i = 0; i < len; i += sizeof (Sint8) * 2) {
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f);
-        ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f);
-        ptr++;
+    /* Truncating like the casts in the scalar code, the pack saturates */
+    for (i = 0; i + 8 <= count; i += 8) {
+        const __m128i lo = _mm_cvttps_epi32(_mm_loadu_ps(src + i));
+        const __m128i hi = _mm_cvttps_epi32(_mm_loadu_ps(src + i + 4));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packs_epi32(lo, hi));
     }
+    return(i);
 }
-static void _Eff_position_s8_c4(int chan, void *stream, int len, void *udata)
+/* 8-bit samples, (flip) is 0x80 for unsigned ones */
+static int position_s8_to_float_SSE2(const Uint8 *src, float *dst, int count, int flip)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
+    const __m128i bias = _mm_set1_epi8((char) flip);
     int i;
 
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Sint16) != 0) {
-        *ptr = (Sint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    for (i = 0; i < len; i += sizeof (Sint8) * 4) {
-      switch (args->room_angle) {
-       case 0:
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-    break;
-       case 90:
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-    break;
-       case 180:
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-    break;
-       case 270:
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-    break;
-      }
+    for (i = 0; i + 16 <= count; i += 16) {
+        const __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *) (src + i)), bias);
+        const __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+        const __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+        _mm_storeu_ps(dst + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16)));
+        _mm_storeu_ps(dst + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16)));
+        _mm_storeu_ps(dst + i + 8, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16)));
+        _mm_storeu_ps(dst + i + 12, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16)));
     }
+    return(i);
 }
-static void _Eff_position_s8_c6(int chan, void *stream, int len, void *udata)
+
+static int position_float_to_s8_SSE2(const float *src, Uint8 *dst, int count, int flip)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
+    const __m128i bias = _mm_set1_epi8((char) flip);
     int i;
 
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Sint16) != 0) {
-        *ptr = (Sint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    for (i = 0; i < len; i += sizeof (Sint8) * 6) {
-      switch (args->room_angle) {
-       case 0:
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->center_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-       case 90:
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f / 2)
-           + (Sint8)((((float) *ptr) * args->right_f) * args->distance_f / 2); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-       case 180:
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f / 2)
-           + (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f / 2); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-       case 270:
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f / 2)
-           + (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f / 2); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-      }
+    for (i = 0; i + 16 <= count; i += 16) {
+        const __m128i lo = _mm_packs_epi32(_mm_cvttps_epi32(_mm_loadu_ps(src + i)),
+                                           _mm_cvttps_epi32(_mm_loadu_ps(src + i + 4)));
+        const __m128i hi = _mm_packs_epi32(_mm_cvttps_epi32(_mm_loadu_ps(src + i + 8)),
+                                           _mm_cvttps_epi32(_mm_loadu_ps(src + i + 12)));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_xor_si128(_mm_packs_epi16(lo, hi), bias));
     }
+    return(i);
 }
+#endif
 
-
-/*
- * This one runs about 10.1 times faster than the non-table version, with
- *  no loss in quality. It does, however, require 64k of memory for the
- *  lookup table. Also, this will only update position information once per
- *  call; the non-table version always checks the arguments for each sample,
- *  in case the user has called Mix_SetPanning() or whatnot again while this
- *  callback is running.
- */
-static void _Eff_position_table_s8(int chan, void *stream, int len, void *udata)
+#ifdef POSITION_HAVE_AVX2
+POSITION_TARGETING_AVX2 static int position_gain_AVX2(float *buf, const float *pattern, int pattern_len, int count)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
-    Uint32 *p;
-    int i;
-    Sint8 *l = ((Sint8 *) _Eff_volume_table) + (256 * args->left_u8);
-    Sint8 *r = ((Sint8 *) _Eff_volume_table) + (256 * args->right_u8);
-    Sint8 *d = ((Sint8 *) _Eff_volume_table) + (256 * args->distance_u8);
-
-    if (args->room_angle == 180) {
-        Sint8 *temp = l;
-        l = r;
-        r = temp;
-    }
-
+    int i, j = 0;
 
-    while (len % sizeof (Uint32) != 0) {
-        *ptr = d[l[*ptr]];
-        ptr++;
-        if (args->channels > 1) {
-            *ptr = d[r[*ptr]];
-            ptr++;
+    for (i = 0; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(buf + i, _mm256_mul_ps(_mm256_loadu_ps(buf + i), _mm256_loadu_ps(pattern + j)));
+        j += 8;
+        if (j == pattern_len) {
+            j = 0;
         }
-        len -= args->channels;
     }
+    return(i);
+}
 
-    p = (Uint32 *) ptr;
+POSITION_TARGETING_AVX2 static int position_s16_to_float_AVX2(const Sint16 *src, float *dst, int count)
+{
+    int i;
 
-    for (i = 0; i < len; i += sizeof (Uint32)) {
-#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-        *p = (d[l[((Sint16)(Sint8)((*p & 0xFF000000) >> 24))+128]] << 24) |
-             (d[r[((Sint16)(Sint8)((*p & 0x00FF0000) >> 16))+128]] << 16) |
-             (d[l[((Sint16)(Sint8)((*p & 0x0000FF00) >>  8))+128]] <<  8) |
-             (d[r[((Sint16)(Sint8)((*p & 0x000000FF)      ))+128]]      ) ;
-#else
-        *p = (d[r[((Sint16)(Sint8)((*p & 0xFF000000) >> 24))+128]] << 24) |
-             (d[l[((Sint16)(Sint8)((*p & 0x00FF0000) >> 16))+128]] << 16) |
-             (d[r[((Sint16)(Sint8)((*p & 0x0000FF00) >>  8))+128]] <<  8) |
-             (d[l[((Sint16)(Sint8)((*p & 0x000000FF)      ))+128]]      ) ;
-#endif
-        ++p;
+    for (i = 0; i + 8 <= count; i += 8) {
+        const __m256i x = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *) (src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_cvtepi32_ps(x));
     }
+    return(i);
+}
 
+POSITION_TARGETING_AVX2 static int position_float_to_s16_AVX2(const float *src, Sint16 *dst, int count)
+{
+    int i;
 
+    /* The pack works within 128-bit lanes, the permute puts them back in order */
+    for (i = 0; i + 16 <= count; i += 16) {
+        const __m256i lo = _mm256_cvttps_epi32(_mm256_loadu_ps(src + i));
+        const __m256i hi = _mm256_cvttps_epi32(_mm256_loadu_ps(src + i + 8));
+        const __m256i x = _mm256_permute4x64_epi64(_mm256_packs_epi32(lo, hi), 0xD8);
+        _mm256_storeu_si256((__m256i *) (dst + i), x);
+    }
+    return(i);
 }
+#endif
 
+#ifdef POSITION_HAVE_NEON
+static int position_gain_NEON(float *buf, const float *pattern, int pattern_len, int count)
+{
+    int i, j = 0;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        vst1q_f32(buf + i, vmulq_f32(vld1q_f32(buf + i), vld1q_f32(pattern + j)));
+        vst1q_f32(buf + i + 4, vmulq_f32(vld1q_f32(buf + i + 4), vld1q_f32(pattern + j + 4)));
+        j += 8;
+        if (j == pattern_len) {
+            j = 0;
+        }
+    }
+    return(i);
+}
 
-/* !!! FIXME : Optimize the code for 16-bit samples? */
-
-static void _Eff_position_u16lsb(int chan, void *stream, int len, void *udata)
+static int position_s16_to_float_NEON(const Sint16 *src, float *dst, int count)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
     int i;
 
-    for (i = 0; i < len; i += sizeof (Uint16) * 2) {
-        Sint16 sampl = (Sint16) (SDL_SwapLE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapLE16(*(ptr+1)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-
-    if (args->room_angle == 180) {
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-    }
-    else {
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-    }
+    for (i = 0; i + 8 <= count; i += 8) {
+        const int16x8_t x = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))));
     }
+    return(i);
 }
-static void _Eff_position_u16lsb_c4(int chan, void *stream, int len, void *udata)
+
+static int position_float_to_s16_NEON(const float *src, Sint16 *dst, int count)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
     int i;
 
-    for (i = 0; i < len; i += sizeof (Uint16) * 4) {
-        Sint16 sampl = (Sint16) (SDL_SwapLE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapLE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapLE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapLE16(*(ptr+3)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-            break;
-    }
+    for (i = 0; i + 8 <= count; i += 8) {
+        const int32x4_t lo = vcvtq_s32_f32(vld1q_f32(src + i));
+        const int32x4_t hi = vcvtq_s32_f32(vld1q_f32(src + i + 4));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
     }
+    return(i);
 }
-static void _Eff_position_u16lsb_c6(int chan, void *stream, int len, void *udata)
+static int position_s8_to_float_NEON(const Uint8 *src, float *dst, int count, int flip)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
+    const uint8x16_t bias = vdupq_n_u8((Uint8) flip);
     int i;
 
-    for (i = 0; i < len; i += sizeof (Uint16) * 6) {
-        Sint16 sampl = (Sint16) (SDL_SwapLE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapLE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapLE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapLE16(*(ptr+3)) - 32768);
-        Sint16 sampce = (Sint16) (SDL_SwapLE16(*(ptr+4)) - 32768);
-        Sint16 sampwf = (Sint16) (SDL_SwapLE16(*(ptr+5)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapce = (Uint16) ((Sint16) (((float) sampce * args->center_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapwf = (Uint16) ((Sint16) (((float) sampwf * args->lfe_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapce);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr)/2 + (Uint16) SDL_SwapLE16(swaprr)/2;
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr)/2 + (Uint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl)/2 + (Uint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-    }
+    for (i = 0; i + 16 <= count; i += 16) {
+        const int8x16_t x = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(src + i), bias));
+        const int16x8_t lo = vmovl_s8(vget_low_s8(x));
+        const int16x8_t hi = vmovl_s8(vget_high_s8(x));
+        vst1q_f32(dst + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(lo))));
+        vst1q_f32(dst + i + 4, vcvtq_f32_s32(vmovl_s16(vget_high_s16(lo))));
+        vst1q_f32(dst + i + 8, vcvtq_f32_s32(vmovl_s16(vget_low_s16(hi))));
+        vst1q_f32(dst + i + 12, vcvtq_f32_s32(vmovl_s16(vget_high_s16(hi))));
     }
+    return(i);
 }
 
-static void _Eff_position_s16lsb(int chan, void *stream, int len, void *udata)
+static int position_float_to_s8_NEON(const float *src, Uint8 *dst, int count, int flip)
 {
-    /* 16 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
+    const uint8x16_t bias = vdupq_n_u8((Uint8) flip);
     int i;
 
-#if 0
-    if (len % (sizeof(Sint16) * 2)) {
-        fprintf(stderr,"Not an even number of frames! len=%d\n", len);
-        return;
+    for (i = 0; i + 16 <= count; i += 16) {
+        const int16x8_t lo = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vld1q_f32(src + i))),
+                                          vqmovn_s32(vcvtq_s32_f32(vld1q_f32(src + i + 4))));
+        const int16x8_t hi = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vld1q_f32(src + i + 8))),
+                                          vqmovn_s32(vcvtq_s32_f32(vld1q_f32(src + i + 12))));
+        const int8x16_t x = vcombine_s8(vqmovn_s16(lo), vqmovn_s16(hi));
+        vst1q_u8(dst + i, veorq_u8(vreinterpretq_u8_s8(x), bias));
     }
+    return(i);
+}
 #endif
 
-    for (i = 0; i < len; i += sizeof (Sint16) * 2) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-    if (args->room_angle == 180) {
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
+
+static int position_simd = -1;
+
+#define POSITION_SIMD_NONE  0
+#define POSITION_SIMD_SSE2  1
+#define POSITION_SIMD_AVX2  2
+#define POSITION_SIMD_NEON  3
+
+static int choose_position_simd(void)
+{
+#ifdef POSITION_HAVE_AVX2
+    if (SDL_HasAVX2()) {
+        return(POSITION_SIMD_AVX2);
     }
-    else {
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
+#endif
+#ifdef POSITION_HAVE_SSE2
+    if (SDL_HasSSE2()) {
+        return(POSITION_SIMD_SSE2);
     }
+#endif
+#ifdef POSITION_HAVE_NEON
+    if (SDL_HasNEON()) {
+        return(POSITION_SIMD_NEON);
     }
+#endif
+    return(POSITION_SIMD_NONE);
 }
-static void _Eff_position_s16lsb_c4(int chan, void *stream, int len, void *udata)
+
+static void position_gain(float *buf, const position_matrix *m, int count)
 {
-    /* 16 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
+    int i = 0, j;
 
-    for (i = 0; i < len; i += sizeof (Sint16) * 4) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+2))) *
-                                    args->right_rear_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
+    switch (position_simd) {
+#ifdef POSITION_HAVE_AVX2
+        case POSITION_SIMD_AVX2:
+            i = position_gain_AVX2(buf, m->pattern, m->pattern_len, count);
             break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
+#endif
+#ifdef POSITION_HAVE_SSE2
+        case POSITION_SIMD_SSE2:
+            i = position_gain_SSE2(buf, m->pattern, m->pattern_len, count);
             break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
+#endif
+#ifdef POSITION_HAVE_NEON
+        case POSITION_SIMD_NEON:
+            i = position_gain_NEON(buf, m->pattern, m->pattern_len, count);
             break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
+#endif
+        default:
             break;
     }
+
+    for (j = i % m->pattern_len; i < count; i++) {
+        buf[i] *= m->pattern[j];
+        if (++j == m->pattern_len) {
+            j = 0;
+        }
     }
 }
 
-static void _Eff_position_s16lsb_c6(int chan, void *stream, int len, void *udata)
+static int position_s8_to_float(const Uint8 *src, float *dst, int count, int flip)
 {
-    /* 16 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 6) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-        Sint16 swapce = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+4))) *
-                                    args->center_f) * args->distance_f);
-        Sint16 swapwf = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+5))) *
-                                    args->lfe_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapce);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr)/2 + (Sint16) SDL_SwapLE16(swaprr)/2;
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr)/2 + (Sint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl)/2 + (Sint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-    }
+    switch (position_simd) {
+#ifdef POSITION_HAVE_SSE2
+        case POSITION_SIMD_AVX2:
+        case POSITION_SIMD_SSE2:
+            return(position_s8_to_float_SSE2(src, dst, count, flip));
+#endif
+#ifdef POSITION_HAVE_NEON
+        case POSITION_SIMD_NEON:
+            return(position_s8_to_float_NEON(src, dst, count, flip));
+#endif
+        default:
+            return(0);
     }
 }
 
-static void _Eff_position_u16msb(int chan, void *stream, int len, void *udata)
+static int position_float_to_s8(const float *src, Uint8 *dst, int count, int flip)
 {
-    /* 16 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 2) {
-        Sint16 sampl = (Sint16) (SDL_SwapBE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapBE16(*(ptr+1)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-
-    if (args->room_angle == 180) {
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-    }
-    else {
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-    }
+    switch (position_simd) {
+#ifdef POSITION_HAVE_SSE2
+        case POSITION_SIMD_AVX2:
+        case POSITION_SIMD_SSE2:
+            return(position_float_to_s8_SSE2(src, dst, count, flip));
+#endif
+#ifdef POSITION_HAVE_NEON
+        case POSITION_SIMD_NEON:
+            return(position_float_to_s8_NEON(src, dst, count, flip));
+#endif
+        default:
+            return(0);
     }
 }
-static void _Eff_position_u16msb_c4(int chan, void *stream, int len, void *udata)
+
+static void position_to_float(Uint16 format, const void *stream, float *dst, int count)
 {
-    /* 16 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
+    int i = 0;
 
-    for (i = 0; i < len; i += sizeof (Sint16) * 4) {
-        Sint16 sampl = (Sint16) (SDL_SwapBE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapBE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapBE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapBE16(*(ptr+3)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
+    switch (format) {
+        case AUDIO_U8: {
+            const Uint8 *src = (const Uint8 *) stream;
+            for (i = position_s8_to_float(src, dst, count, 0x80); i < count; i++) {
+                dst[i] = (float) (src[i] - 128);
+            }
             break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
+        }
+        case AUDIO_S8: {
+            const Sint8 *src = (const Sint8 *) stream;
+            for (i = position_s8_to_float((const Uint8 *) src, dst, count, 0); i < count; i++) {
+                dst[i] = (float) src[i];
+            }
             break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
+        }
+        case AUDIO_U16LSB: {
+            const Uint16 *src = (const Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = (float) ((int) SDL_SwapLE16(src[i]) - 32768);
+            }
             break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
+        }
+        case AUDIO_U16MSB: {
+            const Uint16 *src = (const Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = (float) ((int) SDL_SwapBE16(src[i]) - 32768);
+            }
             break;
-    }
-    }
-}
-static void _Eff_position_u16msb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 6) {
-        Sint16 sampl = (Sint16) (SDL_SwapBE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapBE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapBE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapBE16(*(ptr+3)) - 32768);
-        Sint16 sampce = (Sint16) (SDL_SwapBE16(*(ptr+4)) - 32768);
-        Sint16 sampwf = (Sint16) (SDL_SwapBE16(*(ptr+5)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapce = (Uint16) ((Sint16) (((float) sampce * args->center_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapwf = (Uint16) ((Sint16) (((float) sampwf * args->lfe_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapce);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
+        }
+        case AUDIO_S16SYS: {
+            const Sint16 *src = (const Sint16 *) stream;
+            switch (position_simd) {
+#ifdef POSITION_HAVE_AVX2
+                case POSITION_SIMD_AVX2:
+                    i = position_s16_to_float_AVX2(src, dst, count);
+                    break;
+#endif
+#ifdef POSITION_HAVE_SSE2
+                case POSITION_SIMD_SSE2:
+                    i = position_s16_to_float_SSE2(src, dst, count);
+                    break;
+#endif
+#ifdef POSITION_HAVE_NEON
+                case POSITION_SIMD_NEON:
+                    i = position_s16_to_float_NEON(src, dst, count);
+                    break;
+#endif
+                default:
+                    break;
+            }
+            for (; i < count; i++) {
+                dst[i] = (float) src[i];
+            }
             break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr)/2 + (Uint16) SDL_SwapBE16(swaprr)/2;
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
+        }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        case AUDIO_S16MSB: {
+            const Uint16 *src = (const Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = (float) (Sint16) SDL_SwapBE16(src[i]);
+            }
             break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr)/2 + (Uint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
+        }
+#else
+        case AUDIO_S16LSB: {
+            const Uint16 *src = (const Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = (float) (Sint16) SDL_SwapLE16(src[i]);
+            }
             break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl)/2 + (Uint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
+        }
+#endif
+        case AUDIO_S32LSB: {
+            const Uint32 *src = (const Uint32 *) stream;
+            for (; i < count; i++) {
+                dst[i] = (float) (Sint32) SDL_SwapLE32(src[i]);
+            }
             break;
-    }
+        }
+        case AUDIO_S32MSB: {
+            const Uint32 *src = (const Uint32 *) stream;
+            for (; i < count; i++) {
+                dst[i] = (float) (Sint32) SDL_SwapBE32(src[i]);
+            }
+            break;
+        }
+        case AUDIO_F32SYS:
+            SDL_memcpy(dst, stream, count * sizeof (float));
+            break;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        case AUDIO_F32MSB: {
+            const float *src = (const float *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapFloatBE(src[i]);
+            }
+            break;
+        }
+#else
+        case AUDIO_F32LSB: {
+            const float *src = (const float *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapFloatLE(src[i]);
+            }
+            break;
+        }
+#endif
     }
 }
 
-static void _Eff_position_s16msb(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
+/* Clamped like SDL_MixAudioFormat(), and truncated like the old casts */
+#define POSITION_CLAMP(x, lo, hi) (((x) < (lo)) ? (lo) : (((x) > (hi)) ? (hi) : (x)))
 
-    for (i = 0; i < len; i += sizeof (Sint16) * 2) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-        *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-    }
-}
-static void _Eff_position_s16msb_c4(int chan, void *stream, int len, void *udata)
+static void position_from_float(Uint16 format, const float *src, void *stream, int count)
 {
-    /* 16 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
+    int i = 0;
 
-    for (i = 0; i < len; i += sizeof (Sint16) * 4) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
+    switch (format) {
+        case AUDIO_U8: {
+            Uint8 *dst = (Uint8 *) stream;
+            for (i = position_float_to_s8(src, dst, count, 0x80); i < count; i++) {
+                dst[i] = (Uint8) ((int) POSITION_CLAMP(src[i], -128.0f, 127.0f) + 128);
+            }
             break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
+        }
+        case AUDIO_S8: {
+            Sint8 *dst = (Sint8 *) stream;
+            for (i = position_float_to_s8(src, (Uint8 *) dst, count, 0); i < count; i++) {
+                dst[i] = (Sint8) POSITION_CLAMP(src[i], -128.0f, 127.0f);
+            }
             break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
+        }
+        case AUDIO_U16LSB: {
+            Uint16 *dst = (Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapLE16((Uint16) ((int) POSITION_CLAMP(src[i], -32768.0f, 32767.0f) + 32768));
+            }
             break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
+        }
+        case AUDIO_U16MSB: {
+            Uint16 *dst = (Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapBE16((Uint16) ((int) POSITION_CLAMP(src[i], -32768.0f, 32767.0f) + 32768));
+            }
             break;
-    }
-    }
-}
-static void _Eff_position_s16msb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 6) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-        Sint16 swapce = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+4))) *
-                                    args->center_f) * args->distance_f);
-        Sint16 swapwf = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+5))) *
-                                    args->lfe_f) * args->distance_f);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapce);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
+        }
+        case AUDIO_S16SYS: {
+            Sint16 *dst = (Sint16 *) stream;
+            switch (position_simd) {
+#ifdef POSITION_HAVE_AVX2
+                case POSITION_SIMD_AVX2:
+                    i = position_float_to_s16_AVX2(src, dst, count);
+                    break;
+#endif
+#ifdef POSITION_HAVE_SSE2
+                case POSITION_SIMD_SSE2:
+                    i = position_float_to_s16_SSE2(src, dst, count);
+                    break;
+#endif
+#ifdef POSITION_HAVE_NEON
+                case POSITION_SIMD_NEON:
+                    i = position_float_to_s16_NEON(src, dst, count);
+                    break;
+#endif
+                default:
+                    break;
+            }
+            for (; i < count; i++) {
+                dst[i] = (Sint16) POSITION_CLAMP(src[i], -32768.0f, 32767.0f);
+            }
+            break;
+        }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        case AUDIO_S16MSB: {
+            Uint16 *dst = (Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapBE16((Uint16) (Sint16) POSITION_CLAMP(src[i], -32768.0f, 32767.0f));
+            }
             break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr)/2 + (Sint16) SDL_SwapBE16(swaprr)/2;
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
+        }
+#else
+        case AUDIO_S16LSB: {
+            Uint16 *dst = (Uint16 *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapLE16((Uint16) (Sint16) POSITION_CLAMP(src[i], -32768.0f, 32767.0f));
+            }
             break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr)/2 + (Sint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
+        }
+#endif
+        /* 2147483520 is the largest float below 2^31 */
+        case AUDIO_S32LSB: {
+            Uint32 *dst = (Uint32 *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapLE32((Uint32) (Sint32) POSITION_CLAMP(src[i], -2147483648.0f, 2147483520.0f));
+            }
             break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl)/2 + (Sint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
+        }
+        case AUDIO_S32MSB: {
+            Uint32 *dst = (Uint32 *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapBE32((Uint32) (Sint32) POSITION_CLAMP(src[i], -2147483648.0f, 2147483520.0f));
+            }
             break;
+        }
+        case AUDIO_F32SYS:
+            SDL_memcpy(stream, src, count * sizeof (float));
+            break;
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+        case AUDIO_F32MSB: {
+            float *dst = (float *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapFloatBE(src[i]);
+            }
+            break;
+        }
+#else
+        case AUDIO_F32LSB: {
+            float *dst = (float *) stream;
+            for (; i < count; i++) {
+                dst[i] = SDL_SwapFloatLE(src[i]);
+            }
+            break;
+        }
+#endif
     }
+}
+
+static void position_apply(const position_matrix *m, const float *in, float *out, int count)
+{
+    const int channels = m->channels;
+    int i, k;
+
+    if (m->permuted) {
+        /* Spelled out for the layouts that get rotated, so the compiler
+           can keep the sources in registers */
+        const int *src = m->src;
+        switch (channels) {
+            case 2: {
+                const int s0 = src[0], s1 = src[1];
+                for (i = 0; i < count; i += 2) {
+                    out[i + 0] = in[i + s0];
+                    out[i + 1] = in[i + s1];
+                }
+                break;
+            }
+            case 4: {
+                const int s0 = src[0], s1 = src[1], s2 = src[2], s3 = src[3];
+                for (i = 0; i < count; i += 4) {
+                    out[i + 0] = in[i + s0];
+                    out[i + 1] = in[i + s1];
+                    out[i + 2] = in[i + s2];
+                    out[i + 3] = in[i + s3];
+                }
+                break;
+            }
+            case 6: {
+                const int s0 = src[0], s1 = src[1], s2 = src[2], s3 = src[3], s4 = src[4];
+                for (i = 0; i < count; i += 6) {
+                    out[i + 0] = in[i + s0];
+                    out[i + 1] = in[i + s1];
+                    out[i + 2] = in[i + s2];
+                    out[i + 3] = in[i + s3];
+                    out[i + 4] = in[i + s4];
+                    out[i + 5] = in[i + 5];
+                }
+                break;
+            }
+            default:
+                for (i = 0; i < count; i += channels) {
+                    for (k = 0; k < channels; k++) {
+                        out[i + k] = in[i + src[k]];
+                    }
+                }
+                break;
+        }
+    } else {
+        SDL_memcpy(out, in, count * sizeof (float));
+    }
+
+    position_gain(out, m, count);
+
+    if (m->blended) {
+        for (k = 0; k < channels; k++) {
+            const int src2 = m->src2[k];
+            const float gain2 = m->gain2[k];
+            if (src2 < 0) {
+                continue;
+            }
+            for (i = 0; i < count; i += channels) {
+                out[i + k] += in[i + src2] * gain2;
+            }
+        }
+    }
+}
+
+static void _Eff_position(int chan, void *stream, int len, void *udata)
+{
+    volatile position_args *args = (volatile position_args *) udata;
+    const Uint16 format = args->format;
+    const int sample_size = SDL_AUDIO_BITSIZE(format) / 8;
+    float in[POSITION_BLOCK_LEN];
+    float out[POSITION_BLOCK_LEN];
+    position_matrix m;
+    Uint8 *ptr = (Uint8 *) stream;
+    int block, count;
+
+    /* The arguments are only read once per call, they may change while
+       the callback runs if the app calls Mix_SetPosition() and friends */
+    build_position_matrix(args, &m);
+
+    /* Whole frames that also repeat the gain pattern, up to the block size */
+    block = (POSITION_BLOCK_LEN / m.pattern_len) * m.pattern_len;
+    count = (len / (sample_size * m.channels)) * m.channels;
+    while (count > 0) {
+        const int n = SDL_min(count, block);
+        position_to_float(format, ptr, in, n);
+        position_apply(&m, in, out, n);
+        position_from_float(format, out, ptr, n);
+        ptr += n * sample_size;
+        count -= n;
     }
 }
 
+
 static void init_position_args(position_args *args)
 {
     SDL_memset(args, '\0', sizeof (position_args));
@@ -1138,7 +858,7 @@ static void init_position_args(position_args *args)
     args->left_f  = args->right_f  = args->distance_f  = 1.0f;
     args->left_rear_u8 = args->right_rear_u8 = args->center_u8 = args->lfe_u8 = 255;
     args->left_rear_f = args->right_rear_f = args->center_f = args->lfe_f = 1.0f;
-    Mix_QuerySpec(NULL, NULL, (int *) &args->channels);
+    Mix_QuerySpec(NULL, (Uint16 *) &args->format, (int *) &args->channels);
 }
 
 
@@ -1188,106 +908,33 @@ static position_args *get_position_arg(int channel)
 
 static Mix_EffectFunc_t get_position_effect_func(Uint16 format, int channels)
 {
-    Mix_EffectFunc_t f = NULL;
-
     switch (format) {
         case AUDIO_U8:
-        switch (channels) {
-            case 1:
-            case 2:
-                    f = (_Eff_build_volume_table_u8()) ? _Eff_position_table_u8 :
-                                                        _Eff_position_u8;
-                break;
-                case 4:
-                        f = _Eff_position_u8_c4;
-                break;
-                case 6:
-                        f = _Eff_position_u8_c6;
-                break;
-        }
-            break;
-
         case AUDIO_S8:
-        switch (channels) {
-            case 1:
-            case 2:
-                    f = (_Eff_build_volume_table_s8()) ? _Eff_position_table_s8 :
-                                                        _Eff_position_s8;
-                break;
-                case 4:
-                        f = _Eff_position_s8_c4;
-                break;
-                case 6:
-                        f = _Eff_position_s8_c6;
-                break;
-        }
-            break;
-
         case AUDIO_U16LSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                    f = _Eff_position_u16lsb;
-                break;
-                case 4:
-                    f = _Eff_position_u16lsb_c4;
-                break;
-                case 6:
-                    f = _Eff_position_u16lsb_c6;
-                break;
-        }
-            break;
-
         case AUDIO_S16LSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                    f = _Eff_position_s16lsb;
-                break;
-                case 4:
-                    f = _Eff_position_s16lsb_c4;
-                break;
-                case 6:
-                    f = _Eff_position_s16lsb_c6;
-                break;
-        }
-            break;
-
         case AUDIO_U16MSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                    f = _Eff_position_u16msb;
-                break;
-                case 4:
-                    f = _Eff_position_u16msb_c4;
-                break;
-                case 6:
-                    f = _Eff_position_u16msb_c6;
-                break;
-        }
-            break;
-
         case AUDIO_S16MSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                    f = _Eff_position_s16msb;
-                break;
-                case 4:
-                    f = _Eff_position_s16msb_c4;
-                break;
-                case 6:
-                    f = _Eff_position_s16msb_c6;
-                break;
-        }
+        case AUDIO_S32LSB:
+        case AUDIO_S32MSB:
+        case AUDIO_F32LSB:
+        case AUDIO_F32MSB:
             break;
 
         default:
             Mix_SetError("Unsupported audio format");
+            return(NULL);
     }
 
-    return(f);
+    if (channels < 1 || channels > POSITION_MAX_CHANNELS) {
+        Mix_SetError("Unsupported number of audio channels");
+        return(NULL);
+    }
+
+    if (position_simd < 0) {
+        position_simd = choose_position_simd();
+    }
+    return(_Eff_position);
 }
 
 static Uint8 speaker_amplitude[6];
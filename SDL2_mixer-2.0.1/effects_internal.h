@@ -36,9 +36,6 @@ extern "C" {
 #endif
 
 extern int _Mix_effects_max_speed;
-extern void *_Eff_volume_table;
-void *_Eff_build_volume_table_u8(void);
-void *_Eff_build_volume_table_s8(void);
 
 void _Mix_InitEffects(void);
 void _Mix_DeinitEffects(void);
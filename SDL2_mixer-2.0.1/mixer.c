@@ -28,6 +28,20 @@
 #include "SDL_mutex.h"
 #include "SDL_endian.h"
 #include "SDL_timer.h"
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "SDL_hints.h"
+
+#if defined(__WIN32__)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "SDL_mixer.h"
 #include "load_aiff.h"
@@ -212,6 +226,8 @@ int Mix_Init(int flags)
     return (result);
 }
 
+static void quit_chunk_cache(void);
+
 void Mix_Quit()
 {
 #ifdef USE_FLUIDSYNTH_MIDI
@@ -250,10 +266,12 @@ void Mix_Quit()
         soundfont_paths = NULL;
     }
 #endif
+    quit_chunk_cache();
     initialized = 0;
 }
 
 static int _Mix_remove_all_effects(int channel, effect_info **e);
+static void mix_pool_flush(void);
 
 /*
  * rcg06122001 Cleanup effect callbacks.
@@ -262,6 +280,9 @@ static int _Mix_remove_all_effects(int channel, effect_info **e);
  */
 static void _Mix_channel_done_playing(int channel)
 {
+    /* The callbacks may free the chunk or the effects queued for mixing */
+    mix_pool_flush();
+
     if (channel_done_callback) {
         channel_done_callback(channel);
     }
@@ -301,6 +322,268 @@ static void *Mix_DoEffects(int chan, void *snd, int len)
     return(buf);
 }
 
+/*
+ * Optional pool of threads that helps the audio callback mix the channels.
+ *  The callback still walks the channels in order and does all of the
+ *  bookkeeping, but only queues each piece of sample data it would have
+ *  mixed.  Channel i goes to partition (i % num_partitions), which runs its
+ *  channels' effects in order and mixes them into its own buffer.  Whenever
+ *  a channel is done playing, and once at the end, the queued partitions
+ *  are rendered by whichever threads claim them first, the callback thread
+ *  included, and the buffers are added to the stream in partition order.
+ */
+#define MIX_MAX_MIX_THREADS 16
+
+typedef struct _Mix_segment
+{
+    int channel;
+    Uint8 *samples;
+    int len;
+    int index;
+    int volume;
+} mix_segment;
+
+typedef struct _Mix_partition
+{
+    mix_segment *segments;
+    int num_segments;
+    int max_segments;
+    int end;            /* how much of the buffer the segments cover */
+    Uint8 *buffer;
+    Uint8 *scratch;     /* for running a channel's effects */
+} mix_partition;
+
+static struct
+{
+    int num_threads;
+    SDL_Thread *threads[MIX_MAX_MIX_THREADS];
+    int num_partitions;
+    mix_partition *partitions;
+    int buffer_len;
+    SDL_sem *wake;
+    SDL_sem *done;
+    SDL_atomic_t next;
+    SDL_atomic_t quit;
+    Uint8 *stream;      /* non-NULL while mix_channels queues segments */
+    int len;
+    int pending;
+} mix_pool;
+
+static void mix_partition_render(mix_partition *part)
+{
+    int i;
+
+    SDL_memset(part->buffer, mixer.silence, part->end);
+    for (i = 0; i < part->num_segments; ++i) {
+        mix_segment *seg = &part->segments[i];
+        effect_info *e = mix_channel[seg->channel].effects;
+        Uint8 *src = seg->samples;
+
+        if (e != NULL) {
+            SDL_memcpy(part->scratch, src, seg->len);
+            for (; e != NULL; e = e->next) {
+                if (e->callback != NULL) {
+                    e->callback(seg->channel, part->scratch, seg->len, e->udata);
+                }
+            }
+            src = part->scratch;
+        }
+        SDL_MixAudioFormat(part->buffer + seg->index, src, mixer.format, seg->len, seg->volume);
+    }
+}
+
+/* Render partitions until there are none left, returns how many it did */
+static int mix_pool_run(SDL_bool worker)
+{
+    int count = 0;
+    int i;
+
+    while ((i = SDL_AtomicAdd(&mix_pool.next, 1)) < mix_pool.num_partitions) {
+        mix_partition_render(&mix_pool.partitions[i]);
+        if (worker) {
+            SDL_SemPost(mix_pool.done);
+        }
+        ++count;
+    }
+    return(count);
+}
+
+static int SDLCALL mix_pool_thread(void *data)
+{
+    SDL_SetThreadPriority(SDL_THREAD_PRIORITY_HIGH);
+
+    for ( ; ; ) {
+        SDL_SemWait(mix_pool.wake);
+        if (SDL_AtomicGet(&mix_pool.quit)) {
+            break;
+        }
+        mix_pool_run(SDL_TRUE);
+    }
+    return(0);
+}
+
+static void mix_pool_flush(void)
+{
+    int i, busy = 0;
+
+    if (!mix_pool.pending) {
+        return;
+    }
+
+    for (i = 0; i < mix_pool.num_partitions; ++i) {
+        if (mix_pool.partitions[i].num_segments > 0) {
+            ++busy;
+        }
+    }
+    if (busy > 1) {
+        /* The callback thread takes its share, and any partitions the
+           workers haven't gotten to, so it never waits on a sleeping one */
+        SDL_AtomicSet(&mix_pool.next, 0);
+        for (i = 0; i < SDL_min(busy - 1, mix_pool.num_threads); ++i) {
+            SDL_SemPost(mix_pool.wake);
+        }
+        for (i = mix_pool.num_partitions - mix_pool_run(SDL_FALSE); i > 0; --i) {
+            SDL_SemWait(mix_pool.done);
+        }
+    } else {
+        for (i = 0; i < mix_pool.num_partitions; ++i) {
+            if (mix_pool.partitions[i].num_segments > 0) {
+                mix_partition_render(&mix_pool.partitions[i]);
+            }
+        }
+    }
+
+    for (i = 0; i < mix_pool.num_partitions; ++i) {
+        mix_partition *part = &mix_pool.partitions[i];
+        if (part->num_segments > 0) {
+            SDL_MixAudioFormat(mix_pool.stream, part->buffer, mixer.format, part->end, SDL_MIX_MAXVOLUME);
+            part->num_segments = 0;
+            part->end = 0;
+        }
+    }
+    mix_pool.pending = 0;
+}
+
+/* Mix (or queue) a piece of a channel's sample data into the stream */
+static void mix_channel_data(int chan, Uint8 *stream, int index, Uint8 *samples, int len, int volume)
+{
+    Uint8 *mix_input;
+
+    if (mix_pool.stream) {
+        mix_partition *part = &mix_pool.partitions[chan % mix_pool.num_partitions];
+        mix_segment *seg;
+
+        if (part->num_segments == part->max_segments) {
+            int max_segments = part->max_segments * 2;
+            void *ptr = SDL_realloc(part->segments, max_segments * sizeof (mix_segment));
+            if (ptr == NULL) {
+                /* Keep the order, mix everything before this right now */
+                mix_pool_flush();
+                goto mix_now;
+            }
+            part->segments = (mix_segment *) ptr;
+            part->max_segments = max_segments;
+        }
+        seg = &part->segments[part->num_segments++];
+        seg->channel = chan;
+        seg->samples = samples;
+        seg->len = len;
+        seg->index = index;
+        seg->volume = volume;
+        if (index + len > part->end) {
+            part->end = index + len;
+        }
+        ++mix_pool.pending;
+        return;
+    }
+
+mix_now:
+    mix_input = Mix_DoEffects(chan, samples, len);
+    SDL_MixAudio(stream+index, mix_input, len, volume);
+    if (mix_input != samples)
+        SDL_free(mix_input);
+}
+
+static void mix_pool_quit(void)
+{
+    int i;
+
+    SDL_AtomicSet(&mix_pool.quit, 1);
+    for (i = 0; i < mix_pool.num_threads; ++i) {
+        SDL_SemPost(mix_pool.wake);
+    }
+    for (i = 0; i < mix_pool.num_threads; ++i) {
+        SDL_WaitThread(mix_pool.threads[i], NULL);
+    }
+    if (mix_pool.partitions) {
+        for (i = 0; i < mix_pool.num_partitions; ++i) {
+            SDL_free(mix_pool.partitions[i].segments);
+            SDL_free(mix_pool.partitions[i].buffer);
+            SDL_free(mix_pool.partitions[i].scratch);
+        }
+        SDL_free(mix_pool.partitions);
+    }
+    if (mix_pool.wake) {
+        SDL_DestroySemaphore(mix_pool.wake);
+    }
+    if (mix_pool.done) {
+        SDL_DestroySemaphore(mix_pool.done);
+    }
+    SDL_zero(mix_pool);
+}
+
+/* Start the threads asked for by MIX_HINT_MIX_THREADS, if any.
+   Without them every channel is simply mixed on the audio thread. */
+static void mix_pool_init(void)
+{
+    const char *hint = SDL_GetHint(MIX_HINT_MIX_THREADS);
+    int num_threads = hint ? SDL_atoi(hint) : 0;
+    int i;
+
+    SDL_zero(mix_pool);
+    if (num_threads <= 0) {
+        return;
+    }
+    if (num_threads > MIX_MAX_MIX_THREADS) {
+        num_threads = MIX_MAX_MIX_THREADS;
+    }
+
+    mix_pool.num_partitions = num_threads + 1;
+    mix_pool.buffer_len = mixer.size;
+    mix_pool.partitions = (mix_partition *) SDL_calloc(mix_pool.num_partitions, sizeof (mix_partition));
+    mix_pool.wake = SDL_CreateSemaphore(0);
+    mix_pool.done = SDL_CreateSemaphore(0);
+    if (!mix_pool.partitions || !mix_pool.wake || !mix_pool.done) {
+        mix_pool_quit();
+        return;
+    }
+    for (i = 0; i < mix_pool.num_partitions; ++i) {
+        mix_partition *part = &mix_pool.partitions[i];
+        part->max_segments = 2 * (MIX_CHANNELS / mix_pool.num_partitions + 1);
+        part->segments = (mix_segment *) SDL_malloc(part->max_segments * sizeof (mix_segment));
+        part->buffer = (Uint8 *) SDL_malloc(mix_pool.buffer_len);
+        part->scratch = (Uint8 *) SDL_malloc(mix_pool.buffer_len);
+        if (!part->segments || !part->buffer || !part->scratch) {
+            mix_pool_quit();
+            return;
+        }
+    }
+    SDL_AtomicSet(&mix_pool.next, mix_pool.num_partitions);
+
+    for (i = 0; i < num_threads; ++i) {
+        char name[32];
+        SDL_snprintf(name, sizeof (name), "SDL_mixer %d", i);
+        mix_pool.threads[i] = SDL_CreateThread(mix_pool_thread, name, NULL);
+        if (mix_pool.threads[i] == NULL) {
+            break;
+        }
+        ++mix_pool.num_threads;
+    }
+    if (mix_pool.num_threads == 0) {
+        mix_pool_quit();
+    }
+}
+
 static int persist_xmit_audio = 0;
 void Mix_EnablePersistXmit(int enable)
 {
@@ -332,7 +615,6 @@ void Mix_HookGetMixData(void (*get_mix_data)(Uint8*, int, void*), void* contex)
 /* Mixing function */
 static void mix_channels(void *udata, Uint8 *stream, int len)
 {
-    Uint8 *mix_input;
     int i, mixable, volume = SDL_MIX_MAXVOLUME;
     Uint32 sdl_ticks;
 	SDL_bool require_xmit = Mix_PlayingMusic()? SDL_TRUE: SDL_FALSE;
@@ -351,6 +633,9 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
     }
 
     /* Mix any playing channels... */
+    if (mix_pool.num_threads > 0 && len <= mix_pool.buffer_len) {
+        mix_pool.stream = stream;
+    }
     sdl_ticks = SDL_GetTicks();
     for ( i=0; i<num_channels; ++i ) {
 		if ((mix_channel[i].playing > 0) || mix_channel[i].looping) {
@@ -395,10 +680,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
                         mixable = remaining;
                     }
 
-                    mix_input = Mix_DoEffects(i, mix_channel[i].samples, mixable);
-                    SDL_MixAudio(stream+index,mix_input,mixable,volume);
-                    if (mix_input != mix_channel[i].samples)
-                        SDL_free(mix_input);
+                    mix_channel_data(i, stream, index, mix_channel[i].samples, mixable, volume);
 
                     mix_channel[i].samples += mixable;
                     mix_channel[i].playing -= mixable;
@@ -419,10 +701,7 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
                         remaining = alen;
                     }
 
-                    mix_input = Mix_DoEffects(i, mix_channel[i].chunk->abuf, remaining);
-                    SDL_MixAudio(stream+index, mix_input, remaining, volume);
-                    if (mix_input != mix_channel[i].chunk->abuf)
-                        SDL_free(mix_input);
+                    mix_channel_data(i, stream, index, mix_channel[i].chunk->abuf, remaining, volume);
 
                     if (mix_channel[i].looping > 0) {
                         --mix_channel[i].looping;
@@ -442,6 +721,9 @@ static void mix_channels(void *udata, Uint8 *stream, int len)
         }
     }
 
+    mix_pool_flush();
+    mix_pool.stream = NULL;
+
     /* rcg06122001 run posteffects... */
     Mix_DoEffects(MIX_CHANNEL_POST, stream, len);
 
@@ -517,6 +799,8 @@ int Mix_OpenAudio(int frequency, Uint16 format, int nchannels, int chunksize)
         return(-1);
     }
 
+    mix_pool_init();
+
     num_channels = MIX_CHANNELS;
     mix_channel = (struct _Mix_Channel *) SDL_malloc(num_channels * sizeof(struct _Mix_Channel));
 
@@ -635,7 +919,7 @@ static int detect_mp3(Uint8 *magic)
 }
 
 /* Load a wave file */
-Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
+static Mix_Chunk *load_chunk(SDL_RWops *src, int freesrc)
 {
     Uint32 magic;
     Mix_Chunk *chunk;
@@ -643,21 +927,6 @@ Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
     SDL_AudioCVT wavecvt;
     int samplesize;
 
-    /* rcg06012001 Make sure src is valid */
-    if ( ! src ) {
-        SDL_SetError("Mix_LoadWAV_RW with NULL src");
-        return(NULL);
-    }
-
-    /* Make sure audio has been opened */
-    if ( ! audio_opened ) {
-        SDL_SetError("Audio device hasn't been opened");
-        if ( freesrc ) {
-            SDL_RWclose(src);
-        }
-        return(NULL);
-    }
-
     /* Allocate the chunk memory */
     chunk = (Mix_Chunk *)SDL_malloc(sizeof(Mix_Chunk));
     if ( chunk == NULL ) {
@@ -768,6 +1037,644 @@ Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
     return(chunk);
 }
 
+/*
+ * Chunk cache, see Mix_SetChunkCacheSize().
+ *  Entries are kept in most recently used order.  A chunk that shares an
+ *  entry's buffer is marked with MIX_CHUNK_CACHED in its allocated field,
+ *  and Mix_FreeChunk() gives the buffer back to the cache instead of
+ *  freeing it.  Entries that came from the cache directory point into a
+ *  memory-mapped file.
+ */
+#define MIX_CHUNK_CACHED    2
+
+/* Header of the files in the cache directory, the audio follows it */
+#define CHUNK_FILE_MAGIC    "MIXPCM01"
+#define CHUNK_FILE_HEADER   32
+
+typedef struct _Mix_CachedChunk
+{
+    Uint64 hash;            /* of the file contents */
+    Uint32 srclen;
+    Uint16 format;          /* of the converted audio */
+    int channels;
+    int freq;
+    Uint8 *abuf;
+    Uint32 alen;
+    int refcount;
+    void *mapping;          /* the whole file, if abuf points into one */
+    size_t mapping_len;
+    struct _Mix_CachedChunk *prev;
+    struct _Mix_CachedChunk *next;
+} cached_chunk;
+
+static struct
+{
+    SDL_mutex *lock;
+    Uint32 max_bytes;
+    char *dir;
+    cached_chunk *head;
+    cached_chunk *tail;
+    Mix_ChunkCacheStats stats;
+    int quitting;           /* Mix_Quit() was called while chunks were in use */
+} chunk_cache;
+
+/* MurmurHash64A, by Austin Appleby, which is in the public domain */
+static Uint64 hash_chunk_data(const Uint8 *data, size_t len)
+{
+    const Uint64 m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+    Uint64 h = 0x5eed5eed5eed5eedULL ^ (len * m);
+    const Uint8 *end = data + (len & ~(size_t)7);
+    Uint64 k;
+
+    while (data != end) {
+        SDL_memcpy(&k, data, sizeof (k));
+        k = SDL_SwapLE64(k);
+        data += 8;
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        h ^= k;
+        h *= m;
+    }
+
+    switch (len & 7) {
+        case 7: h ^= (Uint64) data[6] << 48;
+        case 6: h ^= (Uint64) data[5] << 40;
+        case 5: h ^= (Uint64) data[4] << 32;
+        case 4: h ^= (Uint64) data[3] << 24;
+        case 3: h ^= (Uint64) data[2] << 16;
+        case 2: h ^= (Uint64) data[1] << 8;
+        case 1: h ^= (Uint64) data[0];
+                h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return(h);
+}
+
+/* Read everything left in (src) into memory */
+static Uint8 *read_chunk_data(SDL_RWops *src, size_t *len)
+{
+    Sint64 size = SDL_RWsize(src) - SDL_RWtell(src);
+    size_t maxlen = (size > 0) ? (size_t) size + 1 : 64 * 1024;
+    size_t datalen = 0, amount;
+    Uint8 *data = NULL;
+    void *ptr;
+
+    do {
+        if (datalen == maxlen || data == NULL) {
+            if (data != NULL) {
+                maxlen *= 2;
+            }
+            ptr = SDL_realloc(data, maxlen);
+            if (ptr == NULL) {
+                SDL_free(data);
+                SDL_SetError("Out of memory");
+                return(NULL);
+            }
+            data = (Uint8 *) ptr;
+        }
+        amount = SDL_RWread(src, data + datalen, 1, maxlen - datalen);
+        datalen += amount;
+    } while (amount > 0);
+
+    *len = datalen;
+    return(data);
+}
+
+static void *map_chunk_file(const char *path, size_t *len)
+{
+#if defined(__WIN32__)
+    void *addr = NULL;
+    wchar_t *wpath = (wchar_t *) SDL_iconv_string("UTF-16LE", "UTF-8", path, SDL_strlen(path) + 1);
+    HANDLE file, mapping;
+    LARGE_INTEGER size;
+
+    if (wpath == NULL) {
+        return(NULL);
+    }
+    file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    SDL_free(wpath);
+    if (file == INVALID_HANDLE_VALUE) {
+        return(NULL);
+    }
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && size.QuadPart <= 0x7FFFFFFF) {
+        mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            *len = (size_t) size.QuadPart;
+        }
+    }
+    CloseHandle(file);
+    return(addr);
+#elif defined(__unix__) || defined(__APPLE__)
+    void *addr = NULL;
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        return(NULL);
+    }
+    if (fstat(fd, &st) == 0 && st.st_size > 0 && st.st_size <= 0x7FFFFFFF) {
+        addr = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) {
+            addr = NULL;
+        } else {
+            *len = (size_t) st.st_size;
+        }
+    }
+    close(fd);
+    return(addr);
+#else
+    /* No mapping here, reading the file still beats decoding it */
+    SDL_RWops *src = SDL_RWFromFile(path, "rb");
+    Uint8 *data;
+
+    if (src == NULL) {
+        return(NULL);
+    }
+    data = read_chunk_data(src, len);
+    SDL_RWclose(src);
+    return(data);
+#endif
+}
+
+static void unmap_chunk_file(void *addr, size_t len)
+{
+#if defined(__WIN32__)
+    UnmapViewOfFile(addr);
+#elif defined(__unix__) || defined(__APPLE__)
+    munmap(addr, len);
+#else
+    SDL_free(addr);
+#endif
+}
+
+static char *chunk_file_path(Uint64 hash, Uint32 srclen, const char *suffix)
+{
+    size_t len = SDL_strlen(chunk_cache.dir) + 64;
+    char *path = (char *) SDL_malloc(len);
+
+    if (path != NULL) {
+        SDL_snprintf(path, len, "%s/%08x%08x-%08x-%04x-%d-%d.pcm%s", chunk_cache.dir,
+                     (unsigned int) (hash >> 32), (unsigned int) hash, (unsigned int) srclen,
+                     mixer.format, mixer.channels, mixer.freq, suffix);
+    }
+    return(path);
+}
+
+static void write_chunk_header(Uint8 *header, const cached_chunk *entry)
+{
+    SDL_memset(header, 0, CHUNK_FILE_HEADER);
+    SDL_memcpy(header, CHUNK_FILE_MAGIC, 8);
+    SDL_memcpy(header + 8, &entry->hash, 8);
+    SDL_memcpy(header + 16, &entry->srclen, 4);
+    SDL_memcpy(header + 20, &entry->format, 2);
+    header[22] = (Uint8) entry->channels;
+    SDL_memcpy(header + 24, &entry->freq, 4);
+    SDL_memcpy(header + 28, &entry->alen, 4);
+}
+
+/* Map the converted audio for (entry) from (path) in the cache directory */
+static int map_cached_chunk(cached_chunk *entry, const char *path)
+{
+    Uint8 expected[CHUNK_FILE_HEADER];
+    size_t len = 0;
+    Uint8 *addr;
+
+    addr = (Uint8 *) map_chunk_file(path, &len);
+    if (addr == NULL) {
+        return(-1);
+    }
+
+    /* The header has to match the file name, and the audio its length */
+    if (len >= CHUNK_FILE_HEADER) {
+        SDL_memcpy(&entry->alen, addr + 28, 4);
+        write_chunk_header(expected, entry);
+        if (SDL_memcmp(addr, expected, CHUNK_FILE_HEADER) == 0 &&
+            entry->alen == len - CHUNK_FILE_HEADER) {
+            entry->mapping = addr;
+            entry->mapping_len = len;
+            entry->abuf = addr + CHUNK_FILE_HEADER;
+            return(0);
+        }
+    }
+    unmap_chunk_file(addr, len);
+    return(-1);
+}
+
+/* Save the converted audio in (entry) to (path) in the cache directory */
+static void write_cached_chunk(const cached_chunk *entry, const char *path)
+{
+    Uint8 header[CHUNK_FILE_HEADER];
+    size_t templen = SDL_strlen(path) + 32;
+    char *temp = (char *) SDL_malloc(templen);
+    SDL_RWops *dst = NULL;
+    int ok = 0;
+
+    /* Per thread, two loads of the same data may both be writing it */
+    if (temp != NULL) {
+        SDL_snprintf(temp, templen, "%s.%lu.tmp", path, SDL_ThreadID());
+        dst = SDL_RWFromFile(temp, "wb");
+    }
+    if (dst != NULL) {
+        write_chunk_header(header, entry);
+        ok = (SDL_RWwrite(dst, header, CHUNK_FILE_HEADER, 1) == 1 &&
+              SDL_RWwrite(dst, entry->abuf, entry->alen, 1) == 1);
+        ok = (SDL_RWclose(dst) == 0) && ok;
+
+        /* Written whole or not at all, so other programs never map half a file */
+        if (!ok || rename(temp, path) != 0) {
+            remove(temp);
+        }
+    }
+    SDL_free(temp);
+}
+
+static void unlink_cached_chunk(cached_chunk *entry)
+{
+    if (entry->prev) {
+        entry->prev->next = entry->next;
+    } else {
+        chunk_cache.head = entry->next;
+    }
+    if (entry->next) {
+        entry->next->prev = entry->prev;
+    } else {
+        chunk_cache.tail = entry->prev;
+    }
+    entry->prev = entry->next = NULL;
+}
+
+static void link_cached_chunk(cached_chunk *entry)
+{
+    entry->prev = NULL;
+    entry->next = chunk_cache.head;
+    if (chunk_cache.head) {
+        chunk_cache.head->prev = entry;
+    } else {
+        chunk_cache.tail = entry;
+    }
+    chunk_cache.head = entry;
+}
+
+static void free_cached_chunk(cached_chunk *entry)
+{
+    if (entry->mapping) {
+        unmap_chunk_file(entry->mapping, entry->mapping_len);
+    } else {
+        SDL_free(entry->abuf);
+    }
+    SDL_free(entry);
+}
+
+/* Evict unused entries, least recently used first, until within budget.
+   Call with the cache locked. */
+static void trim_chunk_cache(void)
+{
+    cached_chunk *entry = chunk_cache.tail;
+
+    while (entry && chunk_cache.stats.bytes > chunk_cache.max_bytes) {
+        cached_chunk *prev = entry->prev;
+        if (entry->refcount == 0) {
+            unlink_cached_chunk(entry);
+            chunk_cache.stats.bytes -= entry->alen;
+            --chunk_cache.stats.entries;
+            ++chunk_cache.stats.evictions;
+            free_cached_chunk(entry);
+        }
+        entry = prev;
+    }
+}
+
+/* Free every entry no chunk is using.
+   Call with the cache locked. */
+static void flush_chunk_cache(void)
+{
+    cached_chunk *entry = chunk_cache.head;
+
+    while (entry) {
+        cached_chunk *next = entry->next;
+        if (entry->refcount == 0) {
+            unlink_cached_chunk(entry);
+            chunk_cache.stats.bytes -= entry->alen;
+            --chunk_cache.stats.entries;
+            free_cached_chunk(entry);
+        }
+        entry = next;
+    }
+}
+
+/* Find a cached entry and take a reference to it.
+   Call with the cache locked. */
+static cached_chunk *find_cached_chunk(Uint64 hash, Uint32 srclen)
+{
+    cached_chunk *entry;
+
+    for (entry = chunk_cache.head; entry; entry = entry->next) {
+        if (entry->hash == hash && entry->srclen == srclen &&
+            entry->format == mixer.format && entry->channels == mixer.channels &&
+            entry->freq == mixer.freq) {
+            unlink_cached_chunk(entry);
+            link_cached_chunk(entry);
+            ++entry->refcount;
+            return(entry);
+        }
+    }
+    return(NULL);
+}
+
+static int chunk_cache_enabled(void)
+{
+    return(chunk_cache.lock != NULL && (chunk_cache.max_bytes > 0 || chunk_cache.dir != NULL));
+}
+
+static int init_chunk_cache(void)
+{
+    if (chunk_cache.lock == NULL) {
+        chunk_cache.lock = SDL_CreateMutex();
+        if (chunk_cache.lock == NULL) {
+            return(-1);
+        }
+    }
+    SDL_LockMutex(chunk_cache.lock);
+    chunk_cache.quitting = 0;
+    SDL_UnlockMutex(chunk_cache.lock);
+    return(0);
+}
+
+static void destroy_chunk_cache(void)
+{
+    SDL_DestroyMutex(chunk_cache.lock);
+    SDL_zero(chunk_cache);
+}
+
+/* Converted audio only fits the device it was made for, from Mix_CloseAudio() */
+static void close_chunk_cache(void)
+{
+    if (chunk_cache.lock == NULL) {
+        return;
+    }
+    SDL_LockMutex(chunk_cache.lock);
+    flush_chunk_cache();
+    SDL_UnlockMutex(chunk_cache.lock);
+}
+
+/* Free the cache, or leave it to the last Mix_FreeChunk() of a cached chunk */
+static void quit_chunk_cache(void)
+{
+    int done;
+
+    if (chunk_cache.lock == NULL) {
+        return;
+    }
+    SDL_LockMutex(chunk_cache.lock);
+    chunk_cache.max_bytes = 0;
+    SDL_free(chunk_cache.dir);
+    chunk_cache.dir = NULL;
+    flush_chunk_cache();
+    chunk_cache.quitting = 1;
+    done = (chunk_cache.head == NULL);
+    SDL_UnlockMutex(chunk_cache.lock);
+
+    if (done) {
+        destroy_chunk_cache();
+    }
+}
+
+void Mix_SetChunkCacheSize(Uint32 max_bytes)
+{
+    if (init_chunk_cache() < 0) {
+        return;
+    }
+    SDL_LockMutex(chunk_cache.lock);
+    chunk_cache.max_bytes = max_bytes;
+    trim_chunk_cache();
+    SDL_UnlockMutex(chunk_cache.lock);
+}
+
+int Mix_SetChunkCacheDir(const char *path)
+{
+    char *dir = NULL;
+
+    if (init_chunk_cache() < 0) {
+        return(-1);
+    }
+    if (path) {
+        dir = SDL_strdup(path);
+        if (dir == NULL) {
+            SDL_SetError("Out of memory");
+            return(-1);
+        }
+    }
+    SDL_LockMutex(chunk_cache.lock);
+    SDL_free(chunk_cache.dir);
+    chunk_cache.dir = dir;
+    SDL_UnlockMutex(chunk_cache.lock);
+    return(0);
+}
+
+void Mix_GetChunkCacheStats(Mix_ChunkCacheStats *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    if (chunk_cache.lock == NULL) {
+        SDL_zerop(stats);
+        return;
+    }
+    SDL_LockMutex(chunk_cache.lock);
+    *stats = chunk_cache.stats;
+    SDL_UnlockMutex(chunk_cache.lock);
+}
+
+static Mix_Chunk *make_cached_chunk(cached_chunk *entry)
+{
+    Mix_Chunk *chunk = (Mix_Chunk *)SDL_malloc(sizeof(Mix_Chunk));
+
+    if (chunk == NULL) {
+        SDL_SetError("Out of memory");
+        return(NULL);
+    }
+    chunk->allocated = MIX_CHUNK_CACHED;
+    chunk->abuf = entry->abuf;
+    chunk->alen = entry->alen;
+    chunk->volume = MIX_MAX_VOLUME;
+    return(chunk);
+}
+
+/* Give a buffer back to the cache, from Mix_FreeChunk() */
+static void release_cached_chunk(Uint8 *abuf)
+{
+    cached_chunk *entry;
+    int done;
+
+    SDL_LockMutex(chunk_cache.lock);
+    for (entry = chunk_cache.head; entry; entry = entry->next) {
+        if (entry->abuf == abuf && entry->refcount > 0) {
+            --entry->refcount;
+            break;
+        }
+    }
+    if (chunk_cache.quitting) {
+        flush_chunk_cache();
+    } else {
+        trim_chunk_cache();
+    }
+    done = (chunk_cache.quitting && chunk_cache.head == NULL);
+    SDL_UnlockMutex(chunk_cache.lock);
+
+    if (done) {
+        destroy_chunk_cache();
+    }
+}
+
+static Mix_Chunk *load_cached_chunk(SDL_RWops *src, int freesrc)
+{
+    cached_chunk *entry, *other;
+    Mix_Chunk *chunk = NULL;
+    SDL_RWops *mem;
+    const Uint8 *view;
+    Uint8 *data = NULL;
+    char *path = NULL;
+    size_t len;
+    Uint64 hash;
+
+    /* Hash memory and mapped files in place */
+    view = (const Uint8 *) SDL_RWGetMemoryView(src, &len);
+    if (view == NULL) {
+        data = read_chunk_data(src, &len);
+        if ( freesrc ) {
+            SDL_RWclose(src);
+        }
+        if (data == NULL) {
+            return(NULL);
+        }
+        view = data;
+        freesrc = 0;
+    }
+    if (len == 0 || len > 0x7FFFFFFF) {
+        Mix_SetError(len ? "Audio data too large" : "Empty audio data");
+        SDL_free(data);
+        if ( freesrc ) {
+            SDL_RWclose(src);
+        }
+        return(NULL);
+    }
+    hash = hash_chunk_data(view, len);
+
+    SDL_LockMutex(chunk_cache.lock);
+    entry = find_cached_chunk(hash, (Uint32) len);
+    if (entry) {
+        ++chunk_cache.stats.hits;
+    } else if (chunk_cache.dir != NULL) {
+        path = chunk_file_path(hash, (Uint32) len, "");
+    }
+    SDL_UnlockMutex(chunk_cache.lock);
+
+    if (entry == NULL) {
+        /* Decode and touch the cache directory without the lock, it can take a while */
+        entry = (cached_chunk *) SDL_calloc(1, sizeof (cached_chunk));
+        if (entry == NULL) {
+            SDL_SetError("Out of memory");
+            SDL_free(path);
+            SDL_free(data);
+            if ( freesrc ) {
+                SDL_RWclose(src);
+            }
+            return(NULL);
+        }
+        entry->hash = hash;
+        entry->srclen = (Uint32) len;
+        entry->format = mixer.format;
+        entry->channels = mixer.channels;
+        entry->freq = mixer.freq;
+        entry->refcount = 1;
+
+        if (path == NULL || map_cached_chunk(entry, path) < 0) {
+            mem = SDL_RWFromConstMem(view, (int) len);
+            chunk = mem ? load_chunk(mem, 1) : NULL;
+            if (chunk == NULL) {
+                SDL_free(entry);
+                SDL_free(path);
+                SDL_free(data);
+                if ( freesrc ) {
+                    SDL_RWclose(src);
+                }
+                return(NULL);
+            }
+            entry->abuf = chunk->abuf;
+            entry->alen = chunk->alen;
+            chunk->allocated = MIX_CHUNK_CACHED;
+            if (path != NULL) {
+                write_cached_chunk(entry, path);
+            }
+        }
+        SDL_free(path);
+
+        SDL_LockMutex(chunk_cache.lock);
+        if (entry->mapping) {
+            ++chunk_cache.stats.disk_hits;
+        } else {
+            ++chunk_cache.stats.misses;
+        }
+        /* Someone else may have loaded the same data in the meantime */
+        other = find_cached_chunk(hash, (Uint32) len);
+        if (other) {
+            if (chunk) {
+                chunk->abuf = other->abuf;
+            }
+            free_cached_chunk(entry);
+            entry = other;
+        } else {
+            link_cached_chunk(entry);
+            chunk_cache.stats.bytes += entry->alen;
+            ++chunk_cache.stats.entries;
+        }
+        trim_chunk_cache();
+        SDL_UnlockMutex(chunk_cache.lock);
+    }
+    SDL_free(data);
+    if ( freesrc ) {
+        SDL_RWclose(src);
+    }
+
+    if (chunk == NULL) {
+        chunk = make_cached_chunk(entry);
+        if (chunk == NULL) {
+            release_cached_chunk(entry->abuf);
+        }
+    }
+    return(chunk);
+}
+
+Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
+{
+    /* rcg06012001 Make sure src is valid */
+    if ( ! src ) {
+        SDL_SetError("Mix_LoadWAV_RW with NULL src");
+        return(NULL);
+    }
+
+    /* Make sure audio has been opened */
+    if ( ! audio_opened ) {
+        SDL_SetError("Audio device hasn't been opened");
+        if ( freesrc ) {
+            SDL_RWclose(src);
+        }
+        return(NULL);
+    }
+
+    if ( chunk_cache_enabled() ) {
+        return(load_cached_chunk(src, freesrc));
+    }
+    return(load_chunk(src, freesrc));
+}
+
 /* Load a wave file of the mixer format from a memory buffer */
 Mix_Chunk *Mix_QuickLoad_WAV(Uint8 *mem)
 {
@@ -849,7 +1756,9 @@ void Mix_FreeChunk(Mix_Chunk *chunk)
         }
         SDL_UnlockAudio();
         /* Actually free the chunk */
-        if ( chunk->allocated ) {
+        if ( chunk->allocated == MIX_CHUNK_CACHED ) {
+            release_cached_chunk(chunk->abuf);
+        } else if ( chunk->allocated ) {
             SDL_free(chunk->abuf);
         }
         SDL_free(chunk);
@@ -1241,6 +2150,8 @@ void Mix_CloseAudio(void)
             Mix_HaltChannel(-1);
             _Mix_DeinitEffects();
             SDL_CloseAudio();
+            mix_pool_quit();
+            close_chunk_cache();
             SDL_free(mix_channel);
             mix_channel = NULL;
 
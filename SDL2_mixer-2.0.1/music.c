@@ -28,6 +28,9 @@
 #include "SDL_endian.h"
 #include "SDL_audio.h"
 #include "SDL_timer.h"
+#include "SDL_atomic.h"
+#include "SDL_thread.h"
+#include "SDL_hints.h"
 
 #include "SDL_mixer.h"
 
@@ -172,6 +175,415 @@ static void add_music_decoder(const char *decoder)
     music_decoders[num_decoders++] = decoder;
 }
 
+#if defined(OGG_MUSIC) || defined(FLAC_MUSIC) || defined(MP3_MAD_MUSIC)
+#define MUSIC_DECODE_AHEAD
+#endif
+
+#ifdef MUSIC_DECODE_AHEAD
+/* Music decoded ahead, see MIX_HINT_MUSIC_DECODE_AHEAD.
+   The thread is the only writer of the ring and the audio callback the
+   only reader, so each only moves its own end forward and neither needs
+   a lock.  The lock guards the decoder of (music) instead: it is held
+   while decoding, seeking or detaching, and the callback never waits
+   for it.  Emptying the ring is only done with both the lock and the
+   audio device locked, when neither end can move.
+   Looping music is looped by the decoder, which notes where each new
+   pass starts in the ring, so the callback can count the loops as it
+   plays past them.
+ */
+#define MUSIC_STREAM_LOOPS  16
+static struct
+{
+    SDL_Thread *thread;
+    SDL_sem *wake;
+    SDL_mutex *lock;
+    SDL_atomic_t quit;
+    Mix_Music *music;       /* being decoded ahead, or NULL */
+    Uint8 *ring;
+    Uint32 size;            /* a power of two */
+    SDL_atomic_t head;      /* bytes written, wrapping */
+    SDL_atomic_t tail;      /* bytes read, wrapping */
+    SDL_atomic_t eof;       /* the decoder has reached the end */
+    int loops;              /* passes left to decode, -1 forever */
+    Uint32 loop_at[MUSIC_STREAM_LOOPS]; /* where passes start in the ring */
+    SDL_atomic_t loops_written;
+    SDL_atomic_t loops_read;
+    int looped;             /* passes the callback started, not counted yet */
+    Uint8 *block;
+    int block_len;          /* a whole number of sample frames */
+    int frame_size;
+    SDL_AudioFormat format;
+    int volume;
+    SDL_atomic_t underruns;
+    Mix_MusicStreamStats stats;
+} music_stream;
+
+static int music_decodes_ahead(Mix_Music *music)
+{
+    if ( music_stream.thread == NULL ) {
+        return 0;
+    }
+    switch (music->type) {
+#ifdef OGG_MUSIC
+        case MUS_OGG:
+        return 1;
+#endif
+#ifdef FLAC_MUSIC
+        case MUS_FLAC:
+        return 1;
+#endif
+#ifdef MP3_MAD_MUSIC
+        case MUS_MP3_MAD:
+        return 1;
+#endif
+        default:
+        return 0;
+    }
+}
+
+/* Decode (len) bytes at full volume, returns how many were left over */
+static int music_decode(Mix_Music *music, Uint8 *stream, int len)
+{
+    switch (music->type) {
+#ifdef OGG_MUSIC
+        case MUS_OGG:
+        return OGG_playAudio(music->data.ogg, stream, len);
+#endif
+#ifdef FLAC_MUSIC
+        case MUS_FLAC:
+        return FLAC_playAudio(music->data.flac, stream, len);
+#endif
+#ifdef MP3_MAD_MUSIC
+        case MUS_MP3_MAD:
+        return mad_getSamples(music->data.mp3_mad, stream, len);
+#endif
+        default:
+        return len;
+    }
+}
+
+/* Start the decoder over for a loop, with the lock held */
+static void music_rewind(Mix_Music *music)
+{
+    switch (music->type) {
+#ifdef OGG_MUSIC
+        case MUS_OGG:
+        OGG_play(music->data.ogg);
+        OGG_jump_to_time(music->data.ogg, 0.0);
+        break;
+#endif
+#ifdef FLAC_MUSIC
+        case MUS_FLAC:
+        FLAC_play(music->data.flac);
+        FLAC_jump_to_time(music->data.flac, 0.0);
+        break;
+#endif
+#ifdef MP3_MAD_MUSIC
+        case MUS_MP3_MAD:
+        mad_start(music->data.mp3_mad);
+        mad_seek(music->data.mp3_mad, 0.0);
+        break;
+#endif
+        default:
+        break;
+    }
+}
+
+static int music_stream_loops_full(void)
+{
+    return ( SDL_AtomicGet(&music_stream.loops_written) -
+             SDL_AtomicGet(&music_stream.loops_read) >= MUSIC_STREAM_LOOPS );
+}
+
+/* Start the next pass of looping music at (head), with the lock held.
+   Returns 1 if it did, 0 if the music ends here, or -1 if the callback
+   has to play past earlier passes first. */
+static int music_stream_rewind(Uint32 head)
+{
+    int written;
+
+    if ( music_stream.loops == 0 ) {
+        return 0;
+    }
+    if ( music_stream_loops_full() ) {
+        return -1;
+    }
+    music_rewind(music_stream.music);
+    if ( music_stream.loops > 0 ) {
+        --music_stream.loops;
+    }
+    written = SDL_AtomicGet(&music_stream.loops_written);
+    music_stream.loop_at[written % MUSIC_STREAM_LOOPS] = head;
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&music_stream.loops_written, written + 1);
+    return 1;
+}
+
+/* Decode up to (want) more bytes into the ring, with the lock held */
+static void music_stream_fill(int want)
+{
+    Uint32 head = (Uint32) SDL_AtomicGet(&music_stream.head);
+    Uint32 tail, offset;
+    int len, left, first, status;
+
+    while ( want > 0 && !SDL_AtomicGet(&music_stream.eof) ) {
+        tail = (Uint32) SDL_AtomicGet(&music_stream.tail);
+        len = (int) (music_stream.size - (head - tail));
+        if ( len > want ) {
+            len = want;
+        }
+        if ( len > music_stream.block_len ) {
+            len = music_stream.block_len;
+        }
+        len -= len % music_stream.frame_size;
+        if ( len <= 0 ) {
+            break;
+        }
+
+        left = music_decode(music_stream.music, music_stream.block, len);
+        len -= left;
+
+        offset = head & (music_stream.size - 1);
+        first = (int) SDL_min((Uint32) len, music_stream.size - offset);
+        SDL_memcpy(music_stream.ring + offset, music_stream.block, first);
+        SDL_memcpy(music_stream.ring, music_stream.block + first, len - first);
+        head += len;
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&music_stream.head, (int) head);
+        want -= len;
+
+        if ( left > 0 ) {
+            status = music_stream_rewind(head);
+            if ( status == 0 ) {
+                /* Only after the last of the audio is in the ring */
+                SDL_AtomicSet(&music_stream.eof, 1);
+            }
+            if ( status <= 0 ) {
+                break;
+            }
+        }
+    }
+}
+
+/* Throw away what was decoded ahead, with the lock and the audio locked */
+static void music_stream_flush(void)
+{
+    SDL_AtomicSet(&music_stream.tail, SDL_AtomicGet(&music_stream.head));
+    SDL_AtomicSet(&music_stream.eof, 0);
+    SDL_AtomicSet(&music_stream.loops_written, 0);
+    SDL_AtomicSet(&music_stream.loops_read, 0);
+    music_stream.looped = 0;
+}
+
+static void music_stream_attach(Mix_Music *music)
+{
+    SDL_LockMutex(music_stream.lock);
+    music_stream.music = music;
+    music_stream.loops = music_loops;
+    music_stream_flush();
+    SDL_UnlockMutex(music_stream.lock);
+    SDL_SemPost(music_stream.wake);
+}
+
+static void music_stream_detach(void)
+{
+    SDL_LockMutex(music_stream.lock);
+    music_stream.music = NULL;
+    music_stream_flush();
+    SDL_UnlockMutex(music_stream.lock);
+}
+
+/* Count the passes of looping music that start before (tail) */
+static void music_stream_passed(Uint32 tail)
+{
+    int read = SDL_AtomicGet(&music_stream.loops_read);
+
+    while ( read != SDL_AtomicGet(&music_stream.loops_written) ) {
+        SDL_MemoryBarrierAcquire();
+        if ( (Sint32) (tail - music_stream.loop_at[read % MUSIC_STREAM_LOOPS]) < 0 ) {
+            break;
+        }
+        ++music_stream.looped;
+        ++read;
+        SDL_AtomicSet(&music_stream.loops_read, read);
+    }
+}
+
+/* Copy decoded audio out of the ring, returns how many bytes were left
+   over because the music ended */
+static int music_stream_read(Uint8 *stream, int len)
+{
+    Uint32 head, tail, offset;
+    int amount, first;
+    int refilled = 0;
+
+    while ( len > 0 ) {
+        tail = (Uint32) SDL_AtomicGet(&music_stream.tail);
+        head = (Uint32) SDL_AtomicGet(&music_stream.head);
+        amount = (int) SDL_min(head - tail, (Uint32) len);
+
+        if ( amount == 0 ) {
+            if ( SDL_AtomicGet(&music_stream.eof) ) {
+                /* The end was written before eof was set, check again */
+                if ( (Uint32) SDL_AtomicGet(&music_stream.head) != head ) {
+                    continue;
+                }
+                break;
+            }
+            SDL_AtomicIncRef(&music_stream.underruns);
+
+            /* Decode the rest here if the thread isn't busy, otherwise
+               this part of the stream stays silent */
+            if ( refilled || SDL_TryLockMutex(music_stream.lock) != 0 ) {
+                return 0;
+            }
+            music_stream_fill(len);
+            SDL_UnlockMutex(music_stream.lock);
+            refilled = 1;
+            continue;
+        }
+
+        SDL_MemoryBarrierAcquire();
+        offset = tail & (music_stream.size - 1);
+        first = (int) SDL_min((Uint32) amount, music_stream.size - offset);
+        if ( music_stream.volume == MIX_MAX_VOLUME ) {
+            SDL_memcpy(stream, music_stream.ring + offset, first);
+            SDL_memcpy(stream + first, music_stream.ring, amount - first);
+        } else {
+            SDL_MixAudioFormat(stream, music_stream.ring + offset,
+                               music_stream.format, first, music_stream.volume);
+            SDL_MixAudioFormat(stream + first, music_stream.ring,
+                               music_stream.format, amount - first, music_stream.volume);
+        }
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&music_stream.tail, (int) (tail + amount));
+        stream += amount;
+        len -= amount;
+        music_stream_passed(tail + amount);
+    }
+
+    if ( SDL_SemValue(music_stream.wake) == 0 ) {
+        SDL_SemPost(music_stream.wake);
+    }
+    return len;
+}
+
+static int SDLCALL music_stream_thread(void *data)
+{
+    Uint64 start;
+    Uint32 elapsed, used;
+    int decoded;
+
+    while ( !SDL_AtomicGet(&music_stream.quit) ) {
+        SDL_LockMutex(music_stream.lock);
+        used = (Uint32) SDL_AtomicGet(&music_stream.head) - (Uint32) SDL_AtomicGet(&music_stream.tail);
+        decoded = ( music_stream.music && !SDL_AtomicGet(&music_stream.eof) &&
+                    !music_stream_loops_full() &&
+                    music_stream.size - used >= (Uint32) music_stream.block_len );
+        if ( decoded ) {
+            start = SDL_GetPerformanceCounter();
+            music_stream_fill(music_stream.block_len);
+            elapsed = (Uint32) ((SDL_GetPerformanceCounter() - start) * 1000000 / SDL_GetPerformanceFrequency());
+            ++music_stream.stats.decodes;
+            music_stream.stats.decode_us += elapsed;
+            if ( elapsed > music_stream.stats.max_decode_us ) {
+                music_stream.stats.max_decode_us = elapsed;
+            }
+        }
+        SDL_UnlockMutex(music_stream.lock);
+
+        if ( !decoded ) {
+            SDL_SemWait(music_stream.wake);
+        }
+    }
+    return 0;
+}
+
+static void music_stream_quit(void)
+{
+    if ( music_stream.thread ) {
+        SDL_AtomicSet(&music_stream.quit, 1);
+        SDL_SemPost(music_stream.wake);
+        SDL_WaitThread(music_stream.thread, NULL);
+    }
+    if ( music_stream.wake ) {
+        SDL_DestroySemaphore(music_stream.wake);
+    }
+    if ( music_stream.lock ) {
+        SDL_DestroyMutex(music_stream.lock);
+    }
+    SDL_free(music_stream.ring);
+    SDL_free(music_stream.block);
+    SDL_zero(music_stream);
+}
+
+static void music_stream_init(SDL_AudioSpec *mixer)
+{
+    const char *hint = SDL_GetHint(MIX_HINT_MUSIC_DECODE_AHEAD);
+    int ms = hint ? SDL_atoi(hint) : 0;
+    Uint32 bytes;
+
+    SDL_zero(music_stream);
+    if ( ms <= 0 ) {
+        return;
+    }
+    if ( ms > 10000 ) {
+        ms = 10000;
+    }
+
+    music_stream.frame_size = (SDL_AUDIO_BITSIZE(mixer->format) / 8) * mixer->channels;
+    music_stream.block_len = mixer->samples * music_stream.frame_size;
+    music_stream.format = mixer->format;
+    music_stream.volume = MIX_MAX_VOLUME;
+
+    /* At least room for the thread to decode a block while the callback
+       still has one to read */
+    bytes = (Uint32) ((Sint64) ms * mixer->freq / 1000) * music_stream.frame_size;
+    bytes = SDL_max(bytes, 2 * (Uint32) music_stream.block_len);
+    music_stream.size = 1;
+    while ( music_stream.size < bytes ) {
+        music_stream.size *= 2;
+    }
+
+    music_stream.ring = (Uint8 *) SDL_malloc(music_stream.size);
+    music_stream.block = (Uint8 *) SDL_malloc(music_stream.block_len);
+    music_stream.wake = SDL_CreateSemaphore(0);
+    music_stream.lock = SDL_CreateMutex();
+    if ( !music_stream.ring || !music_stream.block || !music_stream.wake || !music_stream.lock ) {
+        music_stream_quit();
+        return;
+    }
+    music_stream.thread = SDL_CreateThread(music_stream_thread, "SDL_mixer music", NULL);
+    if ( music_stream.thread == NULL ) {
+        music_stream_quit();
+    }
+}
+
+void Mix_GetMusicStreamStats(Mix_MusicStreamStats *stats)
+{
+    if ( stats == NULL ) {
+        return;
+    }
+    if ( music_stream.lock == NULL ) {
+        SDL_zerop(stats);
+        return;
+    }
+    SDL_LockMutex(music_stream.lock);
+    *stats = music_stream.stats;
+    stats->underruns = (Uint32) SDL_AtomicGet(&music_stream.underruns);
+    stats->buffered = (Uint32) SDL_AtomicGet(&music_stream.head) - (Uint32) SDL_AtomicGet(&music_stream.tail);
+    stats->capacity = music_stream.size;
+    SDL_UnlockMutex(music_stream.lock);
+}
+#else
+void Mix_GetMusicStreamStats(Mix_MusicStreamStats *stats)
+{
+    if ( stats != NULL ) {
+        SDL_zerop(stats);
+    }
+}
+#endif /* MUSIC_DECODE_AHEAD */
+
 /* Local low-level functions prototypes */
 static void music_internal_initialize_volume(void);
 static void music_internal_volume(int volume);
@@ -207,6 +619,21 @@ static int music_halt_or_loop (void)
 {
     /* Restart music if it has to loop */
 
+#ifdef MUSIC_DECODE_AHEAD
+    if ( music_stream.music == music_playing ) {
+        /* The decoding thread loops it, just count the passes started */
+        for ( ; music_stream.looped > 0; --music_stream.looped ) {
+            if ( music_loops > 0 ) {
+                --music_loops;
+            }
+            music_playing->played = 0;
+        }
+        if ( !music_internal_playing() ) {
+            music_loops = 0;
+        }
+    }
+#endif
+
     if (!music_internal_playing())
     {
 #ifdef USE_NATIVE_MIDI
@@ -323,13 +750,20 @@ void music_mixer(void *udata, Uint8 *stream, int len)
 #endif
 #ifdef OGG_MUSIC
             case MUS_OGG:
-
-                left = OGG_playAudio(music_playing->data.ogg, stream, len);
+                if ( music_stream.music == music_playing ) {
+                    left = music_stream_read(stream, len);
+                } else {
+                    left = OGG_playAudio(music_playing->data.ogg, stream, len);
+                }
                 break;
 #endif
 #ifdef FLAC_MUSIC
             case MUS_FLAC:
-                left = FLAC_playAudio(music_playing->data.flac, stream, len);
+                if ( music_stream.music == music_playing ) {
+                    left = music_stream_read(stream, len);
+                } else {
+                    left = FLAC_playAudio(music_playing->data.flac, stream, len);
+                }
                 break;
 #endif
 #ifdef MP3_MUSIC
@@ -339,7 +773,11 @@ void music_mixer(void *udata, Uint8 *stream, int len)
 #endif
 #ifdef MP3_MAD_MUSIC
             case MUS_MP3_MAD:
-                left = mad_getSamples(music_playing->data.mp3_mad, stream, len);
+                if ( music_stream.music == music_playing ) {
+                    left = music_stream_read(stream, len);
+                } else {
+                    left = mad_getSamples(music_playing->data.mp3_mad, stream, len);
+                }
                 break;
 #endif
             default:
@@ -434,6 +872,9 @@ int open_music(SDL_AudioSpec *mixer)
 
     music_playing = NULL;
     music_stopped = 0;
+#ifdef MUSIC_DECODE_AHEAD
+    music_stream_init(mixer);
+#endif
     Mix_VolumeMusic(SDL_MIX_MAXVOLUME);
 
     /* Calculate the number of ms for each callback */
@@ -553,7 +994,7 @@ Mix_Music *Mix_LoadMUS(const char *file)
     }
 #endif
 
-    src = SDL_RWFromFile(file, "rb");
+    src = SDL_RWFromFileMapped(file);
     if ( src == NULL ) {
         Mix_SetError("Couldn't open '%s'", file);
         return NULL;
@@ -994,6 +1435,12 @@ static int music_internal_play(Mix_Music *music, double position)
     }
 
 skip:
+#ifdef MUSIC_DECODE_AHEAD
+    if ( retval == 0 && music_decodes_ahead(music) ) {
+        music_stream_attach(music);
+    }
+#endif
+
     /* Set the playback position, note any errors if an offset is used */
     if ( retval == 0 ) {
         if ( position > 0.0 ) {
@@ -1068,6 +1515,13 @@ int Mix_PlayMusic(Mix_Music *music, int loops)
 int music_internal_position(double position)
 {
     int retval = 0;
+#ifdef MUSIC_DECODE_AHEAD
+    int ahead = ( music_stream.music == music_playing );
+
+    if ( ahead ) {
+        SDL_LockMutex(music_stream.lock);
+    }
+#endif
 
     switch (music_playing->type) {
 #ifdef WAV_MUSIC
@@ -1114,6 +1568,17 @@ int music_internal_position(double position)
         retval = -1;
         break;
     }
+
+#ifdef MUSIC_DECODE_AHEAD
+    if ( ahead ) {
+        /* Start over from the new position, with enough for the next
+           callback already decoded */
+        music_stream_flush();
+        music_stream_fill(music_stream.block_len);
+        SDL_UnlockMutex(music_stream.lock);
+        SDL_SemPost(music_stream.wake);
+    }
+#endif
     return(retval);
 }
 int Mix_SetMusicPosition(double position)
@@ -1148,6 +1613,15 @@ static void music_internal_initialize_volume(void)
 /* Set the music volume */
 static void music_internal_volume(int volume)
 {
+#ifdef MUSIC_DECODE_AHEAD
+    /* Music decoded ahead is decoded at full volume, and the volume
+       applied as it is played */
+    if ( music_decodes_ahead(music_playing) ) {
+        music_stream.volume = volume;
+        volume = MIX_MAX_VOLUME;
+    }
+#endif
+
     switch (music_playing->type) {
 #ifdef CMD_MUSIC
         case MUS_CMD:
@@ -1240,6 +1714,12 @@ int Mix_VolumeMusic(int volume)
 /* Halt playing of music */
 static void music_internal_halt(void)
 {
+#ifdef MUSIC_DECODE_AHEAD
+    if ( music_stream.music == music_playing ) {
+        music_stream_detach();
+    }
+#endif
+
     switch (music_playing->type) {
 #ifdef CMD_MUSIC
         case MUS_CMD:
@@ -1410,6 +1890,14 @@ static int music_internal_playing()
         return 0;
     }
 
+#ifdef MUSIC_DECODE_AHEAD
+    /* Still playing what was decoded ahead after the decoder finished */
+    if (music_stream.music == music_playing) {
+        return !SDL_AtomicGet(&music_stream.eof) ||
+               SDL_AtomicGet(&music_stream.head) != SDL_AtomicGet(&music_stream.tail);
+    }
+#endif
+
     switch (music_playing->type) {
 #ifdef CMD_MUSIC
         case MUS_CMD:
@@ -1547,6 +2035,9 @@ int Mix_GetSynchroValue(void)
 void close_music(void)
 {
     Mix_HaltMusic();
+#ifdef MUSIC_DECODE_AHEAD
+    music_stream_quit();
+#endif
 #ifdef CMD_MUSIC
     Mix_SetMusicCMD(NULL);
 #endif
@@ -552,6 +552,9 @@ void FLAC_jump_to_time(FLAC_music *music, double time)
                 music->flac_data.overflow = NULL;
             }
 
+            // drop what was converted before the seek
+            music->len_available = 0;
+
             if (!flac.FLAC__stream_decoder_seek_absolute (music->flac_decoder,
                                                 (FLAC__uint64)seek_sample)) {
                 if (flac.FLAC__stream_decoder_get_state (music->flac_decoder)
@@ -293,12 +293,14 @@ mad_seek(mad_data *mp3_mad, double position) {
     mp3_mad->frames_read = 0;
     mad_timer_reset(&mp3_mad->next_frame_start);
     mp3_mad->status &= ~MS_error_flags;
-    mp3_mad->output_begin = 0;
-    mp3_mad->output_end = 0;
 
     SDL_RWseek(mp3_mad->src, 0, RW_SEEK_SET);
   }
 
+  /* Drop what was decoded before the seek */
+  mp3_mad->output_begin = 0;
+  mp3_mad->output_end = 0;
+
   /* Now we have to skip frames until we come to the right one.
      Again, only truly necessary if the file is VBR. */
   while (mad_timer_compare(mp3_mad->next_frame_start, target) < 0) {
@@ -215,6 +215,8 @@ void OGG_delete(OGG_music *music)
 /* Jump (seek) to a given position (time is in seconds) */
 void OGG_jump_to_time(OGG_music *music, double time)
 {
+       /* Drop what was decoded before the seek */
+       music->len_available = 0;
 #ifdef OGG_USE_TREMOR
        vorbis.ov_time_seek( &music->vf, (ogg_int64_t)(time * 1000.0) );
 #else
@@ -65,6 +65,13 @@ typedef struct cached_glyph {
     int yoffset;
     int advance;
     Uint16 cached;
+
+    /* Links in the font's glyph cache, see Find_Glyph() */
+    struct cached_glyph *hash_next;
+    struct cached_glyph *prev;          /* all glyphs, most recently used first */
+    struct cached_glyph *next;
+    struct cached_glyph *image_prev;    /* glyphs with a bitmap or pixmap, likewise */
+    struct cached_glyph *image_next;
 } c_glyph;
 
 /* The structure used to hold internal font information */
@@ -96,7 +103,15 @@ struct _TTF_Font {
 
     /* Cache for style-transformed glyphs */
     c_glyph *current;
-    c_glyph cache[257]; /* 257 is a prime */
+    c_glyph **glyph_hash;
+    int glyph_hash_size;    /* a power of two */
+    c_glyph *first_glyph;
+    c_glyph *last_glyph;
+    c_glyph *first_image;
+    c_glyph *last_image;
+    Uint32 cache_max_bytes;
+    TTF_GlyphCacheStats cache_stats;
+    Uint32 cache_serial;    /* changes whenever the cached glyphs do */
 
     /* We are responsible for closing the font stream */
     SDL_RWops *src;
@@ -125,6 +140,7 @@ struct _TTF_Font {
 static FT_Library library;
 static int TTF_initialized = 0;
 static int TTF_byteswapped = 0;
+static Uint32 TTF_cache_serial = 0;
 
 #define TTF_CHECKPOINTER(p, errval)                 \
     if ( !TTF_initialized ) {                   \
@@ -385,6 +401,7 @@ TTF_Font* TTF_OpenFontIndexRW( SDL_RWops *src, int freesrc, int ptsize, long ind
     FT_Stream stream;
     FT_CharMap found;
     Sint64 position;
+    size_t size;
     int i;
 
     if ( ! TTF_initialized ) {
@@ -422,6 +439,8 @@ TTF_Font* TTF_OpenFontIndexRW( SDL_RWops *src, int freesrc, int ptsize, long ind
 
     font->src = src;
     font->freesrc = freesrc;
+    font->cache_max_bytes = TTF_DEFAULT_GLYPH_CACHE_SIZE;
+    font->cache_serial = ++TTF_cache_serial;
 
     stream = (FT_Stream)SDL_malloc(sizeof(*stream));
     if ( stream == NULL ) {
@@ -431,10 +450,16 @@ TTF_Font* TTF_OpenFontIndexRW( SDL_RWops *src, int freesrc, int ptsize, long ind
     }
     SDL_memset(stream, 0, sizeof(*stream));
 
-    stream->read = RWread;
-    stream->descriptor.pointer = src;
-    stream->pos = (unsigned long)position;
-    stream->size = (unsigned long)(SDL_RWsize(src) - position);
+    stream->base = (unsigned char *)SDL_RWGetMemoryView(src, &size);
+    if ( stream->base ) {
+        /* FreeType reads memory streams in place, without copying */
+        stream->size = (unsigned long)size;
+    } else {
+        stream->read = RWread;
+        stream->descriptor.pointer = src;
+        stream->pos = (unsigned long)position;
+        stream->size = (unsigned long)(SDL_RWsize(src) - position);
+    }
 
 	posix_print("TTF_OpenFontIndexRW(%i.%li), 1, used ticks: %u\n", ptsize, index, SDL_GetTicks() - start_ticks);
 	start_ticks = SDL_GetTicks();
@@ -562,7 +587,7 @@ TTF_Font* TTF_OpenFontRW( SDL_RWops *src, int freesrc, int ptsize )
 
 TTF_Font* TTF_OpenFontIndex( const char *file, int ptsize, long index )
 {
-    SDL_RWops *rw = SDL_RWFromFile(file, "rb");
+    SDL_RWops *rw = SDL_RWFromFileMapped(file);
     if ( rw == NULL ) {
         return NULL;
     }
@@ -575,10 +600,59 @@ TTF_Font* TTF_OpenFont( const char *file, int ptsize )
     return TTF_OpenFontIndex(file, ptsize, 0);
 }
 
-static void Flush_Glyph( c_glyph* glyph )
+/* Memory used by the bitmap and pixmap of a glyph */
+static Uint32 Glyph_Image_Size( c_glyph* glyph )
 {
-    glyph->stored = 0;
-    glyph->index = 0;
+    Uint32 size = 0;
+    if ( glyph->bitmap.buffer ) {
+        size += glyph->bitmap.pitch * glyph->bitmap.rows;
+    }
+    if ( glyph->pixmap.buffer ) {
+        size += glyph->pixmap.pitch * glyph->pixmap.rows;
+    }
+    return size;
+}
+
+static void Unlink_Glyph_Image( TTF_Font* font, c_glyph* glyph )
+{
+    if ( glyph->image_prev ) {
+        glyph->image_prev->image_next = glyph->image_next;
+    } else {
+        font->first_image = glyph->image_next;
+    }
+    if ( glyph->image_next ) {
+        glyph->image_next->image_prev = glyph->image_prev;
+    } else {
+        font->last_image = glyph->image_prev;
+    }
+    glyph->image_prev = glyph->image_next = NULL;
+}
+
+/* Move a glyph to the front of the list of rendered glyphs */
+static void Touch_Glyph_Image( TTF_Font* font, c_glyph* glyph )
+{
+    if ( font->first_image == glyph ) {
+        return;
+    }
+    if ( glyph->image_prev || font->last_image == glyph ) {
+        Unlink_Glyph_Image( font, glyph );
+    }
+    glyph->image_next = font->first_image;
+    if ( font->first_image ) {
+        font->first_image->image_prev = glyph;
+    } else {
+        font->last_image = glyph;
+    }
+    font->first_image = glyph;
+}
+
+/* Drop the bitmap and pixmap of a glyph, but keep its metrics */
+static void Flush_Glyph_Image( TTF_Font* font, c_glyph* glyph )
+{
+    if ( glyph->image_prev || font->first_image == glyph ) {
+        Unlink_Glyph_Image( font, glyph );
+    }
+    font->cache_stats.bytes -= Glyph_Image_Size( glyph );
     if ( glyph->bitmap.buffer ) {
         SDL_free( glyph->bitmap.buffer );
         glyph->bitmap.buffer = 0;
@@ -587,20 +661,83 @@ static void Flush_Glyph( c_glyph* glyph )
         SDL_free( glyph->pixmap.buffer );
         glyph->pixmap.buffer = 0;
     }
-    glyph->cached = 0;
+    glyph->stored &= ~(CACHED_BITMAP|CACHED_PIXMAP);
+}
+
+/* Remove a glyph from the cache and free it */
+static void Flush_Glyph( TTF_Font* font, c_glyph* glyph )
+{
+    c_glyph **link = &font->glyph_hash[glyph->cached & (font->glyph_hash_size - 1)];
+
+    while ( *link != glyph ) {
+        link = &(*link)->hash_next;
+    }
+    *link = glyph->hash_next;
+
+    if ( glyph->prev ) {
+        glyph->prev->next = glyph->next;
+    } else {
+        font->first_glyph = glyph->next;
+    }
+    if ( glyph->next ) {
+        glyph->next->prev = glyph->prev;
+    } else {
+        font->last_glyph = glyph->prev;
+    }
+
+    Flush_Glyph_Image( font, glyph );
+    font->cache_stats.bytes -= sizeof( *glyph );
+    --font->cache_stats.glyphs;
+    if ( font->current == glyph ) {
+        font->current = NULL;
+    }
+    SDL_free( glyph );
 }
 
 static void Flush_Cache( TTF_Font* font )
 {
-    int i;
-    int size = sizeof( font->cache ) / sizeof( font->cache[0] );
+    while ( font->first_glyph ) {
+        Flush_Glyph( font, font->first_glyph );
+    }
+    font->cache_serial = ++TTF_cache_serial;
+}
 
-    for ( i = 0; i < size; ++i ) {
-        if ( font->cache[i].cached ) {
-            Flush_Glyph( &font->cache[i] );
+/* Drop the least recently used rendered glyphs, then glyphs, until the
+   cache fits in its budget again.  The current glyph is always kept. */
+static void Trim_Cache( TTF_Font* font )
+{
+    while ( font->cache_stats.bytes > font->cache_max_bytes ) {
+        if ( font->last_image && font->last_image != font->current ) {
+            Flush_Glyph_Image( font, font->last_image );
+            ++font->cache_stats.image_evictions;
+        } else if ( font->last_glyph && font->last_glyph != font->current ) {
+            Flush_Glyph( font, font->last_glyph );
+            ++font->cache_stats.evictions;
+        } else {
+            break;
         }
+    }
+}
 
+/* Double the size of the hash table */
+static int Grow_Cache( TTF_Font* font )
+{
+    int size = font->glyph_hash_size ? font->glyph_hash_size * 2 : 256;
+    c_glyph **hash = (c_glyph **)SDL_calloc( size, sizeof( *hash ) );
+    c_glyph *glyph;
+
+    if ( !hash ) {
+        return -1;
+    }
+    for ( glyph = font->first_glyph; glyph; glyph = glyph->next ) {
+        c_glyph **link = &hash[glyph->cached & (size - 1)];
+        glyph->hash_next = *link;
+        *link = glyph;
     }
+    SDL_free( font->glyph_hash );
+    font->glyph_hash = hash;
+    font->glyph_hash_size = size;
+    return 0;
 }
 
 static FT_Error Load_Glyph( TTF_Font* font, Uint16 ch, c_glyph* cached, int want )
@@ -920,24 +1057,88 @@ static FT_Error Load_Glyph( TTF_Font* font, Uint16 ch, c_glyph* cached, int want
 static FT_Error Find_Glyph( TTF_Font* font, Uint16 ch, int want )
 {
     int retval = 0;
-    int hsize = sizeof( font->cache ) / sizeof( font->cache[0] );
+    c_glyph *glyph = NULL;
+    Uint32 image_size;
 
-    int h = ch % hsize;
-    font->current = &font->cache[h];
+    if ( font->glyph_hash ) {
+        glyph = font->glyph_hash[ch & (font->glyph_hash_size - 1)];
+        while ( glyph && glyph->cached != ch ) {
+            glyph = glyph->hash_next;
+        }
+    }
 
-    if (font->current->cached != ch)
-        Flush_Glyph( font->current );
+    if ( glyph ) {
+        /* Move it to the front of the glyphs */
+        if ( glyph->prev ) {
+            glyph->prev->next = glyph->next;
+            if ( glyph->next ) {
+                glyph->next->prev = glyph->prev;
+            } else {
+                font->last_glyph = glyph->prev;
+            }
+            glyph->prev = NULL;
+            glyph->next = font->first_glyph;
+            font->first_glyph->prev = glyph;
+            font->first_glyph = glyph;
+        }
+    } else {
+        if ( font->cache_stats.glyphs >= (Uint32) font->glyph_hash_size ) {
+            if ( Grow_Cache( font ) < 0 ) {
+                return FT_Err_Out_Of_Memory;
+            }
+        }
+        glyph = (c_glyph *)SDL_calloc( 1, sizeof( *glyph ) );
+        if ( !glyph ) {
+            return FT_Err_Out_Of_Memory;
+        }
+        glyph->cached = ch;
+        glyph->hash_next = font->glyph_hash[ch & (font->glyph_hash_size - 1)];
+        font->glyph_hash[ch & (font->glyph_hash_size - 1)] = glyph;
+        glyph->next = font->first_glyph;
+        if ( font->first_glyph ) {
+            font->first_glyph->prev = glyph;
+        } else {
+            font->last_glyph = glyph;
+        }
+        font->first_glyph = glyph;
+        font->cache_stats.bytes += sizeof( *glyph );
+        ++font->cache_stats.glyphs;
+    }
+    font->current = glyph;
 
-    if ( (font->current->stored & want) != want ) {
-        retval = Load_Glyph( font, ch, font->current, want );
+    if ( (glyph->stored & want) != want ) {
+        ++font->cache_stats.misses;
+        image_size = Glyph_Image_Size( glyph );
+        retval = Load_Glyph( font, ch, glyph, want );
+        font->cache_stats.bytes += Glyph_Image_Size( glyph ) - image_size;
+    } else {
+        ++font->cache_stats.hits;
     }
+    if ( (want & glyph->stored) & (CACHED_BITMAP|CACHED_PIXMAP) ) {
+        Touch_Glyph_Image( font, glyph );
+    }
+
+    Trim_Cache( font );
     return retval;
 }
 
+void TTF_SetFontGlyphCacheSize( TTF_Font* font, Uint32 max_bytes )
+{
+    font->cache_max_bytes = max_bytes;
+    font->current = NULL;
+    Trim_Cache( font );
+}
+
+void TTF_GetFontGlyphCacheStats( const TTF_Font* font, TTF_GlyphCacheStats *stats )
+{
+    *stats = font->cache_stats;
+}
+
 void TTF_CloseFont( TTF_Font* font )
 {
     if ( font ) {
         Flush_Cache( font );
+        SDL_free( font->glyph_hash );
         if ( font->face ) {
             FT_Done_Face( font->face );
         }
@@ -2150,6 +2351,580 @@ SDL_Surface *TTF_RenderGlyph_Blended(TTF_Font *font, Uint16 ch, SDL_Color fg)
     return TTF_RenderUTF8_Blended(font, (char *)utf8, fg);
 }
 
+/* Text engine for SDL_Renderer.
+ * Glyphs are rendered once into textures shared by all the text drawn
+ * with the engine, packed with a skyline allocator: each page keeps the
+ * outline of the occupied area as a list of horizontal segments, and a
+ * new glyph goes where its top edge ends up lowest.  When every page is
+ * full, all of them are emptied and refilled from the text drawn next.
+ */
+#define TTF_ATLAS_PAGE_SIZE 1024
+#define TTF_ATLAS_MAX_PAGES 4
+#define TTF_ATLAS_CLEAR_ROWS 64
+
+typedef struct atlas_node {
+    int x;
+    int y;
+    int w;
+} atlas_node;
+
+typedef struct atlas_page {
+    SDL_Texture *texture;
+    atlas_node *skyline;
+    int num_nodes;
+} atlas_page;
+
+typedef struct atlas_glyph {
+    Uint32 serial;          /* of the font glyph cache it came from */
+    Uint16 ch;
+    int page;
+    SDL_Rect rect;
+    struct atlas_glyph *next;
+} atlas_glyph;
+
+typedef struct atlas_draw {
+    int page;
+    SDL_Rect src;
+    SDL_Rect dst;
+} atlas_draw;
+
+struct _TTF_TextEngine {
+    SDL_Renderer *renderer;
+    atlas_page pages[TTF_ATLAS_MAX_PAGES];
+    int num_pages;
+
+    atlas_glyph *glyphs[256];
+    int num_glyphs;
+
+    /* Draws waiting to be submitted, grouped by page */
+    atlas_draw *draws;
+    int num_draws;
+    int max_draws;
+
+    Uint32 *pixels;
+    int max_pixels;
+};
+
+TTF_TextEngine *TTF_CreateRendererTextEngine( SDL_Renderer *renderer )
+{
+    TTF_TextEngine *engine;
+
+    if ( !renderer ) {
+        TTF_SetError( "Passed a NULL renderer" );
+        return NULL;
+    }
+    engine = (TTF_TextEngine *)SDL_calloc( 1, sizeof( *engine ) );
+    if ( !engine ) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    engine->renderer = renderer;
+    return engine;
+}
+
+/* Makes room for (count) pixels in the upload buffer */
+static int Atlas_Reserve( TTF_TextEngine *engine, int count )
+{
+    if ( engine->max_pixels < count ) {
+        Uint32 *pixels = (Uint32 *)SDL_realloc( engine->pixels, count * sizeof( Uint32 ) );
+        if ( !pixels ) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        engine->pixels = pixels;
+        engine->max_pixels = count;
+    }
+    return 0;
+}
+
+/* Empties a page, so the padding around its glyphs and the gaps the
+   skyline leaves are transparent, whatever was there before */
+static int Atlas_ClearPage( TTF_TextEngine *engine, atlas_page *page )
+{
+    SDL_Rect rect;
+
+    if ( Atlas_Reserve( engine, TTF_ATLAS_PAGE_SIZE * TTF_ATLAS_CLEAR_ROWS ) < 0 ) {
+        return -1;
+    }
+    SDL_memset( engine->pixels, 0, TTF_ATLAS_PAGE_SIZE * TTF_ATLAS_CLEAR_ROWS * sizeof( Uint32 ) );
+    rect.x = 0;
+    rect.w = TTF_ATLAS_PAGE_SIZE;
+    rect.h = TTF_ATLAS_CLEAR_ROWS;
+    for ( rect.y = 0; rect.y < TTF_ATLAS_PAGE_SIZE; rect.y += rect.h ) {
+        if ( SDL_UpdateTexture( page->texture, &rect, engine->pixels, rect.w * sizeof( Uint32 ) ) < 0 ) {
+            return -1;
+        }
+    }
+
+    page->num_nodes = 1;
+    page->skyline[0].x = 0;
+    page->skyline[0].y = 0;
+    page->skyline[0].w = TTF_ATLAS_PAGE_SIZE;
+    return 0;
+}
+
+static void Atlas_FreeGlyphs( TTF_TextEngine *engine )
+{
+    int i;
+
+    for ( i = 0; i < SDL_arraysize( engine->glyphs ); ++i ) {
+        while ( engine->glyphs[i] ) {
+            atlas_glyph *next = engine->glyphs[i]->next;
+            SDL_free( engine->glyphs[i] );
+            engine->glyphs[i] = next;
+        }
+    }
+    engine->num_glyphs = 0;
+}
+
+static int Atlas_Clear( TTF_TextEngine *engine )
+{
+    int i;
+
+    Atlas_FreeGlyphs( engine );
+
+    for ( i = 0; i < engine->num_pages; ++i ) {
+        if ( Atlas_ClearPage( engine, &engine->pages[i] ) < 0 ) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void TTF_DestroyRendererTextEngine( TTF_TextEngine *engine )
+{
+    int i;
+
+    if ( engine ) {
+        Atlas_FreeGlyphs( engine );
+        for ( i = 0; i < engine->num_pages; ++i ) {
+            SDL_DestroyTexture( engine->pages[i].texture );
+            SDL_free( engine->pages[i].skyline );
+        }
+        SDL_free( engine->draws );
+        SDL_free( engine->pixels );
+        SDL_free( engine );
+    }
+}
+
+static int Atlas_AddPage( TTF_TextEngine *engine )
+{
+    atlas_page *page = &engine->pages[engine->num_pages];
+
+    /* A glyph is at least one pixel wide, so there are at most as many
+       nodes as columns, plus one while Atlas_Pack() inserts a node
+       before merging */
+    page->skyline = (atlas_node *)SDL_malloc( (TTF_ATLAS_PAGE_SIZE + 1) * sizeof( *page->skyline ) );
+    if ( !page->skyline ) {
+        SDL_OutOfMemory();
+        return -1;
+    }
+    page->texture = SDL_CreateTexture( engine->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                       SDL_TEXTUREACCESS_STATIC,
+                                       TTF_ATLAS_PAGE_SIZE, TTF_ATLAS_PAGE_SIZE );
+    if ( !page->texture ) {
+        SDL_free( page->skyline );
+        page->skyline = NULL;
+        return -1;
+    }
+    if ( Atlas_ClearPage( engine, page ) < 0 ) {
+        SDL_DestroyTexture( page->texture );
+        SDL_free( page->skyline );
+        page->texture = NULL;
+        page->skyline = NULL;
+        return -1;
+    }
+    SDL_SetTextureBlendMode( page->texture, SDL_BLENDMODE_BLEND );
+    ++engine->num_pages;
+    return 0;
+}
+
+/* Returns the y a w x h rectangle would have at skyline node (index),
+   or -1 if it doesn't fit there */
+static int Atlas_Fit( atlas_page *page, int index, int w, int h )
+{
+    int x = page->skyline[index].x;
+    int y = 0;
+    int left = w;
+
+    if ( x + w > TTF_ATLAS_PAGE_SIZE ) {
+        return -1;
+    }
+    while ( left > 0 ) {
+        if ( page->skyline[index].y > y ) {
+            y = page->skyline[index].y;
+        }
+        if ( y + h > TTF_ATLAS_PAGE_SIZE ) {
+            return -1;
+        }
+        left -= page->skyline[index].w;
+        ++index;
+    }
+    return y;
+}
+
+/* Find room for a w x h rectangle in a page, returns 0 or -1 if full */
+static int Atlas_Pack( atlas_page *page, int w, int h, SDL_Rect *rect )
+{
+    int i, y;
+    int best = -1;
+    int best_y = TTF_ATLAS_PAGE_SIZE;
+    int best_w = TTF_ATLAS_PAGE_SIZE;
+    atlas_node *node;
+
+    for ( i = 0; i < page->num_nodes; ++i ) {
+        y = Atlas_Fit( page, i, w, h );
+        if ( y >= 0 && (y + h < best_y || (y + h == best_y && page->skyline[i].w < best_w)) ) {
+            best = i;
+            best_y = y + h;
+            best_w = page->skyline[i].w;
+        }
+    }
+    if ( best < 0 ) {
+        return -1;
+    }
+
+    rect->x = page->skyline[best].x;
+    rect->y = best_y - h;
+    rect->w = w;
+    rect->h = h;
+
+    /* The rectangle's top becomes a new segment... */
+    SDL_memmove( &page->skyline[best + 1], &page->skyline[best],
+                 (page->num_nodes - best) * sizeof( *node ) );
+    ++page->num_nodes;
+    node = &page->skyline[best];
+    node->y = best_y;
+    node->w = w;
+
+    /* ...which hides the start of the segments after it */
+    i = best + 1;
+    while ( i < page->num_nodes ) {
+        atlas_node *next = &page->skyline[i];
+        int shrink = (node->x + node->w) - next->x;
+        if ( shrink <= 0 ) {
+            break;
+        }
+        if ( shrink < next->w ) {
+            next->x += shrink;
+            next->w -= shrink;
+            break;
+        }
+        SDL_memmove( next, next + 1, (page->num_nodes - i - 1) * sizeof( *node ) );
+        --page->num_nodes;
+    }
+
+    /* Merge segments at the same height */
+    for ( i = 0; i < page->num_nodes - 1; ) {
+        if ( page->skyline[i].y == page->skyline[i + 1].y ) {
+            page->skyline[i].w += page->skyline[i + 1].w;
+            SDL_memmove( &page->skyline[i + 1], &page->skyline[i + 2],
+                         (page->num_nodes - i - 2) * sizeof( *node ) );
+            --page->num_nodes;
+        } else {
+            ++i;
+        }
+    }
+    return 0;
+}
+
+static void Atlas_Submit( TTF_TextEngine *engine, SDL_Color fg )
+{
+    int page, i;
+
+    for ( page = 0; page < engine->num_pages; ++page ) {
+        SDL_Texture *texture = engine->pages[page].texture;
+        int used = 0;
+        for ( i = 0; i < engine->num_draws; ++i ) {
+            atlas_draw *draw = &engine->draws[i];
+            if ( draw->page != page ) {
+                continue;
+            }
+            if ( !used ) {
+                SDL_SetTextureColorMod( texture, fg.r, fg.g, fg.b );
+                SDL_SetTextureAlphaMod( texture, 255 );
+                used = 1;
+            }
+            SDL_RenderCopy( engine->renderer, texture, &draw->src, &draw->dst );
+        }
+    }
+    engine->num_draws = 0;
+}
+
+/* Returns the atlas copy of the font's current glyph, adding it if needed */
+static atlas_glyph *Atlas_Find( TTF_TextEngine *engine, TTF_Font *font, SDL_Color fg )
+{
+    c_glyph *glyph = font->current;
+    Uint16 ch = glyph->cached;
+    atlas_glyph **bucket = &engine->glyphs[ch & (SDL_arraysize( engine->glyphs ) - 1)];
+    atlas_glyph *entry;
+    FT_Bitmap *pixmap = &glyph->pixmap;
+    SDL_Rect rect;
+    int page, row, col;
+
+    for ( entry = *bucket; entry; entry = entry->next ) {
+        if ( entry->ch == ch && entry->serial == font->cache_serial ) {
+            return entry;
+        }
+    }
+
+    /* Leave a pixel of space around each glyph, so scaled text doesn't
+       pick up its neighbours */
+    for ( page = 0; page < engine->num_pages; ++page ) {
+        if ( Atlas_Pack( &engine->pages[page], pixmap->width + 1, pixmap->rows + 1, &rect ) == 0 ) {
+            break;
+        }
+    }
+    if ( page == engine->num_pages ) {
+        if ( engine->num_pages == TTF_ATLAS_MAX_PAGES ) {
+            /* Start over, after drawing what still uses the old glyphs */
+            Atlas_Submit( engine, fg );
+            if ( Atlas_Clear( engine ) < 0 ) {
+                return NULL;
+            }
+            page = 0;
+        } else if ( Atlas_AddPage( engine ) < 0 ) {
+            return NULL;
+        }
+        bucket = &engine->glyphs[ch & (SDL_arraysize( engine->glyphs ) - 1)];
+        if ( Atlas_Pack( &engine->pages[page], pixmap->width + 1, pixmap->rows + 1, &rect ) < 0 ) {
+            TTF_SetError( "Glyph too large for the text engine" );
+            return NULL;
+        }
+    }
+    rect.w -= 1;
+    rect.h -= 1;
+
+    entry = (atlas_glyph *)SDL_malloc( sizeof( *entry ) );
+    if ( !entry ) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    entry->serial = font->cache_serial;
+    entry->ch = ch;
+    entry->page = page;
+    entry->rect = rect;
+    entry->next = *bucket;
+    *bucket = entry;
+    ++engine->num_glyphs;
+
+    /* White, with the coverage as alpha, so color mod gives the color */
+    if ( rect.w > 0 && rect.h > 0 ) {
+        if ( Atlas_Reserve( engine, rect.w * rect.h ) < 0 ) {
+            return NULL;
+        }
+        for ( row = 0; row < rect.h; ++row ) {
+            const Uint8 *src = pixmap->buffer + row * pixmap->pitch;
+            Uint32 *dst = engine->pixels + row * rect.w;
+            for ( col = 0; col < rect.w; ++col ) {
+                dst[col] = ((Uint32)src[col] << 24) | 0x00FFFFFF;
+            }
+        }
+        SDL_UpdateTexture( engine->pages[page].texture, &rect, engine->pixels, rect.w * sizeof( Uint32 ) );
+    }
+    return entry;
+}
+
+static int Atlas_AddDraw( TTF_TextEngine *engine, int page, const SDL_Rect *src, const SDL_Rect *dst )
+{
+    atlas_draw *draw;
+
+    if ( engine->num_draws == engine->max_draws ) {
+        int max_draws = engine->max_draws ? engine->max_draws * 2 : 64;
+        atlas_draw *draws = (atlas_draw *)SDL_realloc( engine->draws, max_draws * sizeof( *draws ) );
+        if ( !draws ) {
+            SDL_OutOfMemory();
+            return -1;
+        }
+        engine->draws = draws;
+        engine->max_draws = max_draws;
+    }
+    draw = &engine->draws[engine->num_draws++];
+    draw->page = page;
+    draw->src = *src;
+    draw->dst = *dst;
+    return 0;
+}
+
+static void Atlas_DrawLine( TTF_TextEngine *engine, TTF_Font *font, int x, int y, int width, int height, int row, SDL_Color fg )
+{
+    SDL_Rect rect;
+    Uint8 r, g, b, a;
+    SDL_BlendMode blend;
+    int line_height = font->underline_height;
+
+    /* Take outline into account, as TTF_drawLine_Blended() does */
+    if ( font->outline > 0 ) {
+        line_height += font->outline * 2;
+    }
+    if ( row < 0 ) {
+        row = 0;
+    }
+    rect.x = x;
+    rect.y = y + row;
+    rect.w = width;
+    rect.h = SDL_min( line_height, height - row );
+    if ( rect.h <= 0 ) {
+        return;
+    }
+
+    SDL_GetRenderDrawColor( engine->renderer, &r, &g, &b, &a );
+    SDL_GetRenderDrawBlendMode( engine->renderer, &blend );
+    SDL_SetRenderDrawColor( engine->renderer, fg.r, fg.g, fg.b, 255 );
+    SDL_SetRenderDrawBlendMode( engine->renderer, SDL_BLENDMODE_BLEND );
+    SDL_RenderFillRect( engine->renderer, &rect );
+    SDL_SetRenderDrawColor( engine->renderer, r, g, b, a );
+    SDL_SetRenderDrawBlendMode( engine->renderer, blend );
+}
+
+int TTF_DrawRendererUTF8( TTF_TextEngine *engine, TTF_Font *font,
+                          const char *text, int x, int y, SDL_Color fg )
+{
+    SDL_bool first;
+    int xstart;
+    int width, height;
+    int left, top, bottom;
+    c_glyph *glyph;
+    atlas_glyph *entry;
+    SDL_Rect src, dst;
+    FT_Error error;
+    FT_Long use_kerning;
+    FT_UInt prev_index = 0;
+    size_t textlen;
+
+    TTF_CHECKPOINTER(engine, -1);
+    TTF_CHECKPOINTER(text, -1);
+
+    /* Get the dimensions of the text, to clip it like a surface would */
+    if ( TTF_SizeUTF8(font, text, &width, &height) < 0 ) {
+        return -1;
+    }
+    if ( !width ) {
+        return 0;
+    }
+
+    /* check kerning */
+    use_kerning = FT_HAS_KERNING( font->face ) && font->kerning;
+
+    /* Load and draw each character, following TTF_RenderUTF8_Blended() */
+    textlen = SDL_strlen(text);
+    first = SDL_TRUE;
+    xstart = 0;
+    engine->num_draws = 0;
+    while ( textlen > 0 ) {
+        Uint16 c = UTF8_getch(&text, &textlen);
+        if ( c == UNICODE_BOM_NATIVE || c == UNICODE_BOM_SWAPPED ) {
+            continue;
+        }
+
+        error = Find_Glyph(font, c, CACHED_METRICS|CACHED_PIXMAP);
+        if ( error ) {
+            TTF_SetFTError("Couldn't find glyph", error);
+            return -1;
+        }
+        glyph = font->current;
+        entry = Atlas_Find( engine, font, fg );
+        if ( !entry ) {
+            return -1;
+        }
+
+        /* do kerning, if possible AC-Patch */
+        if ( use_kerning && prev_index && glyph->index ) {
+            FT_Vector delta;
+            FT_Get_Kerning( font->face, prev_index, glyph->index, ft_kerning_default, &delta );
+            xstart += delta.x >> 6;
+        }
+
+        /* Compensate for the wrap around bug with negative minx's */
+        if ( first && (glyph->minx < 0) ) {
+            xstart -= glyph->minx;
+        }
+        first = SDL_FALSE;
+
+        /* Ensure the width of the pixmap is correct. On some cases,
+         * freetype may report a larger pixmap than possible.*/
+        src = entry->rect;
+        if ( font->outline <= 0 && src.w > glyph->maxx - glyph->minx ) {
+            src.w = glyph->maxx - glyph->minx;
+        }
+        if ( src.w > width - (xstart + glyph->minx) ) {
+            src.w = width - (xstart + glyph->minx);
+        }
+        left = SDL_max( 0, -(xstart + glyph->minx) );
+        src.x += left;
+        src.w -= left;
+        top = SDL_max( 0, -glyph->yoffset );
+        bottom = SDL_min( src.h, height - glyph->yoffset );
+        src.y += top;
+        src.h = bottom - top;
+        dst.x = x + xstart + glyph->minx + left;
+        dst.y = y + glyph->yoffset + top;
+        dst.w = src.w;
+        dst.h = src.h;
+        if ( src.w > 0 && src.h > 0 ) {
+            if ( Atlas_AddDraw( engine, entry->page, &src, &dst ) < 0 ) {
+                return -1;
+            }
+        }
+
+        xstart += glyph->advance;
+        if ( TTF_HANDLE_STYLE_BOLD(font) ) {
+            xstart += font->glyph_overhang;
+        }
+        prev_index = glyph->index;
+    }
+    Atlas_Submit( engine, fg );
+
+    /* Handle the underline style */
+    if ( TTF_HANDLE_STYLE_UNDERLINE(font) ) {
+        Atlas_DrawLine( engine, font, x, y, width, height, TTF_underline_top_row(font), fg );
+    }
+
+    /* Handle the strikethrough style */
+    if ( TTF_HANDLE_STYLE_STRIKETHROUGH(font) ) {
+        Atlas_DrawLine( engine, font, x, y, width, height, TTF_strikethrough_top_row(font), fg );
+    }
+    return 0;
+}
+
+int TTF_DrawRendererText( TTF_TextEngine *engine, TTF_Font *font,
+                          const char *text, int x, int y, SDL_Color fg )
+{
+    int status = -1;
+    Uint8 *utf8;
+
+    TTF_CHECKPOINTER(text, -1);
+
+    utf8 = SDL_stack_alloc(Uint8, SDL_strlen(text)*2+1);
+    if ( utf8 ) {
+        LATIN1_to_UTF8(text, utf8);
+        status = TTF_DrawRendererUTF8(engine, font, (char *)utf8, x, y, fg);
+        SDL_stack_free(utf8);
+    } else {
+        SDL_OutOfMemory();
+    }
+    return status;
+}
+
+int TTF_DrawRendererUNICODE( TTF_TextEngine *engine, TTF_Font *font,
+                             const Uint16 *text, int x, int y, SDL_Color fg )
+{
+    int status = -1;
+    Uint8 *utf8;
+
+    TTF_CHECKPOINTER(text, -1);
+
+    utf8 = SDL_stack_alloc(Uint8, UCS2_len(text)*3+1);
+    if ( utf8 ) {
+        UCS2_to_UTF8(text, utf8);
+        status = TTF_DrawRendererUTF8(engine, font, (char *)utf8, x, y, fg);
+        SDL_stack_free(utf8);
+    } else {
+        SDL_OutOfMemory();
+    }
+    return status;
+}
+
 void TTF_SetFontStyle( TTF_Font* font, int style )
 {
     int prev_style = font->style;
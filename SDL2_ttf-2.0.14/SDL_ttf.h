@@ -116,6 +116,28 @@ extern DECLSPEC void SDLCALL TTF_SetFontOutline(TTF_Font *font, int outline);
 extern DECLSPEC int SDLCALL TTF_GetFontHinting(const TTF_Font *font);
 extern DECLSPEC void SDLCALL TTF_SetFontHinting(TTF_Font *font, int hinting);
 
+/* Set how much memory the font may use to cache glyphs, in bytes.
+   Glyph metrics and rendered glyphs are cached separately: when the
+   cache is full, the least recently used rendered glyphs are dropped
+   first, and their metrics only once no rendered glyphs are left.
+   The default is TTF_DEFAULT_GLYPH_CACHE_SIZE.
+ */
+#define TTF_DEFAULT_GLYPH_CACHE_SIZE    (1024 * 1024)
+extern DECLSPEC void SDLCALL TTF_SetFontGlyphCacheSize(TTF_Font *font, Uint32 max_bytes);
+
+/* Counters for the glyph cache of a font, since it was opened */
+typedef struct TTF_GlyphCacheStats
+{
+    Uint32 hits;            /* lookups that found what they needed cached */
+    Uint32 misses;          /* lookups that had to load the glyph */
+    Uint32 evictions;       /* glyphs dropped from the cache */
+    Uint32 image_evictions; /* rendered glyphs dropped, keeping their metrics */
+    Uint32 glyphs;          /* glyphs currently cached */
+    Uint32 bytes;           /* memory used by them */
+} TTF_GlyphCacheStats;
+
+extern DECLSPEC void SDLCALL TTF_GetFontGlyphCacheStats(const TTF_Font *font, TTF_GlyphCacheStats *stats);
+
 /* Get the total height of the font - usually equal to point size */
 extern DECLSPEC int SDLCALL TTF_FontHeight(const TTF_Font *font);
 
@@ -239,6 +261,29 @@ extern DECLSPEC SDL_Surface * SDLCALL TTF_RenderUNICODE_Blended_Wrapped(TTF_Font
 extern DECLSPEC SDL_Surface * SDLCALL TTF_RenderGlyph_Blended(TTF_Font *font,
                         Uint16 ch, SDL_Color fg);
 
+/* A text engine draws text straight to a renderer, from glyphs it keeps
+   packed in textures on that renderer.  Text that changes every frame
+   then needs no new surface or texture: only glyphs that haven't been
+   drawn before are rendered and uploaded.
+   The engine must be destroyed before the renderer.
+   This function returns the new engine, or NULL if there was an error.
+*/
+typedef struct _TTF_TextEngine TTF_TextEngine;
+extern DECLSPEC TTF_TextEngine * SDLCALL TTF_CreateRendererTextEngine(SDL_Renderer *renderer);
+extern DECLSPEC void SDLCALL TTF_DestroyRendererTextEngine(TTF_TextEngine *engine);
+
+/* Draw the given text at high quality with the given font and color,
+   with its top left corner at (x, y).  This looks the same as rendering
+   it with TTF_RenderUTF8_Blended() and copying that to the renderer.
+   This function returns 0, or -1 if there was an error.
+*/
+extern DECLSPEC int SDLCALL TTF_DrawRendererText(TTF_TextEngine *engine,
+                TTF_Font *font, const char *text, int x, int y, SDL_Color fg);
+extern DECLSPEC int SDLCALL TTF_DrawRendererUTF8(TTF_TextEngine *engine,
+                TTF_Font *font, const char *text, int x, int y, SDL_Color fg);
+extern DECLSPEC int SDLCALL TTF_DrawRendererUNICODE(TTF_TextEngine *engine,
+                TTF_Font *font, const Uint16 *text, int x, int y, SDL_Color fg);
+
 /* For compatibility with previous versions, here are the old functions */
 #define TTF_RenderText(font, text, fg, bg)  \
     TTF_RenderText_Shaded(font, text, fg, bg)